@@ -62,4 +62,10 @@ BenchmarkBase::Result BenchmarkBase::calculateResult(
     return result;
 }
 
-
+InetAddress benchmarkAddress(const std::string& host, int port) {
+    const std::string kUnixPrefix = "unix:";
+    if (host.compare(0, kUnixPrefix.size(), kUnixPrefix) == 0) {
+        return InetAddress::fromUnixPath(host.substr(kUnixPrefix.size()));
+    }
+    return InetAddress(static_cast<uint16_t>(port), host);
+}
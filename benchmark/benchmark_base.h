@@ -1,5 +1,7 @@
 #pragma once
 #include "Timestamp.h"
+#include "InetAddress.h"
+#include <string>
 #include <vector>
 #include <atomic>
 #include <functional>
@@ -35,4 +37,6 @@ private:
     mutable std::mutex latencies_mutex_;
 };
 
-
+// 解析基准测试的服务器地址：host为"unix:路径"（"unix:@名字"为抽象命名空间）时使用Unix域socket，
+// 否则为IPv4地址host:port
+InetAddress benchmarkAddress(const std::string& host, int port);
@@ -0,0 +1,150 @@
+#include "Buffer.h"
+#include "BufferScan.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Buffer分隔符查找的微基准：对比原来基于std::search的findCRLF与各个向量化实现，
+// 以及WebSocket解掩码的逐字节实现与向量化实现
+namespace
+{
+
+// 原来的Buffer::findCRLF实现
+const char* searchCRLF(const char* begin, const char* end)
+{
+    static const char kCRLF[] = "\r\n";
+    const char* crlf = std::search(begin, end, kCRLF, kCRLF + 2);
+    return crlf == end ? nullptr : crlf;
+}
+
+// 流水线请求：大量短行
+std::string makePipelinedRequests(size_t bytes)
+{
+    const std::string request =
+        "GET /index.html HTTP/1.1\r\n"
+        "Host: 127.0.0.1:8000\r\n"
+        "User-Agent: buffer_scan_bench\r\n"
+        "Accept: */*\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n";
+    std::string data;
+    while (data.size() < bytes)
+    {
+        data += request;
+    }
+    return data;
+}
+
+// 长行：例如大的RESP bulk string或长header
+std::string makeLongLines(size_t bytes, size_t lineLen)
+{
+    std::string data;
+    while (data.size() < bytes)
+    {
+        data.append(lineLen, 'v');
+        data += "\r\n";
+    }
+    return data;
+}
+
+template <typename Find>
+double measure(const std::string& data, int iterations, Find find, size_t* lines)
+{
+    const char* begin = data.data();
+    const char* end = begin + data.size();
+    size_t count = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        const char* p = begin;
+        while (const char* hit = find(p, end))
+        {
+            p = hit + 1;
+            ++count;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    *lines = count / iterations;
+    return static_cast<double>(data.size()) * iterations / seconds / (1024 * 1024);
+}
+
+// WebSocket负载解掩码，data会被反复原地异或
+template <typename Mask>
+double measureMask(std::string* data, int iterations, Mask mask)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        mask(&(*data)[0], data->size());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(data->size()) * iterations / seconds / (1024 * 1024);
+}
+
+const unsigned char kMaskKey[4] = {0x37, 0xfa, 0x21, 0x3d};
+
+void runCase(const std::string& name, const std::string& data, int iterations)
+{
+    std::cout << "--- " << name << " (" << data.size() / 1024 << " KB x " << iterations << ") ---" << std::endl;
+    size_t lines = 0;
+    double baseline = measure(data, iterations, searchCRLF, &lines);
+    std::cout << std::left << std::setw(28) << "std::search findCRLF" << std::fixed << std::setprecision(1)
+              << std::setw(10) << baseline << " MB/s  matches=" << lines << std::endl;
+    std::string payload = data;
+    double byteMask = measureMask(&payload, iterations, [](char* p, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+        {
+            p[i] = static_cast<char>(p[i] ^ kMaskKey[i & 3]);
+        }
+    });
+    std::cout << std::setw(28) << "bytewise xorMask" << std::setw(10) << byteMask << " MB/s" << std::endl;
+
+    const scan::Implementation detected = scan::implementation();
+    const scan::Implementation impls[] = {scan::kScalar, scan::kSse2, scan::kAvx2};
+    for (scan::Implementation impl : impls)
+    {
+        if (!scan::setImplementation(impl))
+        {
+            continue;
+        }
+        std::string label = std::string(scan::implementationName(impl));
+        double crlf = measure(data, iterations, scan::findCRLF, &lines);
+        std::cout << std::setw(28) << (label + " findCRLF") << std::setw(10) << crlf
+                  << " MB/s  x" << std::setprecision(2) << crlf / baseline << std::setprecision(1) << std::endl;
+        double eol = measure(data, iterations, [](const char* b, const char* e) {
+            return scan::findByte(b, e, '\n');
+        }, &lines);
+        std::cout << std::setw(28) << (label + " findEOL") << std::setw(10) << eol << " MB/s" << std::endl;
+        double any = measure(data, iterations, [](const char* b, const char* e) {
+            return scan::findAnyOf(b, e, ":\r\n", 3);
+        }, &lines);
+        std::cout << std::setw(28) << (label + " findAnyOf(\":\\r\\n\")") << std::setw(10) << any
+                  << " MB/s" << std::endl;
+        double mask = measureMask(&payload, iterations, [](char* p, size_t n) {
+            scan::xorMask(p, n, kMaskKey);
+        });
+        std::cout << std::setw(28) << (label + " xorMask") << std::setw(10) << mask
+                  << " MB/s  x" << std::setprecision(2) << mask / byteMask << std::setprecision(1) << std::endl;
+    }
+    scan::setImplementation(detected);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 20;
+    if (iterations <= 0)
+    {
+        iterations = 20;
+    }
+    std::cout << "=== Buffer Scan Benchmark ===" << std::endl;
+    std::cout << "Detected implementation: " << scan::implementationName(scan::implementation()) << std::endl;
+
+    runCase("pipelined HTTP requests", makePipelinedRequests(1024 * 1024), iterations);
+    runCase("4KB lines", makeLongLines(1024 * 1024, 4096), iterations);
+    return 0;
+}
@@ -14,8 +14,8 @@
 #include <fcntl.h>
 #include <errno.h>
 
-EchoServerBench::EchoServerBench(int port, int payload_size)
-    : port_(port), payload_size_(payload_size),
+EchoServerBench::EchoServerBench(int port, int payload_size, const std::string& host)
+    : port_(port), serverAddr_(benchmarkAddress(host, port)), payload_size_(payload_size),
       loop_(nullptr), server_(nullptr), received_bytes_(0) {}
 
 void EchoServerBench::setup() {
@@ -28,8 +28,7 @@ void EchoServerBench::setup() {
     // 先创建服务器线程，在该线程中创建EventLoop
     server_thread_.reset(new std::thread([this] {
         loop_ = new EventLoop;  // 在服务器线程中创建EventLoop
-        InetAddress listenAddr(port_);
-        server_ = new TcpServer(loop_, listenAddr);
+        server_ = new TcpServer(loop_, serverAddr_);
 
         server_->setConnectionCallback([this](const TcpConnectionPtr& conn) {
             if (conn->connected()) {
@@ -51,7 +50,7 @@ void EchoServerBench::setup() {
         server_->setThreadNum(8);
         LOG_INFO("Server thread count set to 8");
         server_->start();
-        LOG_INFO("Server started on port %d", port_);
+        LOG_INFO("Server started on %s", serverAddr_.toIpPort().c_str());
 
         loop_->loop();  // 在服务器线程中运行loop()
 
@@ -77,19 +76,13 @@ BenchmarkBase::Result EchoServerBench::run(int concurrent_clients, int duration_
         // 启动多个客户端
         for (int i = 0; i < concurrent_clients; ++i) {
             clients.emplace_back([this, &total_requests, &total_bytes, &running] {
-                int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+                int sockfd = socket(serverAddr_.family(), SOCK_STREAM, 0);
                 if (sockfd < 0) {
                     LOG_ERROR("Failed to create socket: %s", strerror(errno));
                     return;
                 }
 
-                struct sockaddr_in serv_addr;
-                memset(&serv_addr, 0, sizeof(serv_addr));
-                serv_addr.sin_family = AF_INET;
-                serv_addr.sin_port = htons(port_);
-                inet_pton(AF_INET, "127.0.0.1", &serv_addr.sin_addr);
-
-                if (connect(sockfd, (struct sockaddr*)&serv_addr, sizeof(serv_addr)) < 0) {
+                if (connect(sockfd, serverAddr_.getGenericSockAddr(), serverAddr_.getSockAddrLen()) < 0) {
                     LOG_ERROR("Failed to connect to server: %s", strerror(errno));
                     close(sockfd);
                     return;
@@ -5,10 +5,12 @@
 #include <atomic>
 #include <thread>
 #include <memory>
+#include <string>
 
 class EchoServerBench : public BenchmarkBase {
 public:
-    EchoServerBench(int port, int payload_size);
+    // host为"unix:路径"时服务器和客户端都走Unix域socket，用于与回环TCP对比
+    EchoServerBench(int port, int payload_size, const std::string& host = "127.0.0.1");
 
     void setup() override;
     BenchmarkBase::Result run(int concurrent_clients, int duration_seconds) override;
@@ -16,6 +18,7 @@ public:
 
 private:
     int port_;
+    InetAddress serverAddr_;
     int payload_size_;
     EventLoop* loop_;
     TcpServer* server_;
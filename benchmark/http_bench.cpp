@@ -0,0 +1,230 @@
+#include "HttpServer.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "Eventloop.h"
+#include "InetAddress.h"
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// HTTP服务器压测：进程内启动HttpServer，多个客户端线程在长连接上发送流水线请求，
+// 统计每秒请求数和每批请求的往返延迟
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+const char kRequest[] =
+    "GET /hello HTTP/1.1\r\n"
+    "Host: 127.0.0.1\r\n"
+    "User-Agent: http_bench\r\n"
+    "Accept: */*\r\n"
+    "\r\n";
+
+struct ClientResult
+{
+    uint64_t requests = 0;
+    std::vector<double> latenciesUs;    // 每批流水线请求的往返时间
+    bool ok = true;
+};
+
+int connectTo(int port)
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    int on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof on);
+    sockaddr_in addr;
+    ::memset(&addr, 0, sizeof addr);
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) < 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 从已收到的数据中取出完整响应，返回取出的个数
+int consumeResponses(std::string* data)
+{
+    int count = 0;
+    size_t pos = 0;
+    for (;;)
+    {
+        size_t headerEnd = data->find("\r\n\r\n", pos);
+        if (headerEnd == std::string::npos)
+        {
+            break;
+        }
+        size_t cl = data->find("Content-Length: ", pos);
+        size_t length = 0;
+        if (cl != std::string::npos && cl < headerEnd)
+        {
+            length = std::strtoul(data->c_str() + cl + 16, nullptr, 10);
+        }
+        size_t end = headerEnd + 4 + length;
+        if (data->size() < end)
+        {
+            break;
+        }
+        pos = end;
+        ++count;
+    }
+    data->erase(0, pos);
+    return count;
+}
+
+void runClient(int port, int pipeline, Clock::time_point deadline, ClientResult* result)
+{
+    int fd = connectTo(port);
+    if (fd < 0)
+    {
+        result->ok = false;
+        return;
+    }
+    std::string batch;
+    for (int i = 0; i < pipeline; ++i)
+    {
+        batch += kRequest;
+    }
+    std::string received;
+    char buf[64 * 1024];
+    while (Clock::now() < deadline)
+    {
+        auto start = Clock::now();
+        if (::write(fd, batch.data(), batch.size()) != static_cast<ssize_t>(batch.size()))
+        {
+            result->ok = false;
+            break;
+        }
+        int pending = pipeline;
+        while (pending > 0)
+        {
+            ssize_t n = ::read(fd, buf, sizeof buf);
+            if (n <= 0)
+            {
+                result->ok = false;
+                break;
+            }
+            received.append(buf, static_cast<size_t>(n));
+            pending -= consumeResponses(&received);
+        }
+        if (!result->ok)
+        {
+            break;
+        }
+        result->requests += static_cast<uint64_t>(pipeline);
+        result->latenciesUs.push_back(
+            std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    ::close(fd);
+}
+
+double percentile(std::vector<double>* v, double p)
+{
+    if (v->empty())
+    {
+        return 0;
+    }
+    size_t idx = std::min(v->size() - 1, static_cast<size_t>(p * static_cast<double>(v->size())));
+    std::nth_element(v->begin(), v->begin() + static_cast<long>(idx), v->end());
+    return (*v)[idx];
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    double seconds = argc > 1 ? std::atof(argv[1]) : 5;
+    int connections = argc > 2 ? std::atoi(argv[2]) : 16;
+    int pipeline = argc > 3 ? std::atoi(argv[3]) : 16;
+    int ioThreads = argc > 4 ? std::atoi(argv[4]) : 0;
+    int port = argc > 5 ? std::atoi(argv[5]) : 19100;
+    if (seconds <= 0 || connections <= 0 || pipeline <= 0 || ioThreads < 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [seconds] [connections] [pipeline] [ioThreads] [port]" << std::endl;
+        return 1;
+    }
+    Logger::instance().setLogLevel(ERROR);
+
+    std::cout << "=== HTTP Server Benchmark ===" << std::endl;
+    std::cout << "Duration: " << seconds << "s, connections: " << connections
+              << ", pipeline: " << pipeline << ", io threads: " << ioThreads << std::endl;
+
+    EventLoop* serverLoop = nullptr;
+    std::promise<void> ready;
+    std::thread serverThread([&]() {
+        EventLoop loop;
+        HttpServer server(&loop, InetAddress(static_cast<uint16_t>(port)), TcpServer::kReusePort);
+        server.setThreadNum(ioThreads);
+        server.setHttpCallback([](const HttpRequest&, HttpResponse* resp) {
+            resp->setContentType("text/plain");
+            resp->setBody("Hello, World!");
+        });
+        server.start();
+        serverLoop = &loop;
+        ready.set_value();
+        loop.loop();
+    });
+    ready.get_future().wait();
+
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    std::vector<ClientResult> results(static_cast<size_t>(connections));
+    std::vector<std::thread> clients;
+    for (int i = 0; i < connections; ++i)
+    {
+        clients.emplace_back(runClient, port, pipeline, deadline, &results[static_cast<size_t>(i)]);
+    }
+    for (std::thread& t : clients)
+    {
+        t.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    serverLoop->quit();
+    serverThread.join();
+
+    uint64_t requests = 0;
+    bool ok = true;
+    std::vector<double> latencies;
+    for (ClientResult& r : results)
+    {
+        requests += r.requests;
+        ok = ok && r.ok;
+        latencies.insert(latencies.end(), r.latenciesUs.begin(), r.latenciesUs.end());
+    }
+    double p50 = percentile(&latencies, 0.50);
+    double p99 = percentile(&latencies, 0.99);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Requests: " << requests << std::endl;
+    std::cout << "Requests/sec: " << static_cast<double>(requests) / elapsed << std::endl;
+    std::cout << "Batch latency p50: " << p50 << " us, p99: " << p99 << " us" << std::endl;
+    if (!ok || requests == 0)
+    {
+        std::cerr << "http_bench: client error" << std::endl;
+        return 1;
+    }
+    return 0;
+}
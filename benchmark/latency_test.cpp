@@ -26,8 +26,8 @@
 class LatencyTest : public BenchmarkBase {
 public:
     LatencyTest(const std::string& server_ip, int port, int payload_size)
-        : server_ip_(server_ip), port_(port), payload_size_(payload_size),
-          loop_(nullptr), server_(nullptr) {}
+        : server_ip_(server_ip), port_(port), serverAddr_(benchmarkAddress(server_ip, port)),
+          payload_size_(payload_size), loop_(nullptr), server_(nullptr) {}
 
     void setup() override {
         // 设置日志级别为INFO，启用异步日志记录
@@ -40,8 +40,7 @@ public:
         // 启动服务器线程
         server_thread_.reset(new std::thread([this, &server_ready] {
             loop_ = new EventLoop;
-            InetAddress listenAddr(port_);
-            server_ = new TcpServer(loop_, listenAddr);
+            server_ = new TcpServer(loop_, serverAddr_);
 
             server_->setConnectionCallback([](const TcpConnectionPtr& conn) {
                 if (conn->connected()) {
@@ -101,7 +100,7 @@ public:
 
         // === 步骤 1: 建立所有连接（阻塞模式，确保连接成功）===
         for (int i = 0; i < concurrent_clients; ++i) {
-            int sockfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0); // 直接创建非阻塞 socket
+            int sockfd = socket(serverAddr_.family(), SOCK_STREAM | SOCK_NONBLOCK, 0); // 直接创建非阻塞 socket
             if (sockfd < 0) {
                 std::cerr << "Socket creation failed: " << strerror(errno) << std::endl;
                 continue;
@@ -111,13 +110,8 @@ public:
             int opt = 1;
             setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
 
-            struct sockaddr_in serv_addr{};
-            serv_addr.sin_family = AF_INET;
-            serv_addr.sin_port = htons(port_);
-            inet_pton(AF_INET, server_ip_.c_str(), &serv_addr.sin_addr);
-
-            // 非阻塞 connect
-            if (connect(sockfd, (struct sockaddr*)&serv_addr, sizeof(serv_addr)) < 0) {
+            // 非阻塞 connect（TCP或Unix域socket）
+            if (connect(sockfd, serverAddr_.getGenericSockAddr(), serverAddr_.getSockAddrLen()) < 0) {
                 if (errno != EINPROGRESS) {
                     close(sockfd);
                     continue;
@@ -287,13 +281,14 @@ public:
 private:
     std::string server_ip_;
     int port_;
+    InetAddress serverAddr_;
     int payload_size_;
     EventLoop* loop_;
     TcpServer* server_;
     std::unique_ptr<std::thread> server_thread_;
 };
 
-void run_latency_tests() {
+void run_latency_tests(const std::string& server_ip, int port) {
     // === 关键修复 4: 合理的测试参数 ===
     std::vector<int> payload_sizes = {64, 256, 1024, 4096, 16384, 65536};
     const int clients = 100;    // 从 1000 降至 100（避免客户端瓶颈）
@@ -308,6 +303,7 @@ void run_latency_tests() {
 
     report << "=== Optimized Latency Test Report ===" << std::endl;
     report << "Test Time: " << std::chrono::system_clock::now().time_since_epoch().count() << std::endl;
+    report << "Transport: " << benchmarkAddress(server_ip, port).toIpPort() << std::endl;
     report << "Clients: " << clients << " (non-blocking I/O)" << std::endl;
     report << "Duration: " << duration << "s" << std::endl;
     report << "Server Threads: 8" << std::endl;
@@ -324,7 +320,7 @@ void run_latency_tests() {
         report << "Testing payload size: " << payload << " bytes" << std::endl;
 
         try {
-            LatencyTest test("127.0.0.1", 8888, payload);
+            LatencyTest test(server_ip, port, payload);
             test.setup();
             auto result = test.run(clients, duration);
             test.teardown();
@@ -352,8 +348,10 @@ void run_latency_tests() {
 
 int main(int argc, char* argv[]) {
     if (argc > 1 && std::string(argv[1]) == "--help") {
-        std::cout << "Usage: " << argv[0] << " [server_ip] [port]\n";
+        std::cout << "Usage: " << argv[0] << " [server_ip|unix:path] [port]\n";
         std::cout << "Default: 127.0.0.1 8888\n";
+        std::cout << "  unix:/tmp/latency.sock or unix:@latency runs over a Unix domain socket,\n";
+        std::cout << "  run once with each to compare UDS against loopback TCP\n";
         std::cout << "\nOptimized for accurate latency measurement:\n";
         std::cout << "  - Non-blocking I/O with busy-wait\n";
         std::cout << "  - 100 clients (avoids client-side bottleneck)\n";
@@ -375,7 +373,7 @@ int main(int argc, char* argv[]) {
     std::cout << "Ensure you have sufficient CPU cores (recommend 8+ cores for 100 clients)." << std::endl;
     std::cout << std::endl;
 
-    run_latency_tests();
+    run_latency_tests(server_ip, port);
     std::cout << "Optimized latency test completed." << std::endl;
 
     return 0;
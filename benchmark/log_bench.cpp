@@ -0,0 +1,243 @@
+#include "AsyncLogging.h"
+#include "BinaryLog.h"
+#include "FlightRecorder.h"
+#include "Logger.h"
+#include "LogStream.h"
+#include "Thread.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 日志前端开销压测：同一条带字符串、整数和浮点参数的日志，分别走
+// 文本日志(LOG_INFO)、二进制日志后端格式化、二进制日志原样写入，都输出到AsyncLogging；
+// 以及低于日志级别的BLOG_DEBUG只写进FlightRecorder的环形缓冲区。
+// 输出调用线程上每条日志的平均耗时，以及包括后端写完在内的总耗时。
+// 另外单独比较LogStream数字格式化和原来逐位除法、snprintf的实现。
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+enum Mode
+{
+    kText,
+    kBinaryFormatted,
+    kBinaryRaw,
+    kFlightRecorder,
+};
+
+const char* modeName(Mode mode)
+{
+    switch (mode)
+    {
+    case kText:
+        return "text LOG_INFO";
+    case kBinaryFormatted:
+        return "binary, backend format";
+    case kFlightRecorder:
+        return "flight recorder only";
+    default:
+        return "binary, raw";
+    }
+}
+
+void run(Mode mode, long messages, int threads)
+{
+    Clock::time_point start = Clock::now();
+    double frontNs = 0;
+    {
+        AsyncLogging log("log/log_bench", 1024 * 1024 * 1024, 3);
+        if (mode == kBinaryFormatted)
+        {
+            log.setEncoding(AsyncLogging::kBinaryFormatted);
+        }
+        else if (mode == kBinaryRaw)
+        {
+            log.setEncoding(AsyncLogging::kBinaryRaw);
+        }
+        if (mode == kFlightRecorder)
+        {
+            FlightRecorder::enable("log/log_bench.flight", FlightRecorder::kDefaultRingBytes, false);
+        }
+        log.start();
+        Logger::setOutput([&log](const char* msg, int len) { log.append(msg, len); });
+        binlog::setOutput([&log](const char* record, int len) { log.append(record, len); });
+
+        std::vector<double> elapsedNs(threads);
+        std::vector<std::unique_ptr<Thread>> workers;
+        std::string name = "conn-127.0.0.1:8080#42";
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back(new Thread([&, t]() {
+                Clock::time_point begin = Clock::now();
+                for (long i = 0; i < messages; ++i)
+                {
+                    if (mode == kText)
+                    {
+                        LOG_INFO("conn %s fd=%d bytes=%ld latency=%.3f", name.c_str(), t, i, i * 0.001);
+                    }
+                    else if (mode == kFlightRecorder)
+                    {
+                        BLOG_DEBUG("conn %s fd=%d bytes=%ld latency=%.3f", name.c_str(), t, i, i * 0.001);
+                    }
+                    else
+                    {
+                        BLOG_INFO("conn %s fd=%d bytes=%ld latency=%.3f", name.c_str(), t, i, i * 0.001);
+                    }
+                }
+                elapsedNs[t] = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+            }, "LogBench"));
+        }
+        for (auto& worker : workers)
+        {
+            worker->start();
+        }
+        for (auto& worker : workers)
+        {
+            worker->join();
+        }
+        for (double ns : elapsedNs)
+        {
+            frontNs += ns / messages / threads;
+        }
+        Logger::setOutput([](const char* msg, int len) { fwrite(msg, 1, len, stdout); });
+        binlog::setOutput(nullptr);
+        FlightRecorder::disable();
+        log.stop();
+    }
+    double totalSec = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << std::left << std::setw(26) << modeName(mode) << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << frontNs << " ns/msg"
+              << std::setw(12) << messages * threads / totalSec / 1000 << " k msg/s end-to-end" << std::endl;
+}
+
+// 改写前的LogStream实现：每位一次除法再反转，浮点数用snprintf，指针逐个半字节
+namespace legacy
+{
+
+const char digits[] = "9876543210123456789";
+const char* zero = digits + 9;
+
+template <typename T>
+size_t convert(char buf[], T value)
+{
+    T i = value;
+    char* p = buf;
+    do
+    {
+        int lsd = static_cast<int>(i % 10);
+        i /= 10;
+        *p++ = zero[lsd];
+    } while (i != 0);
+    if (value < 0)
+    {
+        *p++ = '-';
+    }
+    *p = '\0';
+    std::reverse(buf, p);
+    return p - buf;
+}
+
+size_t formatDouble(char* buf, double v)
+{
+    return snprintf(buf, LogStream::kMaxNumericSize, "%.12g", v);
+}
+
+size_t formatPointer(char* buf, const void* p)
+{
+    uintptr_t v = reinterpret_cast<uintptr_t>(p);
+    char* cur = buf;
+    *cur++ = '0';
+    *cur++ = 'x';
+    for (int i = (sizeof(void*) * 2) - 1; i >= 0; --i)
+    {
+        int nibble = (v >> (i * 4)) & 0xf;
+        *cur++ = (nibble < 10) ? ('0' + nibble) : ('a' + nibble - 10);
+    }
+    return cur - buf;
+}
+
+} // namespace legacy
+
+// 每次格式化一个值，满了就重置，输出每个值的平均耗时
+template <typename F>
+double measureNs(long count, F format)
+{
+    Clock::time_point begin = Clock::now();
+    for (long i = 0; i < count; ++i)
+    {
+        format(i);
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / count;
+}
+
+void runLogStream(long count)
+{
+    std::vector<int64_t> integers(1024);
+    std::vector<double> doubles(1024);
+    for (size_t i = 0; i < integers.size(); ++i)
+    {
+        // 1到13位不等，和访问日志里的长度、字节数、耗时相近
+        integers[i] = static_cast<int64_t>((i * 2654435761u) % 1000000007) * (i % 3 == 0 ? 1 : 1000 + i);
+        doubles[i] = integers[i] / 1024.0 + 0.001 * i;
+    }
+    LogStream stream;
+    char buf[64];
+    size_t sink = 0;
+    uintptr_t base = reinterpret_cast<uintptr_t>(&stream);
+
+    auto report = [](const char* name, double legacyNs, double newNs) {
+        std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << legacyNs << " ns -> " << std::setw(6) << newNs << " ns" << std::endl;
+    };
+    report("int64 (division+reverse)",
+           measureNs(count, [&](long i) { sink += legacy::convert(buf, integers[i & 1023]); }),
+           measureNs(count, [&](long i) {
+               if (stream.length() > 3900) stream.reset();
+               stream << integers[i & 1023];
+           }));
+    report("double (snprintf %.12g)",
+           measureNs(count, [&](long i) { sink += legacy::formatDouble(buf, doubles[i & 1023]); }),
+           measureNs(count, [&](long i) {
+               if (stream.length() > 3900) stream.reset();
+               stream << doubles[i & 1023];
+           }));
+    report("pointer (per nibble)",
+           measureNs(count, [&](long i) { sink += legacy::formatPointer(buf, reinterpret_cast<const void*>(base + i * 16)); }),
+           measureNs(count, [&](long i) {
+               if (stream.length() > 3900) stream.reset();
+               stream << reinterpret_cast<const void*>(base + i * 16);
+           }));
+    if (sink == 0)
+    {
+        std::cout << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    long messages = argc > 1 ? std::atol(argv[1]) : 1000000;
+    int threads = argc > 2 ? std::atoi(argv[2]) : 1;
+
+    std::cout << "=== Log Front-end Benchmark ===" << std::endl;
+    std::cout << "Messages per thread: " << messages << ", threads: " << threads << std::endl;
+
+    run(kText, messages, threads);
+    run(kBinaryFormatted, messages, threads);
+    run(kBinaryRaw, messages, threads);
+    run(kFlightRecorder, messages, threads);
+
+    std::cout << "=== LogStream Number Formatting (legacy -> current) ===" << std::endl;
+    runLogStream(messages * 5);
+
+    system("rm -f log/log_bench*.log 2>/dev/null");
+    return 0;
+}
@@ -0,0 +1,277 @@
+#include "RespServer.h"
+#include "RespParser.h"
+#include "RespWriter.h"
+#include "Buffer.h"
+#include "Eventloop.h"
+#include "InetAddress.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// RESP服务器压测，仿照redis-benchmark的流水线模式（-n/-c/-P）：
+// 进程内启动一个简单的键值RespServer，依次测PING、SET、GET，输出每秒请求数和每批往返延迟
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+const int kKeySpace = 100000;
+
+struct ClientResult
+{
+    uint64_t requests = 0;
+    std::vector<double> latenciesUs;
+    bool ok = true;
+};
+
+int connectTo(int port)
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    int on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof on);
+    sockaddr_in addr;
+    ::memset(&addr, 0, sizeof addr);
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) < 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 和redis-benchmark一样使用"key:__rand_int__"形式的键，值为3字节
+void encodeCommand(const std::string& test, std::mt19937* rng, RespWriter* out)
+{
+    if (test == "PING")
+    {
+        out->arrayHeader(1);
+        out->bulkString("PING");
+        return;
+    }
+    std::string key = "key:" + std::to_string((*rng)() % kKeySpace);
+    if (test == "SET")
+    {
+        out->arrayHeader(3);
+        out->bulkString("SET");
+        out->bulkString(key);
+        out->bulkString("xxx");
+    }
+    else
+    {
+        out->arrayHeader(2);
+        out->bulkString("GET");
+        out->bulkString(key);
+    }
+}
+
+void runClient(int port, const std::string& test, uint64_t requests, int pipeline, unsigned seed,
+               ClientResult* result)
+{
+    int fd = connectTo(port);
+    if (fd < 0)
+    {
+        result->ok = false;
+        return;
+    }
+    std::mt19937 rng(seed);
+    Buffer out;
+    Buffer in;
+    RespWriter writer(&out);
+    RespParser parser;
+    while (result->requests < requests)
+    {
+        int batch = static_cast<int>(std::min<uint64_t>(pipeline, requests - result->requests));
+        for (int i = 0; i < batch; ++i)
+        {
+            encodeCommand(test, &rng, &writer);
+        }
+        auto start = Clock::now();
+        std::string data = out.retrieveAllAsString();
+        if (::write(fd, data.data(), data.size()) != static_cast<ssize_t>(data.size()))
+        {
+            result->ok = false;
+            break;
+        }
+        int pending = batch;
+        while (pending > 0)
+        {
+            char buf[64 * 1024];
+            ssize_t n = ::read(fd, buf, sizeof buf);
+            if (n <= 0)
+            {
+                result->ok = false;
+                break;
+            }
+            in.append(buf, static_cast<size_t>(n));
+            RespParser::Result r;
+            while ((r = parser.parse(&in)) == RespParser::kComplete)
+            {
+                --pending;
+            }
+            if (r == RespParser::kError)
+            {
+                result->ok = false;
+                break;
+            }
+            in.retrieve(parser.consumed());
+            parser.clear();
+        }
+        if (!result->ok)
+        {
+            break;
+        }
+        result->requests += static_cast<uint64_t>(batch);
+        result->latenciesUs.push_back(
+            std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    ::close(fd);
+}
+
+double percentile(std::vector<double>* v, double p)
+{
+    if (v->empty())
+    {
+        return 0;
+    }
+    size_t idx = std::min(v->size() - 1, static_cast<size_t>(p * static_cast<double>(v->size())));
+    std::nth_element(v->begin(), v->begin() + static_cast<long>(idx), v->end());
+    return (*v)[idx];
+}
+
+bool runTest(const std::string& test, int port, uint64_t requests, int clients, int pipeline)
+{
+    std::vector<ClientResult> results(static_cast<size_t>(clients));
+    std::vector<std::thread> threads;
+    uint64_t perClient = (requests + static_cast<uint64_t>(clients) - 1) / static_cast<uint64_t>(clients);
+    auto start = Clock::now();
+    for (int i = 0; i < clients; ++i)
+    {
+        threads.emplace_back(runClient, port, test, perClient, pipeline, static_cast<unsigned>(i + 1),
+                             &results[static_cast<size_t>(i)]);
+    }
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    uint64_t total = 0;
+    bool ok = true;
+    std::vector<double> latencies;
+    for (ClientResult& r : results)
+    {
+        total += r.requests;
+        ok = ok && r.ok;
+        latencies.insert(latencies.end(), r.latenciesUs.begin(), r.latenciesUs.end());
+    }
+    double p50 = percentile(&latencies, 0.50);
+    double p99 = percentile(&latencies, 0.99);
+    std::cout << std::fixed << std::setprecision(1)
+              << test << ": " << static_cast<double>(total) / elapsed << " requests per second, "
+              << "p50=" << p50 << " us, p99=" << p99 << " us (per pipeline batch)" << std::endl;
+    return ok && total > 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    long requests = argc > 1 ? std::atol(argv[1]) : 1000000;
+    int clients = argc > 2 ? std::atoi(argv[2]) : 50;
+    int pipeline = argc > 3 ? std::atoi(argv[3]) : 16;
+    int ioThreads = argc > 4 ? std::atoi(argv[4]) : 0;
+    int port = argc > 5 ? std::atoi(argv[5]) : 19101;
+    if (requests <= 0 || clients <= 0 || pipeline <= 0 || ioThreads < 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [requests] [clients] [pipeline] [ioThreads] [port]" << std::endl;
+        return 1;
+    }
+    Logger::instance().setLogLevel(ERROR);
+
+    std::cout << "=== RESP Server Benchmark ===" << std::endl;
+    std::cout << "Requests: " << requests << ", clients: " << clients << ", pipeline: " << pipeline
+              << ", io threads: " << ioThreads << std::endl;
+
+    EventLoop* serverLoop = nullptr;
+    std::promise<void> ready;
+    std::thread serverThread([&]() {
+        EventLoop loop;
+        RespServer server(&loop, InetAddress(static_cast<uint16_t>(port)), TcpServer::kReusePort);
+        server.setThreadNum(ioThreads);
+        // 多个IO线程时每个线程一份数据，压测只关心协议处理开销
+        server.setCommandBatchCallback([](const TcpConnectionPtr&, const RespCommand* cmds, size_t n, RespWriter* out) {
+            thread_local std::unordered_map<std::string, std::string> store;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const RespCommand& cmd = cmds[i];
+                if (cmd.is("ping"))
+                {
+                    out->simpleString("PONG");
+                }
+                else if (cmd.is("set") && cmd.argc == 3)
+                {
+                    store[std::string(cmd[1])].assign(cmd[2].data(), cmd[2].size());
+                    out->ok();
+                }
+                else if (cmd.is("get") && cmd.argc == 2)
+                {
+                    auto it = store.find(std::string(cmd[1]));
+                    if (it == store.end())
+                    {
+                        out->null();
+                    }
+                    else
+                    {
+                        out->bulkString(it->second);
+                    }
+                }
+                else
+                {
+                    out->error("ERR unknown command");
+                }
+            }
+        });
+        server.start();
+        serverLoop = &loop;
+        ready.set_value();
+        loop.loop();
+    });
+    ready.get_future().wait();
+
+    bool ok = true;
+    for (const char* test : {"PING", "SET", "GET"})
+    {
+        ok = runTest(test, port, static_cast<uint64_t>(requests), clients, pipeline) && ok;
+    }
+
+    serverLoop->quit();
+    serverThread.join();
+    if (!ok)
+    {
+        std::cerr << "resp_bench: client error" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include "RpcServer.h"
+#include "RpcClient.h"
+#include "TcpConnection.h"
+#include "Eventloop.h"
+#include "InetAddress.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 多路复用RPC压测：进程内启动一个echo RpcServer，每个客户端连接上始终保持concurrency个未完成的调用，
+// 每个调用完成后立即发出下一个。输出每秒调用数和单个调用的延迟分布。
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchClient
+{
+    BenchClient(EventLoop* loop, const InetAddress& addr, const std::string& name)
+        : client(loop, addr, name)
+    {
+    }
+
+    RpcClient client;
+    uint64_t started = 0;
+    uint64_t finished = 0;
+    bool ok = true;
+    std::vector<double> latenciesUs;
+};
+
+double percentile(std::vector<double>* v, double p)
+{
+    if (v->empty())
+    {
+        return 0;
+    }
+    size_t idx = std::min(v->size() - 1, static_cast<size_t>(p * static_cast<double>(v->size())));
+    std::nth_element(v->begin(), v->begin() + static_cast<long>(idx), v->end());
+    return (*v)[idx];
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    long calls = argc > 1 ? std::atol(argv[1]) : 1000000;
+    int clients = argc > 2 ? std::atoi(argv[2]) : 4;
+    int concurrency = argc > 3 ? std::atoi(argv[3]) : 64;
+    int payloadSize = argc > 4 ? std::atoi(argv[4]) : 32;
+    int port = argc > 5 ? std::atoi(argv[5]) : 19102;
+    if (calls <= 0 || clients <= 0 || concurrency <= 0 || payloadSize < 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [calls] [clients] [concurrency] [payload] [port]" << std::endl;
+        return 1;
+    }
+    Logger::instance().setLogLevel(ERROR);
+
+    std::cout << "=== RPC Benchmark ===" << std::endl;
+    std::cout << "Calls: " << calls << ", clients: " << clients << ", concurrency: " << concurrency
+              << ", payload: " << payloadSize << " bytes" << std::endl;
+
+    EventLoop* serverLoop = nullptr;
+    std::promise<void> ready;
+    std::thread serverThread([&]() {
+        EventLoop loop;
+        RpcServer server(&loop, InetAddress(static_cast<uint16_t>(port)), TcpServer::kReusePort);
+        server.registerMethod("echo", [](std::string_view request, const RpcResponder& responder) {
+            responder.reply(request);
+        });
+        server.start();
+        serverLoop = &loop;
+        ready.set_value();
+        loop.loop();
+    });
+    ready.get_future().wait();
+
+    EventLoop loop;
+    InetAddress serverAddr(static_cast<uint16_t>(port));
+    const std::string payload(static_cast<size_t>(payloadSize), 'x');
+    const uint64_t perClient = (static_cast<uint64_t>(calls) + static_cast<uint64_t>(clients) - 1) /
+                               static_cast<uint64_t>(clients);
+    std::vector<std::unique_ptr<BenchClient>> benchClients;
+    int running = clients;
+
+    std::function<void(BenchClient*)> issue = [&](BenchClient* c) {
+        ++c->started;
+        Clock::time_point start = Clock::now();
+        c->client.call("echo", payload, [&, c, start](rpc::Status status, std::string_view response) {
+            c->latenciesUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            if (status != rpc::kOk || response.size() != payload.size())
+            {
+                c->ok = false;
+            }
+            if (++c->finished == perClient)
+            {
+                if (--running == 0)
+                {
+                    loop.quit();
+                }
+            }
+            else if (c->ok && c->started < perClient)
+            {
+                issue(c);
+            }
+        });
+    };
+
+    for (int i = 0; i < clients; ++i)
+    {
+        benchClients.emplace_back(new BenchClient(&loop, serverAddr, "RpcBench" + std::to_string(i)));
+        BenchClient* c = benchClients.back().get();
+        c->latenciesUs.reserve(perClient);
+        c->client.setConnectionCallback([&, c](const TcpConnectionPtr& conn) {
+            if (!conn->connected())
+            {
+                return;
+            }
+            for (int j = 0; j < concurrency && c->started < perClient; ++j)
+            {
+                issue(c);
+            }
+        });
+    }
+
+    auto start = Clock::now();
+    for (auto& c : benchClients)
+    {
+        c->client.connect();
+    }
+    loop.runAfter(120.0, [&loop]() { loop.quit(); });
+    loop.loop();
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    uint64_t total = 0;
+    bool ok = running == 0;
+    std::vector<double> latencies;
+    for (auto& c : benchClients)
+    {
+        total += c->finished;
+        ok = ok && c->ok;
+        latencies.insert(latencies.end(), c->latenciesUs.begin(), c->latenciesUs.end());
+    }
+    double p50 = percentile(&latencies, 0.50);
+    double p99 = percentile(&latencies, 0.99);
+    double p999 = percentile(&latencies, 0.999);
+    std::cout << std::fixed << std::setprecision(1)
+              << "echo: " << static_cast<double>(total) / elapsed << " calls per second, "
+              << "p50=" << p50 << " us, p99=" << p99 << " us, p99.9=" << p999 << " us" << std::endl;
+
+    serverLoop->quit();
+    serverThread.join();
+    if (!ok)
+    {
+        std::cerr << "rpc_bench: call failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -5,7 +5,7 @@
 #include <iomanip>
 #include <iostream>
 
-void run_throughput_benchmark() {
+void run_throughput_benchmark(const std::string& host) {
     // 【参数调优】客户端数量：{1, 10, 100, 1000}(默认) -> {10, 100, 500, 1000, 2000}(高负荷)
     // 增加客户端数量可以测试高并发下的性能表现
     std::vector<int> client_counts = {10, 100, 500, 1000, 2000};
@@ -22,11 +22,12 @@ void run_throughput_benchmark() {
     }
     report << "=== Throughput Benchmark Report ===" << std::endl;
     report << "Test Time: " << std::chrono::system_clock::now().time_since_epoch().count() << std::endl;
+    report << "Transport: " << benchmarkAddress(host, 8888).toIpPort() << std::endl;
     report << std::endl;
 
     for (int clients : client_counts) {
         for (int payload : payload_sizes) {
-            EchoServerBench bench(8888, payload);
+            EchoServerBench bench(8888, payload, host);
             bench.setup();
 
             // 【参数调优】测试持续时间：10s(默认) -> 30s(高负荷)
@@ -55,9 +56,11 @@ void run_throughput_benchmark() {
     std::cout << "Report saved to: " << report_path << std::endl;
 }
 
-int main() {
+// 用法: echo_bench [unix:路径]，不带参数时走127.0.0.1:8888的回环TCP
+int main(int argc, char* argv[]) {
+    std::string host = (argc > 1) ? argv[1] : "127.0.0.1";
     std::cout << "Starting throughput benchmark...\n";
-    run_throughput_benchmark();
+    run_throughput_benchmark(host);
     std::cout << "Throughput benchmark completed." << std::endl;
 
     // 检查是否有错误日志
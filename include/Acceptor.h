@@ -3,6 +3,7 @@
 #include "Socket.h"
 #include "Channel.h"
 #include <functional>
+#include <string>
 using namespace std;
 class EventLoop;
 class InetAddress;
@@ -21,6 +22,9 @@ public:
 
     bool listenning() const {return listening_;}
     void listen();
+
+    // reuseport模式下按CPU挑选监听socket，groupSize为同一端口上的监听socket数量
+    bool setReusePortCpuFilter(int groupSize) {return acceptSocket_.setReusePortCpuFilter(groupSize);}
 private:
     void handleRead();
     EventLoop *loop_;
@@ -28,4 +32,5 @@ private:
     Channel acceptChannel_;
     NewConnectionCallback newConnectionCallback_;
     bool listening_;
+    string unixPath_;   // 文件路径形式的Unix域监听地址，析构时删除socket文件
 };
\ No newline at end of file
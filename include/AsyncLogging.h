@@ -10,34 +10,150 @@
 #include <atomic>
 #include <string>
 
+/**
+ * @brief AsyncLogging类，异步日志后端
+ *
+ * 每个写日志的线程有自己的暂存缓冲区，append()只在本线程的缓冲区上追加，各线程之间不竞争同一把锁。
+ * 缓冲区写满后通过无锁栈交给后端线程；后端每轮取走所有写满的缓冲区（超时轮次还会收走各线程
+ * 未写满的缓冲区），用一次writev写入文件，再把缓冲区还给所属线程复用。
+ *
+ * 每个线程最多持有bufferPoolDepth个缓冲区（正在写的、等待写入的和空闲的），都在途时临时分配，
+ * 写入后释放。同一线程的日志保持顺序，不同线程之间按到达后端的批次交错。
+ *
+ * 二进制编码时append()收到的是BinaryLog.h的记录，由后端格式化成文本，或者原样写入留给binlog_decode。
+ *
+ * 交给后端还没写完的字节数（积压）有上限，磁盘卡住时内存不会无限增长。积压已满时按策略
+ * 丢弃最新的日志、丢弃本线程还没交出的较旧日志，或者等待一段时间后再丢弃；积压恢复后
+ * 后端把丢弃的条数和字节数作为一条ERROR日志写进文件。
+ */
 class AsyncLogging : noncopyable {
 public:
+    static const size_t kDefaultBufferSize = 256 * 1024;
+    static const int kDefaultBufferPoolDepth = 4;
+
+    enum Encoding {
+        kText,              // 缓冲区原样写入
+        kBinaryFormatted,   // 缓冲区里是二进制日志记录，后端格式化成文本再写入
+        kBinaryRaw,         // 原样写入二进制记录，每个文件开头附带格式点定义
+    };
+
+    enum OverflowPolicy {
+        kDropNewest,        // 丢弃新来的日志
+        kDropOldest,        // 丢弃本线程缓冲区里还没交给后端的日志，保留最近的
+        kBlock,             // 等待积压下降，超时后丢弃新来的日志
+    };
+
+    static const size_t kDefaultMaxBacklogBytes = 64 * 1024 * 1024;
+
     AsyncLogging(const std::string& basename,
                  off_t rollSize,
-                 int flushInterval = 3);
+                 int flushInterval = 3,
+                 size_t bufferSize = kDefaultBufferSize,
+                 int bufferPoolDepth = kDefaultBufferPoolDepth);
 
-    ~AsyncLogging() { if (running_) stop(); }
+    ~AsyncLogging();
 
+    // 线程安全，超过bufferSize的日志被截断
     void append(const char* logline, int len);
 
+    // 在start()之前调用，二进制编码要求bufferSize不小于binlog::kMaxRecordSize
+    void setEncoding(Encoding encoding);
+
+    // 在start()之前调用，maxBacklogBytes为0表示不限制；上限按缓冲区粒度检查，可能超出线程数个缓冲区
+    void setBacklogLimit(size_t maxBacklogBytes, OverflowPolicy policy = kDropNewest, double blockSeconds = 0.1);
+
+    // 在start()之前调用，每隔syncSeconds秒fdatasync一次，0表示不主动落盘
+    void setSyncInterval(int syncSeconds);
+
+    // 在start()之前调用，滚动出去的文件在后台压缩成.gz（需要zlib）
+    void setCompressRolledFiles(bool on);
+
     void start();
     void stop();
 
+    size_t bufferSize() const { return bufferSize_; }
+    int bufferPoolDepth() const { return bufferPoolDepth_; }
+    size_t backlogBytes() const { return backlogBytes_.load(); }
+    // 累计丢弃的日志条数和字节数
+    uint64_t droppedLines() const { return totalDroppedLines_.load(); }
+    uint64_t droppedBytes() const { return totalDroppedBytes_.load(); }
+
 private:
+    struct ThreadBuffer;
+
+    struct LogBuffer {
+        explicit LogBuffer(size_t capacity)
+            : data(new char[capacity]), capacity(capacity) {}
+
+        std::unique_ptr<char[]> data;
+        size_t capacity;
+        size_t length = 0;
+        size_t lines = 0;
+        LogBuffer* next = nullptr;
+        ThreadBuffer* owner = nullptr;
+        bool pooled = true;     // false表示超出池深度临时分配，写入后释放
+    };
+
+    // 一个线程的暂存区，由注册表和该线程的thread_local共同持有
+    struct ThreadBuffer {
+        ~ThreadBuffer();
+
+        MutexLock mutex;                        // 本线程和后端收取未满缓冲区时使用，基本不竞争
+        LogBuffer* current = nullptr;
+        LogBuffer* spare = nullptr;             // 本线程的空闲缓冲区
+        std::atomic<LogBuffer*> returned{nullptr};  // 后端写完还回来的缓冲区
+        int pooled = 0;                         // 已分配的池内缓冲区数
+        std::atomic<int> inFlight{0};           // 已交给后端还没写完的缓冲区数
+        std::atomic<bool> retired{false};       // 线程已退出
+        bool detached = false;                  // AsyncLogging已析构，受mutex保护
+        AsyncLogging* owner = nullptr;
+    };
+
+    ThreadBuffer* threadBuffer();
+    LogBuffer* acquireBuffer(ThreadBuffer* tb);
+    // 把缓冲区交给后端，调用方持有tb->mutex
+    void handOff(ThreadBuffer* tb, LogBuffer* buffer);
+    // 积压已满时按策略处理，返回false表示这条日志被丢弃，调用方持有tb->mutex
+    bool makeRoom(ThreadBuffer* tb, LogBuffer* buffer, size_t len);
+    bool backlogFull() const;
+    void waitForBacklog();
+    void recordDropped(uint64_t lines, uint64_t bytes);
+    // 把积压期间丢弃的统计编码成一条日志，没有丢弃时返回false
+    bool formatDroppedNotice(std::string* out);
+    // 收取各线程未写满的缓冲区
+    void collectPartialBuffers();
+    void releaseBuffer(LogBuffer* buffer);
     void threadFunc();
 
-    typedef FixedBuffer Buffer;
-    typedef std::vector<std::unique_ptr<Buffer>> BufferVector;
-    typedef BufferVector::value_type BufferPtr;
+    static void retireThreadBuffer(const std::shared_ptr<ThreadBuffer>& tb);
 
     const int flushInterval_;
     std::atomic<bool> running_;
     const std::string basename_;
     const off_t rollSize_;
+    const size_t bufferSize_;
+    const int bufferPoolDepth_;
+    const uint64_t instanceId_;   // 区分先后创建在同一地址上的实例
+    Encoding encoding_;
+    size_t maxBacklogBytes_;
+    OverflowPolicy overflowPolicy_;
+    double blockSeconds_;
+    int syncInterval_;
+    bool compressRolledFiles_;
     Thread thread_;
+
+    std::atomic<LogBuffer*> fullBuffers_;   // 写满等待写入的缓冲区，无锁栈
+    std::atomic<bool> sleeping_;            // 后端正在等待，交出缓冲区的线程需要唤醒它
+    std::atomic<size_t> backlogBytes_;      // 已交给后端还没写完的缓冲区容量之和
+    std::atomic<int> blockedWriters_;       // 正在等待积压下降的线程数
+    std::atomic<uint64_t> droppedLines_;    // 下一次写入时报告的丢弃统计
+    std::atomic<uint64_t> droppedBytes_;
+    std::atomic<uint64_t> totalDroppedLines_;
+    std::atomic<uint64_t> totalDroppedBytes_;
     MutexLock mutex_;
     Condition cond_;
-    BufferPtr currentBuffer_;
-    BufferPtr nextBuffer_;
-    BufferVector buffers_;
+    Condition spaceCond_;                   // 积压下降，唤醒kBlock策略下等待的线程
+
+    MutexLock registryMutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers_;
 };
@@ -0,0 +1,267 @@
+#pragma once
+
+#include "Logger.h"
+#include "FlightRecorder.h"
+#include "Timestamp.h"
+#include "noncopyable.h"
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <unordered_map>
+#include <type_traits>
+
+/**
+ * 二进制日志：调用线程只拷贝参数，格式化推迟到AsyncLogging后端线程或离线的binlog_decode
+ *
+ *     BLOG_INFO("connection %s fd=%d", name.c_str(), fd);
+ *
+ * 每个BLOG_XXX语句是一个格式点，格式串、文件、行号、级别和参数类型在模板实例化时确定，
+ * 程序启动时注册并分配ID；格式串里的转换说明个数在编译期和参数个数核对。
+ * 一条记录是 记录头(格式点ID、长度、微秒时间戳) + 各参数的原始字节，字符串按长度拷贝。
+ *
+ * 启用FlightRecorder时，低于日志级别的记录也会编码，只写进本线程的环形缓冲区。
+ *
+ * 支持的参数：整数、枚举、浮点、char、字符串(const char*、std::string、std::string_view)和指针；
+ * 不支持'*'宽度和精度。格式点在main()之前注册，静态初始化期间不要使用BLOG_XXX。
+ */
+namespace binlog {
+
+// 参数类型码：有符号整数b/h/i/l、无符号整数B/H/I/L（按1/2/4/8字节），
+// 浮点d，字符c，字符串s，指针p
+struct Site {
+    const char* format;
+    const char* file;
+    int line;
+    int level;
+    const char* argTypes;
+};
+
+struct RecordHeader {
+    uint32_t siteId;    // 0表示这是一条格式点定义，离线解码时使用
+    uint32_t length;    // 整条记录的字节数，含记录头
+    int64_t micros;     // 写日志时的时间戳
+};
+
+const uint32_t kSiteDefinition = 0;
+const size_t kMaxRecordSize = 1024;
+
+// 注册格式点，返回从1开始的ID，线程安全；超过kMaxSites个时返回kSiteDefinition，之后的记录不输出
+uint32_t registerSite(const Site& site);
+const uint32_t kMaxSites = 256 * 1024;
+// 按ID查找已注册的格式点，不加锁
+const Site* findSite(uint32_t id);
+uint32_t siteCount();
+
+/**
+ * @brief 设置记录的输出，通常是二进制编码的AsyncLogging::append
+ *
+ * 未设置时就地格式化成文本交给Logger::output()，BLOG_XXX和LOG_XXX的输出一致
+ */
+void setOutput(std::function<void(const char*, int)> output);
+void output(const char* record, int len);
+
+// 把一条记录格式化成"[时间] 级别: 消息\n"追加到out
+void formatRecord(const Site& site, const char* record, size_t len, std::string* out);
+
+// 把ID在[firstId, lastId]之间的格式点定义编码成记录追加到out
+void encodeDefinitions(uint32_t firstId, uint32_t lastId, std::string* out);
+
+// 格式点定义记录的固定部分（记录头、ID、级别、行号）写到buf，返回kDefinitionHeadSize；
+// 后面依次是格式串、文件名和参数类型，各以'\0'结尾。不分配内存，可以在信号处理函数里使用
+const size_t kDefinitionHeadSize = sizeof(RecordHeader) + 12;
+size_t encodeDefinitionHead(uint32_t id, const Site& site, char* buf);
+
+/**
+ * @brief 解码二进制日志
+ *
+ * 格式点优先从流中的定义记录查找；useRegistry时找不到再查本进程的注册表（后端格式化）。
+ * 离线解码其他进程写的日志时必须关闭useRegistry，两个进程的格式点ID互不相干。
+ */
+class Decoder : noncopyable {
+public:
+    explicit Decoder(bool useRegistry = true) : useRegistry_(useRegistry) {}
+
+    // 解码data中完整的记录追加到out，返回消费的字节数，末尾不完整的记录留给下次
+    size_t decode(const char* data, size_t len, std::string* out);
+
+private:
+    struct OwnedSite {
+        std::string format;
+        std::string file;
+        std::string argTypes;
+        Site site;
+    };
+
+    const Site* lookup(uint32_t id) const;
+    void define(const char* body, size_t len);
+
+    const bool useRegistry_;
+    std::unordered_map<uint32_t, OwnedSite> sites_;
+};
+
+namespace detail {
+
+template <typename T>
+struct AlwaysFalse : std::false_type {};
+
+template <typename T>
+constexpr char argCode() {
+    typedef std::decay_t<T> U;
+    if constexpr (std::is_enum_v<U>) {
+        return argCode<std::underlying_type_t<U>>();
+    } else if constexpr (std::is_same_v<U, bool>) {
+        return 'B';
+    } else if constexpr (std::is_same_v<U, char>) {
+        return 'c';
+    } else if constexpr (std::is_integral_v<U>) {
+        constexpr const char* codes = std::is_signed_v<U> ? "bh?i???l" : "BH?I???L";
+        return codes[sizeof(U) - 1];
+    } else if constexpr (std::is_floating_point_v<U>) {
+        return 'd';
+    } else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*> ||
+                         std::is_same_v<U, std::string> || std::is_same_v<U, std::string_view>) {
+        return 's';
+    } else if constexpr (std::is_pointer_v<U>) {
+        return 'p';
+    } else {
+        static_assert(AlwaysFalse<U>::value, "unsupported binary log argument type");
+        return '?';
+    }
+}
+
+template <typename... Args>
+struct ArgTypes {
+    static constexpr char value[] = {argCode<Args>()..., '\0'};
+};
+
+// 格式串中转换说明的个数，"%%"不计
+constexpr size_t countConversions(const char* format) {
+    size_t n = 0;
+    for (const char* p = format; *p != '\0'; ++p) {
+        if (*p == '%') {
+            if (p[1] == '%') {
+                ++p;
+            } else {
+                ++n;
+            }
+        }
+    }
+    return n;
+}
+
+// 每个参数在记录中固定占用的字节数，字符串只计长度字段
+template <typename T>
+constexpr size_t fixedSize() {
+    constexpr char code = argCode<T>();
+    switch (code) {
+    case 'b': case 'B': case 'c': return 1;
+    case 'h': case 'H': case 's': return 2;
+    case 'i': case 'I': return 4;
+    default: return 8;
+    }
+}
+
+template <typename T>
+inline void encodeArg(char*& cur, size_t& stringBudget, const T& value) {
+    constexpr char code = argCode<T>();
+    if constexpr (code == 's') {
+        std::string_view s;
+        if constexpr (std::is_pointer_v<T>) {
+            // 只有真正的指针才可能为空，字符数组直接转换
+            s = value != nullptr ? std::string_view(value) : std::string_view("(null)");
+        } else {
+            s = value;
+        }
+        uint16_t n = static_cast<uint16_t>(std::min(s.size(), stringBudget));
+        stringBudget -= n;
+        memcpy(cur, &n, sizeof n);
+        memcpy(cur + sizeof n, s.data(), n);
+        cur += sizeof n + n;
+    } else if constexpr (code == 'd') {
+        double v = static_cast<double>(value);
+        memcpy(cur, &v, sizeof v);
+        cur += sizeof v;
+    } else if constexpr (code == 'p') {
+        uint64_t v = reinterpret_cast<uintptr_t>(value);
+        memcpy(cur, &v, sizeof v);
+        cur += sizeof v;
+    } else {
+        memcpy(cur, &value, sizeof value);
+        cur += sizeof value;
+    }
+}
+
+// 格式点的ID，模板静态成员在程序启动时初始化，每个(格式点, 参数类型)组合注册一次
+template <typename SiteTag, typename... Args>
+struct Registration {
+    static const uint32_t id;
+};
+
+template <typename SiteTag, typename... Args>
+const uint32_t Registration<SiteTag, Args...>::id = registerSite(
+    Site{SiteTag::format(), SiteTag::file(), SiteTag::line(), SiteTag::level(), ArgTypes<Args...>::value});
+
+} // namespace detail
+
+// 把一条记录编码进buf（至少kMaxRecordSize字节），返回记录长度，格式点还没注册时返回0
+template <typename SiteTag, typename... Args>
+int encode(char* buf, const Args&... args) {
+    static_assert(detail::countConversions(SiteTag::format()) == sizeof...(Args),
+                  "binary log format does not match the number of arguments");
+    constexpr size_t kFixed = sizeof(RecordHeader) + (detail::fixedSize<Args>() + ... + 0);
+    static_assert(kFixed <= kMaxRecordSize, "too many binary log arguments");
+
+    uint32_t id = detail::Registration<SiteTag, std::decay_t<Args>...>::id;
+    if (id == kSiteDefinition) {
+        return 0;  // 静态初始化期间格式点还没注册
+    }
+    char* cur = buf + sizeof(RecordHeader);
+    size_t stringBudget = kMaxRecordSize - kFixed;
+    (detail::encodeArg(cur, stringBudget, args), ...);
+    (void)stringBudget;  // 没有字符串参数时不会用到
+
+    RecordHeader header = {id, static_cast<uint32_t>(cur - buf), Timestamp::now().microSecondsSinceEpoch()};
+    memcpy(buf, &header, sizeof header);
+    return static_cast<int>(cur - buf);
+}
+
+template <typename SiteTag, typename... Args>
+void log(const Args&... args) {
+    char buf[kMaxRecordSize];
+    int len = encode<SiteTag>(buf, args...);
+    if (len > 0) {
+        if (FlightRecorder::enabled()) {
+            FlightRecorder::record(buf, len);
+        }
+        if (Logger::enabled(SiteTag::level())) {
+            output(buf, len);
+        }
+    }
+}
+
+} // namespace binlog
+
+// 格式点是语句处的局部类型，格式串和位置都是它的constexpr成员；
+// 低于日志级别时只在FlightRecorder启用时编码
+#define BLOG_IMPL(lvl, LogmsgFormat, ...) \
+    do \
+    { \
+        if (Logger::enabled(lvl) || FlightRecorder::enabled()) \
+        { \
+            struct BinlogSite \
+            { \
+                static constexpr const char* format() { return LogmsgFormat; } \
+                static constexpr const char* file() { return __FILE__; } \
+                static constexpr int line() { return __LINE__; } \
+                static constexpr int level() { return lvl; } \
+            }; \
+            binlog::log<BinlogSite>(__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define BLOG_INFO(LogmsgFormat, ...) BLOG_IMPL(INFO, LogmsgFormat, ##__VA_ARGS__)
+#define BLOG_ERROR(LogmsgFormat, ...) BLOG_IMPL(ERROR, LogmsgFormat, ##__VA_ARGS__)
+#define BLOG_DEBUG(LogmsgFormat, ...) BLOG_IMPL(DEBUG, LogmsgFormat, ##__VA_ARGS__)
@@ -4,6 +4,10 @@
 #include <vector>
 #include <algorithm>
 #include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <endian.h>
+#include "BufferScan.h"
 
 class Buffer
 {
@@ -33,16 +37,72 @@ public:
     const char* peek() const
     { return begin() + readerIndex_; }
 
+    // 原地修改可读数据用，如WebSocket帧的解掩码
+    char* mutablePeek()
+    { return begin() + readerIndex_; }
+
+    // 以下查找函数使用BufferScan中按CPU选择的向量化实现，找不到返回nullptr
     const char* findCRLF() const
     {
-        const char* crlf = std::search(peek(), beginWrite(), kCRLF, kCRLF + 2);
-        return crlf == beginWrite() ? nullptr : crlf;
+        return scan::findCRLF(peek(), beginWrite());
     }
 
     const char* findCRLF(const char* start) const
     {
-        const char* crlf = std::search(start, beginWrite(), kCRLF, kCRLF + 2);
-        return crlf == beginWrite() ? nullptr : crlf;
+        return scan::findCRLF(start, beginWrite());
+    }
+
+    const char* findEOL() const
+    {
+        return scan::findByte(peek(), beginWrite(), '\n');
+    }
+
+    const char* findEOL(const char* start) const
+    {
+        return scan::findByte(start, beginWrite(), '\n');
+    }
+
+    /**
+     * 增量查找：从peek()+*offset开始查找，找不到时把*offset推进到下次需要开始的位置，
+     * 新数据到达后再次调用不会重复扫描已经看过的字节。offset是相对peek()的偏移，
+     * 缓冲区扩容后依然有效；retrieve之后需要由调用方清零。
+     */
+    const char* findCRLF(size_t* offset) const
+    {
+        const char* found = scan::findCRLF(peek() + std::min(*offset, readableBytes()), beginWrite());
+        if (found == nullptr)
+        {
+            // 最后一个字节可能是'\r'，下次从它开始
+            *offset = readableBytes() > 0 ? readableBytes() - 1 : 0;
+        }
+        return found;
+    }
+
+    const char* findEOL(size_t* offset) const
+    {
+        return findByte('\n', offset);
+    }
+
+    const char* findByte(char c, size_t* offset) const
+    {
+        const char* found = scan::findByte(peek() + std::min(*offset, readableBytes()), beginWrite(), c);
+        if (found == nullptr)
+        {
+            *offset = readableBytes();
+        }
+        return found;
+    }
+
+    // 查找set中任意一个字节，set不超过scan::kMaxVectorSet个字节时走向量化路径
+    const char* findAnyOf(const char* set, size_t setSize, size_t* offset) const
+    {
+        const char* found = scan::findAnyOf(peek() + std::min(*offset, readableBytes()), beginWrite(),
+                                            set, setSize);
+        if (found == nullptr)
+        {
+            *offset = readableBytes();
+        }
+        return found;
     }
 
     void retrieve(size_t len)
@@ -99,6 +159,175 @@ public:
         append(static_cast<const char*>(data), len);
     }
 
+    // 按网络字节序追加整数
+    void appendInt64(int64_t x)
+    {
+        int64_t be64 = static_cast<int64_t>(htobe64(static_cast<uint64_t>(x)));
+        append(&be64, sizeof be64);
+    }
+
+    void appendInt32(int32_t x)
+    {
+        int32_t be32 = static_cast<int32_t>(htobe32(static_cast<uint32_t>(x)));
+        append(&be32, sizeof be32);
+    }
+
+    void appendInt16(int16_t x)
+    {
+        int16_t be16 = static_cast<int16_t>(htobe16(static_cast<uint16_t>(x)));
+        append(&be16, sizeof be16);
+    }
+
+    void appendInt8(int8_t x)
+    {
+        append(&x, sizeof x);
+    }
+
+    // 读取网络字节序的整数，要求可读字节足够
+    int64_t peekInt64() const
+    {
+        assert(readableBytes() >= sizeof(int64_t));
+        uint64_t be64 = 0;
+        ::memcpy(&be64, peek(), sizeof be64);
+        return static_cast<int64_t>(be64toh(be64));
+    }
+
+    int32_t peekInt32() const
+    {
+        assert(readableBytes() >= sizeof(int32_t));
+        uint32_t be32 = 0;
+        ::memcpy(&be32, peek(), sizeof be32);
+        return static_cast<int32_t>(be32toh(be32));
+    }
+
+    int16_t peekInt16() const
+    {
+        assert(readableBytes() >= sizeof(int16_t));
+        uint16_t be16 = 0;
+        ::memcpy(&be16, peek(), sizeof be16);
+        return static_cast<int16_t>(be16toh(be16));
+    }
+
+    int8_t peekInt8() const
+    {
+        assert(readableBytes() >= sizeof(int8_t));
+        return static_cast<int8_t>(*peek());
+    }
+
+    int64_t readInt64()
+    {
+        int64_t result = peekInt64();
+        retrieve(sizeof result);
+        return result;
+    }
+
+    int32_t readInt32()
+    {
+        int32_t result = peekInt32();
+        retrieve(sizeof result);
+        return result;
+    }
+
+    int16_t readInt16()
+    {
+        int16_t result = peekInt16();
+        retrieve(sizeof result);
+        return result;
+    }
+
+    int8_t readInt8()
+    {
+        int8_t result = peekInt8();
+        retrieve(sizeof result);
+        return result;
+    }
+
+    // 无符号LEB128变长整数（protobuf varint），每字节7位，最多10字节
+    static const size_t kMaxVarintBytes = 10;
+
+    void appendVarint(uint64_t x)
+    {
+        char buf[kMaxVarintBytes];
+        size_t n = encodeVarint(x, buf);
+        append(buf, n);
+    }
+
+    /**
+     * @brief 读取变长整数但不移动读指针
+     * @return 编码占用的字节数；数据还不完整返回0，超过10字节仍未结束或超出64位返回-1
+     */
+    int peekVarint(uint64_t* value) const
+    {
+        return decodeVarint(peek(), readableBytes(), value);
+    }
+
+    // 读取一个完整的变长整数，调用方需先用peekVarint确认数据完整
+    uint64_t readVarint()
+    {
+        uint64_t value = 0;
+        int n = peekVarint(&value);
+        assert(n > 0);
+        retrieve(static_cast<size_t>(n));
+        return value;
+    }
+
+    static size_t encodeVarint(uint64_t x, char* buf)
+    {
+        size_t n = 0;
+        while (x >= 0x80)
+        {
+            buf[n++] = static_cast<char>((x & 0x7f) | 0x80);
+            x >>= 7;
+        }
+        buf[n++] = static_cast<char>(x);
+        return n;
+    }
+
+    static int decodeVarint(const char* data, size_t len, uint64_t* value)
+    {
+        uint64_t result = 0;
+        size_t limit = std::min(len, kMaxVarintBytes);
+        for (size_t i = 0; i < limit; ++i)
+        {
+            uint8_t byte = static_cast<uint8_t>(data[i]);
+            if (i == kMaxVarintBytes - 1 && byte > 0x01)
+            {
+                // 第10字节只能放下最高的1位，更大的值或延续位都是溢出
+                return -1;
+            }
+            result |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+            if ((byte & 0x80) == 0)
+            {
+                *value = result;
+                return static_cast<int>(i + 1);
+            }
+        }
+        return len >= kMaxVarintBytes ? -1 : 0;
+    }
+
+    void prependInt64(int64_t x)
+    {
+        int64_t be64 = static_cast<int64_t>(htobe64(static_cast<uint64_t>(x)));
+        prepend(&be64, sizeof be64);
+    }
+
+    void prependInt32(int32_t x)
+    {
+        int32_t be32 = static_cast<int32_t>(htobe32(static_cast<uint32_t>(x)));
+        prepend(&be32, sizeof be32);
+    }
+
+    void prependInt16(int16_t x)
+    {
+        int16_t be16 = static_cast<int16_t>(htobe16(static_cast<uint16_t>(x)));
+        prepend(&be16, sizeof be16);
+    }
+
+    void prependInt8(int8_t x)
+    {
+        prepend(&x, sizeof x);
+    }
+
     void prepend(const void* data, size_t len)
     {
         if (len < prependableBytes())
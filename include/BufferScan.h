@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief 缓冲区中查找分隔符等逐字节处理的向量化实现
+ *
+ * 进程第一次使用时按CPU选择实现：支持AVX2时每次比较32字节，否则在x86-64上用SSE2每次16字节，
+ * 其他平台退回逐字节的标量实现。所有函数在[begin, end)中查找，找不到返回nullptr。
+ */
+namespace scan
+{
+
+enum Implementation
+{
+    kScalar,
+    kSse2,
+    kAvx2,
+};
+
+// 查找单个字节
+const char* findByte(const char* begin, const char* end, char c);
+
+// 查找"\r\n"，返回'\r'的位置
+const char* findCRLF(const char* begin, const char* end);
+
+// 查找set中任意一个字节；不超过kMaxVectorSet个字节时走向量化路径
+const size_t kMaxVectorSet = 8;
+const char* findAnyOf(const char* begin, const char* end, const char* set, size_t setSize);
+
+// 与4字节循环密钥异或（WebSocket的掩码/解掩码），原地修改[data, data + len)。
+// keyOffset为data[0]在密钥中的位置（只取低2位），便于分段处理同一帧
+void xorMask(char* data, size_t len, const unsigned char key[4], size_t keyOffset = 0);
+
+// 当前使用的实现
+Implementation implementation();
+const char* implementationName(Implementation impl);
+
+// 强制使用某个实现，供测试和基准对比用；CPU不支持时返回false且不改变当前实现。
+// 不是线程安全的，只应在启动IO线程之前调用
+bool setImplementation(Implementation impl);
+
+} // namespace scan
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "noncopyable.h"
+#include "InetAddress.h"
+#include "Timer.h"
+#include <functional>
+#include <memory>
+
+class Channel;
+class EventLoop;
+
+/**
+ * @brief Connector类，负责发起非阻塞connect
+ *
+ * connect返回EINPROGRESS后通过Channel等待可写，再用SO_ERROR判断结果；
+ * 失败时按指数退避重试（初始500ms，上限30s），成功后把sockfd交给NewConnectionCallback。
+ * Connector只在所属loop线程中工作，由TcpClient持有。
+ */
+class Connector : noncopyable, public std::enable_shared_from_this<Connector>
+{
+public:
+    using NewConnectionCallback = std::function<void(int sockfd)>;
+
+    Connector(EventLoop *loop, const InetAddress &serverAddr);
+    ~Connector();
+
+    void setNewConnectionCallback(const NewConnectionCallback &cb) { newConnectionCallback_ = cb; }
+
+    // 设置重试的初始间隔和最大间隔（毫秒）
+    void setRetryDelay(int initDelayMs, int maxDelayMs)
+    {
+        initRetryDelayMs_ = initDelayMs;
+        maxRetryDelayMs_ = maxDelayMs;
+        retryDelayMs_ = initDelayMs;
+    }
+
+    void start();   // 可在任意线程调用
+    void restart(); // 必须在loop线程调用
+    void stop();    // 可在任意线程调用
+
+    const InetAddress &serverAddress() const { return serverAddr_; }
+    // 已经进行过的重试次数，连接成功后清零
+    int retries() const { return retries_; }
+
+    static const int kMaxRetryDelayMs = 30 * 1000;
+    static const int kInitRetryDelayMs = 500;
+
+private:
+    enum States { kDisconnected, kConnecting, kConnected };
+
+    void setState(States s) { state_ = s; }
+    void startInLoop();
+    void stopInLoop();
+    void connect();
+    void connecting(int sockfd);
+    void handleWrite();
+    void handleError();
+    void retry(int sockfd);
+    int removeAndResetChannel();
+    void resetChannel();
+
+    EventLoop *loop_;
+    InetAddress serverAddr_;
+    bool connect_;
+    States state_;
+    std::unique_ptr<Channel> channel_;
+    NewConnectionCallback newConnectionCallback_;
+    int initRetryDelayMs_;
+    int maxRetryDelayMs_;
+    int retryDelayMs_;
+    int retries_;
+    TimerId retryTimerId_;
+};
+
+using ConnectorPtr = std::shared_ptr<Connector>;
@@ -0,0 +1,316 @@
+#pragma once
+
+/**
+ * C++20协程接口，只在以-DRE_MUDUO_COROUTINES=ON配置（使用-std=c++20编译）时可用。
+ *
+ *   co::Task<> session(TcpConnectionPtr conn)
+ *   {
+ *       co::Stream stream(conn);
+ *       while (auto line = co_await stream.readUntil("\r\n"))
+ *       {
+ *           co_await stream.send(*line);
+ *           co_await conn->getLoop()->sleep(0.1);
+ *       }
+ *   }
+ *   // 在连接回调中：co::spawn(conn->getLoop(), session(conn));
+ *
+ * 所有挂起点都由所属EventLoop上的事件（可读、写完成、连接关闭、定时器）直接恢复，
+ * 恢复发生在loop线程的回调中，不经过额外的线程切换和任务队列。
+ */
+#ifdef RE_MUDUO_COROUTINES
+
+#include "Callbacks.h"
+#include "noncopyable.h"
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+class EventLoop;
+class Buffer;
+
+namespace co
+{
+
+/**
+ * @brief 协程帧分配器
+ *
+ * 按64字节分级缓存释放的协程帧，同一线程（即同一个EventLoop）上反复创建的短命协程直接复用，
+ * 不再走全局的operator new。每个线程一个实例，在其他线程释放的帧放入那个线程的缓存，
+ * 超过kMaxBlockSize的帧和超出每级缓存上限的块直接交还给operator delete。
+ */
+class FrameAllocator : noncopyable
+{
+public:
+    static constexpr size_t kGranularity = 64;
+    static constexpr size_t kMaxBlockSize = 2048;
+    static constexpr size_t kMaxCachedPerClass = 1024;
+
+    static FrameAllocator& current();
+
+    void* allocate(size_t size);
+    void deallocate(void* p, size_t size);
+
+    // 从缓存中复用的次数和向operator new申请的次数
+    size_t reused() const { return reused_; }
+    size_t allocated() const { return allocated_; }
+
+    ~FrameAllocator();
+
+private:
+    FrameAllocator() = default;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    static constexpr size_t kClasses = kMaxBlockSize / kGranularity;
+
+    FreeBlock* freeLists_[kClasses] = {};
+    size_t cached_[kClasses] = {};
+    size_t reused_ = 0;
+    size_t allocated_ = 0;
+};
+
+// 所有协程帧共用的promise基类：帧从FrameAllocator分配，保存等待者和异常
+struct PromiseBase
+{
+    static void* operator new(size_t size) { return FrameAllocator::current().allocate(size); }
+    static void operator delete(void* p, size_t size) { FrameAllocator::current().deallocate(p, size); }
+
+    struct FinalAwaiter
+    {
+        bool await_ready() noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept
+        {
+            PromiseBase& promise = h.promise();
+            if (promise.detached)
+            {
+                promise.finishDetached();
+                h.destroy();
+                return std::noop_coroutine();
+            }
+            // 对称转移：直接切回等待者，不增加调用栈深度
+            return promise.continuation ? promise.continuation : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { exception = std::current_exception(); }
+
+    // spawn()启动的协程结束时调用：没有等待者接收的异常写入日志
+    void finishDetached();
+
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+    bool detached = false;
+};
+
+template <typename T>
+struct Promise : PromiseBase
+{
+    template <typename U>
+    void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+
+    T result()
+    {
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+        return std::move(*value);
+    }
+
+    std::optional<T> value;
+};
+
+template <>
+struct Promise<void> : PromiseBase
+{
+    void return_void() {}
+
+    void result()
+    {
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+/**
+ * @brief 惰性启动的协程任务
+ *
+ * 创建时不执行，被co_await时才开始运行，结束后恢复等待者；最外层的任务交给spawn()启动。
+ */
+template <typename T = void>
+class [[nodiscard]] Task
+{
+public:
+    struct promise_type : Promise<T>
+    {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task()
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    T await_resume() { return handle_.promise().result(); }
+
+    // 交出协程句柄，由spawn()管理生命周期
+    std::coroutine_handle<promise_type> release() { return std::exchange(handle_, nullptr); }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> h) : handle_(h) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// 在loop线程中启动task（在loop线程调用时立即执行到第一个挂起点），协程结束后自动释放
+void spawn(EventLoop* loop, Task<> task);
+
+/**
+ * @brief co_await loop->sleep(seconds)的等待对象，由loop的定时器恢复
+ */
+class SleepAwaitable
+{
+public:
+    SleepAwaitable(EventLoop* loop, double seconds) : loop_(loop), seconds_(seconds) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h);
+    void await_resume() const noexcept {}
+
+private:
+    EventLoop* loop_;
+    double seconds_;
+};
+
+/**
+ * @brief Stream类，把一个TcpConnection交给协程读写
+ *
+ * 构造时接管连接的消息、写完成、高水位和连接回调（原来的回调不再调用，连接关闭通过读写的结果通知），
+ * 只能在连接所属的loop线程中使用。read/readUntil返回指向inputBuffer_的视图，不做拷贝，
+ * 在同一个Stream的下一次读操作之前有效；连接关闭且数据不足时返回std::nullopt。
+ * Stream析构后连接上再到达的数据留在inputBuffer_中不处理。
+ */
+class Stream : noncopyable
+{
+public:
+    static constexpr size_t kDefaultHighWaterMark = 64 * 1024;
+    static constexpr size_t kDefaultMaxLineLength = 64 * 1024;
+
+    explicit Stream(const TcpConnectionPtr& conn);
+    ~Stream();
+
+    const TcpConnectionPtr& connection() const { return conn_; }
+
+    // send()之后outputBuffer_中未发出的数据达到该值时挂起，直到全部发出
+    void setHighWaterMark(size_t n) { state_->highWaterMark = n; }
+    size_t highWaterMark() const { return state_->highWaterMark; }
+    // readUntil()查找分隔符的最大长度，超过时返回std::nullopt
+    void setMaxLineLength(size_t n) { state_->maxLineLength = n; }
+
+    class ReadAwaitable;
+    class SendAwaitable;
+
+    // 恰好n字节
+    ReadAwaitable read(size_t n);
+    // 到分隔符为止的数据，不含分隔符，分隔符一并消费
+    ReadAwaitable readUntil(std::string_view delimiter);
+    // 发出data，返回连接是否仍然有效
+    SendAwaitable send(std::string_view data);
+
+private:
+    struct State;
+
+public:
+    class ReadAwaitable
+    {
+    public:
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> h);
+        std::optional<std::string_view> await_resume();
+
+    private:
+        friend class Stream;
+
+        ReadAwaitable(State* state, size_t n, std::string_view delimiter)
+            : state_(state), n_(n), delimiter_(delimiter), scanFrom_(0), found_(std::string_view::npos)
+        {
+        }
+
+        // 数据是否已经足够，找到分隔符时记录其位置
+        bool satisfied();
+
+        State* state_;
+        std::coroutine_handle<> handle_;
+        size_t n_;
+        std::string_view delimiter_;    // 为空时按长度读
+        size_t scanFrom_;
+        size_t found_;
+    };
+
+    class SendAwaitable
+    {
+    public:
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> h);
+        bool await_resume() const;
+
+    private:
+        friend class Stream;
+
+        SendAwaitable(Stream* stream, std::string_view data) : stream_(stream), data_(data) {}
+
+        Stream* stream_;
+        std::string_view data_;
+    };
+
+private:
+    struct State
+    {
+        Buffer* input = nullptr;
+        Buffer* output = nullptr;
+        ReadAwaitable* reader = nullptr;    // 挂起中的读操作，位于协程帧中
+        std::coroutine_handle<> writer;
+        size_t pendingRetrieve = 0;         // 上次读返回的视图占用的字节，下次读之前才从缓冲区取走
+        size_t highWaterMark = kDefaultHighWaterMark;
+        size_t maxLineLength = kDefaultMaxLineLength;
+        bool closed = false;
+
+        void onMessage();
+        void onWriteComplete();
+        void onClose();
+    };
+
+    TcpConnectionPtr conn_;
+    // 连接的回调持有State，Stream析构后回调仍然可以安全地执行
+    std::shared_ptr<State> state_;
+};
+
+} // namespace co
+
+#endif // RE_MUDUO_COROUTINES
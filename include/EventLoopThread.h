@@ -21,9 +21,11 @@ public:
      * 构造函数
      * @param cb 线程初始化回调函数，默认为空函数
      * @param name 线程名称，默认为空字符串
+     * @param cpu 绑定的CPU编号，-1表示不绑定
      */
     EventLoopThread(const ThreadInitCallback &cb = ThreadInitCallback(),
-        const string &name = string());
+        const string &name = string(),
+        int cpu = -1);
 
     // 析构函数
     ~EventLoopThread();
@@ -33,6 +35,12 @@ public:
      * @return 返回事件循环对象的指针
      */
     EventLoop* startLoop();
+
+    // 返回该线程绑定的CPU编号，-1表示未绑定
+    int cpu() const { return cpu_; }
+
+    // 返回startLoop()得到的事件循环，线程退出后为nullptr
+    EventLoop* getLoop() { std::unique_lock<std::mutex> lock(mutex_); return loop_; }
 private:
     // 线程主函数
     void threadFunc();
@@ -45,4 +53,5 @@ private:
     mutex mutex_;               // 互斥锁
     condition_variable cond_;   // 条件变量
     ThreadInitCallback callback_; // 线程初始化回调函数
+    int cpu_;                   // 绑定的CPU编号
 };
\ No newline at end of file
@@ -19,15 +19,35 @@ public:
 
     void setThreadNUm(int numThreads) {numThreads_ = numThreads;}
 
+    // 开启后第i个IO线程绑定到进程可用CPU列表中的第(i % n)个CPU，必须在start()之前设置
+    void setCpuAffinity(bool on) {pinLoops_ = on;}
+
     void start(const ThreadInitCallback &cb = ThreadInitCallback());
 
     EventLoop* getNextLoop();
 
+    // 返回绑定在cpu上的IO线程的loop（同一CPU上有多个时轮询），没有匹配时回退到getNextLoop()
+    EventLoop* getLoopForCpu(int cpu);
+
     vector<EventLoop*> getAllLoops();
 
+    // 运行时扩缩容，均需在baseLoop线程中调用
+    // addLoop: 新建一个IO线程并加入轮询，返回其loop
+    EventLoop* addLoop();
+    // retireLoop: 把最后加入的loop移出轮询（不再分配新连接），线程仍然运行直到reapLoop
+    EventLoop* retireLoop();
+    // reapLoop: 结束已退役loop的线程，调用前需保证该loop上已没有连接；
+    // 不阻塞，该loop执行完此前排队的任务后，线程在baseLoop中异步回收
+    void reapLoop(EventLoop *loop);
+    // 当前参与分配的IO线程数（不含已退役的）
+    int numLoops() const {return static_cast<int>(loops_.size());}
+
     bool started() const {return started_;}
     const string name() const {return name_;}
 private:
+    EventLoop* startThread(int index);
+    void removeRetired(EventLoopThread *thread);
+
     EventLoop *baseLoop_;
     string name_;
     bool started_;
@@ -35,4 +55,14 @@ private:
     int next_;
     vector<unique_ptr<EventLoopThread>> threads_;
     vector<EventLoop*> loops_;
+    vector<unique_ptr<EventLoopThread>> retired_;   // 已移出轮询、等待回收的线程
+    ThreadInitCallback initCallback_;
+    int nextThreadId_;                              // 用于新线程命名
+
+    bool pinLoops_;
+    vector<int> cpus_;                      // 允许绑定的CPU列表
+    vector<vector<EventLoop*>> cpuLoops_;   // 下标为CPU编号，值为绑定在该CPU上的loop
+    vector<size_t> cpuNext_;                // 每个CPU上的轮询位置
+
+    shared_ptr<bool> alive_;                // 回收通知用来判断线程池是否还在
 };
\ No newline at end of file
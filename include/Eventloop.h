@@ -18,6 +18,10 @@ class TimerQueue;
 
 class TimerId;
 
+#ifdef RE_MUDUO_COROUTINES
+namespace co { class SleepAwaitable; }
+#endif
+
 // EventLoop: 事件循环类，负责管理IO事件和定时任务
 // 每个线程最多有一个EventLoop实例
 // 主要功能：
@@ -45,6 +49,10 @@ public:
     // 返回Poller返回的时间戳（即最近一次IO事件发生的时间）
     Timestamp pollReturnTime() const { return pollReturnTime_; }
 
+    // 返回事件循环累计的忙碌时间（微秒，不含阻塞在poll中的时间），可在其他线程读取
+    // 两次采样的差值除以经过的时间即为该loop在这段时间内的利用率
+    int64_t busyMicroSeconds() const { return busyMicroSeconds_.load(std::memory_order_relaxed); }
+
     // 在当前IO线程中执行回调，如果不在IO线程则排队到IO线程执行
     void runInLoop(Functor cb);
     
@@ -82,6 +90,11 @@ public:
     // 取消定时器
     void cancel(TimerId timerId);
 
+#ifdef RE_MUDUO_COROUTINES
+    // 协程中co_await loop->sleep(seconds)，由本loop的定时器恢复（见Coroutine.h）
+    co::SleepAwaitable sleep(double seconds);
+#endif
+
 private:
     // 处理wakeupfd上的可读事件
     void handleRead();
@@ -99,6 +112,7 @@ private:
     std::atomic_bool callingPendingFunctors_; // 是否正在执行待处理的回调
     const pid_t threadId_;                  // 创建EventLoop的线程ID
     Timestamp pollReturnTime_;              // Poller返回的时间戳
+    std::atomic<int64_t> busyMicroSeconds_; // 累计忙碌时间（微秒）
     std::unique_ptr<Poller> poller_;        // IO多路复用器
 
     int wakeupFd_;                          // 用于唤醒IO线程的eventfd
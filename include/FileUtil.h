@@ -4,22 +4,60 @@
 #include <string>
 #include <sys/types.h>
 
+struct iovec;
+
+namespace FileUtil {
+
+// 逐级创建目录，相当于mkdir -p，已存在时返回true
+bool makeDirectories(const std::string& dir);
+
+// 把文件压缩成path.gz后删除原文件，没有zlib时返回false并保留原文件
+bool gzipFile(const std::string& path);
+
+} // namespace FileUtil
+
+/**
+ * @brief AppendFile类，日志文件的直接写入
+ *
+ * 不经过stdio：小的写入先拷进缓冲区，攒满一块后用pwrite写到文件中对齐的位置；
+ * 大的批量写入直接pwritev。可以按preallocateBytes分段用fallocate预分配磁盘空间，
+ * 写入时不再为分配块付出代价，关闭时释放没用到的部分。
+ */
 class AppendFile : noncopyable {
 public:
-    explicit AppendFile(std::string filename);
+    static const size_t kBufferSize = 64 * 1024;
 
+    explicit AppendFile(std::string filename, off_t preallocateBytes = 0);
+
+    // 写出缓冲区，释放多余的预分配空间后关闭
     ~AppendFile();
 
     void append(const char* logline, size_t len);
 
+    // 一次写入多段，保持写入顺序；合计超过缓冲区大小时不经过缓冲区
+    void appendv(const struct iovec* iov, int iovcnt);
+
+    // 缓冲区写入内核
     void flush();
 
+    // flush之后fdatasync
+    void sync();
+
     off_t writtenBytes() const { return writtenBytes_; }
+    const std::string& filename() const { return filename_; }
 
 private:
-    size_t write(const char* logline, size_t len);
-
-    FILE* fp_;
-    char buffer_[64 * 1024];
+    // 从fileOffset_开始写入，处理部分写入，之后fileOffset_前移
+    void writeAt(const struct iovec* iov, int iovcnt);
+    // 保证[0, end)已经预分配
+    void reserve(off_t end);
+
+    const std::string filename_;
+    int fd_;
+    off_t preallocateBytes_;   // 每次预分配的大小，文件系统不支持时置0
+    off_t allocatedBytes_;
+    off_t fileOffset_;         // 已经写入内核的位置
+    size_t bufferUsed_;
     off_t writtenBytes_;
+    char buffer_[kBufferSize];
 };
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "noncopyable.h"
+#include <stddef.h>
+#include <atomic>
+#include <string>
+
+/**
+ * @brief FlightRecorder类，内存中的飞行记录器
+ *
+ * 启用后每条BLOG_XXX记录（包括低于日志级别、不会写进文件的）都以二进制形式追加到
+ * 本线程的环形缓冲区，写满后覆盖最旧的记录。写入只在本线程的缓冲区上拷贝，不加锁、
+ * 不格式化、不做IO，可以在生产环境常开。
+ *
+ * 收到SIGSEGV、SIGBUS、SIGFPE、SIGILL、SIGABRT，或者LOG_FATAL退出前，把所有线程缓冲区里
+ * 最近的记录转储到启用时给定的文件；也可以随时调用dump()。转储文件和AsyncLogging的
+ * kBinaryRaw格式相同，用binlog_decode解码，每个线程的记录前有一条标明线程ID的记录。
+ *
+ * printf风格的LOG_XXX在调用处格式化，不进入环形缓冲区。
+ */
+class FlightRecorder : noncopyable {
+public:
+    static const size_t kDefaultRingBytes = 64 * 1024;
+    static const int kMaxThreads = 256;
+
+    /**
+     * @brief 启用记录，只有第一次调用生效
+     * @param dumpPath 崩溃和LOG_FATAL时的转储文件
+     * @param ringBytes 每个线程环形缓冲区的字节数，向上取整到2的幂，至少4KB
+     * @param installSignalHandlers 是否为致命信号安装转储处理函数（处理后恢复默认行为）
+     */
+    static void enable(const std::string& dumpPath, size_t ringBytes = kDefaultRingBytes,
+                       bool installSignalHandlers = true);
+
+    // 停止记录，已经记录的内容保留，仍然可以转储
+    static void disable();
+
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // 追加一条BinaryLog记录到本线程的环形缓冲区，超过kMaxThreads个线程时不记录
+    static void record(const char* record, int len);
+
+    // 把所有线程最近的记录写到path（默认为启用时给定的文件），成功返回true
+    static bool dump();
+    static bool dump(const std::string& path);
+
+    // LOG_FATAL退出前调用，未启用时什么也不做
+    static void dumpOnFatal();
+
+private:
+    static std::atomic<bool> enabled_;
+};
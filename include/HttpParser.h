@@ -0,0 +1,99 @@
+#pragma once
+
+#include "HttpRequest.h"
+#include "noncopyable.h"
+#include <cstdint>
+#include <string>
+
+class Buffer;
+
+/**
+ * @brief HttpParser类，增量的HTTP/1.1请求解析器
+ *
+ * 直接在连接的inputBuffer_上解析，每次可读事件只扫描新到达的字节（见Buffer::findCRLF(size_t*)），
+ * 解析过程中只记录相对peek()的偏移，缓冲区扩容搬移数据后仍然有效；请求完整后才生成视图。
+ * 除分块编码的请求体需要拼接外，不做任何内存分配。
+ *
+ * 用法：parse()返回kComplete后处理request()，然后buf->retrieve(consumed())并reset()，
+ * 再继续parse()下一个流水线请求。
+ */
+class HttpParser : noncopyable
+{
+public:
+    enum Result
+    {
+        kNeedMore,
+        kComplete,
+        kError,
+    };
+
+    static const size_t kDefaultMaxHeaderSize = 64 * 1024;
+    static const size_t kDefaultMaxBodySize = 8 * 1024 * 1024;
+
+    HttpParser();
+
+    void setMaxHeaderSize(size_t n) { maxHeaderSize_ = n; }
+    void setMaxBodySize(size_t n) { maxBodySize_ = n; }
+
+    Result parse(const Buffer* buf);
+
+    // 以下在parse()返回kComplete后有效
+    const HttpRequest& request() const { return request_; }
+    // 该请求在缓冲区中占用的字节数
+    size_t consumed() const { return consumed_; }
+
+    // parse()返回kError时应答的状态码：400/413/431/501
+    int errorStatus() const { return errorStatus_; }
+
+    void reset();
+
+private:
+    enum State
+    {
+        kRequestLine,
+        kHeaders,
+        kBody,
+        kChunkSize,
+        kChunkData,
+        kTrailers,
+        kDone,
+    };
+
+    struct Span
+    {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    Result fail(int status);
+    bool parseRequestLine(const char* begin, const char* end);
+    bool parseHeader(const char* begin, const char* end);
+    // 头部结束后根据Content-Length/Transfer-Encoding决定后续状态
+    Result finishHeaders(const Buffer* buf, size_t end);
+    Result complete(const Buffer* buf, size_t end);
+    Span span(const char* base, const char* begin, const char* end) const;
+
+    State state_;
+    size_t scanOffset_;         // 下次开始查找CRLF的位置
+    size_t lineStart_;          // 当前行的起始位置
+    size_t bodyStart_;
+    uint64_t contentLength_;
+    uint64_t chunkRemaining_;
+    size_t consumed_;
+    int errorStatus_;
+    size_t maxHeaderSize_;
+    size_t maxBodySize_;
+
+    Span method_;
+    Span target_;
+    Span headerNames_[HttpRequest::kMaxHeaders];
+    Span headerValues_[HttpRequest::kMaxHeaders];
+    int headerCount_;
+    bool chunked_;
+    bool hasContentLength_;
+    int8_t connectionHeader_;
+    int minorVersion_;
+
+    std::string chunkedBody_;   // 分块编码的请求体，reset时保留容量
+    HttpRequest request_;
+};
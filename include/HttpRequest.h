@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief HttpRequest类，一个解析完成的HTTP请求
+ *
+ * 所有字段都是指向连接inputBuffer_的视图（分块编码的请求体除外，它由解析器拼接），
+ * 只在HttpServer的回调期间有效，需要保留时由调用方拷贝。
+ */
+class HttpRequest
+{
+public:
+    struct Header
+    {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    static const int kMaxHeaders = 64;
+
+    std::string_view method() const { return method_; }
+    // 请求目标中'?'之前的部分
+    std::string_view path() const { return path_; }
+    // '?'之后的部分，不含'?'
+    std::string_view query() const { return query_; }
+    // HTTP/1.x中的x
+    int minorVersion() const { return minorVersion_; }
+
+    int headerCount() const { return headerCount_; }
+    const Header& header(int i) const { return headers_[i]; }
+    // 按名字查找头部，不区分大小写，不存在时返回空视图
+    std::string_view header(std::string_view name) const;
+
+    std::string_view body() const { return body_; }
+    bool chunked() const { return chunked_; }
+
+    // HTTP/1.1默认长连接，除非带Connection: close；HTTP/1.0需要显式的Connection: keep-alive
+    bool keepAlive() const;
+
+    // 逗号分隔的列表（如Connection: keep-alive, Upgrade）中是否有某个token，不区分大小写
+    static bool hasToken(std::string_view list, std::string_view token);
+
+private:
+    friend class HttpParser;
+
+    std::string_view method_;
+    std::string_view path_;
+    std::string_view query_;
+    int minorVersion_ = 1;
+    Header headers_[kMaxHeaders];
+    int headerCount_ = 0;
+    std::string_view body_;
+    bool chunked_ = false;
+    int8_t connectionHeader_ = 0;   // 1: keep-alive, -1: close, 0: 未指定
+};
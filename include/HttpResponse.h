@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+class Buffer;
+
+/**
+ * @brief HttpResponse类，由HttpServer的回调填写的HTTP响应
+ *
+ * 序列化时状态行和头部写入一个Buffer，较大的响应体不拷贝，由HttpServer与头部一起用writev发出。
+ * 调用appendChunk()后以Transfer-Encoding: chunked发送，每段作为一个分块。
+ */
+class HttpResponse
+{
+public:
+    enum HttpStatusCode
+    {
+        kUnknown = 0,
+        k200Ok = 200,
+        k204NoContent = 204,
+        k301MovedPermanently = 301,
+        k400BadRequest = 400,
+        k403Forbidden = 403,
+        k404NotFound = 404,
+        k413PayloadTooLarge = 413,
+        k426UpgradeRequired = 426,
+        k431HeaderFieldsTooLarge = 431,
+        k500InternalServerError = 500,
+        k501NotImplemented = 501,
+        k505VersionNotSupported = 505,
+    };
+
+    explicit HttpResponse(bool close)
+        : statusCode_(k200Ok),
+          closeConnection_(close),
+          chunked_(false)
+    {
+    }
+
+    void setStatusCode(int code) { statusCode_ = code; }
+    int statusCode() const { return statusCode_; }
+    // 不设置时使用状态码对应的标准短语
+    void setStatusMessage(const std::string& message) { statusMessage_ = message; }
+
+    void setCloseConnection(bool on) { closeConnection_ = on; }
+    bool closeConnection() const { return closeConnection_; }
+
+    void setContentType(const std::string& contentType) { addHeader("Content-Type", contentType); }
+    void addHeader(const std::string& key, const std::string& value) { headers_.emplace_back(key, value); }
+
+    void setBody(std::string body) { body_ = std::move(body); }
+    const std::string& body() const { return body_; }
+
+    // 追加一个分块，之后以分块编码发送，body_不再使用
+    void appendChunk(std::string chunk);
+    bool chunked() const { return chunked_; }
+    const std::vector<std::string>& chunks() const { return chunks_; }
+
+    // 写入状态行和头部（以空行结束），Content-Length/Transfer-Encoding、Connection和Date由这里统一生成
+    void appendHeadersToBuffer(Buffer* output) const;
+    // 完整的响应，包括响应体
+    void appendToBuffer(Buffer* output) const;
+
+    static const char* defaultStatusMessage(int code);
+
+private:
+    int statusCode_;
+    std::string statusMessage_;
+    bool closeConnection_;
+    bool chunked_;
+    std::vector<std::pair<std::string, std::string>> headers_;
+    std::string body_;
+    std::vector<std::string> chunks_;
+};
+
+/**
+ * @brief 当前时间的HTTP Date头部值，如"Sun, 06 Nov 1994 08:49:37 GMT"
+ *
+ * 每个线程缓存一份，同一秒内的调用直接返回缓存，不再调用gmtime_r/strftime。
+ */
+const std::string& httpDate();
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "TcpServer.h"
+#include "noncopyable.h"
+#include <functional>
+#include <string>
+
+class HttpRequest;
+class HttpResponse;
+
+/**
+ * @brief HttpServer类，基于TcpServer的HTTP/1.1服务器
+ *
+ * 每个连接持有一个HttpParser（存放在TcpConnection的context中），直接在inputBuffer_上增量解析。
+ * 一次可读事件中到达的所有流水线请求依次交给HttpCallback处理，响应按请求顺序拼成一批：
+ * 状态行、头部和小的响应体写入同一个Buffer，较大的响应体不拷贝，作为单独的iovec，
+ * 最后通过TcpConnection::sendv()一次writev发出。
+ *
+ * 请求不是长连接、响应设置了closeConnection或请求解析出错时，发送完已有响应后半关闭连接。
+ */
+class HttpServer : noncopyable
+{
+public:
+    using HttpCallback = std::function<void(const HttpRequest&, HttpResponse*)>;
+
+    // 响应体不超过该长度时拷贝进头部所在的Buffer，否则单独作为一个iovec
+    static const size_t kDefaultInlineBodyThreshold = 4096;
+
+    HttpServer(EventLoop* loop,
+               const InetAddress& listenAddr,
+               TcpServer::Option option = TcpServer::kNoReusePort);
+
+    EventLoop* getLoop() const { return loop_; }
+
+    // 默认回调对所有请求返回404
+    void setHttpCallback(const HttpCallback& cb) { httpCallback_ = cb; }
+    void setThreadNum(int numThreads) { server_.setThreadNum(numThreads); }
+    void setMaxHeaderSize(size_t n) { maxHeaderSize_ = n; }
+    void setMaxBodySize(size_t n) { maxBodySize_ = n; }
+    void setInlineBodyThreshold(size_t n) { inlineBodyThreshold_ = n; }
+
+    void start();
+
+private:
+    void onConnection(const TcpConnectionPtr& conn);
+    void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp receiveTime);
+
+    EventLoop* loop_;
+    TcpServer server_;
+    HttpCallback httpCallback_;
+    size_t maxHeaderSize_;
+    size_t maxBodySize_;
+    size_t inlineBodyThreshold_;
+};
@@ -2,13 +2,16 @@
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <sys/un.h>
 #include <string>
 #include <strings.h>
 
 /**
- * @brief InetAddress类，用于封装IPv4的socket地址
- * 
- * 提供了IP地址和端口的封装，方便进行网络编程
+ * @brief InetAddress类，用于封装socket地址
+ *
+ * 提供了IP地址和端口的封装，方便进行网络编程。
+ * 除IPv4外也可以表示AF_UNIX地址（见fromUnixPath），Acceptor/Socket/Connector
+ * 按地址族创建socket，因此TcpServer/TcpConnection可以直接跑在Unix域socket上。
  */
 class InetAddress {
 public:
@@ -24,38 +27,87 @@ public:
      * @param addr sockaddr_in结构体
      */
     explicit InetAddress(const sockaddr_in& addr)
-        : addr(addr) {}
+        : addr(addr), len(sizeof addr) {}
 
     /**
-     * @brief 获取IP地址字符串
+     * @brief 构造函数，通过任意地址族的sockaddr创建InetAddress（accept/getsockname的结果）
+     * @param sa 地址
+     * @param salen 地址长度
+     */
+    InetAddress(const sockaddr* sa, socklen_t salen);
+
+    /**
+     * @brief 创建Unix域socket地址
+     * @param path 文件路径；以'@'开头时表示抽象命名空间，不在文件系统中创建文件
+     * @return 路径超出sun_path长度时记录错误并返回无效地址（isValid()为false）
+     */
+    static InetAddress fromUnixPath(const std::string& path);
+
+    /**
+     * @brief 获取地址族（AF_INET或AF_UNIX）
+     */
+    sa_family_t family() const { return addr.sin_family; }
+
+    /**
+     * @brief 是否为Unix域socket地址
+     */
+    bool isUnix() const { return family() == AF_UNIX; }
+
+    /**
+     * @brief 是否为有效地址，fromUnixPath拒绝的路径返回false
+     */
+    bool isValid() const { return family() != AF_UNSPEC; }
+
+    /**
+     * @brief 获取Unix域socket的路径，抽象命名空间的地址以'@'开头；非Unix地址返回空串
+     */
+    std::string unixPath() const;
+
+    /**
+     * @brief 获取IP地址字符串，Unix域地址返回其路径
      * @return IP地址字符串
      */
     std::string toIp() const;
 
     /**
-     * @brief 获取IP地址和端口号字符串
+     * @brief 获取IP地址和端口号字符串，Unix域地址返回"unix:路径"
      * @return IP地址:端口号格式的字符串
      */
     std::string toIpPort() const;
 
     /**
      * @brief 获取端口号
-     * @return 端口号（主机字节序）
+     * @return 端口号（主机字节序），Unix域地址为0
      */
     uint16_t toPort() const;
 
     /**
-     * @brief 获取sockaddr_in结构体指针
+     * @brief 获取sockaddr_in结构体指针，仅对IPv4地址有意义
      * @return sockaddr_in结构体指针
      */
     const sockaddr_in* getSockAddr() const { return &addr; }
 
+    /**
+     * @brief 获取通用的sockaddr指针，配合getSockAddrLen()用于bind/connect
+     */
+    const sockaddr* getGenericSockAddr() const { return reinterpret_cast<const sockaddr*>(&storage); }
+
+    /**
+     * @brief 获取地址的实际长度
+     */
+    socklen_t getSockAddrLen() const { return len; }
+
     /**
      * @brief 设置sockaddr_in结构体
      * @param addr sockaddr_in结构体
      */
-    void setSockAddr(const sockaddr_in& addr) { this->addr = addr; }
+    void setSockAddr(const sockaddr_in& addr) { this->addr = addr; len = sizeof addr; }
 
 private:
-    sockaddr_in addr;  ///< sockaddr_in结构体
-};
\ No newline at end of file
+    union {
+        sockaddr_in addr;       ///< IPv4地址
+        sockaddr_un unixAddr;   ///< Unix域地址
+        sockaddr_storage storage;
+    };
+    socklen_t len;              ///< 地址的实际长度，Unix域地址的长度与路径有关
+};
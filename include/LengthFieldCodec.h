@@ -0,0 +1,95 @@
+#pragma once
+
+#include "noncopyable.h"
+#include "Callbacks.h"
+#include "Timestamp.h"
+#include <functional>
+#include <string_view>
+
+class Buffer;
+
+/**
+ * @brief LengthFieldCodec类，长度前缀分帧
+ *
+ * 每帧为"长度字段 + 负载"，长度字段可以是1/2/4/8字节网络字节序整数或varint，只表示负载长度。
+ * 作为TcpConnection的MessageCallback使用：一次可读事件中收到的所有完整帧依次以
+ * string_view交给FrameCallback，视图直接指向inputBuffer_，不做拷贝，
+ * 全部分发完后才统一retrieve一次，剩下的半帧留到下次可读事件。
+ * 视图只在回调期间有效，需要保留时由调用方自行拷贝；回调中不要读写inputBuffer_。
+ *
+ * 也可以改用BatchFrameCallback：一次可读事件中的所有完整帧以数组形式一次交给应用，
+ * 便于对整批请求做批量查询，再用encode()把所有响应编码进同一个Buffer后一次send。
+ */
+class LengthFieldCodec : noncopyable
+{
+public:
+    enum LengthField
+    {
+        kVarint = 0,
+        kInt8 = 1,
+        kInt16 = 2,
+        kInt32 = 4,
+        kInt64 = 8,
+    };
+
+    enum Error
+    {
+        kFrameTooLarge,     // 长度超过maxFrameSize
+        kInvalidLength,     // 负数长度或varint超过10字节
+    };
+
+    using FrameCallback = std::function<void(const TcpConnectionPtr&, std::string_view frame, Timestamp)>;
+    using BatchFrameCallback = std::function<void(const TcpConnectionPtr&, const std::string_view* frames,
+                                                  size_t n, Timestamp)>;
+    using ErrorCallback = std::function<void(const TcpConnectionPtr&, Error)>;
+
+    static const size_t kDefaultMaxFrameSize = 64 * 1024 * 1024;
+
+    explicit LengthFieldCodec(const FrameCallback& cb,
+                              LengthField lengthField = kInt32,
+                              size_t maxFrameSize = kDefaultMaxFrameSize);
+    // 批量分发：每次onMessage最多调用一次回调，没有完整帧时不调用
+    explicit LengthFieldCodec(const BatchFrameCallback& cb,
+                              LengthField lengthField = kInt32,
+                              size_t maxFrameSize = kDefaultMaxFrameSize);
+
+    // 出错时的处理，默认记录日志并强制关闭连接；回调返回后缓冲区中的数据会被丢弃
+    void setErrorCallback(const ErrorCallback& cb) { errorCallback_ = cb; }
+    // 单帧负载上限，同时限制了为等待一个完整帧而缓存的数据量
+    void setMaxFrameSize(size_t n) { maxFrameSize_ = n; }
+
+    LengthField lengthField() const { return lengthField_; }
+    size_t maxFrameSize() const { return maxFrameSize_; }
+
+    /**
+     * @brief 作为MessageCallback绑定到连接上
+     * @return 本次分发的帧数
+     */
+    size_t onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp receiveTime);
+
+    // 长度字段能表示、对端解码时接受的最大负载长度
+    static uint64_t maxLength(LengthField lengthField);
+
+    // 在out末尾追加一帧；负载超过maxLength()时记录错误并返回false，out不变
+    bool encode(Buffer* out, std::string_view payload) const;
+    // 在out末尾依次追加n帧；有负载超长时一帧也不追加，返回false
+    bool encode(Buffer* out, const std::string_view* payloads, size_t n) const;
+    // 编码后通过conn一次发出，编码失败时不发送
+    bool send(const TcpConnectionPtr& conn, std::string_view payload) const;
+    // 把n帧编码进同一个缓冲区后只调用一次send
+    bool send(const TcpConnectionPtr& conn, const std::string_view* payloads, size_t n) const;
+
+private:
+    /**
+     * @brief 解析data处的长度字段
+     * @return 长度字段的字节数；数据不足返回0，非法返回-1
+     */
+    int parseLength(const char* data, size_t len, uint64_t* frameLen) const;
+    void handleError(const TcpConnectionPtr& conn, Buffer* buf, Error error);
+
+    FrameCallback frameCallback_;
+    BatchFrameCallback batchCallback_;
+    ErrorCallback errorCallback_;
+    LengthField lengthField_;
+    size_t maxFrameSize_;
+};
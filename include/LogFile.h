@@ -5,39 +5,67 @@
 #include <memory>
 
 class AppendFile;
+class ThreadPool;
+struct iovec;
 
+/**
+ * @brief LogFile类，按大小和日期滚动的日志文件
+ *
+ * 每个文件按rollSize（最多kMaxPreallocateBytes一段）预分配磁盘空间。滚动时写入的线程只打开新文件，
+ * 旧文件交给后台线程关闭，按需fdatasync和压缩成.gz，滚动不会让写日志的线程卡在磁盘上。
+ *
+ * 距上次刷新超过flushInterval秒时把缓冲区写入内核；syncInterval大于0时flush()每隔这么多秒
+ * 再fdatasync一次，为0时不主动落盘。
+ */
 class LogFile : noncopyable {
 public:
+    static const off_t kMaxPreallocateBytes = 64 * 1024 * 1024;
+
     LogFile(const std::string& basename,
             off_t rollSize,
             bool threadSafe = true,
             int flushInterval = 3,
-            int checkEveryN = 1024);
+            int syncInterval = 0);
 
     ~LogFile();
 
     void append(const char* logline, int len);
 
+    // 一次写入多段日志（AsyncLogging每轮收集的所有缓冲区）
+    void appendv(const struct iovec* iov, int iovcnt);
+
     void flush();
 
     bool rollFile();
 
+    // 滚动出去的文件在后台线程压缩成.gz，需要编译时找到zlib，否则保留原文件
+    void setCompressRolledFiles(bool on) { compressRolledFiles_ = on; }
+
+    // 当前文件已写入的字节数，滚动后从0开始
+    off_t writtenBytes() const;
+
 private:
     void append_unlocked(const char* logline, int len);
+    // 写入之后检查是否需要滚动或刷新
+    void afterWrite();
+    void flush_unlocked(time_t now);
+    // 把滚动出去的文件交给后台线程
+    void retire(std::unique_ptr<AppendFile> file);
 
     static std::string getLogFileName(const std::string& basename, time_t* now);
 
     const std::string basename_;
     const off_t rollSize_;
     const int flushInterval_;
-    const int checkEveryN_;
-
-    int count_;
+    const int syncInterval_;
+    bool compressRolledFiles_;
 
     std::unique_ptr<MutexLock> mutex_;
     time_t startOfPeriod_;
-    time_t lastRoll_;
+    time_t lastFlush_;
+    time_t lastSync_;
     std::unique_ptr<AppendFile> file_;
+    std::unique_ptr<ThreadPool> archiver_;   // 第一次滚动时启动
 
     const static int kRollPerSeconds = 60 * 60 * 24;
 };
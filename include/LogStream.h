@@ -10,6 +10,9 @@ public:
 
     enum { kMaxNumericSize = 48 };
 
+    // 绝对值小于它的整数值double按整数输出，例如100000.0输出"100000"而不是"1e+05"
+    static constexpr double kMaxExactInteger = 1e15;
+
     LogStream() : cur_(data_) {}
 
     ~LogStream() = default;
@@ -3,23 +3,35 @@
 #include <iostream>
 #include <string>
 #include <functional>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
 
 #include "noncopyable.h"
 #include "LogStream.h"
 #include "Timestamp.h"
+#include "FlightRecorder.h"
 
-// 定义日志的级别 INFO ERROR FATAL DEBUG
+// 定义日志的级别，从低到高 DEBUG INFO ERROR FATAL
 enum LogLevel {
+    DEBUG,  ///< 调试级别
     INFO,   ///< 信息级别
     ERROR,  ///< 错误级别
     FATAL,  ///< 致命错误级别
-    DEBUG,  ///< 调试级别
 };
 
+// 编译期的最低日志级别，低于它的日志语句不生成代码
+// 由CMake的RE_MUDUO_MIN_LOG_LEVEL配置，默认INFO，即LOG_DEBUG在默认构建中不产生任何开销
+#ifndef RE_MUDUO_MIN_LOG_LEVEL
+#define RE_MUDUO_MIN_LOG_LEVEL INFO
+#endif
+
 /**
  * @brief Logger类，日志记录器
  *
- * 提供了日志记录功能，支持不同级别的日志输出
+ * 日志级别是一个运行期的阈值：setLogLevel()之后低于阈值的日志语句只做一次比较，
+ * 参数既不求值也不格式化。每条日志在调用线程的栈上格式化为
+ * "[时间] 级别: 消息\n"，然后交给output()。
  */
 class Logger : noncopyable {
 public:
@@ -30,16 +42,42 @@ public:
     static Logger& instance();
 
     /**
-     * @brief 设置日志级别
+     * @brief 设置日志级别阈值，低于该级别的日志被丢弃，可以在任意线程调用
      * @param level 日志级别
      */
-    void setLogLevel(int level);
+    void setLogLevel(int level) { g_logLevel.store(level, std::memory_order_relaxed); }
+
+    /**
+     * @brief 当前的日志级别阈值
+     */
+    static int logLevel() { return g_logLevel.load(std::memory_order_relaxed); }
 
     /**
-     * @brief 记录日志
+     * @brief 该级别的日志是否输出：编译期最低级别和运行期阈值都满足
+     */
+    static bool enabled(int level) { return level >= RE_MUDUO_MIN_LOG_LEVEL && level >= logLevel(); }
+
+    /**
+     * @brief 以INFO级别记录一条已经格式化好的日志
      * @param msg 日志消息
      */
-    void log(std::string msg);
+    void log(const std::string& msg) { log(INFO, msg); }
+
+    /**
+     * @brief 以指定级别记录一条已经格式化好的日志
+     */
+    void log(int level, const std::string& msg);
+
+    /**
+     * @brief printf风格格式化并输出，LOG_XXX宏在检查级别之后调用
+     */
+    static void logf(int level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    /**
+     * @brief 同logf，suppressed大于0时在消息末尾注明上次输出以来被跳过的条数，供限流宏使用
+     */
+    static void logSampled(int level, uint64_t suppressed, const char* format, ...)
+        __attribute__((format(printf, 3, 4)));
 
     /**
      * @brief 设置日志输出回调
@@ -53,52 +91,164 @@ public:
      */
     static std::function<void(const char*, int)>& output();
 
+    /**
+     * @brief 把"[时间] 级别: "前缀写入buf，返回写入的字节数，buf至少kMaxPrefixSize字节
+     */
+    static int formatPrefix(char* buf, int level) { return formatPrefix(buf, level, Timestamp::now()); }
+    static int formatPrefix(char* buf, int level, Timestamp time);
+    static const int kMaxPrefixSize = 48;
+
+    static const char* levelName(int level);
+
 private:
-    int LogLevel_;  ///< 当前日志级别
-    Logger() {};   ///< 私有构造函数，实现单例模式
+    Logger() {}    ///< 私有构造函数，实现单例模式
 
+    static std::atomic<int> g_logLevel;
     static std::function<void(const char*, int)> output_;
 };
 
-// log的宏
-#define LOG_INFO(LogmsgFormat, ...) \
-    do \
-    {\
-        Logger &logger = Logger::instance(); \
-        logger.setLogLevel(INFO); \
-        char buf[1024] = {0}; \
-        snprintf(buf,1024,LogmsgFormat, ##__VA_ARGS__); \
-        logger.log(buf); \
-    }while(0)
-#define LOG_ERROR(LogmsgFormat, ...) \
+/**
+ * @brief LogMessage类，流式日志的一条消息
+ *
+ * 构造时写入前缀，析构时补上换行并输出，FATAL级别输出后退出进程。
+ * 由LOGS_XXX宏在级别检查通过后创建，消息在栈上的LogStream中拼接，不分配内存。
+ */
+class LogMessage : noncopyable {
+public:
+    explicit LogMessage(int level);
+    ~LogMessage();
+
+    LogStream& stream() { return stream_; }
+
+private:
+    int level_;
+    LogStream stream_;
+};
+
+/**
+ * @brief LogSampler类，一个限流日志语句的计数
+ *
+ * 作为LOG_EVERY_N/LOG_FIRST_N/LOG_EVERY_MS语句处的函数内静态变量，构造函数是constexpr，
+ * 常量初始化，没有初始化锁；计数只用原子操作，多个线程同时经过同一语句也不加锁。
+ */
+class LogSampler {
+public:
+    constexpr LogSampler() : count_(0), suppressed_(0), nextMicros_(0) {}
+
+    // 第1、n+1、2n+1...次返回true，*suppressed为上次输出以来跳过的次数
+    bool everyN(uint64_t n, uint64_t* suppressed) {
+        uint64_t count = count_.fetch_add(1, std::memory_order_relaxed);
+        if (n <= 1 || count % n == 0) {
+            *suppressed = (n <= 1 || count == 0) ? 0 : n - 1;
+            return true;
+        }
+        return false;
+    }
+
+    // 前n次返回true，之后只做一次读
+    bool firstN(uint64_t n) {
+        return count_.load(std::memory_order_relaxed) < n &&
+               count_.fetch_add(1, std::memory_order_relaxed) < n;
+    }
+
+    // 距上次输出至少ms毫秒时返回true，*suppressed为期间跳过的次数
+    bool everyMs(int64_t ms, uint64_t* suppressed) {
+        int64_t now = Timestamp::now().microSecondsSinceEpoch();
+        int64_t next = nextMicros_.load(std::memory_order_relaxed);
+        if (now >= next &&
+            nextMicros_.compare_exchange_strong(next, now + ms * 1000, std::memory_order_relaxed)) {
+            *suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+private:
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> suppressed_;
+    std::atomic<int64_t> nextMicros_;
+};
+
+// 让"条件 ? (void)0 : 流表达式"两个分支的类型一致
+struct LogMessageVoidify {
+    void operator&(LogStream&) {}
+};
+
+// 级别检查在最前面：编译期最低级别以下的分支是常量false，被编译器直接删除；
+// 其余情况下关闭的日志语句只有一次原子读和一次比较，参数不求值
+#define LOG_IMPL(level, LogmsgFormat, ...) \
     do \
-    {\
-        Logger &logger = Logger::instance(); \
-        logger.setLogLevel(ERROR); \
-        char buf[1024] = {0}; \
-        snprintf(buf,1024,LogmsgFormat, ##__VA_ARGS__); \
-        logger.log(buf); \
-    }while(0)
+    { \
+        if (Logger::enabled(level)) \
+        { \
+            Logger::logf(level, LogmsgFormat, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_INFO(LogmsgFormat, ...) LOG_IMPL(INFO, LogmsgFormat, ##__VA_ARGS__)
+#define LOG_ERROR(LogmsgFormat, ...) LOG_IMPL(ERROR, LogmsgFormat, ##__VA_ARGS__)
+#define LOG_DEBUG(LogmsgFormat, ...) LOG_IMPL(DEBUG, LogmsgFormat, ##__VA_ARGS__)
+// FATAL不受阈值影响，输出后退出进程
 #define LOG_FATAL(LogmsgFormat, ...) \
     do \
-    {\
-        Logger &logger = Logger::instance(); \
-        logger.setLogLevel(FATAL); \
-        char buf[1024] = {0}; \
-        snprintf(buf,1024,LogmsgFormat, ##__VA_ARGS__); \
-        logger.log(buf); \
+    { \
+        Logger::logf(FATAL, LogmsgFormat, ##__VA_ARGS__); \
+        FlightRecorder::dumpOnFatal(); \
         exit(-1); \
-    }while(0)
-#ifdef MUDEBUF
-#define LOG_DEBUG(LogmsgFormat, ...) \
+    } while (0)
+
+// 限流日志，用于事故期间可能每秒触发成千上万次的错误路径：
+//   LOG_EVERY_N(ERROR, 100, ...)   每100次输出一次
+//   LOG_FIRST_N(ERROR, 10, ...)    只输出前10次
+//   LOG_EVERY_MS(ERROR, 1000, ...) 每秒最多输出一次
+// 每个语句有自己的计数，恢复输出时在消息末尾注明期间跳过了多少条
+#define LOG_EVERY_N(level, n, LogmsgFormat, ...) \
     do \
-    {\
-        Logger &logger = Logger::instance(); \
-        logger.setLogLevel(DEBUG); \
-        char buf[1024] = {0}; \
-        snprintf(buf,1024,LogmsgFormat, ##__VA_ARGS__); \
-        logger.log(buf); \
-    }while(0)
-#else
-    #define LOG_DEBUG(LogmsgFormat, ...)
-#endif
+    { \
+        if (Logger::enabled(level)) \
+        { \
+            static LogSampler logSampler; \
+            uint64_t logSuppressed; \
+            if (logSampler.everyN(n, &logSuppressed)) \
+            { \
+                Logger::logSampled(level, logSuppressed, LogmsgFormat, ##__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+#define LOG_FIRST_N(level, n, LogmsgFormat, ...) \
+    do \
+    { \
+        if (Logger::enabled(level)) \
+        { \
+            static LogSampler logSampler; \
+            if (logSampler.firstN(n)) \
+            { \
+                Logger::logf(level, LogmsgFormat, ##__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+#define LOG_EVERY_MS(level, ms, LogmsgFormat, ...) \
+    do \
+    { \
+        if (Logger::enabled(level)) \
+        { \
+            static LogSampler logSampler; \
+            uint64_t logSuppressed; \
+            if (logSampler.everyMs(ms, &logSuppressed)) \
+            { \
+                Logger::logSampled(level, logSuppressed, LogmsgFormat, ##__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+// 流式日志：LOGS_INFO << "fd=" << fd;
+#define LOGS_IMPL(level) \
+    !Logger::enabled(level) ? (void)0 : LogMessageVoidify() & LogMessage(level).stream()
+
+#define LOGS_DEBUG LOGS_IMPL(DEBUG)
+#define LOGS_INFO LOGS_IMPL(INFO)
+#define LOGS_ERROR LOGS_IMPL(ERROR)
+#define LOGS_FATAL LogMessageVoidify() & LogMessage(FATAL).stream()
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "noncopyable.h"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+class Buffer;
+
+/**
+ * @brief RESP（Redis序列化协议）的一个值节点
+ *
+ * 一个完整的值按先序展开成若干节点：聚合类型的节点后面紧跟它的元素。
+ * 字符串类节点的str是指向输入缓冲区的视图，不做拷贝。
+ */
+struct RespValue
+{
+    enum Type : char
+    {
+        kSimpleString = '+',
+        kError = '-',
+        kInteger = ':',
+        kBulkString = '$',
+        kArray = '*',
+        // 以下为RESP3新增类型
+        kNull = '_',
+        kBoolean = '#',
+        kDouble = ',',
+        kBigNumber = '(',
+        kBulkError = '!',
+        kVerbatimString = '=',
+        kMap = '%',
+        kSet = '~',
+        kAttribute = '|',
+        kPush = '>',
+    };
+
+    Type type;
+    // RESP2的空bulk string（$-1）和空数组（*-1），以及RESP3的_
+    bool null;
+    // 整数和布尔值；聚合类型为元素个数，kMap/kAttribute为键值对个数
+    int64_t integer;
+    // 字符串类（包括kDouble、kBigNumber的文本）的内容
+    std::string_view str;
+
+    bool isAggregate() const
+    {
+        return type == kArray || type == kMap || type == kSet || type == kAttribute || type == kPush;
+    }
+};
+
+/**
+ * @brief RespParser类，增量的RESP2/RESP3解析器
+ *
+ * 直接在连接的inputBuffer_上解析，数据不完整时记住解析到的位置和未完成的聚合层次，
+ * 下次可读事件从断点继续，不会从头重新扫描；大的bulk string只检查长度，不逐字节扫描。
+ * 未完成值的节点只记录相对peek()的偏移，缓冲区扩容搬移数据后仍然有效。
+ *
+ * 也接受inline命令（如telnet输入的"PING\r\n"），解析成由bulk string组成的数组。
+ *
+ * 用法：循环调用parse()直到不再返回kComplete，此时values()中按顺序是本次得到的所有完整值，
+ * 处理完后buf->retrieve(consumed())并调用clear()。
+ */
+class RespParser : noncopyable
+{
+public:
+    enum Result
+    {
+        kNeedMore,
+        kComplete,
+        kError,
+    };
+
+    static const size_t kDefaultMaxBulkLength = 512 * 1024 * 1024;
+    static const size_t kDefaultMaxElements = 1024 * 1024;
+    // 不带CRLF的一行（类型行或inline命令）的上限
+    static const size_t kMaxLineLength = 64 * 1024;
+
+    RespParser();
+
+    void setMaxBulkLength(size_t n) { maxBulkLength_ = n; }
+    void setMaxElements(size_t n) { maxElements_ = n; }
+
+    // 从上次停下的地方继续解析，得到一个完整的顶层值时返回kComplete，其节点追加到values()末尾
+    Result parse(const Buffer* buf);
+
+    const std::vector<RespValue>& values() const { return values_; }
+    // 已得到的完整值在缓冲区中占用的字节数
+    size_t consumed() const { return consumed_; }
+    // parse()返回kError时的原因
+    const char* error() const { return error_; }
+
+    // 调用方retrieve(consumed())之后调用：丢弃已完成的值，保留未完成值的进度
+    void clear();
+    // 完全重置，包括未完成的值
+    void reset();
+
+private:
+    struct Node
+    {
+        RespValue::Type type;
+        bool null;
+        int64_t integer;
+        size_t offset;
+        size_t length;
+    };
+
+    struct Frame
+    {
+        int64_t remaining;
+        bool attribute;
+    };
+
+    Result fail(const char* reason);
+    // 一个元素结束后逐层减少外层聚合的剩余元素个数，顶层值完整时返回true
+    bool finishElement();
+    void completeValue(const char* base);
+    bool parseInline(const char* base, size_t lineEnd);
+
+    size_t pos_;                // 下一个要解析的位置
+    size_t scanOffset_;         // 下次开始查找CRLF的位置
+    size_t consumed_;
+    int64_t bulkRemaining_;     // 正在等待的bulk负载长度，-1表示在等类型行
+    size_t maxBulkLength_;
+    size_t maxElements_;
+    const char* error_;
+
+    std::vector<Node> pending_;     // 未完成值的节点
+    std::vector<Frame> stack_;      // 未完成的聚合层次
+    std::vector<RespValue> values_;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "TcpServer.h"
+#include "RespParser.h"
+#include "noncopyable.h"
+#include <functional>
+#include <string_view>
+
+class RespWriter;
+
+/**
+ * @brief 一条RESP命令，参数是指向inputBuffer_的视图，只在回调期间有效
+ */
+struct RespCommand
+{
+    const std::string_view* argv;
+    size_t argc;
+
+    std::string_view name() const { return argv[0]; }
+    std::string_view operator[](size_t i) const { return argv[i]; }
+    // 命令名比较，不区分大小写；name应为小写
+    bool is(std::string_view name) const;
+};
+
+/**
+ * @brief RespServer类，基于TcpServer的RESP（Redis协议）服务器
+ *
+ * 每个连接持有一个RespParser（存放在TcpConnection的context中），一次可读事件中
+ * 收到的所有流水线命令解析完后，以数组形式一次交给CommandBatchCallback，便于批量查询。
+ * 回调通过RespWriter把回复直接写入outputBuffer_，整批处理完后只调用一次write。
+ *
+ * 每条命令必须回复一次且按命令顺序回复。协议错误时先处理完之前的完整命令，
+ * 再回复"-ERR Protocol error"并关闭连接，和Redis的行为一致。
+ */
+class RespServer : noncopyable
+{
+public:
+    using CommandBatchCallback = std::function<void(const TcpConnectionPtr&, const RespCommand* commands,
+                                                    size_t n, RespWriter* out)>;
+
+    RespServer(EventLoop* loop,
+               const InetAddress& listenAddr,
+               TcpServer::Option option = TcpServer::kNoReusePort);
+
+    // 默认对所有命令回复unknown command
+    void setCommandBatchCallback(const CommandBatchCallback& cb) { commandBatchCallback_ = cb; }
+    void setThreadNum(int numThreads) { server_.setThreadNum(numThreads); }
+    void setMaxBulkLength(size_t n) { maxBulkLength_ = n; }
+    void setMaxElements(size_t n) { maxElements_ = n; }
+
+    void start();
+
+private:
+    void onConnection(const TcpConnectionPtr& conn);
+    void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp receiveTime);
+
+    TcpServer server_;
+    CommandBatchCallback commandBatchCallback_;
+    size_t maxBulkLength_;
+    size_t maxElements_;
+};
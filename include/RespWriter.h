@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+class Buffer;
+
+/**
+ * @brief RespWriter类，把回复按RESP2/RESP3格式直接写入Buffer
+ *
+ * 通常直接写入连接的outputBuffer_，整批回复写完后由TcpConnection::flushOutputBuffer()发出，
+ * 中间不经过临时字符串。RESP3特有的类型在RESP2下退化成等价的旧类型：
+ * null写成$-1（数组为*-1），map写成2n个元素的数组，布尔值写成整数，double写成bulk string。
+ */
+class RespWriter
+{
+public:
+    explicit RespWriter(Buffer* out, int protocol = 2)
+        : out_(out),
+          protocol_(protocol)
+    {
+    }
+
+    Buffer* buffer() const { return out_; }
+    // 2或3，通常由HELLO命令切换
+    int protocol() const { return protocol_; }
+    void setProtocol(int protocol) { protocol_ = protocol; }
+
+    void ok();
+    void simpleString(std::string_view s);
+    // message应以错误前缀开头，如"ERR unknown command"
+    void error(std::string_view message);
+    void integer(int64_t value);
+    void bulkString(std::string_view s);
+    // 不存在的值：RESP2为$-1，RESP3为_
+    void null();
+    // 不存在的数组：RESP2为*-1，RESP3为_
+    void nullArray();
+    void boolean(bool value);
+    void doubleValue(double value);
+
+    // 聚合类型只写头部，之后由调用方依次写入元素
+    void arrayHeader(size_t n);
+    void setHeader(size_t n);
+    // n为键值对个数
+    void mapHeader(size_t n);
+    void pushHeader(size_t n);
+
+private:
+    void appendHeader(char type, int64_t n);
+
+    Buffer* out_;
+    int protocol_;
+};
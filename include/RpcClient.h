@@ -0,0 +1,97 @@
+#pragma once
+
+#include "TcpClient.h"
+#include "LengthFieldCodec.h"
+#include "RpcProtocol.h"
+#include "Buffer.h"
+#include "Timer.h"
+#include "noncopyable.h"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief RpcClient类，在一个TcpClient连接上多路复用的RPC客户端
+ *
+ * call()可以在任意线程调用：请求立即编码进待发送缓冲区，同一轮事件循环中的所有调用
+ * 由loop线程合并成一次write发出，减少小包和系统调用。响应按请求ID匹配，可以乱序到达。
+ *
+ * 每个调用有截止时间：未完成的调用按截止时间排序，只为最早的截止时间注册一个loop定时器，
+ * 到期后批量以kDeadlineExceeded结束，调用正常完成时不需要增删定时器。
+ * 连接断开（包括RpcClient析构）时所有未完成的调用以kConnectionClosed结束。回调都在loop线程中执行。
+ */
+class RpcClient : noncopyable
+{
+public:
+    // response为响应体或错误信息，只在回调期间有效
+    using Callback = std::function<void(rpc::Status status, std::string_view response)>;
+
+    static constexpr double kDefaultTimeout = 5.0;
+
+    RpcClient(EventLoop* loop, const InetAddress& serverAddr, const std::string& name);
+    ~RpcClient();
+
+    void connect() { client_.connect(); }
+    void disconnect() { client_.disconnect(); }
+    void enableRetry() { client_.enableRetry(); }
+    bool connected() const;
+    // 连接建立和断开时在内部处理之后调用
+    void setConnectionCallback(const ConnectionCallback& cb) { connectionCallback_ = cb; }
+
+    void setDefaultTimeout(double seconds) { defaultTimeout_ = seconds; }
+    void setMaxFrameSize(size_t n) { codec_.setMaxFrameSize(n); }
+
+    // 线程安全；timeout <= 0时使用默认超时
+    void call(std::string_view method, std::string_view request, Callback done, double timeout = 0);
+
+    // 已发出但还没有完成的调用数，只能在loop线程中调用
+    size_t pendingCalls() const { return pending_.size(); }
+
+private:
+    struct QueuedCall
+    {
+        uint64_t id;
+        int64_t deadline;       // 微秒
+        Callback done;
+    };
+
+    struct PendingCall
+    {
+        int64_t deadline;
+        Callback done;
+    };
+
+    void onConnection(const TcpConnectionPtr& conn);
+    void onFrame(const TcpConnectionPtr& conn, std::string_view frame, Timestamp receiveTime);
+    void flushQueued();
+    void armDeadlineTimer();
+    void onDeadlineTimer();
+    void failAll(rpc::Status status);
+
+    EventLoop* loop_;
+    LengthFieldCodec codec_;
+    ConnectionCallback connectionCallback_;
+    double defaultTimeout_;
+
+    // 以下由mutex_保护：已编码但还没发出的请求
+    std::mutex mutex_;
+    uint64_t nextId_;
+    Buffer outgoing_;
+    std::vector<QueuedCall> queued_;
+    bool flushScheduled_;
+
+    // 以下只在loop线程中访问
+    std::unordered_map<uint64_t, PendingCall> pending_;
+    std::set<std::pair<int64_t, uint64_t>> deadlines_;
+    TimerId deadlineTimer_;
+    int64_t armedDeadline_;     // 已注册定时器的到期时间，0表示没有
+    std::shared_ptr<bool> alive_;   // 排队的flush用来判断RpcClient是否还在
+
+    // 最后声明、最先析构：析构时关闭连接会回调onConnection，此时其他成员仍然有效
+    TcpClient client_;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "LengthFieldCodec.h"
+#include <cstdint>
+#include <string_view>
+
+class Buffer;
+
+/**
+ * @brief RpcServer/RpcClient之间的消息格式
+ *
+ * 每条消息是一个varint长度前缀的帧（见LengthFieldCodec::kVarint），帧内依次为：
+ *   请求：类型(1字节，0) | 请求ID(varint) | 超时毫秒数(varint，0为不限) | 方法名长度(varint) | 方法名 | 请求体
+ *   响应：类型(1字节，1) | 请求ID(varint) | 状态(1字节) | 响应体（失败时为错误信息）
+ * 请求ID由客户端分配，服务器原样带回，响应可以乱序返回。
+ */
+namespace rpc
+{
+
+enum Status : uint8_t
+{
+    kOk = 0,
+    kMethodNotFound = 1,
+    kApplicationError = 2,
+    // 以下只在客户端本地产生
+    kDeadlineExceeded = 3,
+    kConnectionClosed = 4,
+};
+
+const char* statusName(Status status);
+
+enum MessageType : uint8_t
+{
+    kRequest = 0,
+    kResponse = 1,
+};
+
+const LengthFieldCodec::LengthField kLengthField = LengthFieldCodec::kVarint;
+
+struct Request
+{
+    uint64_t id;
+    uint32_t timeoutMs;
+    std::string_view method;
+    std::string_view payload;
+};
+
+struct Response
+{
+    uint64_t id;
+    Status status;
+    std::string_view payload;
+};
+
+// 在out末尾追加一条完整的消息，包括长度前缀
+void encodeRequest(Buffer* out, uint64_t id, uint32_t timeoutMs, std::string_view method, std::string_view payload);
+void encodeResponse(Buffer* out, uint64_t id, Status status, std::string_view payload);
+
+// frame为LengthFieldCodec交出的帧（不含长度前缀），视图指向frame，格式错误返回false
+bool decodeRequest(std::string_view frame, Request* request);
+bool decodeResponse(std::string_view frame, Response* response);
+
+} // namespace rpc
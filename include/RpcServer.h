@@ -0,0 +1,77 @@
+#pragma once
+
+#include "TcpServer.h"
+#include "LengthFieldCodec.h"
+#include "RpcProtocol.h"
+#include "noncopyable.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * @brief RpcResponder类，服务器一侧对一个请求的应答句柄
+ *
+ * 可以拷贝、保存到其他线程后异步应答，同一连接上的请求可以按任意顺序应答，每个请求应答一次。
+ * 在IO线程中应答时直接编码进outputBuffer_：处理一批请求期间的所有同步应答合并为一次write。
+ */
+class RpcResponder
+{
+public:
+    uint64_t requestId() const { return requestId_; }
+    // 客户端剩余的超时时间，0表示不限；处理时间可能超过它时可以提前放弃
+    uint32_t timeoutMs() const { return timeoutMs_; }
+
+    void reply(std::string_view response) const;
+    void fail(std::string_view message, rpc::Status status = rpc::kApplicationError) const;
+
+private:
+    friend class RpcServer;
+
+    RpcResponder(const TcpConnectionPtr& conn, uint64_t requestId, uint32_t timeoutMs)
+        : conn_(conn),
+          requestId_(requestId),
+          timeoutMs_(timeoutMs)
+    {
+    }
+
+    void send(rpc::Status status, std::string_view payload) const;
+
+    std::weak_ptr<TcpConnection> conn_;
+    uint64_t requestId_;
+    uint32_t timeoutMs_;
+};
+
+/**
+ * @brief RpcServer类，基于TcpServer和LengthFieldCodec的多路复用RPC服务器
+ *
+ * 一个连接上可以同时有任意多个未完成的请求，用请求ID对应请求和响应。
+ * 一次可读事件中收到的所有请求按顺序分发给各方法的处理函数，处理函数同步应答的响应
+ * 先写入outputBuffer_，整批分发完后只调用一次write。
+ */
+class RpcServer : noncopyable
+{
+public:
+    // request为指向inputBuffer_的视图，只在调用期间有效
+    using Handler = std::function<void(std::string_view request, const RpcResponder& responder)>;
+
+    RpcServer(EventLoop* loop,
+              const InetAddress& listenAddr,
+              TcpServer::Option option = TcpServer::kNoReusePort);
+
+    // 在start()之前注册
+    void registerMethod(const std::string& name, const Handler& handler) { methods_[name] = handler; }
+    void setThreadNum(int numThreads) { server_.setThreadNum(numThreads); }
+    void setMaxFrameSize(size_t n) { codec_.setMaxFrameSize(n); }
+
+    void start();
+
+private:
+    void onConnection(const TcpConnectionPtr& conn);
+    void onFrames(const TcpConnectionPtr& conn, const std::string_view* frames, size_t n, Timestamp receiveTime);
+
+    TcpServer server_;
+    LengthFieldCodec codec_;
+    std::unordered_map<std::string, Handler> methods_;
+};
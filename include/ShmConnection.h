@@ -0,0 +1,152 @@
+#pragma once
+
+#include "noncopyable.h"
+#include "Buffer.h"
+#include "Timestamp.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Channel;
+class EventLoop;
+class ShmConnection;
+
+using ShmConnectionPtr = std::shared_ptr<ShmConnection>;
+using ShmConnectionCallback = std::function<void(const ShmConnectionPtr&)>;
+using ShmMessageCallback = std::function<void(const ShmConnectionPtr&, Buffer*, Timestamp)>;
+
+/**
+ * @brief ShmConnection类，同一台机器上两个进程之间基于共享内存的连接
+ *
+ * 一块memfd映射出两个单生产者单消费者的字节环，每个方向一个；每一端各有一个eventfd，
+ * 作为Channel注册在自己的EventLoop上，对端写入数据或腾出空间时用它唤醒本端。
+ * 消费者只有在环空、准备回到epoll等待前才置上等待标志，生产者发布数据后看到标志才写eventfd，
+ * 因此消费者正在处理或自旋时，发送不需要任何系统调用。
+ *
+ * 建立连接：一端用create()创建，把exportFds()得到的fd通过已有的Unix域socket用sendFds()交给对端，
+ * 对端recvFds()后用attach()映射同一块内存，两端都调用start()。
+ * 与TcpConnection一样是字节流语义，回调也在所属loop线程中执行，消息边界需要由上层编解码处理。
+ * 对端进程异常退出不会被感知，需要配合用来交换fd的socket判断对端是否存活。
+ */
+class ShmConnection : noncopyable, public std::enable_shared_from_this<ShmConnection>
+{
+public:
+    static const size_t kDefaultCapacity = 1024 * 1024;
+
+    /**
+     * @brief 创建一对新的共享内存环
+     * @param capacity 每个方向的环大小，向上取整为2的幂
+     */
+    static ShmConnectionPtr create(EventLoop* loop, const std::string& name,
+                                   size_t capacity = kDefaultCapacity);
+
+    /**
+     * @brief 用对端exportFds()的fd映射同一对环，收发方向与创建方相反；fd的所有权转交给返回的连接
+     * @return fd无效或内存布局不匹配时返回nullptr
+     */
+    static ShmConnectionPtr attach(EventLoop* loop, const std::string& name,
+                                   const std::vector<int>& fds);
+
+    // 通过Unix域socket用SCM_RIGHTS发送/接收fd，附带1字节数据；recvFds返回收到的fd个数，失败返回-1
+    static bool sendFds(int sockfd, const std::vector<int>& fds);
+    static int recvFds(int sockfd, std::vector<int>* fds);
+
+    ShmConnection(EventLoop* loop, const std::string& name, int memfd,
+                  void* base, size_t mapSize, int localEventfd, int peerEventfd, bool creator);
+    ~ShmConnection();
+
+    // 需要交给对端的fd：memfd、创建方的eventfd、接收方的eventfd，仍归本连接所有
+    std::vector<int> exportFds() const;
+
+    EventLoop* getLoop() const { return loop_; }
+    const std::string& name() const { return name_; }
+    bool connected() const { return state_ == kConnected; }
+    bool disconnected() const { return state_ == kDisconnected; }
+
+    void setConnectionCallback(const ShmConnectionCallback& cb) { connectionCallback_ = cb; }
+    void setMessageCallback(const ShmMessageCallback& cb) { messageCallback_ = cb; }
+    void setWriteCompleteCallback(const ShmConnectionCallback& cb) { writeCompleteCallback_ = cb; }
+    void setCloseCallback(const ShmConnectionCallback& cb) { closeCallback_ = cb; }
+
+    // 环空时先自旋检查多少次再进入等待，适合对延迟敏感、愿意多花CPU的场景，默认为0
+    void setSpinCount(int n) { spinCount_ = n; }
+
+    // 注册eventfd并调用连接回调，可在任意线程调用
+    void start();
+
+    // 可在任意线程调用；环满时多出的数据暂存在outputBuffer_，对端腾出空间后继续写入
+    void send(const void* data, size_t len);
+    void send(const std::string& message);
+    void send(Buffer* message);
+    // 待发送数据写完后通知对端，对端读完剩余数据后关闭
+    void shutdown();
+    void forceClose();
+
+    Buffer* inputBuffer() { return &inputBuffer_; }
+    Buffer* outputBuffer() { return &outputBuffer_; }
+
+    // 统计，可在其他线程读取
+    uint64_t bytesSent() const { return bytesSent_.load(std::memory_order_relaxed); }
+    uint64_t bytesReceived() const { return bytesReceived_.load(std::memory_order_relaxed); }
+    // 实际写eventfd的次数，以及因为对端未在等待而省掉的次数
+    uint64_t notifies() const { return notifies_.load(std::memory_order_relaxed); }
+    uint64_t notifiesSkipped() const { return notifiesSkipped_.load(std::memory_order_relaxed); }
+    // 本端被eventfd唤醒的次数
+    uint64_t wakeups() const { return wakeups_.load(std::memory_order_relaxed); }
+
+private:
+    struct RingHeader;
+
+    enum StateE { kDisconnected, kConnecting, kConnected, kDisconnecting };
+
+    void handleRead(Timestamp receiveTime);
+    void handleClose();
+    void sendInLoop(const void* data, size_t len);
+    void shutdownInLoop();
+    // 从接收环读出所有数据，返回读到的字节数
+    size_t drain();
+    // 把数据写入发送环，返回写入的字节数
+    size_t writeRing(const void* data, size_t len);
+    // 把outputBuffer_中的数据写入发送环
+    void flushOutput();
+    // 对端写入的环位置不合法，按致命的协议错误关闭连接
+    void protocolError(const char* where, uint64_t head, uint64_t tail);
+    // 发布数据/空间后按对端的等待标志决定是否唤醒对端
+    void notifyPeer(std::atomic<uint32_t>& waiting);
+    bool peerClosed() const;
+
+    EventLoop* loop_;
+    const std::string name_;
+    StateE state_;
+    const bool creator_;
+    int memfd_;
+    void* base_;
+    size_t mapSize_;
+    int localEventfd_;
+    int peerEventfd_;
+    std::unique_ptr<Channel> channel_;
+    const size_t capacity_;     // 每个环的容量，创建或接入时校验过，不再读共享内存里的值
+
+    RingHeader* txHeader_;      // 本端生产、对端消费
+    char* txData_;
+    RingHeader* rxHeader_;      // 对端生产、本端消费
+    char* rxData_;
+    uint64_t cachedTxTail_;     // 上次看到的对端读取位置，只在空间不够时才重新读取共享变量
+    int spinCount_;
+
+    ShmConnectionCallback connectionCallback_;
+    ShmMessageCallback messageCallback_;
+    ShmConnectionCallback writeCompleteCallback_;
+    ShmConnectionCallback closeCallback_;
+
+    Buffer inputBuffer_;
+    Buffer outputBuffer_;
+
+    std::atomic<uint64_t> bytesSent_;
+    std::atomic<uint64_t> bytesReceived_;
+    std::atomic<uint64_t> notifies_;
+    std::atomic<uint64_t> notifiesSkipped_;
+    std::atomic<uint64_t> wakeups_;
+};
@@ -20,8 +20,19 @@ public:
     void setReuseAddr(bool on);
     void setReusePort(bool on);
     void setKeepAlive(bool on);
+
+    // 为SO_REUSEPORT组挂载classic BPF程序，按处理软中断的CPU选择监听socket（cpu % groupSize）
+    bool setReusePortCpuFilter(int groupSize);
     
     static InetAddress getLocalAddr(int sockfd);
+    static InetAddress getPeerAddr(int sockfd);
+    // 读取并清除SO_ERROR
+    static int getSocketError(int sockfd);
+    // 本地地址与对端地址相同（自连接）时返回true
+    static bool isSelfConnect(int sockfd);
+
+    // 读取SO_INCOMING_CPU，返回处理该连接软中断的CPU编号，失败返回-1
+    static int getIncomingCpu(int sockfd);
 private:
     const int sockfd_;
 };
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "noncopyable.h"
+#include "Callbacks.h"
+#include "Buffer.h"
+#include <memory>
+
+class EventLoop;
+
+/**
+ * @brief SpliceRelay类，在两个TcpConnection之间做零拷贝的双向转发
+ *
+ * 两条连接必须属于同一个EventLoop。每个方向借用本线程管道池中的一个管道，
+ * 用splice(2)把数据从源socket搬进管道、再从管道搬到目的socket，数据不经过用户态缓冲区。
+ *  - 背压：目的socket写不动、管道里有积压时停止读源socket，同时关注目的socket的可写事件；
+ *  - 半关闭：源端读到EOF且管道排空后，对目的端shutdownWrite；两个方向都结束后关闭两条连接；
+ *  - 任意一端出错或被关闭时，另一端随之关闭；
+ *  - 转发的数据同时刷新两端的空闲定时器，设置了空闲超时的连接在转发期间不会被关闭。
+ * 启动前两条连接inputBuffer/outputBuffer中已有的数据会先按顺序转发出去。
+ * 转发期间relay由两条连接持有，结束后自动释放，调用者无需保存返回值。
+ */
+class SpliceRelay : noncopyable, public std::enable_shared_from_this<SpliceRelay>
+{
+public:
+    using RelayPtr = std::shared_ptr<SpliceRelay>;
+
+    // 在a和b之间开始转发，可在任意线程调用
+    static RelayPtr start(const TcpConnectionPtr &a, const TcpConnectionPtr &b);
+
+    SpliceRelay(const TcpConnectionPtr &a, const TcpConnectionPtr &b);
+    ~SpliceRelay();
+
+    // 已转发的字节数：0为a->b方向，1为b->a方向
+    size_t bytesRelayed(int dir) const { return dirs_[dir].bytes; }
+    bool finished() const { return finished_; }
+
+private:
+    struct Direction
+    {
+        TcpConnectionPtr from;
+        TcpConnectionPtr to;
+        int pipeRead = -1;
+        int pipeWrite = -1;
+        size_t inPipe = 0;      // 管道中尚未写出的字节数
+        Buffer head;            // 启动前已经读入用户态、需要先发出的数据
+        bool eof = false;       // 源端已读到EOF
+        bool done = false;      // 该方向已经结束（已半关闭目的端或目的端已不可写）
+        size_t bytes = 0;
+    };
+
+    void startInLoop();
+    void pump(Direction &d);
+    bool flushHead(Direction &d);
+    void updateInterest();
+    void handleClose(int side);
+    void abort();
+    void finish();
+    void releasePipes();
+
+    EventLoop *loop_;
+    Direction dirs_[2];
+    bool finished_;
+};
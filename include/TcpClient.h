@@ -0,0 +1,61 @@
+#pragma once
+
+#include "noncopyable.h"
+#include "InetAddress.h"
+#include "Callbacks.h"
+#include "Connector.h"
+#include <mutex>
+#include <string>
+
+class EventLoop;
+
+/**
+ * @brief TcpClient类，客户端一侧的TcpConnection管理者
+ *
+ * 通过Connector发起非阻塞连接，连接建立后创建TcpConnection并在所属loop中处理IO。
+ * 开启retry后连接断开会自动重连（重连同样使用指数退避）。
+ */
+class TcpClient : noncopyable
+{
+public:
+    TcpClient(EventLoop *loop, const InetAddress &serverAddr, const std::string &name);
+    ~TcpClient();
+
+    void connect();
+    void disconnect();
+    void stop();
+
+    TcpConnectionPtr connection() const
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return connection_;
+    }
+
+    EventLoop *getLoop() const { return loop_; }
+    bool retry() const { return retry_; }
+    void enableRetry() { retry_ = true; }
+    const std::string &name() const { return name_; }
+    const InetAddress &serverAddress() const { return connector_->serverAddress(); }
+    Connector *connector() const { return connector_.get(); }
+
+    // 以下回调均在loop线程中执行，需在connect()之前设置
+    void setConnectionCallback(ConnectionCallback cb) { connectionCallback_ = std::move(cb); }
+    void setMessageCallback(MessageCallback cb) { messageCallback_ = std::move(cb); }
+    void setWriteCompleteCallback(WriteCompleteCallback cb) { writeCompleteCallback_ = std::move(cb); }
+
+private:
+    void newConnection(int sockfd);
+    void removeConnection(const TcpConnectionPtr &conn);
+
+    EventLoop *loop_;
+    ConnectorPtr connector_;
+    const std::string name_;
+    ConnectionCallback connectionCallback_;
+    MessageCallback messageCallback_;
+    WriteCompleteCallback writeCompleteCallback_;
+    bool retry_;
+    bool connect_;
+    int nextConnId_;
+    mutable std::mutex mutex_;
+    TcpConnectionPtr connection_;   // 受mutex_保护
+};
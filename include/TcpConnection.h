@@ -7,11 +7,15 @@
 #include "Buffer.h"
 #include "Timestamp.h"
 #include "Timer.h"
+#include <any>
 #include <string>
 #include <memory>
 
+struct iovec;
+
 class Channel;
 class Socket;
+class Strand;
 
 class TcpConnection : noncopyable, public std::enable_shared_from_this<TcpConnection>
 {
@@ -33,6 +37,10 @@ public:
 
     void send(const std::string& message);
     void send(Buffer* message);
+    // 聚集写：在loop线程中且没有待发送数据时一次writev发出，写不完的部分按顺序拷贝到outputBuffer_
+    void sendv(const struct iovec* iov, int iovcnt);
+    // 应用直接把数据写入outputBuffer()后调用，尽量立即写出，剩余部分等可写事件；只能在loop线程中调用
+    void flushOutputBuffer();
     void shutdown();
     void forceClose();
 
@@ -60,9 +68,29 @@ public:
     void connectEstablished();
     void connectDestroyed();
 
+    // 连接上的协议状态（如HttpServer的解析器）
+    void setContext(const std::any& context) { context_ = context; }
+    const std::any& getContext() const { return context_; }
+    std::any* getMutableContext() { return &context_; }
+
     Buffer* inputBuffer() { return &inputBuffer_; }
     Buffer* outputBuffer() { return &outputBuffer_; }
 
+    // 计算线程池中属于该连接的strand，提交到其中的任务按顺序执行；未设置计算线程池时为nullptr
+    void setStrand(const std::shared_ptr<Strand>& strand) { strand_ = strand; }
+    Strand* strand() const { return strand_.get(); }
+
+    // 接管socket的原始IO（零拷贝转发用，见SpliceRelay），必须在loop线程中调用。
+    // 设置后可读/可写事件直接交给readHandler/writeHandler，不再经过inputBuffer_/outputBuffer_；
+    // closeHandler在连接关闭时先于连接回调调用。传入空回调即恢复普通模式
+    using RawEventHandler = std::function<void()>;
+    void setRawHandlers(RawEventHandler readHandler,
+                        RawEventHandler writeHandler,
+                        RawEventHandler closeHandler);
+    void enableRawReading(bool on);
+    void enableRawWriting(bool on);
+    int fd() const;
+
 private:
     enum StateE { kDisconnected, kConnecting, kConnected, kDisconnecting };
 
@@ -73,6 +101,7 @@ private:
     void handleError();
     void sendInLoop(const std::string& message);
     void sendInLoop(const void* data, size_t len);
+    void sendvInLoop(const struct iovec* iov, int iovcnt);
     void shutdownInLoop();
     void forceCloseInLoop();
 
@@ -98,6 +127,7 @@ private:
     CloseCallback closeCallback_;
     HighWaterMarkCallback highWaterMarkCallback_;
     size_t highWaterMark_;
+    bool aboveHighWaterMark_;   // 已经报告过越过水位线，降到水位线以下后清除
 
     // 定时器相关成员变量
     TimerId connectionTimeoutTimerId_;
@@ -110,4 +140,11 @@ private:
 
     Buffer inputBuffer_;
     Buffer outputBuffer_;
+
+    std::shared_ptr<Strand> strand_;
+    std::any context_;
+
+    RawEventHandler rawReadHandler_;
+    RawEventHandler rawWriteHandler_;
+    RawEventHandler rawCloseHandler_;
 };
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "noncopyable.h"
+#include "InetAddress.h"
+#include "Callbacks.h"
+#include "Connector.h"
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+class EventLoop;
+
+/**
+ * @brief TcpConnectionPool类，按目标地址(ip:port)缓存出站连接的连接池
+ *
+ * 每个EventLoop各自持有一个连接池，池中连接都属于该loop，因此所有接口都必须在loop线程中调用，
+ * 无需加锁。acquire优先复用空闲的热连接（命中），否则经Connector新建连接（未命中）；
+ * release把仍然可用的连接放回空闲队列，超过每个地址的空闲上限时直接关闭。
+ */
+class TcpConnectionPool : noncopyable
+{
+public:
+    // 连接建立超时时参数为nullptr
+    using AcquireCallback = std::function<void(const TcpConnectionPtr &)>;
+
+    static constexpr double kDefaultConnectTimeout = 10.0;
+
+    TcpConnectionPool(EventLoop *loop, const std::string &name);
+    ~TcpConnectionPool();
+
+    // 以下回调作用于池中所有连接，需在第一次acquire之前设置
+    void setMessageCallback(MessageCallback cb) { messageCallback_ = std::move(cb); }
+    void setConnectionCallback(ConnectionCallback cb) { connectionCallback_ = std::move(cb); }
+    // 每个地址最多保留的空闲连接数
+    void setMaxIdlePerKey(size_t n) { maxIdlePerKey_ = n; }
+    // 新建连接失败时的重试间隔（毫秒）
+    void setRetryDelay(int initDelayMs, int maxDelayMs)
+    {
+        initRetryDelayMs_ = initDelayMs;
+        maxRetryDelayMs_ = maxDelayMs;
+    }
+    // 新建连接（含重试）的总时限（秒），超时后放弃并以nullptr调用AcquireCallback，<=0表示一直重试
+    void setConnectTimeout(double seconds) { connectTimeout_ = seconds; }
+
+    // 获取一条到addr的连接，cb在loop线程中被调用，拿到的连接归调用者独占直到release
+    void acquire(const InetAddress &addr, AcquireCallback cb);
+    // 归还连接，已断开的连接会被丢弃
+    void release(const TcpConnectionPtr &conn);
+
+    EventLoop *getLoop() const { return loop_; }
+    size_t idleCount(const InetAddress &addr) const;
+    size_t numConnections() const { return connections_.size(); }
+
+    // 复用统计
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+    double reuseRate() const
+    {
+        uint64_t total = hits_ + misses_;
+        return total == 0 ? 0.0 : static_cast<double>(hits_) / total;
+    }
+
+private:
+    using IdleList = std::deque<TcpConnectionPtr>;
+
+    // 正在新建的连接
+    struct Pending
+    {
+        ConnectorPtr connector;
+        AcquireCallback cb;
+        TimerId timeoutTimer;
+    };
+
+    void newConnection(int connectorId, const std::string &key, int sockfd);
+    void connectTimeout(int connectorId);
+    void removeConnection(const TcpConnectionPtr &conn);
+    bool removeIdle(const TcpConnectionPtr &conn);
+
+    EventLoop *loop_;
+    const std::string name_;
+    MessageCallback messageCallback_;
+    ConnectionCallback connectionCallback_;
+    size_t maxIdlePerKey_;
+    int initRetryDelayMs_;
+    int maxRetryDelayMs_;
+    double connectTimeout_;
+    int nextConnId_;
+    int nextConnectorId_;
+    uint64_t hits_;
+    uint64_t misses_;
+
+    std::unordered_map<std::string, IdleList> idle_;                  // key -> 空闲连接
+    std::unordered_map<std::string, TcpConnectionPtr> connections_;   // 连接名 -> 池管理的所有连接
+    std::unordered_map<std::string, std::string> connKeys_;           // 连接名 -> key
+    std::unordered_map<int, Pending> connecting_;                     // connector编号 -> 正在新建的连接
+};
@@ -12,6 +12,9 @@ using namespace std;
 #include "Callbacks.h"
 #include<atomic>
 #include <unordered_map>
+#include <vector>
+class ThreadPool;
+
 class TcpServer : noncopyable
 {
 public:
@@ -32,6 +35,29 @@ public:
     void setWriteCompleteCallback(const WriteCompleteCallback &cb) {writeCompleteCallback_ = cb;}
     void setThreadNum(int numThreads);
     void start();
+
+    // 设置计算线程池，之后建立的每个连接都会得到一个该线程池上的strand（见TcpConnection::strand()）
+    void setComputePool(ThreadPool *pool) { computePool_ = pool; }
+
+    // 将IO线程绑定到CPU，必须在start()之前调用
+    void setThreadCpuAffinity(bool on) { threadPool_->setCpuAffinity(on); }
+    // IO线程池，start()之后才有IO线程
+    shared_ptr<EventLoopThreadPool> threadPool() const { return threadPool_; }
+    // 按SO_INCOMING_CPU把新连接分配给绑定在同一CPU上的IO线程，需配合setThreadCpuAffinity使用
+    void setIncomingCpuSteering(bool on) { incomingCpuSteering_ = on; }
+    // reuseport模式下挂载按CPU选择监听socket的BPF程序，groupSize为同端口的监听者数量
+    bool setReusePortCpuSteering(int groupSize) { return acceptor_->setReusePortCpuFilter(groupSize); }
+
+    // 运行时调整IO线程数，可在任意线程调用
+    // 减少线程时被退役的loop不再分配新连接，等其上的连接全部结束后回收线程
+    void adjustThreadNum(int numThreads);
+    // 按IO线程的平均利用率自动扩缩容：每interval秒采样一次，
+    // 高于highUtilization且未达maxThreads时增加一个线程，低于lowUtilization且高于minThreads时退役一个线程
+    void enableAutoScale(int minThreads, int maxThreads,
+                         double lowUtilization = 0.2, double highUtilization = 0.8,
+                         double interval = 5.0);
+    // 退役loop上的连接在drainTimeout秒后仍未结束则强制关闭，0表示一直等待连接自然结束
+    void setDrainTimeout(double seconds) { drainTimeout_ = seconds; }
     
     // 服务器级超时设置
     void setConnectionTimeout(double seconds) { connectionTimeout_ = seconds; }
@@ -46,6 +72,11 @@ private:
     void removeConnectionInLoop(const TcpConnectionPtr &conn);
     void printConnectionsStat();
 
+    void adjustThreadNumInLoop(int numThreads);
+    void closeLoopConnections(EventLoop *ioLoop);
+    void reapRetiringLoops();
+    void onScaleTimer();
+
     using ConnectionMap = unordered_map<string, TcpConnectionPtr>;
     EventLoop *loop_;
     const string ipPort_;
@@ -68,6 +99,22 @@ private:
     double idleTimeout_;
     bool keepAliveEnabled_;
     int keepAliveInterval_;
+
+    bool incomingCpuSteering_;
+    ThreadPool *computePool_;
+
+    // 运行时扩缩容
+    unordered_map<EventLoop*, int> loopConnections_;   // 每个IO loop上的连接数
+    vector<EventLoop*> retiringLoops_;                  // 已退役、等待排空的loop
+    double drainTimeout_;
+    unordered_map<EventLoop*, TimerId> drainTimers_;    // 排空超时后强制关闭连接的定时器
+    int minThreads_;
+    int maxThreads_;
+    double lowUtilization_;
+    double highUtilization_;
+    TimerId scaleTimerId_;
+    Timestamp lastScaleSample_;
+    unordered_map<EventLoop*, int64_t> lastBusyMicroSeconds_;
     
     // 连接统计
     TimerId statTimerId_;
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "noncopyable.h"
+#include "Thread.h"
+#include "Eventloop.h"
+#include <functional>
+#include <memory>
+#include <deque>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <type_traits>
+
+/**
+ * @brief ThreadPool类，用于卸载CPU密集任务的计算线程池
+ *
+ * 每个工作线程有自己的任务队列，空闲时从其他线程的队列尾部窃取任务（work stealing）。
+ * 在工作线程内提交的任务进入本线程队列，外部提交的任务轮询分配到各队列。
+ * IO线程只负责把任务交给线程池，结果通过EventLoop::queueInLoop送回所属的loop。
+ */
+class ThreadPool : noncopyable
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(const std::string &name = std::string("ThreadPool"));
+    ~ThreadPool();
+
+    /**
+     * @brief 启动线程池
+     * @param numThreads 工作线程数，0表示使用CPU核数
+     */
+    void start(int numThreads = 0);
+
+    /**
+     * @brief 停止线程池，等待已提交的任务执行完毕
+     * 可以和其他线程的run()并发：stop()开始之前进入队列的任务都会执行，之后的run()在调用线程中执行
+     */
+    void stop();
+
+    /**
+     * @brief 提交任务，可在任意线程调用；线程池未启动或已停止时直接在调用线程执行
+     */
+    void run(Task task);
+
+    /**
+     * @brief 在工作线程中执行work，完成后在loop线程中执行done(result)
+     * result通过移动传递，不产生额外拷贝；work、done和result可以是只能移动的类型。
+     * work返回引用时done收到的是一份拷贝；work返回void时调用done()
+     */
+    template <typename Work, typename Done>
+    void runThenInLoop(Work work, EventLoop *loop, Done done)
+    {
+        run(thenInLoop(std::move(work), loop, std::move(done)));
+    }
+
+    /**
+     * @brief 把work和done包装成一个任务：执行work后把结果交给loop线程中的done
+     * Task是std::function，要求可拷贝，所以work、done和结果放在shared_ptr中；
+     * 执行后work在工作线程中释放，done和结果在loop线程中释放
+     */
+    template <typename Work, typename Done>
+    static Task thenInLoop(Work work, EventLoop *loop, Done done)
+    {
+        auto workPtr = std::make_shared<Work>(std::move(work));
+        auto donePtr = std::make_shared<Done>(std::move(done));
+        return [workPtr, loop, donePtr]() mutable {
+            // 引用在work释放或回到loop线程后可能已经失效，按值保存
+            using Result = std::decay_t<decltype((*workPtr)())>;
+            if constexpr (std::is_void_v<Result>)
+            {
+                (*workPtr)();
+                workPtr.reset();
+                loop->queueInLoop([donePtr = std::move(donePtr)]() { (*donePtr)(); });
+            }
+            else
+            {
+                auto result = std::make_shared<Result>((*workPtr)());
+                workPtr.reset();
+                loop->queueInLoop([donePtr = std::move(donePtr), result]() {
+                    (*donePtr)(std::move(*result));
+                });
+            }
+        };
+    }
+
+    const std::string &name() const { return name_; }
+    int numThreads() const { return static_cast<int>(threads_.size()); }
+    // 尚未开始执行的任务数
+    int pendingTasks() const { return pending_.load(); }
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerFunc(size_t index);
+    bool popTask(size_t index, Task &task);
+
+    std::string name_;
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::unique_ptr<Thread>> threads_;
+    std::atomic<size_t> nextQueue_;     // 外部提交时轮询的队列下标
+    std::atomic<bool> running_;         // 工作线程是否继续等待任务
+    std::atomic<bool> accepting_;       // run()是否把任务放入队列，stop()先关闭它
+    std::atomic<int> submitting_;       // 正在往队列里放任务的run()调用数
+    std::atomic<int> pending_;          // 所有队列中的任务总数
+    std::atomic<int> idle_;             // 正在睡眠的工作线程数
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCond_;
+};
+
+/**
+ * @brief Strand类，保证提交到同一个strand的任务按提交顺序串行执行
+ *
+ * 不同strand的任务可以在线程池中并行执行。通常每个TcpConnection持有一个strand，
+ * 这样同一连接上的请求处理保持有序，而不同连接之间可以利用所有CPU核。
+ */
+class Strand : noncopyable, public std::enable_shared_from_this<Strand>
+{
+public:
+    using Task = ThreadPool::Task;
+
+    explicit Strand(ThreadPool *pool);
+
+    /**
+     * @brief 提交任务，可在任意线程调用
+     */
+    void post(Task task);
+
+    /**
+     * @brief 按strand顺序在工作线程中执行work，完成后在loop线程中执行done(result)
+     */
+    template <typename Work, typename Done>
+    void postThenInLoop(Work work, EventLoop *loop, Done done)
+    {
+        post(ThreadPool::thenInLoop(std::move(work), loop, std::move(done)));
+    }
+
+    ThreadPool *pool() const { return pool_; }
+
+private:
+    void drain();
+
+    // 每次最多连续执行的任务数，超过后重新排队，避免长队列的strand独占工作线程
+    static const int kMaxBatch = 64;
+
+    ThreadPool *pool_;
+    std::mutex mutex_;
+    std::deque<Task> tasks_;
+    bool scheduled_;    // 是否已在线程池中排队或正在执行
+};
+
+using StrandPtr = std::shared_ptr<Strand>;
@@ -33,6 +33,16 @@ public:
      */
     std::string to_string() const;
 
+    /**
+     * @brief 把本地时间"YYYYMMDD HH:MM:SS.uuuuuu"写入buf，不追加'\0'
+     * @return 写入的字节数，即kFormattedSize
+     *
+     * 本地时区的偏移每个线程每小时用localtime_r取一次，能跟随夏令时切换；
+     * 每个线程缓存最近一秒的"YYYYMMDD HH:MM:SS"，同一秒内只改写微秒部分。
+     */
+    int format(char* buf) const;
+    static const int kFormattedSize = 24;
+
     /**
      * @brief 判断时间戳是否有效
      * @return true表示有效，false表示无效
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "noncopyable.h"
+#include "InetAddress.h"
+#include "Timestamp.h"
+#include "Socket.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Channel;
+class EventLoop;
+class UdpChannel;
+
+/**
+ * @brief 一个收到的UDP报文，data指向所属loop的报文区(arena)，只在批量回调期间有效
+ */
+struct Datagram
+{
+    const char *data;
+    size_t len;
+    InetAddress peer;
+};
+
+using DatagramBatchCallback = std::function<void(UdpChannel *, const Datagram *datagrams, size_t n, Timestamp)>;
+
+/**
+ * @brief UdpChannel类，一个绑定在某个EventLoop上的UDP socket
+ *
+ * 接收：每次可读事件用recvmmsg一次读入一批报文，放进本线程的报文区后整批交给DatagramBatchCallback；
+ * 开启GRO时内核合并的大报文会在回调前按段长拆回独立的报文。
+ * 发送：send()只把报文追加到发送队列，本轮事件循环结束前（pending functor阶段）统一用sendmmsg发出；
+ * 开启GSO时sendSegments()的同目的地多段数据以一个带UDP_SEGMENT的报文提交，由内核/网卡切分。
+ */
+class UdpChannel : noncopyable, public std::enable_shared_from_this<UdpChannel>
+{
+public:
+    static const int kDefaultBatchSize = 64;
+    static const size_t kDefaultMaxDatagramSize = 2048;
+
+    UdpChannel(EventLoop *loop, const InetAddress &bindAddr, bool reusePort = false);
+    ~UdpChannel();
+
+    // 以下设置需在start()之前完成
+    void setBatchCallback(DatagramBatchCallback cb) { batchCallback_ = std::move(cb); }
+    // 每次recvmmsg/sendmmsg最多处理的报文数
+    void setBatchSize(int n) { batchSize_ = n; }
+    // 不开启GRO时单个报文的接收上限，超过的报文被丢弃并计入datagramsTruncated()
+    void setMaxDatagramSize(size_t n) { maxDatagramSize_ = n; }
+    // 开启UDP GSO/GRO，内核不支持时返回false
+    bool enableGso(bool on);
+    bool enableGro(bool on);
+
+    // 开始接收，可在任意线程调用
+    void start();
+    // 停止接收并从loop中移除，必须在loop线程中调用
+    void stopInLoop();
+
+    // 发送一个报文，可在任意线程调用；在loop线程中调用时只拷贝到发送队列，本轮循环结束前批量发出
+    void send(const InetAddress &peer, const void *data, size_t len);
+    // 把data按segmentSize切分成多个报文发给同一个peer，开启GSO时每64段只需内核处理一次
+    void sendSegments(const InetAddress &peer, const void *data, size_t len, size_t segmentSize);
+
+    EventLoop *getLoop() const { return loop_; }
+    int fd() const { return socket_.fd(); }
+    InetAddress localAddress() const { return Socket::getLocalAddr(socket_.fd()); }
+    bool gsoEnabled() const { return gso_; }
+    bool groEnabled() const { return gro_; }
+
+    // 统计，可在其他线程读取；报文数/系统调用次数即为平均批量大小
+    uint64_t datagramsReceived() const { return datagramsReceived_.load(std::memory_order_relaxed); }
+    uint64_t recvCalls() const { return recvCalls_.load(std::memory_order_relaxed); }
+    // 超过接收上限而被丢弃的报文数
+    uint64_t datagramsTruncated() const { return datagramsTruncated_.load(std::memory_order_relaxed); }
+    uint64_t datagramsSent() const { return datagramsSent_.load(std::memory_order_relaxed); }
+    uint64_t sendCalls() const { return sendCalls_.load(std::memory_order_relaxed); }
+
+private:
+    struct PendingDatagram
+    {
+        sockaddr_in peer;
+        size_t offset;          // 在pendingData_中的偏移
+        size_t len;
+        uint16_t segmentSize;   // 非0表示以GSO提交，len为多段总长
+    };
+
+    void handleRead(Timestamp receiveTime);
+    void handleWrite();
+    void queueDatagram(const sockaddr_in &peer, const char *data, size_t len, uint16_t segmentSize);
+    void scheduleFlush();
+    void flush();
+
+    EventLoop *loop_;
+    Socket socket_;
+    std::unique_ptr<Channel> channel_;
+    DatagramBatchCallback batchCallback_;
+    int batchSize_;
+    size_t maxDatagramSize_;
+    bool gso_;
+    bool gro_;
+
+    std::vector<PendingDatagram> pending_;
+    std::string pendingData_;
+    size_t pendingHead_;        // 第一个尚未发出的报文
+    bool flushQueued_;
+
+    std::atomic<uint64_t> datagramsReceived_;
+    std::atomic<uint64_t> recvCalls_;
+    std::atomic<uint64_t> datagramsTruncated_;
+    std::atomic<uint64_t> datagramsSent_;
+    std::atomic<uint64_t> sendCalls_;
+};
+
+using UdpChannelPtr = std::shared_ptr<UdpChannel>;
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "noncopyable.h"
+#include "InetAddress.h"
+#include "UdpChannel.h"
+#include "EventLoopThreadPool.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+class EventLoop;
+
+/**
+ * @brief UdpServer类，在一个或多个IO线程上接收同一端口的UDP报文
+ *
+ * 不设置线程数时只在baseLoop上创建一个UdpChannel；设置线程数后每个IO线程各自持有一个
+ * SO_REUSEPORT的UdpChannel，由内核按四元组把报文分散到各个线程，线程之间没有共享状态。
+ */
+class UdpServer : noncopyable
+{
+public:
+    UdpServer(EventLoop *loop, const InetAddress &listenAddr, const std::string &name);
+    ~UdpServer();
+
+    // 以下设置需在start()之前完成
+    void setThreadNum(int numThreads) { threadPool_->setThreadNUm(numThreads); }
+    void setBatchCallback(const DatagramBatchCallback &cb) { batchCallback_ = cb; }
+    void setBatchSize(int n) { batchSize_ = n; }
+    void setMaxDatagramSize(size_t n) { maxDatagramSize_ = n; }
+    void enableGso(bool on) { gso_ = on; }
+    void enableGro(bool on) { gro_ = on; }
+
+    // 开始接收，必须在baseLoop线程中调用
+    void start();
+
+    const std::string &name() const { return name_; }
+    const std::vector<UdpChannelPtr> &channels() const { return channels_; }
+
+    // 所有UdpChannel的统计之和
+    uint64_t datagramsReceived() const;
+    uint64_t recvCalls() const;
+    uint64_t datagramsSent() const;
+    uint64_t sendCalls() const;
+
+private:
+    EventLoop *loop_;
+    const InetAddress listenAddr_;
+    const std::string name_;
+    std::unique_ptr<EventLoopThreadPool> threadPool_;
+    DatagramBatchCallback batchCallback_;
+    int batchSize_;
+    size_t maxDatagramSize_;
+    bool gso_;
+    bool gro_;
+    bool started_;
+    std::vector<UdpChannelPtr> channels_;
+};
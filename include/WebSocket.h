@@ -0,0 +1,161 @@
+#pragma once
+
+#include "noncopyable.h"
+#include "Callbacks.h"
+#include "Timestamp.h"
+#include "TcpServer.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+class HttpParser;
+class HttpRequest;
+class HttpResponse;
+
+/**
+ * @brief WebSocket协议（RFC 6455）的帧格式和握手
+ */
+namespace websocket
+{
+
+enum Opcode
+{
+    kContinuation = 0x0,
+    kText = 0x1,
+    kBinary = 0x2,
+    kClose = 0x8,
+    kPing = 0x9,
+    kPong = 0xA,
+};
+
+enum CloseCode
+{
+    kNormalClosure = 1000,
+    kGoingAway = 1001,
+    kProtocolError = 1002,
+    kUnsupportedData = 1003,
+    kNoStatusReceived = 1005,
+    kMessageTooBig = 1009,
+};
+
+// 帧头最长14字节：2字节基本头 + 8字节扩展长度 + 4字节掩码密钥
+const size_t kMaxFrameHeaderSize = 14;
+
+// 由客户端的Sec-WebSocket-Key计算Sec-WebSocket-Accept：base64(SHA1(key + GUID))
+std::string acceptKey(std::string_view clientKey);
+
+// 把帧头写入out（至少kMaxFrameHeaderSize字节），返回帧头长度。
+// 服务器发出的帧不带掩码；maskKey非空时设置掩码位并附上4字节密钥，负载需由调用方用scan::xorMask掩码
+size_t encodeFrameHeader(char* out, Opcode opcode, uint64_t payloadLen,
+                         bool fin = true, const unsigned char* maskKey = nullptr);
+
+} // namespace websocket
+
+class WebSocketConnection;
+using WebSocketConnectionPtr = std::shared_ptr<WebSocketConnection>;
+// 握手完成和连接断开时各调用一次，用connected()区分
+using WebSocketConnectionCallback = std::function<void(const WebSocketConnectionPtr&)>;
+// 完整的消息（分片已拼接），opcode为kText或kBinary；视图只在回调期间有效
+using WebSocketMessageCallback = std::function<void(const WebSocketConnectionPtr&, std::string_view message,
+                                                    websocket::Opcode opcode, Timestamp)>;
+
+/**
+ * @brief WebSocketConnection类，一个WebSocket连接
+ *
+ * 存放在TcpConnection的context中，只持有TcpConnection的弱引用。
+ * send()可以在任意线程调用：帧头放在栈上，和负载一起用TcpConnection::sendv()聚集写出，负载不做拷贝
+ * （跨线程调用时由sendv拷贝一次转交给IO线程）。
+ */
+class WebSocketConnection : noncopyable
+{
+public:
+    explicit WebSocketConnection(const TcpConnectionPtr& conn);
+    ~WebSocketConnection();
+
+    const std::string& name() const { return name_; }
+    // 握手已完成且尚未开始关闭
+    bool connected() const { return state_ == kOpen; }
+    TcpConnectionPtr tcpConnection() const { return conn_.lock(); }
+
+    void send(std::string_view payload, websocket::Opcode opcode = websocket::kText);
+    // 多条消息一次writev发出，适合推送服务合并同一连接上的消息
+    void send(const std::string_view* payloads, size_t n, websocket::Opcode opcode = websocket::kText);
+    void ping(std::string_view payload = std::string_view());
+    // 发送关闭帧后半关闭连接，之后收到的数据帧被丢弃
+    void close(uint16_t code = websocket::kNormalClosure, std::string_view reason = std::string_view());
+
+private:
+    friend class WebSocketServer;
+
+    enum State
+    {
+        kHandshake,
+        kOpen,
+        kClosing,
+    };
+
+    void sendFrame(websocket::Opcode opcode, std::string_view payload);
+
+    std::weak_ptr<TcpConnection> conn_;
+    std::string name_;
+    std::atomic<int> state_;
+
+    // 以下只在IO线程中访问
+    std::unique_ptr<HttpParser> handshake_;
+    std::string message_;               // 分片消息的拼接缓冲
+    websocket::Opcode messageOpcode_;
+    bool inMessage_;
+    uint64_t unmaskedBytes_;            // 当前未收全的帧中已解掩码的负载字节数
+};
+
+/**
+ * @brief WebSocketServer类，基于TcpServer的WebSocket服务器
+ *
+ * 连接先按HTTP/1.1解析握手请求，升级成功后在inputBuffer_上原地解析帧：
+ * 负载用scan::xorMask（SSE2/AVX2每次16/32字节）原地解掩码，大帧在数据陆续到达时边收边解，
+ * 不必等整帧收齐后再把全部数据读一遍；不分片的消息直接以指向inputBuffer_的视图交给回调。
+ * Ping自动回Pong，收到关闭帧时回应关闭帧并半关闭连接；协议错误以1002关闭，消息超过上限以1009关闭。
+ *
+ * 不是升级请求的HTTP请求交给HttpCallback处理，未设置时返回426。
+ */
+class WebSocketServer : noncopyable
+{
+public:
+    using HttpCallback = std::function<void(const HttpRequest&, HttpResponse*)>;
+    // 在回复101之前调用，返回false时以403拒绝，可用于检查路径、Origin等
+    using HandshakeCallback = std::function<bool(const HttpRequest&)>;
+
+    static const size_t kDefaultMaxMessageSize = 16 * 1024 * 1024;
+
+    WebSocketServer(EventLoop* loop,
+                    const InetAddress& listenAddr,
+                    TcpServer::Option option = TcpServer::kNoReusePort);
+
+    void setConnectionCallback(const WebSocketConnectionCallback& cb) { connectionCallback_ = cb; }
+    void setMessageCallback(const WebSocketMessageCallback& cb) { messageCallback_ = cb; }
+    void setHandshakeCallback(const HandshakeCallback& cb) { handshakeCallback_ = cb; }
+    void setHttpCallback(const HttpCallback& cb) { httpCallback_ = cb; }
+    // 单条消息（分片拼接后）的上限
+    void setMaxMessageSize(size_t n) { maxMessageSize_ = n; }
+    void setThreadNum(int numThreads) { server_.setThreadNum(numThreads); }
+
+    void start();
+
+private:
+    void onConnection(const TcpConnectionPtr& conn);
+    void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp receiveTime);
+    // 握手完成返回true
+    bool handleHandshake(const TcpConnectionPtr& conn, const WebSocketConnectionPtr& ws, Buffer* buf);
+    void handleFrames(const WebSocketConnectionPtr& ws, Buffer* buf, Timestamp receiveTime);
+    void failConnection(const WebSocketConnectionPtr& ws, uint16_t code);
+
+    TcpServer server_;
+    WebSocketConnectionCallback connectionCallback_;
+    WebSocketMessageCallback messageCallback_;
+    HandshakeCallback handshakeCallback_;
+    HttpCallback httpCallback_;
+    size_t maxMessageSize_;
+};
@@ -7,9 +7,10 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 
-static int createNonblockingOrDie()
+static int createNonblockingOrDie(sa_family_t family)
 {
-    int sockfd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+    int protocol = (family == AF_UNIX) ? 0 : IPPROTO_TCP;
+    int sockfd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol);
     if (sockfd < 0)
     {
         LOG_FATAL("%s:%s:%d listen socket create err:%d \n", __FILE__, __FUNCTION__, __LINE__, errno);
@@ -19,12 +20,23 @@ static int createNonblockingOrDie()
 
 Acceptor::Acceptor(EventLoop *loop, const InetAddress &listenAddr, bool reuseport)
     : loop_(loop),
-      acceptSocket_(createNonblockingOrDie()),
+      acceptSocket_(createNonblockingOrDie(listenAddr.family())),
       acceptChannel_(loop, acceptSocket_.fd()),
       listening_(false)
 {
-    acceptSocket_.setReuseAddr(true);
-    acceptSocket_.setReusePort(reuseport);
+    if (listenAddr.isUnix())
+    {
+        string path = listenAddr.unixPath();
+        if (!path.empty() && path[0] != '@')
+        {
+            unixPath_ = path;
+        }
+    }
+    else
+    {
+        acceptSocket_.setReuseAddr(true);
+        acceptSocket_.setReusePort(reuseport);
+    }
     acceptSocket_.bindAddress(listenAddr);
 
     // 设置读事件回调
@@ -36,6 +48,10 @@ Acceptor::~Acceptor()
 {
     acceptChannel_.disableAll();
     acceptChannel_.remove();
+    if (!unixPath_.empty())
+    {
+        ::unlink(unixPath_.c_str());
+    }
 }
 
 void Acceptor::listen()
@@ -62,10 +78,12 @@ void Acceptor::handleRead()
     }
     else
     {
-        LOG_ERROR("%s:%s:%d accept err:%d\n", __FILE__, __FUNCTION__, __LINE__, errno);
-        if (errno == EMFILE)
+        // fd耗尽时监听套接字一直可读，每轮poll都会走到这里，限流避免刷屏
+        int savedErrno = errno;
+        LOG_EVERY_MS(ERROR, 1000, "%s:%s:%d accept err:%d", __FILE__, __FUNCTION__, __LINE__, savedErrno);
+        if (savedErrno == EMFILE)
         {
-            LOG_ERROR("%s:%s:%d sockfd reached limit!\n", __FILE__, __FUNCTION__, __LINE__);
+            LOG_EVERY_MS(ERROR, 1000, "%s:%s:%d sockfd reached limit!", __FILE__, __FUNCTION__, __LINE__);
         }
     }
 }
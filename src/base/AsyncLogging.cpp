@@ -1,93 +1,402 @@
 #include "AsyncLogging.h"
+#include "BinaryLog.h"
 #include "LogFile.h"
+#include "Logger.h"
 #include "Timestamp.h"
 #include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <sys/uio.h>
+
+namespace {
+
+std::atomic<uint64_t> g_nextInstanceId(1);
+
+constexpr char kDroppedNotice[] = "AsyncLogging dropped %llu lines (%llu bytes) while the backlog was full";
+
+// 二进制原样写入时，丢弃统计也写成一条二进制记录
+struct DroppedNoticeSite {
+    static constexpr const char* format() { return kDroppedNotice; }
+    static constexpr const char* file() { return __FILE__; }
+    static constexpr int line() { return __LINE__; }
+    static constexpr int level() { return ERROR; }
+};
+
+} // namespace
+
+AsyncLogging::ThreadBuffer::~ThreadBuffer() {
+    delete current;
+    for (LogBuffer* list : {spare, returned.load()}) {
+        while (list != nullptr) {
+            LogBuffer* next = list->next;
+            delete list;
+            list = next;
+        }
+    }
+}
 
 AsyncLogging::AsyncLogging(const std::string& basename,
                            off_t rollSize,
-                           int flushInterval)
+                           int flushInterval,
+                           size_t bufferSize,
+                           int bufferPoolDepth)
     : flushInterval_(flushInterval),
       running_(false),
       basename_(basename),
       rollSize_(rollSize),
+      bufferSize_(bufferSize),
+      bufferPoolDepth_(std::max(bufferPoolDepth, 2)),
+      instanceId_(g_nextInstanceId.fetch_add(1)),
+      encoding_(kText),
+      maxBacklogBytes_(kDefaultMaxBacklogBytes),
+      overflowPolicy_(kDropNewest),
+      blockSeconds_(0.1),
+      syncInterval_(0),
+      compressRolledFiles_(false),
       thread_(std::bind(&AsyncLogging::threadFunc, this), "Logging"),
+      fullBuffers_(nullptr),
+      sleeping_(false),
+      backlogBytes_(0),
+      blockedWriters_(0),
+      droppedLines_(0),
+      droppedBytes_(0),
+      totalDroppedLines_(0),
+      totalDroppedBytes_(0),
       mutex_(),
       cond_(mutex_),
-      currentBuffer_(new Buffer),
-      nextBuffer_(new Buffer),
-      buffers_() {
-    currentBuffer_->bzero();
-    nextBuffer_->bzero();
-    buffers_.reserve(16);
+      spaceCond_(mutex_) {
+}
+
+AsyncLogging::~AsyncLogging() {
+    if (running_) {
+        stop();
+    }
+    MutexLockGuard lock(registryMutex_);
+    for (const auto& tb : threadBuffers_) {
+        // 线程退出时不再访问本对象，它持有的缓冲区随ThreadBuffer释放
+        MutexLockGuard tbLock(tb->mutex);
+        tb->detached = true;
+    }
+    LogBuffer* list = fullBuffers_.exchange(nullptr);
+    while (list != nullptr) {
+        LogBuffer* next = list->next;
+        delete list;
+        list = next;
+    }
+}
+
+void AsyncLogging::retireThreadBuffer(const std::shared_ptr<ThreadBuffer>& tb) {
+    MutexLockGuard lock(tb->mutex);
+    if (!tb->detached && tb->current != nullptr && tb->current->length > 0) {
+        tb->owner->handOff(tb.get(), tb->current);
+        tb->current = nullptr;
+    }
+    tb->retired = true;
+}
+
+AsyncLogging::ThreadBuffer* AsyncLogging::threadBuffer() {
+    // 线程退出时交出未写满的缓冲区，之后由后端从注册表中移除
+    struct Slot {
+        uint64_t instanceId = 0;
+        std::shared_ptr<ThreadBuffer> tb;
+
+        ~Slot() {
+            if (tb) {
+                retireThreadBuffer(tb);
+            }
+        }
+    };
+    static thread_local Slot t_slot;
+
+    if (t_slot.instanceId != instanceId_) {
+        if (t_slot.tb) {
+            retireThreadBuffer(t_slot.tb);
+        }
+        std::shared_ptr<ThreadBuffer> tb = std::make_shared<ThreadBuffer>();
+        tb->owner = this;
+        {
+            MutexLockGuard lock(registryMutex_);
+            threadBuffers_.push_back(tb);
+        }
+        t_slot.tb = std::move(tb);
+        t_slot.instanceId = instanceId_;
+    }
+    return t_slot.tb.get();
+}
+
+AsyncLogging::LogBuffer* AsyncLogging::acquireBuffer(ThreadBuffer* tb) {
+    if (tb->spare == nullptr) {
+        tb->spare = tb->returned.exchange(nullptr, std::memory_order_acquire);
+    }
+    LogBuffer* buffer = tb->spare;
+    if (buffer != nullptr) {
+        tb->spare = buffer->next;
+        buffer->next = nullptr;
+        return buffer;
+    }
+    buffer = new LogBuffer(bufferSize_);
+    buffer->owner = tb;
+    if (tb->pooled < bufferPoolDepth_) {
+        ++tb->pooled;
+    } else {
+        buffer->pooled = false;
+    }
+    return buffer;
+}
+
+void AsyncLogging::handOff(ThreadBuffer* tb, LogBuffer* buffer) {
+    tb->inFlight.fetch_add(1);
+    backlogBytes_.fetch_add(buffer->capacity);
+    LogBuffer* head = fullBuffers_.load(std::memory_order_relaxed);
+    do {
+        buffer->next = head;
+    } while (!fullBuffers_.compare_exchange_weak(head, buffer));
+    // 和后端的"设置sleeping_后再检查fullBuffers_"配对，两边至少有一边看到对方
+    if (sleeping_.load()) {
+        MutexLockGuard lock(mutex_);
+        cond_.notify();
+    }
 }
 
 void AsyncLogging::append(const char* logline, int len) {
-    MutexLockGuard lock(mutex_);
-    if (currentBuffer_->avail() > len) {
-        currentBuffer_->append(logline, len);
+    ThreadBuffer* tb = threadBuffer();
+    size_t n = std::min(static_cast<size_t>(len), bufferSize_);
+    // 在本线程的锁外等待，后端收取未写满的缓冲区时不会被挡住
+    if (overflowPolicy_ == kBlock && backlogFull()) {
+        waitForBacklog();
+    }
+    MutexLockGuard lock(tb->mutex);
+    LogBuffer* buffer = tb->current;
+    if (buffer == nullptr) {
+        buffer = tb->current = acquireBuffer(tb);
+    } else if (buffer->capacity - buffer->length < n) {
+        if (!makeRoom(tb, buffer, n)) {
+            return;
+        }
+        buffer = tb->current;
+    }
+    memcpy(buffer->data.get() + buffer->length, logline, n);
+    buffer->length += n;
+    ++buffer->lines;
+}
+
+bool AsyncLogging::makeRoom(ThreadBuffer* tb, LogBuffer* buffer, size_t len) {
+    if (!backlogFull()) {
+        handOff(tb, buffer);
+        tb->current = acquireBuffer(tb);
+        return true;
+    }
+    if (overflowPolicy_ == kDropOldest) {
+        recordDropped(buffer->lines, buffer->length);
+        buffer->length = 0;
+        buffer->lines = 0;
+        return true;
+    }
+    recordDropped(1, len);
+    return false;
+}
+
+bool AsyncLogging::backlogFull() const {
+    return maxBacklogBytes_ != 0 && backlogBytes_.load() + bufferSize_ > maxBacklogBytes_;
+}
+
+void AsyncLogging::waitForBacklog() {
+    Timestamp deadline = addTime(Timestamp::now(), blockSeconds_);
+    ++blockedWriters_;
+    {
+        MutexLockGuard lock(mutex_);
+        // 后端没有运行时等待没有意义，直接按丢弃处理
+        while (running_ && backlogFull()) {
+            double remaining = timeDifference(deadline, Timestamp::now());
+            if (remaining <= 0) {
+                break;
+            }
+            spaceCond_.waitForSeconds(remaining);
+        }
+    }
+    --blockedWriters_;
+}
+
+void AsyncLogging::recordDropped(uint64_t lines, uint64_t bytes) {
+    droppedLines_ += lines;
+    droppedBytes_ += bytes;
+    totalDroppedLines_ += lines;
+    totalDroppedBytes_ += bytes;
+}
+
+bool AsyncLogging::formatDroppedNotice(std::string* out) {
+    unsigned long long lines = droppedLines_.exchange(0);
+    unsigned long long bytes = droppedBytes_.exchange(0);
+    if (lines == 0 && bytes == 0) {
+        return false;
+    }
+    char buf[binlog::kMaxRecordSize];
+    int len;
+    if (encoding_ == kBinaryRaw) {
+        len = binlog::encode<DroppedNoticeSite>(buf, lines, bytes);
     } else {
-        buffers_.push_back(std::move(currentBuffer_));
-        if (nextBuffer_) {
-            currentBuffer_ = std::move(nextBuffer_);
-        } else {
-            currentBuffer_.reset(new Buffer);
+        len = Logger::formatPrefix(buf, ERROR);
+        len += snprintf(buf + len, sizeof buf - len - 1, kDroppedNotice, lines, bytes);
+        buf[len++] = '\n';
+    }
+    out->assign(buf, len);
+    return true;
+}
+
+void AsyncLogging::collectPartialBuffers() {
+    std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+    {
+        MutexLockGuard lock(registryMutex_);
+        threadBuffers = threadBuffers_;
+    }
+    for (const auto& tb : threadBuffers) {
+        MutexLockGuard lock(tb->mutex);
+        if (tb->current != nullptr && tb->current->length > 0) {
+            handOff(tb.get(), tb->current);
+            tb->current = nullptr;
         }
-        currentBuffer_->append(logline, len);
-        cond_.notify();
     }
 }
 
+void AsyncLogging::releaseBuffer(LogBuffer* buffer) {
+    ThreadBuffer* tb = buffer->owner;
+    backlogBytes_.fetch_sub(buffer->capacity);
+    if (!buffer->pooled || tb->retired) {
+        delete buffer;
+    } else {
+        buffer->length = 0;
+        buffer->lines = 0;
+        LogBuffer* head = tb->returned.load(std::memory_order_relaxed);
+        do {
+            buffer->next = head;
+        } while (!tb->returned.compare_exchange_weak(head, buffer, std::memory_order_release,
+                                                     std::memory_order_relaxed));
+    }
+    tb->inFlight.fetch_sub(1);
+}
+
+void AsyncLogging::setEncoding(Encoding encoding) {
+    assert(!running_);
+    assert(encoding == kText || bufferSize_ >= binlog::kMaxRecordSize);
+    encoding_ = encoding;
+}
+
+void AsyncLogging::setBacklogLimit(size_t maxBacklogBytes, OverflowPolicy policy, double blockSeconds) {
+    assert(!running_);
+    // 上限至少容纳一个缓冲区，否则永远交不出去
+    maxBacklogBytes_ = maxBacklogBytes == 0 ? 0 : std::max(maxBacklogBytes, bufferSize_);
+    overflowPolicy_ = policy;
+    blockSeconds_ = blockSeconds;
+}
+
+void AsyncLogging::setSyncInterval(int syncSeconds) {
+    assert(!running_);
+    syncInterval_ = syncSeconds;
+}
+
+void AsyncLogging::setCompressRolledFiles(bool on) {
+    assert(!running_);
+    compressRolledFiles_ = on;
+}
+
 void AsyncLogging::threadFunc() {
-    assert(running_ == true);
-    LogFile output(basename_, rollSize_, false);
-    BufferPtr newBuffer1(new Buffer);
-    BufferPtr newBuffer2(new Buffer);
-    newBuffer1->bzero();
-    newBuffer2->bzero();
-    BufferVector buffersToWrite;
-    buffersToWrite.reserve(16);
-    while (running_) {
-        {
+    // 不断言running_：start()之后立刻stop()时后端可能还没运行，第一轮就收取全部日志后退出
+    LogFile output(basename_, rollSize_, false, flushInterval_, syncInterval_);
+    output.setCompressRolledFiles(compressRolledFiles_);
+    std::vector<LogBuffer*> batch;
+    std::vector<struct iovec> iov;
+    binlog::Decoder decoder;
+    std::string text;          // 后端格式化的二进制日志
+    std::string definitions;   // 原样写入时，当前文件还没有的格式点定义
+    std::string droppedNotice;
+    uint32_t definedSites = 0;
+    Timestamp lastCollect = Timestamp::now();
+    for (;;) {
+        bool stopping = !running_;
+        if (!stopping) {
             MutexLockGuard lock(mutex_);
-            if (buffers_.empty()) {
+            sleeping_ = true;
+            if (fullBuffers_.load() == nullptr && running_) {
                 cond_.waitForSeconds(flushInterval_);
             }
-            buffers_.push_back(std::move(currentBuffer_));
-            currentBuffer_ = std::move(newBuffer1);
-            buffersToWrite.swap(buffers_);
-            if (!nextBuffer_) {
-                nextBuffer_ = std::move(newBuffer2);
-            }
+            sleeping_ = false;
         }
 
-        assert(!buffersToWrite.empty());
-
-        for (const auto& buffer : buffersToWrite) {
-            output.append(buffer->data(), buffer->length());
+        // 超时醒来、停止或距上次收取超过刷新间隔时，连同各线程未写满的缓冲区一起写入
+        Timestamp now = Timestamp::now();
+        if (stopping || fullBuffers_.load() == nullptr || timeDifference(now, lastCollect) >= flushInterval_) {
+            collectPartialBuffers();
+            lastCollect = now;
         }
 
-        if (buffersToWrite.size() > 2) {
-            buffersToWrite.resize(2);
+        // 无锁栈是后进先出的，反转后同一线程的缓冲区按交出顺序写入
+        LogBuffer* list = fullBuffers_.exchange(nullptr);
+        batch.clear();
+        for (; list != nullptr; list = list->next) {
+            batch.push_back(list);
         }
+        std::reverse(batch.begin(), batch.end());
 
-        if (!newBuffer1) {
-            assert(!buffersToWrite.empty());
-            newBuffer1 = std::move(buffersToWrite.back());
-            buffersToWrite.pop_back();
-            newBuffer1->reset();
+        // 积压期间丢弃的统计写在这一轮的最前面
+        bool dropped = formatDroppedNotice(&droppedNotice);
+        if (!batch.empty() || dropped) {
+            iov.clear();
+            if (encoding_ == kBinaryFormatted) {
+                // 每条记录都完整地落在一个缓冲区里，逐个缓冲区解码即可
+                text.clear();
+                if (dropped) {
+                    text += droppedNotice;
+                }
+                for (LogBuffer* buffer : batch) {
+                    decoder.decode(buffer->data.get(), buffer->length, &text);
+                }
+                iov.push_back({&text[0], text.size()});
+            } else {
+                if (encoding_ == kBinaryRaw) {
+                    // 新文件从头写一遍格式点定义，之后只补新注册的，每个文件都可以单独解码
+                    if (output.writtenBytes() == 0) {
+                        definedSites = 0;
+                    }
+                    uint32_t sites = binlog::siteCount();
+                    definitions.clear();
+                    if (sites > definedSites) {
+                        binlog::encodeDefinitions(definedSites + 1, sites, &definitions);
+                        definedSites = sites;
+                        iov.push_back({&definitions[0], definitions.size()});
+                    }
+                }
+                if (dropped) {
+                    iov.push_back({&droppedNotice[0], droppedNotice.size()});
+                }
+                for (LogBuffer* buffer : batch) {
+                    iov.push_back({buffer->data.get(), buffer->length});
+                }
+            }
+            output.appendv(iov.data(), static_cast<int>(iov.size()));
+            output.flush();
+            for (LogBuffer* buffer : batch) {
+                releaseBuffer(buffer);
+            }
+            if (blockedWriters_.load() > 0) {
+                MutexLockGuard lock(mutex_);
+                spaceCond_.notifyAll();
+            }
         }
 
-        if (!newBuffer2) {
-            assert(!buffersToWrite.empty());
-            newBuffer2 = std::move(buffersToWrite.back());
-            buffersToWrite.pop_back();
-            newBuffer2->reset();
+        {
+            MutexLockGuard lock(registryMutex_);
+            threadBuffers_.erase(
+                std::remove_if(threadBuffers_.begin(), threadBuffers_.end(),
+                               [](const std::shared_ptr<ThreadBuffer>& tb) {
+                                   return tb->retired && tb->inFlight == 0;
+                               }),
+                threadBuffers_.end());
         }
 
-        buffersToWrite.clear();
-        output.flush();
+        if (stopping) {
+            break;
+        }
     }
-    output.flush();
 }
 
 void AsyncLogging::start() {
@@ -97,6 +406,10 @@ void AsyncLogging::start() {
 
 void AsyncLogging::stop() {
     running_ = false;
-    cond_.notify();
+    {
+        MutexLockGuard lock(mutex_);
+        cond_.notify();
+        spaceCond_.notifyAll();
+    }
     thread_.join();
 }
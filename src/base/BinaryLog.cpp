@@ -0,0 +1,371 @@
+#include "BinaryLog.h"
+#include "Mutex.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <atomic>
+
+namespace binlog {
+
+namespace {
+
+// 注册表只追加，按固定大小的块分配，块的地址写在固定长度的目录里，之后不再移动。
+// 注册方在锁内写好格式点和块指针后release发布count，查找方acquire读到count之后
+// 不加锁访问，不会读到正在被修改的容器结构
+struct Registry {
+    static const uint32_t kChunkSize = 256;
+    static const uint32_t kMaxChunks = kMaxSites / kChunkSize;
+
+    MutexLock mutex;
+    std::atomic<Site*> chunks[kMaxChunks] = {};
+    std::atomic<uint32_t> count{0};
+};
+
+Registry& registry() {
+    static Registry* r = new Registry;   // 不析构，退出阶段的日志仍然可以查找
+    return *r;
+}
+
+std::function<void(const char*, int)> g_output;
+
+// 按printf格式追加，短结果直接写在栈上
+void appendf(std::string* out, const char* spec, ...) __attribute__((format(printf, 2, 3)));
+
+void appendf(std::string* out, const char* spec, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, spec);
+    int n = vsnprintf(buf, sizeof buf, spec, args);
+    va_end(args);
+    if (n < 0) {
+        return;
+    }
+    if (static_cast<size_t>(n) < sizeof buf) {
+        out->append(buf, n);
+        return;
+    }
+    size_t old = out->size();
+    out->resize(old + n + 1);
+    va_start(args, spec);
+    vsnprintf(&(*out)[old], n + 1, spec, args);
+    va_end(args);
+    out->resize(old + n);
+}
+
+// 从记录中按类型码读参数，越界时返回false
+class ArgReader {
+public:
+    ArgReader(const char* data, size_t len) : cur_(data), end_(data + len) {}
+
+    template <typename T>
+    bool read(T* value) {
+        if (static_cast<size_t>(end_ - cur_) < sizeof(T)) {
+            return false;
+        }
+        memcpy(value, cur_, sizeof(T));
+        cur_ += sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    bool readAs(int64_t* value) {
+        T v;
+        if (!read(&v)) {
+            return false;
+        }
+        *value = static_cast<int64_t>(v);
+        return true;
+    }
+
+    bool readString(const char** data, size_t* len) {
+        uint16_t n;
+        if (!read(&n) || static_cast<size_t>(end_ - cur_) < n) {
+            return false;
+        }
+        *data = cur_;
+        *len = n;
+        cur_ += n;
+        return true;
+    }
+
+    // 读一个整数参数，按类型码做符号扩展或零扩展
+    bool readInteger(char code, int64_t* value, int* width, bool* isSigned) {
+        *isSigned = code == 'b' || code == 'h' || code == 'i' || code == 'l' || code == 'c';
+        switch (code) {
+        case 'b': case 'c': *width = 1; return readAs<int8_t>(value);
+        case 'h': *width = 2; return readAs<int16_t>(value);
+        case 'i': *width = 4; return readAs<int32_t>(value);
+        case 'l': *width = 8; return readAs<int64_t>(value);
+        case 'B': *width = 1; return readAs<uint8_t>(value);
+        case 'H': *width = 2; return readAs<uint16_t>(value);
+        case 'I': *width = 4; return readAs<uint32_t>(value);
+        case 'L': *width = 8; return readAs<uint64_t>(value);
+        default: return false;
+        }
+    }
+
+private:
+    const char* cur_;
+    const char* end_;
+};
+
+uint64_t truncateTo(int64_t value, int width) {
+    return width == 8 ? static_cast<uint64_t>(value) : static_cast<uint64_t>(value) & ((1ULL << (width * 8)) - 1);
+}
+
+// 格式化一个转换说明，spec是去掉长度修饰符的"%[标志][宽度][.精度]"，conv是转换字符
+bool formatArg(ArgReader& reader, char code, const std::string& spec, bool hasPrecision, int precision,
+               char conv, std::string* out) {
+    std::string f = spec;
+    if (code == 's') {
+        const char* data;
+        size_t len;
+        if (!reader.readString(&data, &len)) {
+            return false;
+        }
+        if (hasPrecision && static_cast<size_t>(precision) < len) {
+            len = precision;
+        }
+        // 精度已经并入长度，去掉原来的".精度"
+        size_t dot = f.find('.');
+        if (dot != std::string::npos) {
+            f.resize(dot);
+        }
+        f += ".*s";
+        appendf(out, f.c_str(), static_cast<int>(len), data);
+    } else if (code == 'd') {
+        double v;
+        if (!reader.read(&v)) {
+            return false;
+        }
+        f += strchr("fFeEgGaA", conv) != nullptr ? conv : 'g';
+        appendf(out, f.c_str(), v);
+    } else if (code == 'p') {
+        uint64_t v;
+        if (!reader.read(&v)) {
+            return false;
+        }
+        f += 'p';
+        appendf(out, f.c_str(), reinterpret_cast<void*>(static_cast<uintptr_t>(v)));
+    } else {
+        int64_t v;
+        int width;
+        bool isSigned;
+        if (!reader.readInteger(code, &v, &width, &isSigned)) {
+            return false;
+        }
+        if (conv == 'c') {
+            f += 'c';
+            appendf(out, f.c_str(), static_cast<int>(v));
+        } else if (strchr("uxXo", conv) != nullptr) {
+            f += "ll";
+            f += conv;
+            appendf(out, f.c_str(), static_cast<unsigned long long>(truncateTo(v, width)));
+        } else if (isSigned || code != 'L') {
+            f += "lld";
+            appendf(out, f.c_str(), static_cast<long long>(v));
+        } else {
+            f += "llu";
+            appendf(out, f.c_str(), static_cast<unsigned long long>(v));
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+uint32_t registerSite(const Site& site) {
+    Registry& r = registry();
+    MutexLockGuard lock(r.mutex);
+    uint32_t index = r.count.load(std::memory_order_relaxed);
+    if (index >= kMaxSites) {
+        return kSiteDefinition;
+    }
+    std::atomic<Site*>& chunk = r.chunks[index / Registry::kChunkSize];
+    if (chunk.load(std::memory_order_relaxed) == nullptr) {
+        chunk.store(new Site[Registry::kChunkSize], std::memory_order_relaxed);
+    }
+    chunk.load(std::memory_order_relaxed)[index % Registry::kChunkSize] = site;
+    r.count.store(index + 1, std::memory_order_release);
+    return index + 1;
+}
+
+const Site* findSite(uint32_t id) {
+    Registry& r = registry();
+    if (id == kSiteDefinition || id > r.count.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    uint32_t index = id - 1;
+    return &r.chunks[index / Registry::kChunkSize].load(std::memory_order_relaxed)[index % Registry::kChunkSize];
+}
+
+uint32_t siteCount() {
+    return registry().count.load(std::memory_order_acquire);
+}
+
+void setOutput(std::function<void(const char*, int)> output) {
+    g_output = output;
+}
+
+void output(const char* record, int len) {
+    if (g_output) {
+        g_output(record, len);
+        return;
+    }
+    RecordHeader header;
+    memcpy(&header, record, sizeof header);
+    const Site* site = findSite(header.siteId);
+    if (site != nullptr) {
+        std::string text;
+        formatRecord(*site, record, len, &text);
+        Logger::output()(text.data(), static_cast<int>(text.size()));
+    }
+}
+
+void formatRecord(const Site& site, const char* record, size_t len, std::string* out) {
+    RecordHeader header;
+    memcpy(&header, record, sizeof header);
+    char prefix[Logger::kMaxPrefixSize];
+    out->append(prefix, Logger::formatPrefix(prefix, site.level, Timestamp(header.micros)));
+
+    ArgReader reader(record + sizeof header, len - sizeof header);
+    const char* argType = site.argTypes;
+    const char* p = site.format;
+    while (*p != '\0') {
+        const char* percent = strchr(p, '%');
+        if (percent == nullptr) {
+            out->append(p);
+            break;
+        }
+        out->append(p, percent - p);
+        p = percent + 1;
+        if (*p == '%') {
+            out->push_back('%');
+            ++p;
+            continue;
+        }
+
+        // %[标志][宽度][.精度][长度修饰符]转换字符，长度修饰符由参数类型决定，丢弃原来的
+        std::string spec("%");
+        while (*p != '\0' && strchr("-+ #0", *p) != nullptr) {
+            spec.push_back(*p++);
+        }
+        while (*p >= '0' && *p <= '9') {
+            spec.push_back(*p++);
+        }
+        bool hasPrecision = false;
+        int precision = 0;
+        if (*p == '.') {
+            hasPrecision = true;
+            spec.push_back(*p++);
+            while (*p >= '0' && *p <= '9') {
+                precision = precision * 10 + (*p - '0');
+                spec.push_back(*p++);
+            }
+        }
+        while (*p != '\0' && strchr("hlLqjzt", *p) != nullptr) {
+            ++p;
+        }
+        char conv = *p;
+        if (conv != '\0') {
+            ++p;
+        }
+        if (*argType == '\0' || !formatArg(reader, *argType, spec, hasPrecision, precision, conv, out)) {
+            out->append("<bad argument>");
+            break;
+        }
+        ++argType;
+    }
+    out->push_back('\n');
+}
+
+size_t encodeDefinitionHead(uint32_t id, const Site& site, char* buf) {
+    // 定义记录：ID、级别、行号，后面是以'\0'结尾的格式串、文件名和参数类型
+    size_t stringsLen = strlen(site.format) + strlen(site.file) + strlen(site.argTypes) + 3;
+    RecordHeader header = {kSiteDefinition, static_cast<uint32_t>(kDefinitionHeadSize + stringsLen), 0};
+    int32_t level = site.level;
+    int32_t line = site.line;
+    memcpy(buf, &header, sizeof header);
+    memcpy(buf + sizeof header, &id, 4);
+    memcpy(buf + sizeof header + 4, &level, 4);
+    memcpy(buf + sizeof header + 8, &line, 4);
+    return kDefinitionHeadSize;
+}
+
+void encodeDefinitions(uint32_t firstId, uint32_t lastId, std::string* out) {
+    for (uint32_t id = firstId; id <= lastId; ++id) {
+        const Site* site = findSite(id);
+        if (site == nullptr) {
+            continue;
+        }
+        char head[kDefinitionHeadSize];
+        out->append(head, encodeDefinitionHead(id, *site, head));
+        out->append(site->format, strlen(site->format) + 1);
+        out->append(site->file, strlen(site->file) + 1);
+        out->append(site->argTypes, strlen(site->argTypes) + 1);
+    }
+}
+
+const Site* Decoder::lookup(uint32_t id) const {
+    auto it = sites_.find(id);
+    if (it != sites_.end()) {
+        return &it->second.site;
+    }
+    return useRegistry_ ? findSite(id) : nullptr;
+}
+
+void Decoder::define(const char* body, size_t len) {
+    if (len < 12) {
+        return;
+    }
+    uint32_t id;
+    int32_t level;
+    int32_t line;
+    memcpy(&id, body, 4);
+    memcpy(&level, body + 4, 4);
+    memcpy(&line, body + 8, 4);
+    const char* strings[3];
+    const char* cur = body + 12;
+    const char* end = body + len;
+    for (const char*& s : strings) {
+        const char* nul = static_cast<const char*>(memchr(cur, '\0', end - cur));
+        if (nul == nullptr) {
+            return;
+        }
+        s = cur;
+        cur = nul + 1;
+    }
+
+    OwnedSite& owned = sites_[id];
+    owned.format = strings[0];
+    owned.file = strings[1];
+    owned.argTypes = strings[2];
+    owned.site = Site{owned.format.c_str(), owned.file.c_str(), line, level, owned.argTypes.c_str()};
+}
+
+size_t Decoder::decode(const char* data, size_t len, std::string* out) {
+    size_t pos = 0;
+    while (len - pos >= sizeof(RecordHeader)) {
+        RecordHeader header;
+        memcpy(&header, data + pos, sizeof header);
+        if (header.length < sizeof header) {
+            // 记录头损坏，之后的内容无法再对齐
+            out->append("<corrupt binary log>\n");
+            return len;
+        }
+        if (len - pos < header.length) {
+            break;
+        }
+        const char* record = data + pos;
+        if (header.siteId == kSiteDefinition) {
+            define(record + sizeof header, header.length - sizeof header);
+        } else if (const Site* site = lookup(header.siteId)) {
+            formatRecord(*site, record, header.length, out);
+        } else {
+            appendf(out, "<unknown binary log site %u>\n", header.siteId);
+        }
+        pos += header.length;
+    }
+    return pos;
+}
+
+} // namespace binlog
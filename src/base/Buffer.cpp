@@ -4,6 +4,7 @@
 #include <unistd.h>
 
 const char Buffer::kCRLF[] = "\r\n";
+const size_t Buffer::kMaxVarintBytes;
 
 ssize_t Buffer::readFd(int fd, int* savedErrno)
 {
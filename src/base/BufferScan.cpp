@@ -0,0 +1,436 @@
+#include "BufferScan.h"
+#include <cstring>
+#include <cstdint>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define RE_MUDUO_SCAN_X86 1
+#endif
+
+namespace scan
+{
+namespace
+{
+
+using FindByteFunc = const char* (*)(const char*, const char*, char);
+using FindCRLFFunc = const char* (*)(const char*, const char*);
+using FindAnyOfFunc = const char* (*)(const char*, const char*, const char*, size_t);
+using XorMaskFunc = void (*)(char*, size_t, uint32_t);
+
+struct ScanOps
+{
+    Implementation impl;
+    FindByteFunc findByte;
+    FindCRLFFunc findCRLF;
+    FindAnyOfFunc findAnyOf;
+    XorMaskFunc xorMask;
+};
+
+// ---------------- 标量实现 ----------------
+
+// key按内存顺序排列的4字节密钥，data[0]对应key的第0字节；每次处理8字节
+void scalarXorMask(char* data, size_t len, uint32_t key)
+{
+    uint64_t key64 = (static_cast<uint64_t>(key) << 32) | key;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+        uint64_t v;
+        ::memcpy(&v, data + i, 8);
+        v ^= key64;
+        ::memcpy(data + i, &v, 8);
+    }
+    const unsigned char* k = reinterpret_cast<const unsigned char*>(&key);
+    for (; i < len; ++i)
+    {
+        data[i] = static_cast<char>(data[i] ^ k[i & 3]);
+    }
+}
+
+// 单字节查找交给libc的memchr，它在各平台上都有优化实现
+const char* scalarFindByte(const char* begin, const char* end, char c)
+{
+    return static_cast<const char*>(::memchr(begin, c, static_cast<size_t>(end - begin)));
+}
+
+const char* scalarFindCRLF(const char* begin, const char* end)
+{
+    const char* p = begin;
+    while (p + 1 < end)
+    {
+        p = static_cast<const char*>(::memchr(p, '\r', static_cast<size_t>(end - p - 1)));
+        if (p == nullptr)
+        {
+            return nullptr;
+        }
+        if (p[1] == '\n')
+        {
+            return p;
+        }
+        ++p;
+    }
+    return nullptr;
+}
+
+const char* scalarFindAnyOf(const char* begin, const char* end, const char* set, size_t setSize)
+{
+    if (setSize <= 4)
+    {
+        // 集合很小时逐个比较，省掉建表
+        for (const char* p = begin; p < end; ++p)
+        {
+            for (size_t i = 0; i < setSize; ++i)
+            {
+                if (*p == set[i])
+                {
+                    return p;
+                }
+            }
+        }
+        return nullptr;
+    }
+    bool table[256] = {false};
+    for (size_t i = 0; i < setSize; ++i)
+    {
+        table[static_cast<unsigned char>(set[i])] = true;
+    }
+    for (const char* p = begin; p < end; ++p)
+    {
+        if (table[static_cast<unsigned char>(*p)])
+        {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+#ifdef RE_MUDUO_SCAN_X86
+
+// ---------------- SSE2，x86-64上总是可用 ----------------
+
+// 单字节查找只在第一个块内自己比较：命中距离短时省掉一次库函数调用；
+// 更长的距离交给memchr，glibc已经按CPU选择了展开的向量实现，比这里的简单循环更快
+const char* sse2FindByte(const char* begin, const char* end, char c)
+{
+    if (end - begin >= 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+        if (mask != 0)
+        {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+    return scalarFindByte(begin, end, c);
+}
+
+const char* sse2FindCRLF(const char* begin, const char* end)
+{
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const char* p = begin;
+    // 同时比较p处的'\r'和p+1处的'\n'，两个掩码相与即得"\r\n"的起点
+    for (; p + 17 <= end; p += 16)
+    {
+        __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+        int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(v0, cr), _mm_cmpeq_epi8(v1, lf)));
+        if (mask != 0)
+        {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return scalarFindCRLF(p, end);
+}
+
+const char* sse2FindAnyOf(const char* begin, const char* end, const char* set, size_t setSize)
+{
+    if (setSize == 0 || setSize > kMaxVectorSet)
+    {
+        return scalarFindAnyOf(begin, end, set, setSize);
+    }
+    __m128i needles[kMaxVectorSet];
+    for (size_t i = 0; i < setSize; ++i)
+    {
+        needles[i] = _mm_set1_epi8(set[i]);
+    }
+    const char* p = begin;
+    for (; p + 16 <= end; p += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hit = _mm_cmpeq_epi8(v, needles[0]);
+        for (size_t i = 1; i < setSize; ++i)
+        {
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, needles[i]));
+        }
+        int mask = _mm_movemask_epi8(hit);
+        if (mask != 0)
+        {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return scalarFindAnyOf(p, end, set, setSize);
+}
+
+// ---------------- AVX2，运行时检测到才使用 ----------------
+
+__attribute__((target("avx2")))
+const char* avx2FindByte(const char* begin, const char* end, char c)
+{
+    if (end - begin >= 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))));
+        if (mask != 0)
+        {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 32;
+    }
+    return scalarFindByte(begin, end, c);
+}
+
+__attribute__((target("avx2")))
+const char* avx2FindCRLF(const char* begin, const char* end)
+{
+    // 文本协议中分隔符往往就在开头不远处，先用一个16字节块试探，避免短行也付出整轮64字节的代价
+    if (end - begin >= 17)
+    {
+        __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin + 1));
+        int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(v0, _mm_set1_epi8('\r')),
+                                                   _mm_cmpeq_epi8(v1, _mm_set1_epi8('\n'))));
+        if (mask != 0)
+        {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const char* p = begin;
+    // 每轮处理64字节，两个块的掩码合并后只判断一次
+    for (; p + 65 <= end; p += 64)
+    {
+        __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+        __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+        __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 33));
+        __m256i hitA = _mm256_and_si256(_mm256_cmpeq_epi8(a0, cr), _mm256_cmpeq_epi8(a1, lf));
+        __m256i hitB = _mm256_and_si256(_mm256_cmpeq_epi8(b0, cr), _mm256_cmpeq_epi8(b1, lf));
+        if (!_mm256_testz_si256(_mm256_or_si256(hitA, hitB), _mm256_or_si256(hitA, hitB)))
+        {
+            uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hitA))
+                            | (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(hitB))) << 32);
+            return p + __builtin_ctzll(mask);
+        }
+    }
+    for (; p + 33 <= end; p += 32)
+    {
+        __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(v0, cr), _mm256_cmpeq_epi8(v1, lf))));
+        if (mask != 0)
+        {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return sse2FindCRLF(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* avx2FindAnyOf(const char* begin, const char* end, const char* set, size_t setSize)
+{
+    if (setSize == 0 || setSize > kMaxVectorSet)
+    {
+        return scalarFindAnyOf(begin, end, set, setSize);
+    }
+    __m256i needles[kMaxVectorSet];
+    for (size_t i = 0; i < setSize; ++i)
+    {
+        needles[i] = _mm256_set1_epi8(set[i]);
+    }
+    const char* p = begin;
+    for (; p + 32 <= end; p += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hit = _mm256_cmpeq_epi8(v, needles[0]);
+        for (size_t i = 1; i < setSize; ++i)
+        {
+            hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, needles[i]));
+        }
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+        if (mask != 0)
+        {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return sse2FindAnyOf(p, end, set, setSize);
+}
+
+void sse2XorMask(char* data, size_t len, uint32_t key)
+{
+    const __m128i k = _mm_set1_epi32(static_cast<int>(key));
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64)
+    {
+        __m128i* p = reinterpret_cast<__m128i*>(data + i);
+        __m128i v0 = _mm_loadu_si128(p);
+        __m128i v1 = _mm_loadu_si128(p + 1);
+        __m128i v2 = _mm_loadu_si128(p + 2);
+        __m128i v3 = _mm_loadu_si128(p + 3);
+        _mm_storeu_si128(p, _mm_xor_si128(v0, k));
+        _mm_storeu_si128(p + 1, _mm_xor_si128(v1, k));
+        _mm_storeu_si128(p + 2, _mm_xor_si128(v2, k));
+        _mm_storeu_si128(p + 3, _mm_xor_si128(v3, k));
+    }
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i* p = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), k));
+    }
+    // 16的倍数不改变密钥相位
+    scalarXorMask(data + i, len - i, key);
+}
+
+__attribute__((target("avx2")))
+void avx2XorMask(char* data, size_t len, uint32_t key)
+{
+    const __m256i k = _mm256_set1_epi32(static_cast<int>(key));
+    size_t i = 0;
+    for (; i + 128 <= len; i += 128)
+    {
+        __m256i* p = reinterpret_cast<__m256i*>(data + i);
+        __m256i v0 = _mm256_loadu_si256(p);
+        __m256i v1 = _mm256_loadu_si256(p + 1);
+        __m256i v2 = _mm256_loadu_si256(p + 2);
+        __m256i v3 = _mm256_loadu_si256(p + 3);
+        _mm256_storeu_si256(p, _mm256_xor_si256(v0, k));
+        _mm256_storeu_si256(p + 1, _mm256_xor_si256(v1, k));
+        _mm256_storeu_si256(p + 2, _mm256_xor_si256(v2, k));
+        _mm256_storeu_si256(p + 3, _mm256_xor_si256(v3, k));
+    }
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i* p = reinterpret_cast<__m256i*>(data + i);
+        _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), k));
+    }
+    sse2XorMask(data + i, len - i, key);
+}
+
+#endif // RE_MUDUO_SCAN_X86
+
+bool supported(Implementation impl)
+{
+    switch (impl)
+    {
+    case kScalar:
+        return true;
+#ifdef RE_MUDUO_SCAN_X86
+    case kSse2:
+        return true;
+    case kAvx2:
+        return __builtin_cpu_supports("avx2");
+#else
+    default:
+        return false;
+#endif
+    }
+    return false;
+}
+
+ScanOps makeOps(Implementation impl)
+{
+    switch (impl)
+    {
+#ifdef RE_MUDUO_SCAN_X86
+    case kAvx2:
+        return ScanOps{kAvx2, avx2FindByte, avx2FindCRLF, avx2FindAnyOf, avx2XorMask};
+    case kSse2:
+        return ScanOps{kSse2, sse2FindByte, sse2FindCRLF, sse2FindAnyOf, sse2XorMask};
+#endif
+    default:
+        return ScanOps{kScalar, scalarFindByte, scalarFindCRLF, scalarFindAnyOf, scalarXorMask};
+    }
+}
+
+ScanOps detect()
+{
+    if (supported(kAvx2))
+    {
+        return makeOps(kAvx2);
+    }
+    if (supported(kSse2))
+    {
+        return makeOps(kSse2);
+    }
+    return makeOps(kScalar);
+}
+
+ScanOps& ops()
+{
+    static ScanOps instance = detect();
+    return instance;
+}
+
+} // namespace
+
+const char* findByte(const char* begin, const char* end, char c)
+{
+    return begin < end ? ops().findByte(begin, end, c) : nullptr;
+}
+
+const char* findCRLF(const char* begin, const char* end)
+{
+    return begin < end ? ops().findCRLF(begin, end) : nullptr;
+}
+
+const char* findAnyOf(const char* begin, const char* end, const char* set, size_t setSize)
+{
+    return begin < end ? ops().findAnyOf(begin, end, set, setSize) : nullptr;
+}
+
+void xorMask(char* data, size_t len, const unsigned char key[4], size_t keyOffset)
+{
+    // 把密钥旋转到data[0]的相位，之后各实现都从第0字节开始对齐
+    unsigned char rotated[4];
+    for (size_t i = 0; i < 4; ++i)
+    {
+        rotated[i] = key[(keyOffset + i) & 3];
+    }
+    uint32_t k;
+    ::memcpy(&k, rotated, 4);
+    ops().xorMask(data, len, k);
+}
+
+Implementation implementation()
+{
+    return ops().impl;
+}
+
+const char* implementationName(Implementation impl)
+{
+    switch (impl)
+    {
+    case kScalar:
+        return "scalar";
+    case kSse2:
+        return "sse2";
+    case kAvx2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+bool setImplementation(Implementation impl)
+{
+    if (!supported(impl))
+    {
+        return false;
+    }
+    ops() = makeOps(impl);
+    return true;
+}
+
+} // namespace scan
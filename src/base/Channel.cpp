@@ -1,6 +1,7 @@
 #include "Channel.h"
 #include "Eventloop.h"
 #include "Logger.h"
+#include "BinaryLog.h"
 #include <sys/epoll.h>
 #include <iostream>
 
@@ -63,7 +64,7 @@ void Channel::handleEvent(Timestamp receiveTime) {
 void Channel::handleEventWithGuard(Timestamp receiveTime) {
     // 处理挂起事件（对端关闭连接）
     if ((Revents & EPOLLHUP) && !(Revents & EPOLLIN)) {
-        LOG_DEBUG("Channel %d EPOLLHUP event", Fd);
+        BLOG_DEBUG("Channel %d EPOLLHUP event", Fd);
         if (CloseCallback) {
             CloseCallback();
         }
@@ -71,7 +72,7 @@ void Channel::handleEventWithGuard(Timestamp receiveTime) {
 
     // 处理错误事件
     if (Revents & EPOLLERR) {
-        LOG_ERROR("Channel %d EPOLLERR event", Fd);
+        LOG_EVERY_MS(ERROR, 1000, "Channel %d EPOLLERR event", Fd);
         if (ErrorCallback) {
             ErrorCallback();
         }
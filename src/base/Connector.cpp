@@ -0,0 +1,222 @@
+#include "Connector.h"
+#include "Channel.h"
+#include "Eventloop.h"
+#include "Socket.h"
+#include "Logger.h"
+#include <algorithm>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <cassert>
+
+Connector::Connector(EventLoop *loop, const InetAddress &serverAddr)
+    : loop_(loop),
+      serverAddr_(serverAddr),
+      connect_(false),
+      state_(kDisconnected),
+      initRetryDelayMs_(kInitRetryDelayMs),
+      maxRetryDelayMs_(kMaxRetryDelayMs),
+      retryDelayMs_(kInitRetryDelayMs),
+      retries_(0)
+{
+    LOG_DEBUG("Connector ctor[%p]", this);
+}
+
+Connector::~Connector()
+{
+    LOG_DEBUG("Connector dtor[%p]", this);
+    assert(!channel_);
+}
+
+void Connector::start()
+{
+    connect_ = true;
+    loop_->runInLoop(std::bind(&Connector::startInLoop, shared_from_this()));
+}
+
+void Connector::startInLoop()
+{
+    loop_->assertInLoopThread();
+    assert(state_ == kDisconnected);
+    if (connect_)
+    {
+        connect();
+    }
+    else
+    {
+        LOG_DEBUG("Connector::startInLoop do not connect");
+    }
+}
+
+void Connector::stop()
+{
+    connect_ = false;
+    loop_->queueInLoop(std::bind(&Connector::stopInLoop, shared_from_this()));
+}
+
+void Connector::stopInLoop()
+{
+    loop_->assertInLoopThread();
+    if (retryTimerId_.isValid())
+    {
+        loop_->cancel(retryTimerId_);
+        retryTimerId_ = TimerId();
+    }
+    if (state_ == kConnecting)
+    {
+        setState(kDisconnected);
+        int sockfd = removeAndResetChannel();
+        retry(sockfd);
+    }
+}
+
+void Connector::connect()
+{
+    sa_family_t family = serverAddr_.family();
+    int protocol = (family == AF_UNIX) ? 0 : IPPROTO_TCP;
+    int sockfd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol);
+    if (sockfd < 0)
+    {
+        // fd耗尽等情况是暂时的，和连接失败一样按退避重试
+        LOG_ERROR("Connector::connect socket create err:%d", errno);
+        retry(-1);
+        return;
+    }
+    int ret = ::connect(sockfd, serverAddr_.getGenericSockAddr(), serverAddr_.getSockAddrLen());
+    int savedErrno = (ret == 0) ? 0 : errno;
+    switch (savedErrno)
+    {
+    case 0:
+    case EINPROGRESS:
+    case EINTR:
+    case EISCONN:
+        connecting(sockfd);
+        break;
+
+    case EAGAIN:
+    case ENOENT:        // Unix域socket文件尚未创建
+    case EADDRINUSE:
+    case EADDRNOTAVAIL:
+    case ECONNREFUSED:
+    case ENETUNREACH:
+        retry(sockfd);
+        break;
+
+    default:
+        LOG_ERROR("Connector::connect error %d to %s", savedErrno, serverAddr_.toIpPort().c_str());
+        ::close(sockfd);
+        break;
+    }
+}
+
+void Connector::restart()
+{
+    loop_->assertInLoopThread();
+    setState(kDisconnected);
+    retryDelayMs_ = initRetryDelayMs_;
+    retries_ = 0;
+    connect_ = true;
+    startInLoop();
+}
+
+void Connector::connecting(int sockfd)
+{
+    setState(kConnecting);
+    assert(!channel_);
+    channel_.reset(new Channel(loop_, sockfd));
+    channel_->setWriteCallback(std::bind(&Connector::handleWrite, this));
+    channel_->setErrorCallback(std::bind(&Connector::handleError, this));
+    // 连接完成时socket变为可写
+    channel_->enableWriting();
+}
+
+int Connector::removeAndResetChannel()
+{
+    channel_->disableAll();
+    int sockfd = channel_->fd();
+    // 当前可能正在处理该channel的事件，不能在这里析构它
+    loop_->queueInLoop(std::bind(&Connector::resetChannel, shared_from_this()));
+    return sockfd;
+}
+
+void Connector::resetChannel()
+{
+    if (channel_)
+    {
+        channel_->remove();
+        channel_.reset();
+    }
+}
+
+void Connector::handleWrite()
+{
+    LOG_DEBUG("Connector::handleWrite state=%d", state_);
+    if (state_ == kConnecting)
+    {
+        int sockfd = removeAndResetChannel();
+        int err = Socket::getSocketError(sockfd);
+        if (err)
+        {
+            LOG_ERROR("Connector::handleWrite SO_ERROR=%d to %s", err, serverAddr_.toIpPort().c_str());
+            retry(sockfd);
+        }
+        else if (Socket::isSelfConnect(sockfd))
+        {
+            LOG_ERROR("Connector::handleWrite self connect to %s", serverAddr_.toIpPort().c_str());
+            retry(sockfd);
+        }
+        else
+        {
+            setState(kConnected);
+            retryDelayMs_ = initRetryDelayMs_;
+            retries_ = 0;
+            if (connect_ && newConnectionCallback_)
+            {
+                newConnectionCallback_(sockfd);
+            }
+            else
+            {
+                ::close(sockfd);
+            }
+        }
+    }
+    else
+    {
+        assert(state_ == kDisconnected);
+    }
+}
+
+void Connector::handleError()
+{
+    LOG_ERROR("Connector::handleError state=%d", state_);
+    if (state_ == kConnecting)
+    {
+        int sockfd = removeAndResetChannel();
+        int err = Socket::getSocketError(sockfd);
+        LOG_DEBUG("Connector::handleError SO_ERROR=%d", err);
+        (void)err;
+        retry(sockfd);
+    }
+}
+
+void Connector::retry(int sockfd)
+{
+    if (sockfd >= 0)
+    {
+        ::close(sockfd);
+    }
+    setState(kDisconnected);
+    if (connect_)
+    {
+        LOG_INFO("Connector::retry connecting to %s in %d milliseconds",
+                 serverAddr_.toIpPort().c_str(), retryDelayMs_);
+        ++retries_;
+        retryTimerId_ = loop_->runAfter(retryDelayMs_ / 1000.0,
+                                        std::bind(&Connector::startInLoop, shared_from_this()));
+        retryDelayMs_ = std::min(retryDelayMs_ * 2, maxRetryDelayMs_);
+    }
+    else
+    {
+        LOG_DEBUG("Connector::retry do not connect");
+    }
+}
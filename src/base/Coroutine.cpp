@@ -0,0 +1,279 @@
+#include "Coroutine.h"
+
+#ifdef RE_MUDUO_COROUTINES
+
+#include "Eventloop.h"
+#include "TcpConnection.h"
+#include "Buffer.h"
+#include "Logger.h"
+#include <sys/uio.h>
+
+namespace co
+{
+
+FrameAllocator& FrameAllocator::current()
+{
+    static thread_local FrameAllocator t_allocator;
+    return t_allocator;
+}
+
+FrameAllocator::~FrameAllocator()
+{
+    for (size_t i = 0; i < kClasses; ++i)
+    {
+        FreeBlock* block = freeLists_[i];
+        while (block != nullptr)
+        {
+            FreeBlock* next = block->next;
+            ::operator delete(block);
+            block = next;
+        }
+    }
+}
+
+void* FrameAllocator::allocate(size_t size)
+{
+    if (size == 0 || size > kMaxBlockSize)
+    {
+        ++allocated_;
+        return ::operator new(size);
+    }
+    size_t index = (size - 1) / kGranularity;
+    FreeBlock* block = freeLists_[index];
+    if (block != nullptr)
+    {
+        freeLists_[index] = block->next;
+        --cached_[index];
+        ++reused_;
+        return block;
+    }
+    ++allocated_;
+    // 按级别的上限分配，释放后可以给同一级别的任何帧复用
+    return ::operator new((index + 1) * kGranularity);
+}
+
+void FrameAllocator::deallocate(void* p, size_t size)
+{
+    if (size == 0 || size > kMaxBlockSize)
+    {
+        ::operator delete(p);
+        return;
+    }
+    size_t index = (size - 1) / kGranularity;
+    if (cached_[index] >= kMaxCachedPerClass)
+    {
+        ::operator delete(p);
+        return;
+    }
+    FreeBlock* block = static_cast<FreeBlock*>(p);
+    block->next = freeLists_[index];
+    freeLists_[index] = block;
+    ++cached_[index];
+}
+
+void PromiseBase::finishDetached()
+{
+    if (!exception)
+    {
+        return;
+    }
+    try
+    {
+        std::rethrow_exception(exception);
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("co::spawn - coroutine exited with exception: %s", e.what());
+    }
+    catch (...)
+    {
+        LOG_ERROR("co::spawn - coroutine exited with unknown exception");
+    }
+}
+
+void spawn(EventLoop* loop, Task<> task)
+{
+    std::coroutine_handle<Task<>::promise_type> h = task.release();
+    h.promise().detached = true;
+    loop->runInLoop([h]() { h.resume(); });
+}
+
+void SleepAwaitable::await_suspend(std::coroutine_handle<> h)
+{
+    loop_->runAfter(seconds_, [h]() { h.resume(); });
+}
+
+Stream::Stream(const TcpConnectionPtr& conn)
+    : conn_(conn),
+      state_(std::make_shared<State>())
+{
+    conn_->getLoop()->assertInLoopThread();
+    state_->input = conn_->inputBuffer();
+    state_->output = conn_->outputBuffer();
+    state_->closed = !conn_->connected();
+
+    std::shared_ptr<State> state = state_;
+    conn_->setMessageCallback([state](const TcpConnectionPtr&, Buffer*, Timestamp) { state->onMessage(); });
+    conn_->setWriteCompleteCallback([state](const TcpConnectionPtr&) { state->onWriteComplete(); });
+    conn_->setConnectionCallback([state](const TcpConnectionPtr& c) {
+        if (!c->connected())
+        {
+            state->onClose();
+        }
+    });
+    // 背压由send()按outputBuffer_的大小处理，不需要高水位回调
+    conn_->setHighWaterMarkCallback(HighWaterMarkCallback(), 0);
+}
+
+Stream::~Stream()
+{
+    // 交出最后一次读返回的数据，剩下的留给之后接管连接的代码
+    state_->input->retrieve(state_->pendingRetrieve);
+    state_->pendingRetrieve = 0;
+    state_->reader = nullptr;
+    state_->writer = nullptr;
+}
+
+Stream::ReadAwaitable Stream::read(size_t n)
+{
+    return ReadAwaitable(state_.get(), n, std::string_view());
+}
+
+Stream::ReadAwaitable Stream::readUntil(std::string_view delimiter)
+{
+    return ReadAwaitable(state_.get(), 0, delimiter);
+}
+
+Stream::SendAwaitable Stream::send(std::string_view data)
+{
+    return SendAwaitable(this, data);
+}
+
+void Stream::State::onMessage()
+{
+    if (reader != nullptr && reader->satisfied())
+    {
+        ReadAwaitable* r = reader;
+        reader = nullptr;
+        r->handle_.resume();
+    }
+}
+
+void Stream::State::onWriteComplete()
+{
+    // 写完成回调是排队执行的，之前一次send排入的回调可能在后来的数据发出之前到达
+    if (writer && output->readableBytes() < highWaterMark)
+    {
+        std::coroutine_handle<> w = std::exchange(writer, nullptr);
+        w.resume();
+    }
+}
+
+void Stream::State::onClose()
+{
+    closed = true;
+    // 读和写可能由两个协程分别挂起；恢复其中一个可能导致Stream析构，先取出两个句柄
+    ReadAwaitable* r = std::exchange(reader, nullptr);
+    std::coroutine_handle<> w = std::exchange(writer, nullptr);
+    if (r != nullptr)
+    {
+        r->satisfied();
+        r->handle_.resume();
+    }
+    if (w)
+    {
+        w.resume();
+    }
+}
+
+bool Stream::ReadAwaitable::satisfied()
+{
+    size_t readable = state_->input->readableBytes();
+    if (delimiter_.empty())
+    {
+        return readable >= n_;
+    }
+    std::string_view data(state_->input->peek(), readable);
+    found_ = data.find(delimiter_, scanFrom_);
+    if (found_ != std::string_view::npos)
+    {
+        return true;
+    }
+    // 只扫描新到达的数据，保留可能跨越两次到达的分隔符前缀
+    if (readable >= delimiter_.size())
+    {
+        scanFrom_ = readable - delimiter_.size() + 1;
+    }
+    return readable > state_->maxLineLength;
+}
+
+bool Stream::ReadAwaitable::await_ready()
+{
+    Buffer* input = state_->input;
+    input->retrieve(state_->pendingRetrieve);
+    state_->pendingRetrieve = 0;
+    return satisfied() || state_->closed;
+}
+
+void Stream::ReadAwaitable::await_suspend(std::coroutine_handle<> h)
+{
+    handle_ = h;
+    state_->reader = this;
+}
+
+std::optional<std::string_view> Stream::ReadAwaitable::await_resume()
+{
+    Buffer* input = state_->input;
+    if (delimiter_.empty())
+    {
+        if (input->readableBytes() < n_)
+        {
+            return std::nullopt;
+        }
+        state_->pendingRetrieve = n_;
+        return std::string_view(input->peek(), n_);
+    }
+    if (found_ == std::string_view::npos)
+    {
+        // 连接关闭或超过最大长度
+        return std::nullopt;
+    }
+    state_->pendingRetrieve = found_ + delimiter_.size();
+    return std::string_view(input->peek(), found_);
+}
+
+bool Stream::SendAwaitable::await_ready()
+{
+    State* state = stream_->state_.get();
+    if (state->closed)
+    {
+        return true;
+    }
+    if (!data_.empty())
+    {
+        struct iovec iov;
+        iov.iov_base = const_cast<char*>(data_.data());
+        iov.iov_len = data_.size();
+        stream_->conn_->sendv(&iov, 1);
+    }
+    return state->output->readableBytes() < state->highWaterMark;
+}
+
+void Stream::SendAwaitable::await_suspend(std::coroutine_handle<> h)
+{
+    stream_->state_->writer = h;
+}
+
+bool Stream::SendAwaitable::await_resume() const
+{
+    return !stream_->state_->closed;
+}
+
+} // namespace co
+
+co::SleepAwaitable EventLoop::sleep(double seconds)
+{
+    return co::SleepAwaitable(this, seconds);
+}
+
+#endif // RE_MUDUO_COROUTINES
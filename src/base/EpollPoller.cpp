@@ -1,8 +1,8 @@
-#define MUDEBUF
 #include "EpollPoller.h"
 #include "Eventloop.h"
 #include "Channel.h"
 #include "Logger.h"
+#include "BinaryLog.h"
 #include <errno.h>
 #include <string.h>
 #include <unistd.h>
@@ -38,19 +38,19 @@ Timestamp EpollPoller::poll(int timeoutMs, ChannelList* activeChannels)
 
     if (numEvents > 0)
     {
-        // LOG_INFO("%d events happened\n", numEvents);
+        BLOG_DEBUG("EpollPoller::poll() %d events happened", numEvents);
         fillActiveChannels(numEvents, activeChannels);
     }
     else if (numEvents == 0)
     {
-        // LOG_DEBUG("%s timeout\n", __FUNCTION__);
+        BLOG_DEBUG("EpollPoller::poll() timeout");
     }
     else
     {
         if (saveErrno != EINTR)
         {
             errno = saveErrno;
-            LOG_ERROR("EpollPoller::poll() failed");
+            LOG_EVERY_MS(ERROR, 1000, "EpollPoller::poll() failed, errno=%d", saveErrno);
         }
     }
 
@@ -103,7 +103,12 @@ void EpollPoller::removeChannel(Channel* channel)
     int fd = channel->fd();
     // LOG_INFO("func=%s fd=%d\n", __FUNCTION__, fd);
 
-    channels_.erase(fd);
+    // fd可能已被关闭并复用，只有映射仍指向本channel时才删除
+    auto it = channels_.find(fd);
+    if (it != channels_.end() && it->second == channel)
+    {
+        channels_.erase(it);
+    }
 
     int index = channel->index();
     if (index == kAdded)
@@ -1,19 +1,25 @@
 #include "EventLoopThread.h"
 #include "Eventloop.h"
+#include "Logger.h"
+#include <pthread.h>
+#include <sched.h>
 
 /**
  * 构造函数
  * @param cb 线程初始化回调函数
  * @param name 线程名称
+ * @param cpu 绑定的CPU编号
  */
 EventLoopThread::EventLoopThread(const ThreadInitCallback &cb,
-                                 const string &name)
+                                 const string &name,
+                                 int cpu)
     : loop_(nullptr),
       exiting_(false),
       thread(std::bind(&EventLoopThread::threadFunc, this), name),
       mutex_(),
       cond_(),
-      callback_(cb)
+      callback_(cb),
+      cpu_(cpu)
 {
 }
 
@@ -62,6 +68,19 @@ EventLoop* EventLoopThread::startLoop()
  */
 void EventLoopThread::threadFunc()
 {
+    // 在创建EventLoop之前绑定CPU，保证loop的内存在该CPU所在节点上分配
+    if (cpu_ >= 0)
+    {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu_, &cpuset);
+        int err = ::pthread_setaffinity_np(::pthread_self(), sizeof cpuset, &cpuset);
+        if (err != 0)
+        {
+            LOG_ERROR("EventLoopThread::threadFunc() pin to cpu %d failed, err=%d", cpu_, err);
+        }
+    }
+
     EventLoop loop;
 
     if (callback_)
@@ -1,13 +1,37 @@
 #include "EventLoopThreadPool.h"
 #include "EventLoopThread.h"
 #include <assert.h>
+#include <algorithm>
+#include <sched.h>
+
+// 返回当前进程允许运行的CPU编号列表（考虑taskset/cgroup限制）
+static vector<int> allowedCpus()
+{
+    vector<int> cpus;
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    if (::sched_getaffinity(0, sizeof cpuset, &cpuset) == 0)
+    {
+        for (int i = 0; i < CPU_SETSIZE; ++i)
+        {
+            if (CPU_ISSET(i, &cpuset))
+            {
+                cpus.push_back(i);
+            }
+        }
+    }
+    return cpus;
+}
 
 EventLoopThreadPool::EventLoopThreadPool(EventLoop *baseLoop, const string &nameArg)
     : baseLoop_(baseLoop),
       name_(nameArg),
       started_(false),
       numThreads_(0),
-      next_(0)
+      next_(0),
+      nextThreadId_(0),
+      pinLoops_(false),
+      alive_(std::make_shared<bool>(true))
 {
 }
 
@@ -21,14 +45,11 @@ void EventLoopThreadPool::start(const ThreadInitCallback &cb)
     assert(!started_);
     assert(baseLoop_->isInLoopThread());
     started_ = true;
+    initCallback_ = cb;
 
     for (int i = 0; i < numThreads_; ++i)
     {
-        char buf[name_.size() + 32];
-        snprintf(buf, sizeof buf, "%s%d", name_.c_str(), i);
-        EventLoopThread *t = new EventLoopThread(cb, string(buf));
-        threads_.emplace_back(t);
-        loops_.push_back(t->startLoop());
+        startThread(i);
     }
     if (numThreads_ == 0 && cb)
     {
@@ -37,6 +58,111 @@ void EventLoopThreadPool::start(const ThreadInitCallback &cb)
     }
 }
 
+EventLoop* EventLoopThreadPool::startThread(int index)
+{
+    if (pinLoops_ && cpus_.empty())
+    {
+        cpus_ = allowedCpus();
+    }
+
+    char buf[name_.size() + 32];
+    snprintf(buf, sizeof buf, "%s%d", name_.c_str(), nextThreadId_++);
+    int cpu = cpus_.empty() ? -1 : cpus_[index % cpus_.size()];
+    EventLoopThread *t = new EventLoopThread(initCallback_, string(buf), cpu);
+    threads_.emplace_back(t);
+    EventLoop *loop = t->startLoop();
+    loops_.push_back(loop);
+    if (cpu >= 0)
+    {
+        if (static_cast<size_t>(cpu) >= cpuLoops_.size())
+        {
+            cpuLoops_.resize(cpu + 1);
+            cpuNext_.resize(cpu + 1, 0);
+        }
+        cpuLoops_[cpu].push_back(loop);
+    }
+    return loop;
+}
+
+EventLoop* EventLoopThreadPool::addLoop()
+{
+    assert(baseLoop_->isInLoopThread());
+    assert(started_);
+    EventLoop *loop = startThread(static_cast<int>(loops_.size()));
+    numThreads_ = static_cast<int>(loops_.size());
+    return loop;
+}
+
+EventLoop* EventLoopThreadPool::retireLoop()
+{
+    assert(baseLoop_->isInLoopThread());
+    assert(started_);
+    if (loops_.empty())
+    {
+        return nullptr;
+    }
+
+    EventLoop *loop = loops_.back();
+    int cpu = threads_.back()->cpu();
+    retired_.push_back(std::move(threads_.back()));
+    threads_.pop_back();
+    loops_.pop_back();
+    numThreads_ = static_cast<int>(loops_.size());
+
+    if (static_cast<size_t>(next_) >= loops_.size())
+    {
+        next_ = 0;
+    }
+    if (cpu >= 0)
+    {
+        vector<EventLoop*> &onCpu = cpuLoops_[cpu];
+        onCpu.erase(std::remove(onCpu.begin(), onCpu.end(), loop), onCpu.end());
+        if (cpuNext_[cpu] >= onCpu.size())
+        {
+            cpuNext_[cpu] = 0;
+        }
+    }
+    return loop;
+}
+
+void EventLoopThreadPool::reapLoop(EventLoop *loop)
+{
+    assert(baseLoop_->isInLoopThread());
+    for (auto &thread : retired_)
+    {
+        if (thread->getLoop() == loop)
+        {
+            // 排在该loop此前的任务（如connectDestroyed）之后，执行到时再通知baseLoop回收线程，
+            // baseLoop不用等待；线程池先析构时由析构函数回收，通知被忽略
+            EventLoop *baseLoop = baseLoop_;
+            EventLoopThread *t = thread.get();
+            weak_ptr<bool> alive(alive_);
+            loop->queueInLoop([this, baseLoop, t, alive]() {
+                baseLoop->queueInLoop([this, t, alive]() {
+                    if (alive.lock())
+                    {
+                        removeRetired(t);
+                    }
+                });
+            });
+            return;
+        }
+    }
+}
+
+void EventLoopThreadPool::removeRetired(EventLoopThread *thread)
+{
+    assert(baseLoop_->isInLoopThread());
+    for (auto it = retired_.begin(); it != retired_.end(); ++it)
+    {
+        if (it->get() == thread)
+        {
+            retired_.erase(it);     // ~EventLoopThread 会quit并等待线程退出
+            return;
+        }
+    }
+}
+
 EventLoop* EventLoopThreadPool::getNextLoop()
 {
     assert(baseLoop_->isInLoopThread());
@@ -57,6 +183,25 @@ EventLoop* EventLoopThreadPool::getNextLoop()
     return loop;
 }
 
+EventLoop* EventLoopThreadPool::getLoopForCpu(int cpu)
+{
+    assert(baseLoop_->isInLoopThread());
+    assert(started_);
+    if (cpu < 0 || static_cast<size_t>(cpu) >= cpuLoops_.size() || cpuLoops_[cpu].empty())
+    {
+        return getNextLoop();
+    }
+
+    const vector<EventLoop*> &loops = cpuLoops_[cpu];
+    size_t &next = cpuNext_[cpu];
+    EventLoop *loop = loops[next];
+    if (++next >= loops.size())
+    {
+        next = 0;
+    }
+    return loop;
+}
+
 vector<EventLoop*> EventLoopThreadPool::getAllLoops()
 {
     assert(baseLoop_->isInLoopThread());
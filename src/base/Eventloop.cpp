@@ -1,6 +1,7 @@
 #include "Eventloop.h"
 #include "Poller.h"
 #include "Logger.h"
+#include "BinaryLog.h"
 #include "TimerQueue.h"
 
 #include <sys/eventfd.h>
@@ -32,13 +33,14 @@ EventLoop::EventLoop()
       quit_(false),
       callingPendingFunctors_(false),
       threadId_(CurrentThread::tid()),
+      busyMicroSeconds_(0),
       poller_(Poller::newDefaultPoller(this)),
       wakeupFd_(createEventfd()),
       wakeupChannel_(new Channel(this, wakeupFd_)),
       currentActiveChannel_(nullptr),
       timerQueue_(new TimerQueue(this))
 {
-    LOG_DEBUG("EventLoop created %p in thread %d", this, threadId_);
+    BLOG_DEBUG("EventLoop created %p in thread %d", this, threadId_);
     if (t_loopInThisThread)
     {
         LOG_FATAL("Another EventLoop %p exists in this thread %d", t_loopInThisThread, threadId_);
@@ -73,7 +75,7 @@ void EventLoop::loop()
     looping_ = true;
     // 不重置quit_标志，允许在调用loop()之前设置退出标志
     // quit_ = false;  // 注释掉这行，支持在调用loop()之前设置退出标志
-    LOG_DEBUG("EventLoop %p start looping", this);
+    BLOG_DEBUG("EventLoop %p start looping", this);
 
     // 调用进入事件循环的回调函数
     if (loopStartedCallback_)
@@ -97,9 +99,16 @@ void EventLoop::loop()
 
         // 执行待处理的回调函数
         doPendingFunctors();
+
+        // 从poll返回到本轮结束的时间计为忙碌时间
+        int64_t busy = Timestamp::now().microSecondsSinceEpoch() - pollReturnTime_.microSecondsSinceEpoch();
+        if (busy > 0)
+        {
+            busyMicroSeconds_.fetch_add(busy, std::memory_order_relaxed);
+        }
     }
 
-    LOG_DEBUG("EventLoop %p stop looping", this);
+    BLOG_DEBUG("EventLoop %p stop looping", this);
     looping_ = false;
 }
 
@@ -152,12 +161,12 @@ void EventLoop::wakeup()
         {
             // 计数器已经非零，说明之前有未处理的唤醒事件
             // 这是正常情况，不需要记录错误
-            LOG_DEBUG("EventLoop::wakeup() eventfd counter already non-zero");
+            BLOG_DEBUG("EventLoop::wakeup() eventfd counter already non-zero");
         }
         else
         {
             // 其他错误，可能是wakeupFd_无效或系统错误
-            LOG_ERROR("EventLoop::wakeup() writes %ld bytes instead of 8, errno=%d", n, savedErrno);
+            LOG_EVERY_MS(ERROR, 1000, "EventLoop::wakeup() writes %ld bytes instead of 8, errno=%d", n, savedErrno);
             // 如果wakeupFd_无效，尝试重新创建
             if (savedErrno == EBADF || savedErrno == EINVAL)
             {
@@ -220,12 +229,12 @@ void EventLoop::handleRead()
         {
             // 计数器为0，说明没有待处理的唤醒事件
             // 这是正常情况，不需要记录错误
-            LOG_DEBUG("EventLoop::handleRead() eventfd counter is zero");
+            BLOG_DEBUG("EventLoop::handleRead() eventfd counter is zero");
         }
         else
         {
             // 其他错误，可能是wakeupFd_无效或系统错误
-            LOG_ERROR("EventLoop::handleRead() reads %ld bytes instead of 8, errno=%d", n, savedErrno);
+            LOG_EVERY_MS(ERROR, 1000, "EventLoop::handleRead() reads %ld bytes instead of 8, errno=%d", n, savedErrno);
             // 如果wakeupFd_无效，记录严重错误
             if (savedErrno == EBADF || savedErrno == EINVAL)
             {
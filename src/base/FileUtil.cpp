@@ -1,72 +1,214 @@
 #include "FileUtil.h"
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
-#include <assert.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <libgen.h>
+#include <algorithm>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <vector>
+#ifdef RE_MUDUO_HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 using namespace std;
 
-AppendFile::AppendFile(string filename)
-    : fp_(::fopen(filename.data(), "ae")),
-      writtenBytes_(0) {
-    if (!fp_) {
-        // 尝试创建目录
-        char filename_copy[filename.size() + 1];
-        strcpy(filename_copy, filename.c_str());
-        char* dir = dirname(filename_copy);
-        if (mkdir(dir, 0755) == 0 || errno == EEXIST) {
-            // 目录创建成功或已存在，再次尝试打开文件
-            fp_ = ::fopen(filename.data(), "ae");
+bool FileUtil::makeDirectories(const string& dir) {
+    size_t pos = 0;
+    while (pos != string::npos && !dir.empty()) {
+        pos = dir.find('/', pos + 1);
+        string path = dir.substr(0, pos);
+        if (::mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
         }
+    }
+    return true;
+}
+
+bool FileUtil::gzipFile(const string& path) {
+#ifdef RE_MUDUO_HAVE_ZLIB
+    int in = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        return false;
+    }
+    // 先写临时文件，压缩完整后再改名，中途退出不会留下半个.gz
+    string tmp = path + ".gz.tmp";
+    gzFile out = ::gzopen(tmp.c_str(), "wb");
+    bool ok = out != nullptr;
+    char buf[64 * 1024];
+    while (ok) {
+        ssize_t n = ::read(in, buf, sizeof buf);
+        if (n == 0) {
+            break;
+        }
+        if (n < 0) {
+            ok = errno == EINTR;
+            continue;
+        }
+        ok = ::gzwrite(out, buf, static_cast<unsigned>(n)) == n;
+    }
+    ::close(in);
+    if (out != nullptr && ::gzclose(out) != Z_OK) {
+        ok = false;
+    }
+    if (ok && ::rename(tmp.c_str(), (path + ".gz").c_str()) == 0) {
+        ::unlink(path.c_str());
+        return true;
+    }
+    fprintf(stderr, "FileUtil::gzipFile() failed to compress %s\n", path.c_str());
+    ::unlink(tmp.c_str());
+    return false;
+#else
+    (void)path;
+    return false;
+#endif
+}
 
-        if (!fp_) {
-            fprintf(stderr, "AppendFile::AppendFile() failed to open file %s: %s\n", 
-                    filename.c_str(), strerror(errno));
+AppendFile::AppendFile(string filename, off_t preallocateBytes)
+    : filename_(std::move(filename)),
+      fd_(::open(filename_.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644)),
+      preallocateBytes_(preallocateBytes),
+      allocatedBytes_(0),
+      fileOffset_(0),
+      bufferUsed_(0),
+      writtenBytes_(0) {
+    if (fd_ < 0 && errno == ENOENT) {
+        // 目录不存在时逐级创建，再次尝试打开文件
+        char filename_copy[filename_.size() + 1];
+        strcpy(filename_copy, filename_.c_str());
+        if (FileUtil::makeDirectories(dirname(filename_copy))) {
+            fd_ = ::open(filename_.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
         }
     }
 
-    if (fp_) {
-        ::setbuffer(fp_, buffer_, sizeof(buffer_));
+    if (fd_ < 0) {
+        fprintf(stderr, "AppendFile::AppendFile() failed to open file %s: %s\n",
+                filename_.c_str(), strerror(errno));
+        return;
     }
+    // 已有内容时接着写在后面
+    fileOffset_ = ::lseek(fd_, 0, SEEK_END);
+    allocatedBytes_ = fileOffset_;
+    reserve(fileOffset_ + 1);
 }
 
 AppendFile::~AppendFile() {
-    if (fp_) {
-        ::fclose(fp_);
+    if (fd_ < 0) {
+        return;
+    }
+    flush();
+    if (allocatedBytes_ > fileOffset_) {
+        // 截断到实际长度，释放文件末尾之后预分配的块
+        ::ftruncate(fd_, fileOffset_);
     }
+    ::close(fd_);
 }
 
 void AppendFile::append(const char* logline, size_t len) {
-    if (!fp_) {
+    if (fd_ < 0) {
         return;
     }
+    writtenBytes_ += static_cast<off_t>(len);
+    while (len > 0) {
+        // 缓冲区写满时正好落到kBufferSize的整数倍处，flush()之后的第一块可能较短
+        size_t limit = kBufferSize - static_cast<size_t>(fileOffset_ % kBufferSize);
+        size_t n = std::min(len, limit - bufferUsed_);
+        memcpy(buffer_ + bufferUsed_, logline, n);
+        bufferUsed_ += n;
+        logline += n;
+        len -= n;
+        if (bufferUsed_ == limit) {
+            flush();
+        }
+    }
+}
 
-    size_t n = write(logline, len);
-    size_t remain = len - n;
-    while (remain > 0) {
-        size_t x = write(logline + n, remain);
-        if (x == 0) {
-            int err = ferror(fp_);
-            if (err) {
-                fprintf(stderr, "AppendFile::append() failed %s\n", strerror(err));
-            }
-            break;
+void AppendFile::appendv(const struct iovec* iov, int iovcnt) {
+    if (fd_ < 0) {
+        return;
+    }
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        total += iov[i].iov_len;
+    }
+    if (total < kBufferSize) {
+        for (int i = 0; i < iovcnt; ++i) {
+            append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
         }
-        n += x;
-        remain = len - n;
+        return;
     }
-    writtenBytes_ += len;
+    flush();
+    writeAt(iov, iovcnt);
+    writtenBytes_ += static_cast<off_t>(total);
 }
 
 void AppendFile::flush() {
-    if (fp_) {
-        ::fflush(fp_);
+    if (fd_ < 0 || bufferUsed_ == 0) {
+        return;
     }
+    struct iovec iov = {buffer_, bufferUsed_};
+    bufferUsed_ = 0;
+    writeAt(&iov, 1);
 }
 
-size_t AppendFile::write(const char* logline, size_t len) {
-    return fwrite_unlocked(logline, 1, len, fp_);
+void AppendFile::sync() {
+    if (fd_ < 0) {
+        return;
+    }
+    flush();
+    ::fdatasync(fd_);
+}
+
+void AppendFile::writeAt(const struct iovec* iov, int iovcnt) {
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        total += iov[i].iov_len;
+    }
+    reserve(fileOffset_ + static_cast<off_t>(total));
+
+    // pwritev可能只写入一部分，剩余部分从中断的那一段继续
+    std::vector<struct iovec> pending(iov, iov + iovcnt);
+    size_t index = 0;
+    while (index < pending.size()) {
+        int count = static_cast<int>(std::min<size_t>(pending.size() - index, IOV_MAX));
+        ssize_t n = ::pwritev(fd_, &pending[index], count, fileOffset_);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            fprintf(stderr, "AppendFile::writeAt() failed %s\n", strerror(errno));
+            break;
+        }
+        fileOffset_ += n;
+        size_t written = static_cast<size_t>(n);
+        while (index < pending.size() && written >= pending[index].iov_len) {
+            written -= pending[index].iov_len;
+            ++index;
+        }
+        if (written > 0) {
+            pending[index].iov_base = static_cast<char*>(pending[index].iov_base) + written;
+            pending[index].iov_len -= written;
+        }
+    }
+}
+
+void AppendFile::reserve(off_t end) {
+    if (preallocateBytes_ <= 0 || end <= allocatedBytes_) {
+        return;
+    }
+    off_t newEnd = allocatedBytes_;
+    while (newEnd < end) {
+        newEnd += preallocateBytes_;
+    }
+    // KEEP_SIZE：文件长度仍然随写入增长，读者看不到预分配的空洞
+    if (::fallocate(fd_, FALLOC_FL_KEEP_SIZE, allocatedBytes_, newEnd - allocatedBytes_) == 0) {
+        allocatedBytes_ = newEnd;
+    } else {
+        // 文件系统不支持时不再尝试
+        preallocateBytes_ = 0;
+    }
 }
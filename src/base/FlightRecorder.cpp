@@ -0,0 +1,309 @@
+#include "FlightRecorder.h"
+#include "BinaryLog.h"
+#include "CurrentThread.h"
+#include "Mutex.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <memory>
+
+std::atomic<bool> FlightRecorder::enabled_(false);
+
+namespace {
+
+/**
+ * 单个线程的环形缓冲区，只有所属线程写，转储时其他线程或信号处理函数读。
+ * 每条记录后面跟4字节的记录长度，读的一方从最新的记录往回找到仍然完整的最旧记录。
+ * head是累计写入的字节数，写完一条记录后release发布；读的一方拷贝前后各读一次head，
+ * 拷贝期间被覆盖的部分丢弃，不需要和写的一方同步。
+ */
+struct Ring {
+    Ring(char* buf, size_t size) : data(buf), capacity(size) {}
+
+    void append(const char* record, uint32_t len) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        copyIn(h, record, len);
+        copyIn(h + len, reinterpret_cast<const char*>(&len), sizeof len);
+        head.store(h + len + sizeof len, std::memory_order_release);
+    }
+
+    void copyIn(uint64_t pos, const char* src, size_t n) {
+        size_t offset = pos & (capacity - 1);
+        size_t first = std::min(n, capacity - offset);
+        memcpy(data + offset, src, first);
+        memcpy(data, src + first, n - first);
+    }
+
+    void copyOut(uint64_t pos, size_t n, char* dst) const {
+        size_t offset = pos & (capacity - 1);
+        size_t first = std::min(n, capacity - offset);
+        memcpy(dst, data + offset, first);
+        memcpy(dst + first, data, n - first);
+    }
+
+    char* const data;
+    const size_t capacity;                  // 2的幂
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> start{0};         // 当前线程开始使用时的head，之前的记录属于已退出的线程
+    std::atomic<int> tid{0};
+    std::atomic<bool> inUse{false};
+};
+
+// 环形缓冲区只增不减，线程退出后留给之后创建的线程复用，转储时不用担心被释放
+MutexLock g_ringsMutex;
+std::atomic<Ring*> g_rings[FlightRecorder::kMaxThreads];
+std::atomic<int> g_ringCount(0);
+size_t g_ringBytes = 0;
+
+// 转储用到的都提前准备好，信号处理函数里不分配内存
+char g_dumpPath[256];
+char* g_crashScratch = nullptr;
+std::atomic<bool> g_crashDumping(false);
+
+__thread Ring* t_ring = nullptr;
+
+// 线程退出时归还环形缓冲区，已有的记录保留到被复用为止
+struct RingReleaser {
+    ~RingReleaser() {
+        if (t_ring != nullptr) {
+            t_ring->inUse.store(false, std::memory_order_release);
+            t_ring = nullptr;
+        }
+    }
+};
+
+thread_local RingReleaser t_releaser;
+
+constexpr char kDumpFormat[] = "---- flight recorder dump: %s ----";
+constexpr char kThreadFormat[] = "---- flight recorder thread %d: last %u records ----";
+
+struct DumpSite {
+    static constexpr const char* format() { return kDumpFormat; }
+    static constexpr const char* file() { return __FILE__; }
+    static constexpr int line() { return __LINE__; }
+    static constexpr int level() { return INFO; }
+};
+
+struct ThreadSite {
+    static constexpr const char* format() { return kThreadFormat; }
+    static constexpr const char* file() { return __FILE__; }
+    static constexpr int line() { return __LINE__; }
+    static constexpr int level() { return INFO; }
+};
+
+Ring* attachRing() {
+    Ring* ring = nullptr;
+    {
+        MutexLockGuard lock(g_ringsMutex);
+        if (g_ringBytes == 0) {
+            return nullptr;
+        }
+        int count = g_ringCount.load(std::memory_order_relaxed);
+        for (int i = 0; i < count && ring == nullptr; ++i) {
+            Ring* candidate = g_rings[i].load(std::memory_order_relaxed);
+            if (!candidate->inUse.load(std::memory_order_acquire)) {
+                ring = candidate;
+            }
+        }
+        if (ring == nullptr) {
+            if (count == FlightRecorder::kMaxThreads) {
+                return nullptr;
+            }
+            ring = new Ring(new char[g_ringBytes], g_ringBytes);
+            g_rings[count].store(ring, std::memory_order_relaxed);
+            g_ringCount.store(count + 1, std::memory_order_release);
+        }
+        ring->tid.store(CurrentThread::tid(), std::memory_order_relaxed);
+        ring->start.store(ring->head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        ring->inUse.store(true, std::memory_order_release);
+    }
+    (void)&t_releaser;  // 触发thread_local的构造，线程退出时析构
+    t_ring = ring;
+    return ring;
+}
+
+/**
+ * 把ring里仍然完整的记录拷到scratch（至少ring容量大小），去掉每条记录后面的长度，
+ * 返回字节数；*records为记录条数
+ */
+size_t snapshot(const Ring& ring, char* scratch, uint32_t* records) {
+    const size_t capacity = ring.capacity;
+    uint64_t end = ring.head.load(std::memory_order_acquire);
+    uint64_t begin = std::max(ring.start.load(std::memory_order_relaxed), end > capacity ? end - capacity : 0);
+    ring.copyOut(begin, end - begin, scratch);
+    uint64_t after = ring.head.load(std::memory_order_acquire);
+    uint64_t valid = after > capacity ? std::max(begin, after - capacity) : begin;
+
+    // 从最新的记录往回找，长度不合理或者记录开头已经被覆盖时停下
+    uint64_t oldest = end;
+    while (oldest - valid >= sizeof(uint32_t)) {
+        uint32_t len;
+        memcpy(&len, scratch + (oldest - begin - sizeof len), sizeof len);
+        if (len < sizeof(binlog::RecordHeader) || len > binlog::kMaxRecordSize ||
+            oldest - valid < len + sizeof len) {
+            break;
+        }
+        oldest -= len + sizeof len;
+    }
+
+    size_t out = 0;
+    *records = 0;
+    for (uint64_t pos = oldest; pos < end;) {
+        uint32_t len;
+        memcpy(&len, scratch + (pos - begin) + offsetof(binlog::RecordHeader, length), sizeof len);
+        memmove(scratch + out, scratch + (pos - begin), len);
+        out += len;
+        pos += len + sizeof len;
+        ++*records;
+    }
+    return out;
+}
+
+bool writeAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+/**
+ * 转储所有线程的记录，只用open/write/close和栈上的缓冲区，可以在信号处理函数里调用
+ * scratch至少为一个环形缓冲区的大小
+ */
+bool dumpTo(const char* path, char* scratch, const char* reason) {
+    int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = true;
+    uint32_t sites = binlog::siteCount();
+    for (uint32_t id = 1; id <= sites && ok; ++id) {
+        const binlog::Site* site = binlog::findSite(id);
+        char head[binlog::kDefinitionHeadSize];
+        ok = writeAll(fd, head, binlog::encodeDefinitionHead(id, *site, head)) &&
+             writeAll(fd, site->format, strlen(site->format) + 1) &&
+             writeAll(fd, site->file, strlen(site->file) + 1) &&
+             writeAll(fd, site->argTypes, strlen(site->argTypes) + 1);
+    }
+
+    char marker[binlog::kMaxRecordSize];
+    int len = binlog::encode<DumpSite>(marker, reason);
+    ok = ok && writeAll(fd, marker, len);
+
+    int count = g_ringCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count && ok; ++i) {
+        const Ring* ring = g_rings[i].load(std::memory_order_relaxed);
+        uint32_t records;
+        size_t bytes = snapshot(*ring, scratch, &records);
+        len = binlog::encode<ThreadSite>(marker, ring->tid.load(std::memory_order_relaxed), records);
+        ok = writeAll(fd, marker, len) && writeAll(fd, scratch, bytes);
+    }
+    ::close(fd);
+    return ok;
+}
+
+const char* signalName(int sig) {
+    switch (sig) {
+    case SIGSEGV:
+        return "SIGSEGV";
+    case SIGBUS:
+        return "SIGBUS";
+    case SIGFPE:
+        return "SIGFPE";
+    case SIGILL:
+        return "SIGILL";
+    case SIGABRT:
+        return "SIGABRT";
+    default:
+        return "signal";
+    }
+}
+
+// 只转储一次，然后按默认行为重新触发信号（生成core、以该信号结束）
+void onFatalSignal(int sig) {
+    if (!g_crashDumping.exchange(true)) {
+        dumpTo(g_dumpPath, g_crashScratch, signalName(sig));
+    }
+    ::signal(sig, SIG_DFL);
+    ::raise(sig);
+}
+
+} // namespace
+
+void FlightRecorder::enable(const std::string& dumpPath, size_t ringBytes, bool installSignalHandlers) {
+    {
+        MutexLockGuard lock(g_ringsMutex);
+        if (g_ringBytes != 0) {
+            enabled_.store(true, std::memory_order_relaxed);
+            return;
+        }
+        size_t size = 4096;
+        while (size < ringBytes) {
+            size <<= 1;
+        }
+        g_ringBytes = size;
+        g_crashScratch = new char[size];
+        snprintf(g_dumpPath, sizeof g_dumpPath, "%s", dumpPath.c_str());
+    }
+
+    if (installSignalHandlers) {
+        struct sigaction action;
+        memset(&action, 0, sizeof action);
+        action.sa_handler = onFatalSignal;
+        sigemptyset(&action.sa_mask);
+        for (int sig : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+            ::sigaction(sig, &action, nullptr);
+        }
+    }
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void FlightRecorder::disable() {
+    enabled_.store(false, std::memory_order_relaxed);
+}
+
+void FlightRecorder::record(const char* record, int len) {
+    Ring* ring = t_ring;
+    if (__builtin_expect(ring == nullptr, 0)) {
+        ring = attachRing();
+        if (ring == nullptr) {
+            return;
+        }
+    }
+    ring->append(record, static_cast<uint32_t>(len));
+}
+
+bool FlightRecorder::dump() {
+    return dump(g_dumpPath);
+}
+
+bool FlightRecorder::dump(const std::string& path) {
+    size_t ringBytes;
+    {
+        MutexLockGuard lock(g_ringsMutex);
+        ringBytes = g_ringBytes;
+    }
+    if (ringBytes == 0) {
+        return false;
+    }
+    std::unique_ptr<char[]> scratch(new char[ringBytes]);
+    return dumpTo(path.c_str(), scratch.get(), "on demand");
+}
+
+void FlightRecorder::dumpOnFatal() {
+    if (enabled() && !g_crashDumping.exchange(true)) {
+        dumpTo(g_dumpPath, g_crashScratch, "LOG_FATAL");
+    }
+}
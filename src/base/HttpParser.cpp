@@ -0,0 +1,394 @@
+#include "HttpParser.h"
+#include "Buffer.h"
+#include <cstring>
+#include <strings.h>
+
+namespace
+{
+
+// 分块长度行（含扩展）的上限，防止对端只发长度行耗尽内存
+const size_t kMaxChunkSizeLine = 1024;
+
+bool equalsIgnoreCase(const char* begin, const char* end, const char* lower)
+{
+    size_t n = ::strlen(lower);
+    return static_cast<size_t>(end - begin) == n && ::strncasecmp(begin, lower, n) == 0;
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+HttpParser::HttpParser()
+    : maxHeaderSize_(kDefaultMaxHeaderSize),
+      maxBodySize_(kDefaultMaxBodySize)
+{
+    reset();
+}
+
+void HttpParser::reset()
+{
+    state_ = kRequestLine;
+    scanOffset_ = 0;
+    lineStart_ = 0;
+    bodyStart_ = 0;
+    contentLength_ = 0;
+    chunkRemaining_ = 0;
+    consumed_ = 0;
+    errorStatus_ = 0;
+    headerCount_ = 0;
+    chunked_ = false;
+    hasContentLength_ = false;
+    connectionHeader_ = 0;
+    minorVersion_ = 1;
+    chunkedBody_.clear();
+}
+
+HttpParser::Result HttpParser::fail(int status)
+{
+    errorStatus_ = status;
+    return kError;
+}
+
+HttpParser::Span HttpParser::span(const char* base, const char* begin, const char* end) const
+{
+    return Span{static_cast<uint32_t>(begin - base), static_cast<uint32_t>(end - begin)};
+}
+
+HttpParser::Result HttpParser::parse(const Buffer* buf)
+{
+    if (errorStatus_ != 0)
+    {
+        return kError;
+    }
+    if (state_ == kDone)
+    {
+        return kComplete;
+    }
+
+    const char* base = buf->peek();
+    const size_t readable = buf->readableBytes();
+    for (;;)
+    {
+        switch (state_)
+        {
+        case kRequestLine:
+        case kHeaders:
+        {
+            const char* crlf = buf->findCRLF(&scanOffset_);
+            if (crlf == nullptr)
+            {
+                return readable > maxHeaderSize_ ? fail(431) : kNeedMore;
+            }
+            size_t pos = static_cast<size_t>(crlf - base);
+            if (pos > maxHeaderSize_)
+            {
+                return fail(431);
+            }
+            const char* line = base + lineStart_;
+            if (state_ == kRequestLine)
+            {
+                // 请求行之前的空行可以忽略
+                if (pos != lineStart_)
+                {
+                    if (!parseRequestLine(line, crlf))
+                    {
+                        return fail(errorStatus_ ? errorStatus_ : 400);
+                    }
+                    state_ = kHeaders;
+                }
+            }
+            else if (pos == lineStart_)
+            {
+                lineStart_ = scanOffset_ = pos + 2;
+                Result r = finishHeaders(buf, pos + 2);
+                if (r != kNeedMore || state_ == kBody)
+                {
+                    return r;
+                }
+                continue;
+            }
+            else if (!parseHeader(line, crlf))
+            {
+                return fail(errorStatus_ ? errorStatus_ : 400);
+            }
+            lineStart_ = scanOffset_ = pos + 2;
+            break;
+        }
+
+        case kBody:
+            if (readable - bodyStart_ < contentLength_)
+            {
+                return kNeedMore;
+            }
+            return complete(buf, bodyStart_ + static_cast<size_t>(contentLength_));
+
+        case kChunkSize:
+        {
+            const char* crlf = buf->findCRLF(&scanOffset_);
+            if (crlf == nullptr)
+            {
+                return readable - lineStart_ > kMaxChunkSizeLine ? fail(400) : kNeedMore;
+            }
+            const char* p = base + lineStart_;
+            uint64_t size = 0;
+            int digits = 0;
+            for (; p < crlf && hexValue(*p) >= 0; ++p, ++digits)
+            {
+                if (digits >= 15)
+                {
+                    return fail(413);
+                }
+                size = size * 16 + static_cast<uint64_t>(hexValue(*p));
+            }
+            // 长度后面只允许跟扩展（;name=value）或空白
+            if (digits == 0 || (p < crlf && *p != ';' && *p != ' ' && *p != '\t'))
+            {
+                return fail(400);
+            }
+            lineStart_ = scanOffset_ = static_cast<size_t>(crlf - base) + 2;
+            if (size == 0)
+            {
+                state_ = kTrailers;
+            }
+            else
+            {
+                if (chunkedBody_.size() + size > maxBodySize_)
+                {
+                    return fail(413);
+                }
+                chunkRemaining_ = size;
+                state_ = kChunkData;
+            }
+            break;
+        }
+
+        case kChunkData:
+        {
+            size_t end = lineStart_ + static_cast<size_t>(chunkRemaining_);
+            if (readable < end + 2)
+            {
+                return kNeedMore;
+            }
+            if (base[end] != '\r' || base[end + 1] != '\n')
+            {
+                return fail(400);
+            }
+            chunkedBody_.append(base + lineStart_, static_cast<size_t>(chunkRemaining_));
+            lineStart_ = scanOffset_ = end + 2;
+            state_ = kChunkSize;
+            break;
+        }
+
+        case kTrailers:
+        {
+            const char* crlf = buf->findCRLF(&scanOffset_);
+            if (crlf == nullptr)
+            {
+                return readable - bodyStart_ > maxBodySize_ + maxHeaderSize_ ? fail(431) : kNeedMore;
+            }
+            size_t pos = static_cast<size_t>(crlf - base);
+            if (pos == lineStart_)
+            {
+                return complete(buf, pos + 2);
+            }
+            // 尾部字段不使用，直接跳过
+            lineStart_ = scanOffset_ = pos + 2;
+            break;
+        }
+
+        case kDone:
+            return kComplete;
+        }
+    }
+}
+
+bool HttpParser::parseRequestLine(const char* begin, const char* end)
+{
+    const char* base = begin - lineStart_;
+    const char* sp1 = static_cast<const char*>(::memchr(begin, ' ', end - begin));
+    if (sp1 == nullptr || sp1 == begin)
+    {
+        return false;
+    }
+    for (const char* p = begin; p < sp1; ++p)
+    {
+        if (*p < 'A' || *p > 'Z')
+        {
+            return false;
+        }
+    }
+    const char* target = sp1 + 1;
+    const char* sp2 = static_cast<const char*>(::memchr(target, ' ', end - target));
+    if (sp2 == nullptr || sp2 == target)
+    {
+        return false;
+    }
+    const char* version = sp2 + 1;
+    if (end - version != 8 || ::memcmp(version, "HTTP/1.", 7) != 0)
+    {
+        if (end - version >= 5 && ::memcmp(version, "HTTP/", 5) == 0)
+        {
+            errorStatus_ = 505;
+        }
+        return false;
+    }
+    if (version[7] == '1')
+    {
+        minorVersion_ = 1;
+    }
+    else if (version[7] == '0')
+    {
+        minorVersion_ = 0;
+    }
+    else
+    {
+        errorStatus_ = 505;
+        return false;
+    }
+    method_ = span(base, begin, sp1);
+    target_ = span(base, target, sp2);
+    return true;
+}
+
+bool HttpParser::parseHeader(const char* begin, const char* end)
+{
+    const char* base = begin - lineStart_;
+    if (headerCount_ == HttpRequest::kMaxHeaders)
+    {
+        errorStatus_ = 431;
+        return false;
+    }
+    // 不支持已废弃的多行折叠头部
+    if (*begin == ' ' || *begin == '\t')
+    {
+        return false;
+    }
+    const char* colon = static_cast<const char*>(::memchr(begin, ':', end - begin));
+    if (colon == nullptr || colon == begin || colon[-1] == ' ' || colon[-1] == '\t')
+    {
+        return false;
+    }
+    const char* value = colon + 1;
+    while (value < end && (*value == ' ' || *value == '\t')) ++value;
+    const char* valueEnd = end;
+    while (valueEnd > value && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t')) --valueEnd;
+
+    if (equalsIgnoreCase(begin, colon, "content-length"))
+    {
+        if (value == valueEnd || valueEnd - value > 18)
+        {
+            return false;
+        }
+        uint64_t length = 0;
+        for (const char* p = value; p < valueEnd; ++p)
+        {
+            if (*p < '0' || *p > '9')
+            {
+                return false;
+            }
+            length = length * 10 + static_cast<uint64_t>(*p - '0');
+        }
+        if (hasContentLength_ && length != contentLength_)
+        {
+            return false;
+        }
+        hasContentLength_ = true;
+        contentLength_ = length;
+    }
+    else if (equalsIgnoreCase(begin, colon, "transfer-encoding"))
+    {
+        if (!HttpRequest::hasToken(std::string_view(value, valueEnd - value), "chunked"))
+        {
+            // 不支持chunked以外的传输编码
+            errorStatus_ = 501;
+            return false;
+        }
+        chunked_ = true;
+    }
+    else if (equalsIgnoreCase(begin, colon, "connection"))
+    {
+        if (HttpRequest::hasToken(std::string_view(value, valueEnd - value), "close"))
+        {
+            connectionHeader_ = -1;
+        }
+        else if (HttpRequest::hasToken(std::string_view(value, valueEnd - value), "keep-alive"))
+        {
+            connectionHeader_ = 1;
+        }
+    }
+
+    headerNames_[headerCount_] = span(base, begin, colon);
+    headerValues_[headerCount_] = span(base, value, valueEnd);
+    ++headerCount_;
+    return true;
+}
+
+HttpParser::Result HttpParser::finishHeaders(const Buffer* buf, size_t end)
+{
+    bodyStart_ = end;
+    if (chunked_)
+    {
+        // 同时带Content-Length和chunked的请求可能用于请求走私，直接拒绝
+        if (hasContentLength_)
+        {
+            return fail(400);
+        }
+        state_ = kChunkSize;
+        return kNeedMore;
+    }
+    if (contentLength_ > maxBodySize_)
+    {
+        return fail(413);
+    }
+    if (contentLength_ > 0)
+    {
+        state_ = kBody;
+        if (buf->readableBytes() - bodyStart_ < contentLength_)
+        {
+            return kNeedMore;
+        }
+        return complete(buf, bodyStart_ + static_cast<size_t>(contentLength_));
+    }
+    return complete(buf, end);
+}
+
+HttpParser::Result HttpParser::complete(const Buffer* buf, size_t end)
+{
+    const char* base = buf->peek();
+    consumed_ = end;
+    state_ = kDone;
+
+    HttpRequest& req = request_;
+    req.method_ = std::string_view(base + method_.offset, method_.length);
+    std::string_view target(base + target_.offset, target_.length);
+    size_t question = target.find('?');
+    if (question == std::string_view::npos)
+    {
+        req.path_ = target;
+        req.query_ = std::string_view();
+    }
+    else
+    {
+        req.path_ = target.substr(0, question);
+        req.query_ = target.substr(question + 1);
+    }
+    req.minorVersion_ = minorVersion_;
+    req.headerCount_ = headerCount_;
+    for (int i = 0; i < headerCount_; ++i)
+    {
+        req.headers_[i].name = std::string_view(base + headerNames_[i].offset, headerNames_[i].length);
+        req.headers_[i].value = std::string_view(base + headerValues_[i].offset, headerValues_[i].length);
+    }
+    req.chunked_ = chunked_;
+    req.body_ = chunked_ ? std::string_view(chunkedBody_)
+                         : std::string_view(base + bodyStart_, static_cast<size_t>(contentLength_));
+    req.connectionHeader_ = connectionHeader_;
+    return kComplete;
+}
@@ -0,0 +1,47 @@
+#include "HttpRequest.h"
+#include <cstring>
+#include <strings.h>
+
+std::string_view HttpRequest::header(std::string_view name) const
+{
+    for (int i = 0; i < headerCount_; ++i)
+    {
+        const Header& h = headers_[i];
+        if (h.name.size() == name.size()
+            && ::strncasecmp(h.name.data(), name.data(), name.size()) == 0)
+        {
+            return h.value;
+        }
+    }
+    return std::string_view();
+}
+
+bool HttpRequest::keepAlive() const
+{
+    if (minorVersion_ >= 1)
+    {
+        return connectionHeader_ >= 0;
+    }
+    return connectionHeader_ > 0;
+}
+
+bool HttpRequest::hasToken(std::string_view list, std::string_view token)
+{
+    const char* p = list.data();
+    const char* end = p + list.size();
+    while (p < end)
+    {
+        const char* comma = static_cast<const char*>(::memchr(p, ',', end - p));
+        const char* itemEnd = comma ? comma : end;
+        while (p < itemEnd && (*p == ' ' || *p == '\t')) ++p;
+        const char* e = itemEnd;
+        while (e > p && (e[-1] == ' ' || e[-1] == '\t')) --e;
+        if (static_cast<size_t>(e - p) == token.size()
+            && ::strncasecmp(p, token.data(), token.size()) == 0)
+        {
+            return true;
+        }
+        p = comma ? comma + 1 : end;
+    }
+    return false;
+}
@@ -0,0 +1,121 @@
+#include "HttpResponse.h"
+#include "Buffer.h"
+#include <cstdio>
+#include <ctime>
+#include <sys/time.h>
+
+const std::string& httpDate()
+{
+    static thread_local time_t t_cachedSecond = 0;
+    static thread_local std::string t_cachedDate;
+    time_t now = ::time(nullptr);
+    if (now != t_cachedSecond)
+    {
+        struct tm tmUtc;
+        ::gmtime_r(&now, &tmUtc);
+        char buf[64];
+        size_t n = ::strftime(buf, sizeof buf, "%a, %d %b %Y %H:%M:%S GMT", &tmUtc);
+        t_cachedDate.assign(buf, n);
+        t_cachedSecond = now;
+    }
+    return t_cachedDate;
+}
+
+const char* HttpResponse::defaultStatusMessage(int code)
+{
+    switch (code)
+    {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 426: return "Upgrade Required";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    case 505: return "HTTP Version Not Supported";
+    default: return "Unknown";
+    }
+}
+
+void HttpResponse::appendChunk(std::string chunk)
+{
+    chunked_ = true;
+    if (!chunk.empty())
+    {
+        chunks_.push_back(std::move(chunk));
+    }
+}
+
+void HttpResponse::appendHeadersToBuffer(Buffer* output) const
+{
+    char buf[64];
+    int n = snprintf(buf, sizeof buf, "HTTP/1.1 %d ", statusCode_);
+    output->append(buf, n);
+    if (statusMessage_.empty())
+    {
+        output->append(std::string(defaultStatusMessage(statusCode_)));
+    }
+    else
+    {
+        output->append(statusMessage_);
+    }
+    output->append("\r\n", 2);
+
+    if (chunked_)
+    {
+        output->append("Transfer-Encoding: chunked\r\n", 28);
+    }
+    else if (statusCode_ != k204NoContent && statusCode_ != 304)
+    {
+        n = snprintf(buf, sizeof buf, "Content-Length: %zu\r\n", body_.size());
+        output->append(buf, n);
+    }
+    if (closeConnection_)
+    {
+        output->append("Connection: close\r\n", 19);
+    }
+    else
+    {
+        output->append("Connection: Keep-Alive\r\n", 24);
+    }
+    output->append("Date: ", 6);
+    output->append(httpDate());
+    output->append("\r\n", 2);
+
+    for (const auto& header : headers_)
+    {
+        output->append(header.first);
+        output->append(": ", 2);
+        output->append(header.second);
+        output->append("\r\n", 2);
+    }
+    output->append("\r\n", 2);
+}
+
+void HttpResponse::appendToBuffer(Buffer* output) const
+{
+    appendHeadersToBuffer(output);
+    if (!chunked_)
+    {
+        output->append(body_);
+        return;
+    }
+    char buf[32];
+    for (const std::string& chunk : chunks_)
+    {
+        int n = snprintf(buf, sizeof buf, "%zx\r\n", chunk.size());
+        output->append(buf, n);
+        output->append(chunk);
+        output->append("\r\n", 2);
+    }
+    output->append("0\r\n\r\n", 5);
+}
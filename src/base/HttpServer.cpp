@@ -0,0 +1,175 @@
+#include "HttpServer.h"
+#include "HttpParser.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "TcpConnection.h"
+#include "Buffer.h"
+#include "Logger.h"
+#include <deque>
+#include <memory>
+#include <vector>
+#include <sys/uio.h>
+
+namespace
+{
+
+void defaultHttpCallback(const HttpRequest&, HttpResponse* resp)
+{
+    resp->setStatusCode(HttpResponse::k404NotFound);
+    resp->setBody("Not Found");
+}
+
+/**
+ * 一次onMessage中所有响应的聚集缓冲：head保存状态行、头部和内联的小响应体，
+ * segments记录每个大响应体在head中的插入位置，bodies保证这些响应体在writev之前一直有效
+ */
+struct ResponseBatch
+{
+    struct Segment
+    {
+        size_t headEnd;             // 该响应体之前的head数据截止位置
+        const std::string* body;
+    };
+
+    Buffer head;
+    std::vector<Segment> segments;
+    std::deque<HttpResponse> bodies;
+    std::vector<struct iovec> iov;
+
+    bool empty() const { return head.readableBytes() == 0 && segments.empty(); }
+
+    void flush(const TcpConnectionPtr& conn)
+    {
+        if (empty())
+        {
+            return;
+        }
+        const char* base = head.peek();
+        size_t pos = 0;
+        for (const Segment& seg : segments)
+        {
+            if (seg.headEnd > pos)
+            {
+                iov.push_back({const_cast<char*>(base + pos), seg.headEnd - pos});
+                pos = seg.headEnd;
+            }
+            iov.push_back({const_cast<char*>(seg.body->data()), seg.body->size()});
+        }
+        if (head.readableBytes() > pos)
+        {
+            iov.push_back({const_cast<char*>(base + pos), head.readableBytes() - pos});
+        }
+        conn->sendv(iov.data(), static_cast<int>(iov.size()));
+
+        head.retrieveAll();
+        segments.clear();
+        bodies.clear();
+        iov.clear();
+    }
+};
+
+// 各IO线程复用一份，避免每次可读事件都重新分配
+thread_local ResponseBatch t_batch;
+
+} // namespace
+
+HttpServer::HttpServer(EventLoop* loop,
+                       const InetAddress& listenAddr,
+                       TcpServer::Option option)
+    : loop_(loop),
+      server_(loop, listenAddr, option),
+      httpCallback_(defaultHttpCallback),
+      maxHeaderSize_(HttpParser::kDefaultMaxHeaderSize),
+      maxBodySize_(HttpParser::kDefaultMaxBodySize),
+      inlineBodyThreshold_(kDefaultInlineBodyThreshold)
+{
+    server_.setConnectionCallback(
+        std::bind(&HttpServer::onConnection, this, std::placeholders::_1));
+    server_.setMessageCallback(
+        std::bind(&HttpServer::onMessage, this,
+                  std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+}
+
+void HttpServer::start()
+{
+    server_.start();
+}
+
+void HttpServer::onConnection(const TcpConnectionPtr& conn)
+{
+    if (conn->connected())
+    {
+        auto parser = std::make_shared<HttpParser>();
+        parser->setMaxHeaderSize(maxHeaderSize_);
+        parser->setMaxBodySize(maxBodySize_);
+        conn->setContext(parser);
+    }
+}
+
+void HttpServer::onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp receiveTime)
+{
+    auto* parserPtr = std::any_cast<std::shared_ptr<HttpParser>>(conn->getMutableContext());
+    if (parserPtr == nullptr || !conn->connected())
+    {
+        buf->retrieveAll();
+        return;
+    }
+    HttpParser* parser = parserPtr->get();
+    ResponseBatch& batch = t_batch;
+
+    for (;;)
+    {
+        HttpParser::Result result = parser->parse(buf);
+        if (result == HttpParser::kNeedMore)
+        {
+            break;
+        }
+        if (result == HttpParser::kError)
+        {
+            LOG_INFO("HttpServer::onMessage bad request from %s, status=%d",
+                     conn->name().c_str(), parser->errorStatus());
+            HttpResponse response(true);
+            response.setStatusCode(parser->errorStatus());
+            response.appendToBuffer(&batch.head);
+            batch.flush(conn);
+            buf->retrieveAll();
+            conn->shutdown();
+            return;
+        }
+
+        const HttpRequest& request = parser->request();
+        batch.bodies.emplace_back(!request.keepAlive());
+        HttpResponse& response = batch.bodies.back();
+        httpCallback_(request, &response);
+
+        bool close = response.closeConnection();
+        if (request.method() == "HEAD")
+        {
+            response.appendHeadersToBuffer(&batch.head);
+            batch.bodies.pop_back();
+        }
+        else if (response.chunked() || response.body().size() <= inlineBodyThreshold_)
+        {
+            response.appendToBuffer(&batch.head);
+            batch.bodies.pop_back();
+        }
+        else
+        {
+            response.appendHeadersToBuffer(&batch.head);
+            batch.segments.push_back({batch.head.readableBytes(), &response.body()});
+        }
+
+        // 回调返回后请求的视图不再使用，可以丢弃该请求占用的数据
+        buf->retrieve(parser->consumed());
+        parser->reset();
+
+        if (close)
+        {
+            batch.flush(conn);
+            buf->retrieveAll();
+            conn->shutdown();
+            return;
+        }
+    }
+    batch.flush(conn);
+}
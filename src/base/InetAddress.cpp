@@ -1,22 +1,75 @@
 #include "InetAddress.h"
+#include "Logger.h"
+#include <algorithm>
 #include <cstring>
+#include <cstddef>
 #include <iostream>
 #include <strings.h>
 
 InetAddress::InetAddress(uint16_t port, std::string ip) {
-    bzero(&addr, sizeof addr);
+    bzero(&storage, sizeof storage);
     addr.sin_family = AF_INET;
     addr.sin_port = htons(port);
     addr.sin_addr.s_addr = inet_addr(ip.c_str());
+    len = sizeof addr;
+}
+
+InetAddress::InetAddress(const sockaddr* sa, socklen_t salen) {
+    bzero(&storage, sizeof storage);
+    if (salen > sizeof storage) {
+        salen = sizeof storage;
+    }
+    memcpy(&storage, sa, salen);
+    len = salen;
+}
+
+InetAddress InetAddress::fromUnixPath(const std::string& path) {
+    sockaddr_un un;
+    bzero(&un, sizeof un);
+    un.sun_family = AF_UNIX;
+    // 抽象命名空间：sun_path首字节为'\0'，名字不以'\0'结尾，长度按实际名字计算
+    bool abstract = !path.empty() && path[0] == '@';
+    size_t n = path.size();
+    if (n + (abstract ? 0 : 1) > sizeof(un.sun_path)) {
+        // 截断后会是另一个地址，返回无效地址
+        LOG_ERROR("InetAddress::fromUnixPath path too long (%zu bytes): %s", n, path.c_str());
+        un.sun_family = AF_UNSPEC;
+        return InetAddress(reinterpret_cast<const sockaddr*>(&un), sizeof(sa_family_t));
+    }
+    memcpy(un.sun_path, path.data(), n);
+    socklen_t len = offsetof(sockaddr_un, sun_path) + n;
+    if (abstract) {
+        un.sun_path[0] = '\0';
+    } else {
+        len += 1;   // 文件路径带上结尾的'\0'
+    }
+    return InetAddress(reinterpret_cast<const sockaddr*>(&un), len);
+}
+
+std::string InetAddress::unixPath() const {
+    if (!isUnix() || len <= offsetof(sockaddr_un, sun_path)) {
+        return "";
+    }
+    size_t n = len - offsetof(sockaddr_un, sun_path);
+    if (unixAddr.sun_path[0] == '\0') {
+        return "@" + std::string(unixAddr.sun_path + 1, n - 1);
+    }
+    return std::string(unixAddr.sun_path, strnlen(unixAddr.sun_path, n));
 }
 
 std::string InetAddress::toIp() const {
+    if (isUnix()) {
+        return unixPath();
+    }
     char buf[64] = {0};
     ::inet_ntop(AF_INET, &addr.sin_addr, buf, sizeof buf);
     return buf;
 }
 
 std::string InetAddress::toIpPort() const {
+    if (isUnix()) {
+        return "unix:" + unixPath();
+    }
     char buf[64] = {0};
     ::inet_ntop(AF_INET, &addr.sin_addr, buf, sizeof buf);
     size_t end = strlen(buf);
@@ -26,6 +79,9 @@ std::string InetAddress::toIpPort() const {
 }
 
 uint16_t InetAddress::toPort() const {
+    if (isUnix()) {
+        return 0;
+    }
     return ntohs(addr.sin_port);
 }
 
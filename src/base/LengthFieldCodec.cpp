@@ -0,0 +1,247 @@
+#include "LengthFieldCodec.h"
+#include "TcpConnection.h"
+#include "Buffer.h"
+#include "Logger.h"
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <endian.h>
+
+LengthFieldCodec::LengthFieldCodec(const FrameCallback& cb, LengthField lengthField, size_t maxFrameSize)
+    : frameCallback_(cb),
+      lengthField_(lengthField),
+      maxFrameSize_(maxFrameSize)
+{
+}
+
+LengthFieldCodec::LengthFieldCodec(const BatchFrameCallback& cb, LengthField lengthField, size_t maxFrameSize)
+    : batchCallback_(cb),
+      lengthField_(lengthField),
+      maxFrameSize_(maxFrameSize)
+{
+}
+
+int LengthFieldCodec::parseLength(const char* data, size_t len, uint64_t* frameLen) const
+{
+    switch (lengthField_)
+    {
+    case kVarint:
+        return Buffer::decodeVarint(data, len, frameLen);
+    case kInt8:
+        if (len < 1) return 0;
+        *frameLen = static_cast<uint8_t>(data[0]);
+        return 1;
+    case kInt16:
+    {
+        if (len < 2) return 0;
+        uint16_t be16;
+        ::memcpy(&be16, data, sizeof be16);
+        *frameLen = be16toh(be16);
+        return 2;
+    }
+    case kInt32:
+    {
+        if (len < 4) return 0;
+        int32_t be32;
+        ::memcpy(&be32, data, sizeof be32);
+        int32_t n = static_cast<int32_t>(be32toh(static_cast<uint32_t>(be32)));
+        if (n < 0) return -1;
+        *frameLen = static_cast<uint64_t>(n);
+        return 4;
+    }
+    case kInt64:
+    {
+        if (len < 8) return 0;
+        int64_t be64;
+        ::memcpy(&be64, data, sizeof be64);
+        int64_t n = static_cast<int64_t>(be64toh(static_cast<uint64_t>(be64)));
+        if (n < 0) return -1;
+        *frameLen = static_cast<uint64_t>(n);
+        return 8;
+    }
+    }
+    return -1;
+}
+
+size_t LengthFieldCodec::onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp receiveTime)
+{
+    // 批量模式下收集本次的帧视图；同一codec被多个IO线程共用，数组按线程缓存以复用容量
+    static thread_local std::vector<std::string_view> t_frames;
+    std::vector<std::string_view> batch;
+    if (batchCallback_)
+    {
+        batch.swap(t_frames);
+        batch.clear();
+    }
+
+    const char* p = buf->peek();
+    size_t remain = buf->readableBytes();
+    size_t frames = 0;
+    while (remain > 0)
+    {
+        uint64_t frameLen = 0;
+        int headerLen = parseLength(p, remain, &frameLen);
+        if (headerLen == 0)
+        {
+            break;
+        }
+        if (headerLen < 0 || frameLen > maxFrameSize_)
+        {
+            // 出错前已经完整的帧照常分发
+            if (!batch.empty())
+            {
+                batchCallback_(conn, batch.data(), batch.size(), receiveTime);
+                batch.clear();
+            }
+            if (batchCallback_)
+            {
+                t_frames.swap(batch);
+            }
+            handleError(conn, buf, headerLen < 0 ? kInvalidLength : kFrameTooLarge);
+            return frames;
+        }
+        size_t total = static_cast<size_t>(headerLen) + static_cast<size_t>(frameLen);
+        if (remain < total)
+        {
+            break;
+        }
+        std::string_view frame(p + headerLen, static_cast<size_t>(frameLen));
+        if (batchCallback_)
+        {
+            batch.push_back(frame);
+        }
+        else
+        {
+            frameCallback_(conn, frame, receiveTime);
+        }
+        p += total;
+        remain -= total;
+        ++frames;
+    }
+    if (!batch.empty())
+    {
+        batchCallback_(conn, batch.data(), batch.size(), receiveTime);
+        batch.clear();
+    }
+    if (batchCallback_)
+    {
+        t_frames.swap(batch);
+    }
+    // 所有完整帧分发完后统一移动一次读指针
+    buf->retrieve(buf->readableBytes() - remain);
+    return frames;
+}
+
+void LengthFieldCodec::handleError(const TcpConnectionPtr& conn, Buffer* buf, Error error)
+{
+    if (errorCallback_)
+    {
+        errorCallback_(conn, error);
+    }
+    else
+    {
+        LOG_ERROR("LengthFieldCodec %s, connection=%s",
+                  error == kFrameTooLarge ? "frame too large" : "invalid length",
+                  conn ? conn->name().c_str() : "");
+        if (conn)
+        {
+            conn->forceClose();
+        }
+    }
+    buf->retrieveAll();
+}
+
+uint64_t LengthFieldCodec::maxLength(LengthField lengthField)
+{
+    switch (lengthField)
+    {
+    case kVarint:
+        return std::numeric_limits<uint64_t>::max();
+    case kInt8:
+        return std::numeric_limits<uint8_t>::max();
+    case kInt16:
+        return std::numeric_limits<uint16_t>::max();
+    case kInt32:
+        return std::numeric_limits<int32_t>::max();
+    case kInt64:
+        return std::numeric_limits<int64_t>::max();
+    }
+    return 0;
+}
+
+bool LengthFieldCodec::encode(Buffer* out, std::string_view payload) const
+{
+    size_t len = payload.size();
+    if (len > maxLength(lengthField_))
+    {
+        LOG_ERROR("LengthFieldCodec payload of %zu bytes does not fit a %d-byte length field",
+                  len, static_cast<int>(lengthField_));
+        return false;
+    }
+    switch (lengthField_)
+    {
+    case kVarint:
+        out->appendVarint(len);
+        break;
+    case kInt8:
+        out->appendInt8(static_cast<int8_t>(len));
+        break;
+    case kInt16:
+        out->appendInt16(static_cast<int16_t>(len));
+        break;
+    case kInt32:
+        out->appendInt32(static_cast<int32_t>(len));
+        break;
+    case kInt64:
+        out->appendInt64(static_cast<int64_t>(len));
+        break;
+    }
+    out->append(payload.data(), len);
+    return true;
+}
+
+bool LengthFieldCodec::encode(Buffer* out, const std::string_view* payloads, size_t n) const
+{
+    const uint64_t limit = maxLength(lengthField_);
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (payloads[i].size() > limit)
+        {
+            LOG_ERROR("LengthFieldCodec payload #%zu of %zu bytes does not fit a %d-byte length field",
+                      i, payloads[i].size(), static_cast<int>(lengthField_));
+            return false;
+        }
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        encode(out, payloads[i]);
+    }
+    return true;
+}
+
+bool LengthFieldCodec::send(const TcpConnectionPtr& conn, std::string_view payload) const
+{
+    Buffer buf(payload.size() + Buffer::kMaxVarintBytes);
+    if (!encode(&buf, payload))
+    {
+        return false;
+    }
+    conn->send(&buf);
+    return true;
+}
+
+bool LengthFieldCodec::send(const TcpConnectionPtr& conn, const std::string_view* payloads, size_t n) const
+{
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        total += payloads[i].size() + Buffer::kMaxVarintBytes;
+    }
+    Buffer buf(total);
+    if (!encode(&buf, payloads, n))
+    {
+        return false;
+    }
+    conn->send(&buf);
+    return true;
+}
@@ -1,6 +1,7 @@
 #include "LogFile.h"
 #include "FileUtil.h"
 #include "ProcessInfo.h"
+#include "ThreadPool.h"
 #include <time.h>
 #include <sys/time.h>
 #include <stdio.h>
@@ -12,20 +13,30 @@ LogFile::LogFile(const string& basename,
                  off_t rollSize,
                  bool threadSafe,
                  int flushInterval,
-                 int checkEveryN)
+                 int syncInterval)
     : basename_(basename),
       rollSize_(rollSize),
       flushInterval_(flushInterval),
-      checkEveryN_(checkEveryN),
-      count_(0),
+      syncInterval_(syncInterval),
+      compressRolledFiles_(false),
       mutex_(threadSafe ? new MutexLock : NULL),
       startOfPeriod_(0),
-      lastRoll_(0),
+      lastFlush_(0),
+      lastSync_(::time(NULL)),
       file_(nullptr) {
     rollFile();
 }
 
-LogFile::~LogFile() = default;
+LogFile::~LogFile() {
+    if (syncInterval_ > 0) {
+        file_->sync();
+    }
+    file_.reset();
+    // 等后台线程处理完所有滚动出去的文件
+    if (archiver_) {
+        archiver_->stop();
+    }
+}
 
 void LogFile::append(const char* logline, int len) {
     if (mutex_) {
@@ -36,32 +47,55 @@ void LogFile::append(const char* logline, int len) {
     }
 }
 
+void LogFile::appendv(const struct iovec* iov, int iovcnt) {
+    if (mutex_) {
+        MutexLockGuard lock(*mutex_);
+        file_->appendv(iov, iovcnt);
+        afterWrite();
+    } else {
+        file_->appendv(iov, iovcnt);
+        afterWrite();
+    }
+}
+
 void LogFile::flush() {
     if (mutex_) {
         MutexLockGuard lock(*mutex_);
-        file_->flush();
+        flush_unlocked(::time(NULL));
     } else {
-        file_->flush();
+        flush_unlocked(::time(NULL));
     }
 }
 
+off_t LogFile::writtenBytes() const {
+    return file_->writtenBytes();
+}
+
 void LogFile::append_unlocked(const char* logline, int len) {
     file_->append(logline, len);
+    afterWrite();
+}
+
+void LogFile::afterWrite() {
     if (file_->writtenBytes() > rollSize_) {
         rollFile();
-    } else {
-        ++count_;
-        if (count_ >= checkEveryN_) {
-            count_ = 0;
-            time_t now = ::time(NULL);
-            time_t thisPeriod_ = now / kRollPerSeconds * kRollPerSeconds;
-            if (thisPeriod_ != startOfPeriod_) {
-                rollFile();
-            } else if (now - lastRoll_ > flushInterval_) {
-                lastRoll_ = now;
-                file_->flush();
-            }
-        }
+        return;
+    }
+    // 按时间而不是写入次数检查，time()走vDSO，每次写入都检查也很便宜
+    time_t now = ::time(NULL);
+    if (now / kRollPerSeconds * kRollPerSeconds != startOfPeriod_) {
+        rollFile();
+    } else if (now - lastFlush_ >= flushInterval_) {
+        flush_unlocked(now);
+    }
+}
+
+void LogFile::flush_unlocked(time_t now) {
+    lastFlush_ = now;
+    file_->flush();
+    if (syncInterval_ > 0 && now - lastSync_ >= syncInterval_) {
+        lastSync_ = now;
+        file_->sync();
     }
 }
 
@@ -70,22 +104,37 @@ bool LogFile::rollFile() {
     string filename = getLogFileName(basename_, &now);
     time_t start = now / kRollPerSeconds * kRollPerSeconds;
 
-    // 从完整路径中提取目录部分
-    size_t pos = filename.find_last_of('/');
-    if (pos != string::npos) {
-        string dirname = filename.substr(0, pos);
-        // 确保目录存在
-        string mkdirCmd = "mkdir -p " + dirname;
-        system(mkdirCmd.c_str());
-    }
-
-    // 总是创建新的日志文件，即使时间戳相同
-    lastRoll_ = now;
+    // 总是创建新的日志文件，即使时间戳相同；目录不存在时由AppendFile创建
+    lastFlush_ = now;
     startOfPeriod_ = start;
-    file_.reset(new AppendFile(filename));
+    if (file_) {
+        file_->flush();
+        retire(std::move(file_));
+    }
+    file_.reset(new AppendFile(filename, rollSize_ < kMaxPreallocateBytes ? rollSize_ : kMaxPreallocateBytes));
     return true;
 }
 
+void LogFile::retire(std::unique_ptr<AppendFile> file) {
+    if (!archiver_) {
+        archiver_.reset(new ThreadPool("LogArchiver"));
+        archiver_->start(1);
+    }
+    std::shared_ptr<AppendFile> retired(std::move(file));
+    bool sync = syncInterval_ > 0;
+    bool compress = compressRolledFiles_;
+    archiver_->run([retired, sync, compress]() mutable {
+        if (sync) {
+            retired->sync();
+        }
+        string filename = retired->filename();
+        retired.reset();   // 释放预分配的空间并关闭
+        if (compress) {
+            FileUtil::gzipFile(filename);
+        }
+    });
+}
+
 string LogFile::getLogFileName(const string& basename, time_t* now) {
     string filename;
     filename.reserve(basename.size() + 64);
@@ -1,30 +1,84 @@
 #include "LogStream.h"
-#include <algorithm>
-#include <cctype>
-#include <cstdio>
+#include <charconv>
+#include <cstdint>
 #include <cstring>
-#include <functional>
+#include <type_traits>
+
+namespace {
+
+// 00到99的两位数字，每次除以100写出两位
+const char kDigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// 一个字节对应的两位十六进制数字；编译期生成，和kDigitPairs一样是常量初始化，
+// 静态初始化阶段的日志也能用
+struct HexTable {
+    char pairs[512] = {};
+
+    constexpr HexTable() {
+        const char* hex = "0123456789abcdef";
+        for (int i = 0; i < 256; ++i) {
+            pairs[i * 2] = hex[i >> 4];
+            pairs[i * 2 + 1] = hex[i & 0xf];
+        }
+    }
+};
+
+constexpr HexTable kHexTable;
+
+// 十进制位数，只做比较，每4位做一次除法
+template<typename U>
+int countDigits(U u) {
+    int n = 1;
+    for (;;) {
+        if (u < 10) return n;
+        if (u < 100) return n + 1;
+        if (u < 1000) return n + 2;
+        if (u < 10000) return n + 3;
+        u /= 10000U;
+        n += 4;
+    }
+}
 
-const char digits[] = "9876543210123456789";
-const char* zero = digits + 9;
+} // namespace
 
+// 先算出位数，再从末尾往前每次写两位，一遍写完不需要反转
 template<typename T>
 size_t convert(char buf[], T value) {
-    T i = value;
+    typedef typename std::make_unsigned<T>::type U;
     char* p = buf;
-
-    do {
-        int lsd = static_cast<int>(i % 10);
-        i /= 10;
-        *p++ = zero[lsd];
-    } while (i != 0);
-
+    U u = static_cast<U>(value);
     if (value < 0) {
         *p++ = '-';
+        u = static_cast<U>(0) - u;
     }
-    *p = '\0';
-    std::reverse(buf, p);
-    return p - buf;
+
+    char* end = p + countDigits(u);
+    char* q = end;
+    while (u >= 100) {
+        unsigned idx = static_cast<unsigned>(u % 100) * 2;
+        u /= 100;
+        *--q = kDigitPairs[idx + 1];
+        *--q = kDigitPairs[idx];
+    }
+    if (u >= 10) {
+        unsigned idx = static_cast<unsigned>(u) * 2;
+        *--q = kDigitPairs[idx + 1];
+        *--q = kDigitPairs[idx];
+    } else {
+        *--q = static_cast<char>('0' + u);
+    }
+    *end = '\0';
+    return end - buf;
 }
 
 template<typename T>
@@ -81,21 +135,23 @@ LogStream& LogStream::operator<<(const void* p) {
         char* buf = cur_;
         *buf++ = '0';
         *buf++ = 'x';
-
-        for (int i = (sizeof(void*) * 2) - 1; i >= 0; --i) {
-            int shift = i * 4;
-            int nibble = (v >> shift) & 0xf;
-            *buf++ = (nibble < 10) ? ('0' + nibble) : ('a' + nibble - 10);
+        for (int shift = (sizeof(void*) - 1) * 8; shift >= 0; shift -= 8) {
+            memcpy(buf, kHexTable.pairs + ((v >> shift) & 0xff) * 2, 2);
+            buf += 2;
         }
         cur_ = buf;
     }
     return *this;
 }
 
+// 整数值按整数格式化，其余输出能精确还原的最短形式，不经过snprintf
 LogStream& LogStream::operator<<(double v) {
     if (avail() >= kMaxNumericSize) {
-        int len = snprintf(cur_, kMaxNumericSize, "%.12g", v);
-        cur_ += len;
+        if (v > -kMaxExactInteger && v < kMaxExactInteger && v == static_cast<double>(static_cast<int64_t>(v))) {
+            cur_ += convert(cur_, static_cast<int64_t>(v));
+        } else {
+            cur_ = std::to_chars(cur_, cur_ + kMaxNumericSize, v).ptr;
+        }
     }
     return *this;
 }
@@ -1,21 +1,27 @@
 #include "Logger.h"
 #include "AsyncLogging.h"
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 
+std::atomic<int> Logger::g_logLevel(INFO);
+
 std::function<void(const char*, int)> Logger::output_ = [](const char* msg, int len) {
     fwrite(msg, 1, len, stdout);
 };
 
+namespace {
+
+// 一条printf风格日志的最大长度，超出部分截断
+const int kMaxLineSize = 1024;
+
+} // namespace
+
 Logger& Logger::instance() {
     static Logger logger;
     return logger;
 }
 
-void Logger::setLogLevel(int level) {
-    LogLevel_ = level;
-}
-
 void Logger::setOutput(std::function<void(const char*, int)> output) {
     output_ = output;
 }
@@ -24,30 +30,94 @@ std::function<void(const char*, int)>& Logger::output() {
     return output_;
 }
 
-void Logger::log(std::string msg)
-{
-    const char* levelStr = "";
-    switch (LogLevel_)
-    {
+const char* Logger::levelName(int level) {
+    switch (level) {
+    case DEBUG:
+        return "DEBUG";
     case INFO:
-        levelStr = "INFO";
-        break;
+        return "INFO";
     case ERROR:
-        levelStr = "ERROR";
-        break;
+        return "ERROR";
     case FATAL:
-        levelStr = "FATAL";
-        break;
-    case DEBUG:
-        levelStr = "DEBUG";
-        break;
+        return "FATAL";
     default:
-        levelStr = "UNKNOWN";
-        break;
+        return "UNKNOWN";
     }
+}
+
+int Logger::formatPrefix(char* buf, int level, Timestamp time) {
+    // 时间部分来自Timestamp::format的每线程缓存，同一秒内只改写微秒，级别名直接拷贝
+    char* p = buf;
+    *p++ = '[';
+    p += time.format(p);
+    *p++ = ']';
+    *p++ = ' ';
+    const char* name = levelName(level);
+    size_t len = strlen(name);
+    memcpy(p, name, len);
+    p += len;
+    *p++ = ':';
+    *p++ = ' ';
+    return static_cast<int>(p - buf);
+}
 
-    char buf[1024];
-    int len = snprintf(buf, sizeof(buf), "[%s] %s: %s\n", 
-                       Timestamp::now().to_string().c_str(), levelStr, msg.c_str());
-    output_(buf, len);
+namespace {
+
+void vlogf(int level, uint64_t suppressed, const char* format, va_list args) {
+    // 前缀和消息直接写进同一个栈缓冲区，不清零、不经过std::string
+    char buf[kMaxLineSize];
+    int len = Logger::formatPrefix(buf, level);
+    int n = vsnprintf(buf + len, sizeof(buf) - len - 1, format, args);
+    if (n > 0) {
+        len += std::min(n, static_cast<int>(sizeof(buf)) - len - 2);
+    }
+    if (suppressed > 0) {
+        n = snprintf(buf + len, sizeof(buf) - len - 1, " (%llu similar messages suppressed)",
+                     static_cast<unsigned long long>(suppressed));
+        if (n > 0) {
+            len += std::min(n, static_cast<int>(sizeof(buf)) - len - 2);
+        }
+    }
+    buf[len++] = '\n';
+    Logger::output()(buf, len);
+}
+
+} // namespace
+
+void Logger::logf(int level, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vlogf(level, 0, format, args);
+    va_end(args);
+}
+
+void Logger::logSampled(int level, uint64_t suppressed, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vlogf(level, suppressed, format, args);
+    va_end(args);
+}
+
+void Logger::log(int level, const std::string& msg) {
+    if (!enabled(level)) {
+        return;
+    }
+    LogMessage message(level);
+    message.stream() << msg;
+}
+
+LogMessage::LogMessage(int level)
+    : level_(level) {
+    char prefix[Logger::kMaxPrefixSize];
+    int len = Logger::formatPrefix(prefix, level);
+    stream_.append(prefix, len);
+}
+
+LogMessage::~LogMessage() {
+    stream_ << '\n';
+    Logger::output()(stream_.data(), stream_.length());
+    if (level_ == FATAL) {
+        FlightRecorder::dumpOnFatal();
+        exit(-1);
+    }
 }
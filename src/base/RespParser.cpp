@@ -0,0 +1,321 @@
+#include "RespParser.h"
+#include "Buffer.h"
+
+namespace
+{
+
+// 带符号的十进制整数，不允许空串和溢出
+bool parseInteger(const char* p, size_t len, int64_t* value)
+{
+    bool negative = false;
+    if (len > 0 && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        ++p;
+        --len;
+    }
+    if (len == 0 || len > 18)
+    {
+        return false;
+    }
+    int64_t v = 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+        if (p[i] < '0' || p[i] > '9')
+        {
+            return false;
+        }
+        v = v * 10 + (p[i] - '0');
+    }
+    *value = negative ? -v : v;
+    return true;
+}
+
+} // namespace
+
+RespParser::RespParser()
+    : maxBulkLength_(kDefaultMaxBulkLength),
+      maxElements_(kDefaultMaxElements)
+{
+    reset();
+}
+
+void RespParser::reset()
+{
+    pos_ = 0;
+    scanOffset_ = 0;
+    consumed_ = 0;
+    bulkRemaining_ = -1;
+    error_ = nullptr;
+    pending_.clear();
+    stack_.clear();
+    values_.clear();
+}
+
+void RespParser::clear()
+{
+    // 未完成的值整体前移consumed_字节
+    for (Node& node : pending_)
+    {
+        node.offset -= consumed_;
+    }
+    pos_ -= consumed_;
+    scanOffset_ -= consumed_;
+    consumed_ = 0;
+    values_.clear();
+}
+
+RespParser::Result RespParser::fail(const char* reason)
+{
+    error_ = reason;
+    return kError;
+}
+
+bool RespParser::finishElement()
+{
+    while (!stack_.empty())
+    {
+        Frame& frame = stack_.back();
+        if (--frame.remaining > 0)
+        {
+            return false;
+        }
+        bool attribute = frame.attribute;
+        stack_.pop_back();
+        // 属性附加在后面的值上，本身不算外层聚合的元素
+        if (attribute)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RespParser::completeValue(const char* base)
+{
+    for (const Node& node : pending_)
+    {
+        RespValue value;
+        value.type = node.type;
+        value.null = node.null;
+        value.integer = node.integer;
+        value.str = std::string_view(base + node.offset, node.length);
+        values_.push_back(value);
+    }
+    pending_.clear();
+    consumed_ = pos_;
+}
+
+bool RespParser::parseInline(const char* base, size_t lineEnd)
+{
+    const size_t arrayIndex = pending_.size();
+    pending_.push_back(Node{RespValue::kArray, false, 0, pos_, 0});
+    size_t i = pos_;
+    while (i < lineEnd)
+    {
+        while (i < lineEnd && (base[i] == ' ' || base[i] == '\t')) ++i;
+        size_t start = i;
+        while (i < lineEnd && base[i] != ' ' && base[i] != '\t') ++i;
+        if (i > start)
+        {
+            pending_.push_back(Node{RespValue::kBulkString, false, 0, start, i - start});
+        }
+    }
+    int64_t count = static_cast<int64_t>(pending_.size() - arrayIndex - 1);
+    if (count == 0)
+    {
+        pending_.pop_back();
+        return false;
+    }
+    pending_[arrayIndex].integer = count;
+    return true;
+}
+
+RespParser::Result RespParser::parse(const Buffer* buf)
+{
+    if (error_ != nullptr)
+    {
+        return kError;
+    }
+
+    const char* base = buf->peek();
+    const size_t readable = buf->readableBytes();
+    for (;;)
+    {
+        if (bulkRemaining_ >= 0)
+        {
+            // 等待bulk负载：只比较长度，不扫描内容
+            size_t end = pos_ + static_cast<size_t>(bulkRemaining_) + 2;
+            if (readable < end)
+            {
+                return kNeedMore;
+            }
+            if (base[end - 2] != '\r' || base[end - 1] != '\n')
+            {
+                return fail("expected CRLF after bulk string");
+            }
+            Node& node = pending_.back();
+            node.offset = pos_;
+            node.length = static_cast<size_t>(bulkRemaining_);
+            pos_ = scanOffset_ = end;
+            bulkRemaining_ = -1;
+            if (finishElement())
+            {
+                completeValue(base);
+                return kComplete;
+            }
+            continue;
+        }
+
+        if (pos_ >= readable)
+        {
+            return kNeedMore;
+        }
+        if (scanOffset_ < pos_)
+        {
+            scanOffset_ = pos_;
+        }
+        const char* crlf = buf->findCRLF(&scanOffset_);
+        if (crlf == nullptr)
+        {
+            return readable - pos_ > kMaxLineLength ? fail("line too long") : kNeedMore;
+        }
+        const size_t lineEnd = static_cast<size_t>(crlf - base);
+        const size_t next = lineEnd + 2;
+        const bool topLevel = pending_.empty();
+        if (lineEnd == pos_)
+        {
+            // 顶层的空行忽略，和Redis一致
+            if (!topLevel)
+            {
+                return fail("unexpected empty line");
+            }
+            pos_ = scanOffset_ = next;
+            consumed_ = pos_;
+            continue;
+        }
+
+        const char type = base[pos_];
+        const char* content = base + pos_ + 1;
+        const size_t contentLen = lineEnd - pos_ - 1;
+        Node node{static_cast<RespValue::Type>(type), false, 0, pos_ + 1, contentLen};
+        switch (type)
+        {
+        case RespValue::kSimpleString:
+        case RespValue::kError:
+        case RespValue::kDouble:
+        case RespValue::kBigNumber:
+            break;
+
+        case RespValue::kInteger:
+            if (!parseInteger(content, contentLen, &node.integer))
+            {
+                return fail("invalid integer");
+            }
+            break;
+
+        case RespValue::kBoolean:
+            if (contentLen != 1 || (*content != 't' && *content != 'f'))
+            {
+                return fail("invalid boolean");
+            }
+            node.integer = *content == 't';
+            break;
+
+        case RespValue::kNull:
+            if (contentLen != 0)
+            {
+                return fail("invalid null");
+            }
+            node.null = true;
+            break;
+
+        case RespValue::kBulkString:
+        case RespValue::kBulkError:
+        case RespValue::kVerbatimString:
+        {
+            int64_t length;
+            if (!parseInteger(content, contentLen, &length))
+            {
+                return fail("invalid bulk length");
+            }
+            if (length == -1 && type == RespValue::kBulkString)
+            {
+                node.null = true;
+                node.length = 0;
+                break;
+            }
+            if (length < 0 || static_cast<uint64_t>(length) > maxBulkLength_)
+            {
+                return fail("invalid bulk length");
+            }
+            node.length = 0;
+            pending_.push_back(node);
+            pos_ = scanOffset_ = next;
+            bulkRemaining_ = length;
+            continue;
+        }
+
+        case RespValue::kArray:
+        case RespValue::kMap:
+        case RespValue::kSet:
+        case RespValue::kAttribute:
+        case RespValue::kPush:
+        {
+            int64_t count;
+            if (!parseInteger(content, contentLen, &count))
+            {
+                return fail("invalid multibulk length");
+            }
+            node.length = 0;
+            if (count == -1 && type == RespValue::kArray)
+            {
+                node.null = true;
+                break;
+            }
+            if (count < 0 || static_cast<uint64_t>(count) > maxElements_)
+            {
+                return fail("invalid multibulk length");
+            }
+            node.integer = count;
+            pending_.push_back(node);
+            pos_ = scanOffset_ = next;
+            if (count > 0)
+            {
+                bool pairs = type == RespValue::kMap || type == RespValue::kAttribute;
+                stack_.push_back(Frame{pairs ? count * 2 : count, type == RespValue::kAttribute});
+            }
+            else if (type != RespValue::kAttribute && finishElement())
+            {
+                completeValue(base);
+                return kComplete;
+            }
+            continue;
+        }
+
+        default:
+            if (!topLevel)
+            {
+                return fail("unknown type byte");
+            }
+            // inline命令
+            if (parseInline(base, lineEnd))
+            {
+                pos_ = scanOffset_ = next;
+                completeValue(base);
+                return kComplete;
+            }
+            pos_ = scanOffset_ = next;
+            consumed_ = pos_;
+            continue;
+        }
+
+        pending_.push_back(node);
+        pos_ = scanOffset_ = next;
+        if (finishElement())
+        {
+            completeValue(base);
+            return kComplete;
+        }
+    }
+}
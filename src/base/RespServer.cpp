@@ -0,0 +1,151 @@
+#include "RespServer.h"
+#include "RespWriter.h"
+#include "TcpConnection.h"
+#include "Buffer.h"
+#include "Logger.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <strings.h>
+
+namespace
+{
+
+// 每个连接的解析状态，argv和commands在各批之间复用
+struct RespSession
+{
+    RespParser parser;
+    std::vector<std::string_view> argv;
+    std::vector<size_t> starts;
+    std::vector<RespCommand> commands;
+    int protocol = 2;
+};
+
+void defaultCommandBatchCallback(const TcpConnectionPtr&, const RespCommand* commands, size_t n, RespWriter* out)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        out->error("ERR unknown command '" + std::string(commands[i].name()) + "'");
+    }
+}
+
+} // namespace
+
+bool RespCommand::is(std::string_view name) const
+{
+    return argv[0].size() == name.size()
+        && ::strncasecmp(argv[0].data(), name.data(), name.size()) == 0;
+}
+
+RespServer::RespServer(EventLoop* loop,
+                       const InetAddress& listenAddr,
+                       TcpServer::Option option)
+    : server_(loop, listenAddr, option),
+      commandBatchCallback_(defaultCommandBatchCallback),
+      maxBulkLength_(RespParser::kDefaultMaxBulkLength),
+      maxElements_(RespParser::kDefaultMaxElements)
+{
+    server_.setConnectionCallback(
+        std::bind(&RespServer::onConnection, this, std::placeholders::_1));
+    server_.setMessageCallback(
+        std::bind(&RespServer::onMessage, this,
+                  std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+}
+
+void RespServer::start()
+{
+    server_.start();
+}
+
+void RespServer::onConnection(const TcpConnectionPtr& conn)
+{
+    if (conn->connected())
+    {
+        auto session = std::make_shared<RespSession>();
+        session->parser.setMaxBulkLength(maxBulkLength_);
+        session->parser.setMaxElements(maxElements_);
+        conn->setContext(session);
+    }
+}
+
+void RespServer::onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp)
+{
+    auto* sessionPtr = std::any_cast<std::shared_ptr<RespSession>>(conn->getMutableContext());
+    if (sessionPtr == nullptr || !conn->connected())
+    {
+        buf->retrieveAll();
+        return;
+    }
+    RespSession& session = **sessionPtr;
+    RespParser& parser = session.parser;
+
+    RespParser::Result result;
+    while ((result = parser.parse(buf)) == RespParser::kComplete)
+    {
+    }
+
+    // 把解析出的值转换成命令：每条命令必须是由字符串组成的非空数组
+    const char* protocolError = result == RespParser::kError ? parser.error() : nullptr;
+    const std::vector<RespValue>& values = parser.values();
+    session.argv.clear();
+    session.starts.clear();
+    session.commands.clear();
+    for (size_t i = 0; i < values.size() && protocolError == nullptr;)
+    {
+        const RespValue& value = values[i];
+        if (value.type != RespValue::kArray || value.null)
+        {
+            protocolError = "expected array of bulk strings";
+            break;
+        }
+        size_t argc = static_cast<size_t>(value.integer);
+        if (i + 1 + argc > values.size())
+        {
+            protocolError = "expected array of bulk strings";
+            break;
+        }
+        size_t start = session.argv.size();
+        for (size_t j = i + 1; j <= i + argc; ++j)
+        {
+            if ((values[j].type != RespValue::kBulkString && values[j].type != RespValue::kSimpleString)
+                || values[j].null)
+            {
+                protocolError = "expected array of bulk strings";
+                break;
+            }
+            session.argv.push_back(values[j].str);
+        }
+        if (protocolError == nullptr && argc > 0)
+        {
+            session.starts.push_back(start);
+            session.commands.push_back(RespCommand{nullptr, argc});
+        }
+        i += 1 + argc;
+    }
+    // argv全部填完后才取地址，避免扩容导致指针失效
+    for (size_t i = 0; i < session.commands.size(); ++i)
+    {
+        session.commands[i].argv = session.argv.data() + session.starts[i];
+    }
+
+    RespWriter writer(conn->outputBuffer(), session.protocol);
+    if (!session.commands.empty())
+    {
+        commandBatchCallback_(conn, session.commands.data(), session.commands.size(), &writer);
+        session.protocol = writer.protocol();
+    }
+    buf->retrieve(parser.consumed());
+    parser.clear();
+
+    if (protocolError != nullptr)
+    {
+        LOG_INFO("RespServer::onMessage protocol error from %s: %s", conn->name().c_str(), protocolError);
+        writer.error(std::string("ERR Protocol error: ") + protocolError);
+        conn->flushOutputBuffer();
+        buf->retrieveAll();
+        parser.reset();
+        conn->shutdown();
+        return;
+    }
+    conn->flushOutputBuffer();
+}
@@ -0,0 +1,134 @@
+#include "RespWriter.h"
+#include "Buffer.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+void RespWriter::appendHeader(char type, int64_t n)
+{
+    // 类型字节 + 最多20位数字 + CRLF
+    char buf[24];
+    buf[0] = type;
+    char* end = std::to_chars(buf + 1, buf + sizeof buf, n).ptr;
+    *end++ = '\r';
+    *end++ = '\n';
+    out_->append(buf, static_cast<size_t>(end - buf));
+}
+
+void RespWriter::ok()
+{
+    out_->append("+OK\r\n", 5);
+}
+
+void RespWriter::simpleString(std::string_view s)
+{
+    out_->append("+", 1);
+    out_->append(s.data(), s.size());
+    out_->append("\r\n", 2);
+}
+
+void RespWriter::error(std::string_view message)
+{
+    out_->append("-", 1);
+    out_->append(message.data(), message.size());
+    out_->append("\r\n", 2);
+}
+
+void RespWriter::integer(int64_t value)
+{
+    appendHeader(':', value);
+}
+
+void RespWriter::bulkString(std::string_view s)
+{
+    appendHeader('$', static_cast<int64_t>(s.size()));
+    out_->append(s.data(), s.size());
+    out_->append("\r\n", 2);
+}
+
+void RespWriter::null()
+{
+    if (protocol_ >= 3)
+    {
+        out_->append("_\r\n", 3);
+    }
+    else
+    {
+        out_->append("$-1\r\n", 5);
+    }
+}
+
+void RespWriter::nullArray()
+{
+    if (protocol_ >= 3)
+    {
+        out_->append("_\r\n", 3);
+    }
+    else
+    {
+        out_->append("*-1\r\n", 5);
+    }
+}
+
+void RespWriter::boolean(bool value)
+{
+    if (protocol_ >= 3)
+    {
+        out_->append(value ? "#t\r\n" : "#f\r\n", 4);
+    }
+    else
+    {
+        out_->append(value ? ":1\r\n" : ":0\r\n", 4);
+    }
+}
+
+void RespWriter::doubleValue(double value)
+{
+    char buf[64];
+    int n;
+    if (std::isinf(value))
+    {
+        n = snprintf(buf, sizeof buf, "%s", value > 0 ? "inf" : "-inf");
+    }
+    else
+    {
+        n = snprintf(buf, sizeof buf, "%.17g", value);
+    }
+    if (protocol_ >= 3)
+    {
+        out_->append(",", 1);
+        out_->append(buf, static_cast<size_t>(n));
+        out_->append("\r\n", 2);
+    }
+    else
+    {
+        bulkString(std::string_view(buf, static_cast<size_t>(n)));
+    }
+}
+
+void RespWriter::arrayHeader(size_t n)
+{
+    appendHeader('*', static_cast<int64_t>(n));
+}
+
+void RespWriter::setHeader(size_t n)
+{
+    appendHeader(protocol_ >= 3 ? '~' : '*', static_cast<int64_t>(n));
+}
+
+void RespWriter::mapHeader(size_t n)
+{
+    if (protocol_ >= 3)
+    {
+        appendHeader('%', static_cast<int64_t>(n));
+    }
+    else
+    {
+        appendHeader('*', static_cast<int64_t>(n * 2));
+    }
+}
+
+void RespWriter::pushHeader(size_t n)
+{
+    appendHeader(protocol_ >= 3 ? '>' : '*', static_cast<int64_t>(n));
+}
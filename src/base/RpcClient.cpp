@@ -0,0 +1,196 @@
+#include "RpcClient.h"
+#include "TcpConnection.h"
+#include "Eventloop.h"
+#include "Logger.h"
+
+RpcClient::RpcClient(EventLoop* loop, const InetAddress& serverAddr, const std::string& name)
+    : loop_(loop),
+      codec_(std::bind(&RpcClient::onFrame, this,
+                       std::placeholders::_1, std::placeholders::_2, std::placeholders::_3),
+             rpc::kLengthField),
+      defaultTimeout_(kDefaultTimeout),
+      nextId_(1),
+      flushScheduled_(false),
+      armedDeadline_(0),
+      alive_(std::make_shared<bool>(true)),
+      client_(loop, serverAddr, name)
+{
+    client_.setConnectionCallback(
+        std::bind(&RpcClient::onConnection, this, std::placeholders::_1));
+    client_.setMessageCallback(
+        std::bind(&LengthFieldCodec::onMessage, &codec_,
+                  std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+}
+
+RpcClient::~RpcClient()
+{
+    if (armedDeadline_ != 0)
+    {
+        loop_->cancel(deadlineTimer_);
+        armedDeadline_ = 0;
+    }
+    // 还没来得及发出的调用不会再flush，和已发出的一样以kConnectionClosed结束
+    std::vector<QueuedCall> calls;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        calls.swap(queued_);
+    }
+    for (QueuedCall& call : calls)
+    {
+        call.done(rpc::kConnectionClosed, "client destroyed");
+    }
+    failAll(rpc::kConnectionClosed);
+}
+
+bool RpcClient::connected() const
+{
+    TcpConnectionPtr conn = client_.connection();
+    return conn && conn->connected();
+}
+
+void RpcClient::call(std::string_view method, std::string_view request, Callback done, double timeout)
+{
+    if (timeout <= 0)
+    {
+        timeout = defaultTimeout_;
+    }
+    Timestamp deadline = addTime(Timestamp::now(), timeout);
+    uint32_t timeoutMs = static_cast<uint32_t>(timeout * 1000);
+
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t id = nextId_++;
+        rpc::encodeRequest(&outgoing_, id, timeoutMs, method, request);
+        queued_.push_back(QueuedCall{id, deadline.microSecondsSinceEpoch(), std::move(done)});
+        if (!flushScheduled_)
+        {
+            flushScheduled_ = schedule = true;
+        }
+    }
+    // 同一轮中后续的调用只追加到缓冲区，由这一次flush统一发出
+    if (schedule)
+    {
+        // RpcClient可能在flush执行之前析构
+        std::weak_ptr<bool> alive(alive_);
+        loop_->queueInLoop([this, alive]() {
+            if (alive.lock())
+            {
+                flushQueued();
+            }
+        });
+    }
+}
+
+void RpcClient::flushQueued()
+{
+    Buffer out;
+    std::vector<QueuedCall> calls;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(out, outgoing_);
+        calls.swap(queued_);
+        flushScheduled_ = false;
+    }
+
+    TcpConnectionPtr conn = client_.connection();
+    if (!conn || !conn->connected())
+    {
+        for (QueuedCall& call : calls)
+        {
+            call.done(rpc::kConnectionClosed, "not connected");
+        }
+        return;
+    }
+    for (QueuedCall& call : calls)
+    {
+        pending_.emplace(call.id, PendingCall{call.deadline, std::move(call.done)});
+        deadlines_.emplace(call.deadline, call.id);
+    }
+    armDeadlineTimer();
+    conn->send(&out);
+}
+
+void RpcClient::onFrame(const TcpConnectionPtr& conn, std::string_view frame, Timestamp)
+{
+    rpc::Response response;
+    if (!rpc::decodeResponse(frame, &response))
+    {
+        LOG_ERROR("RpcClient::onFrame malformed response from %s", conn->name().c_str());
+        conn->forceClose();
+        return;
+    }
+    auto it = pending_.find(response.id);
+    if (it == pending_.end())
+    {
+        // 已经超时的调用
+        return;
+    }
+    Callback done = std::move(it->second.done);
+    deadlines_.erase(std::make_pair(it->second.deadline, response.id));
+    pending_.erase(it);
+    done(response.status, response.payload);
+}
+
+void RpcClient::armDeadlineTimer()
+{
+    if (deadlines_.empty())
+    {
+        return;
+    }
+    int64_t earliest = deadlines_.begin()->first;
+    // 已注册的定时器更早到期，到期时会再为剩下的调用重新注册
+    if (armedDeadline_ != 0 && armedDeadline_ <= earliest)
+    {
+        return;
+    }
+    if (armedDeadline_ != 0)
+    {
+        loop_->cancel(deadlineTimer_);
+    }
+    armedDeadline_ = earliest;
+    deadlineTimer_ = loop_->runAt(Timestamp(earliest), std::bind(&RpcClient::onDeadlineTimer, this));
+}
+
+void RpcClient::onDeadlineTimer()
+{
+    armedDeadline_ = 0;
+    int64_t now = Timestamp::now().microSecondsSinceEpoch();
+    while (!deadlines_.empty() && deadlines_.begin()->first <= now)
+    {
+        uint64_t id = deadlines_.begin()->second;
+        deadlines_.erase(deadlines_.begin());
+        auto it = pending_.find(id);
+        if (it == pending_.end())
+        {
+            continue;
+        }
+        Callback done = std::move(it->second.done);
+        pending_.erase(it);
+        done(rpc::kDeadlineExceeded, "deadline exceeded");
+    }
+    armDeadlineTimer();
+}
+
+void RpcClient::failAll(rpc::Status status)
+{
+    std::unordered_map<uint64_t, PendingCall> pending;
+    pending.swap(pending_);
+    deadlines_.clear();
+    for (auto& entry : pending)
+    {
+        entry.second.done(status, "connection closed");
+    }
+}
+
+void RpcClient::onConnection(const TcpConnectionPtr& conn)
+{
+    if (!conn->connected())
+    {
+        failAll(rpc::kConnectionClosed);
+    }
+    if (connectionCallback_)
+    {
+        connectionCallback_(conn);
+    }
+}
@@ -0,0 +1,107 @@
+#include "RpcProtocol.h"
+#include "Buffer.h"
+
+namespace
+{
+
+bool readVarint(std::string_view* in, uint64_t* value)
+{
+    int n = Buffer::decodeVarint(in->data(), in->size(), value);
+    if (n <= 0)
+    {
+        return false;
+    }
+    in->remove_prefix(static_cast<size_t>(n));
+    return true;
+}
+
+} // namespace
+
+namespace rpc
+{
+
+const char* statusName(Status status)
+{
+    switch (status)
+    {
+    case kOk: return "OK";
+    case kMethodNotFound: return "METHOD_NOT_FOUND";
+    case kApplicationError: return "APPLICATION_ERROR";
+    case kDeadlineExceeded: return "DEADLINE_EXCEEDED";
+    case kConnectionClosed: return "CONNECTION_CLOSED";
+    }
+    return "UNKNOWN";
+}
+
+void encodeRequest(Buffer* out, uint64_t id, uint32_t timeoutMs, std::string_view method, std::string_view payload)
+{
+    // 先把定长部分编码到栈上，才能算出帧长
+    char header[1 + 3 * Buffer::kMaxVarintBytes];
+    size_t n = 0;
+    header[n++] = static_cast<char>(kRequest);
+    n += Buffer::encodeVarint(id, header + n);
+    n += Buffer::encodeVarint(timeoutMs, header + n);
+    n += Buffer::encodeVarint(method.size(), header + n);
+    out->appendVarint(n + method.size() + payload.size());
+    out->append(header, n);
+    out->append(method.data(), method.size());
+    out->append(payload.data(), payload.size());
+}
+
+void encodeResponse(Buffer* out, uint64_t id, Status status, std::string_view payload)
+{
+    char header[2 + Buffer::kMaxVarintBytes];
+    size_t n = 0;
+    header[n++] = static_cast<char>(kResponse);
+    n += Buffer::encodeVarint(id, header + n);
+    header[n++] = static_cast<char>(status);
+    out->appendVarint(n + payload.size());
+    out->append(header, n);
+    out->append(payload.data(), payload.size());
+}
+
+bool decodeRequest(std::string_view frame, Request* request)
+{
+    if (frame.empty() || static_cast<uint8_t>(frame[0]) != kRequest)
+    {
+        return false;
+    }
+    frame.remove_prefix(1);
+    uint64_t timeoutMs;
+    uint64_t methodLen;
+    if (!readVarint(&frame, &request->id)
+        || !readVarint(&frame, &timeoutMs)
+        || !readVarint(&frame, &methodLen)
+        || timeoutMs > UINT32_MAX
+        || methodLen > frame.size())
+    {
+        return false;
+    }
+    request->timeoutMs = static_cast<uint32_t>(timeoutMs);
+    request->method = frame.substr(0, static_cast<size_t>(methodLen));
+    request->payload = frame.substr(static_cast<size_t>(methodLen));
+    return true;
+}
+
+bool decodeResponse(std::string_view frame, Response* response)
+{
+    if (frame.empty() || static_cast<uint8_t>(frame[0]) != kResponse)
+    {
+        return false;
+    }
+    frame.remove_prefix(1);
+    if (!readVarint(&frame, &response->id) || frame.empty())
+    {
+        return false;
+    }
+    uint8_t status = static_cast<uint8_t>(frame[0]);
+    if (status > kConnectionClosed)
+    {
+        return false;
+    }
+    response->status = static_cast<Status>(status);
+    response->payload = frame.substr(1);
+    return true;
+}
+
+} // namespace rpc
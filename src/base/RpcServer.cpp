@@ -0,0 +1,108 @@
+#include "RpcServer.h"
+#include "TcpConnection.h"
+#include "Eventloop.h"
+#include "Buffer.h"
+#include "Logger.h"
+
+namespace
+{
+
+// 连接的context：标记当前是否在分发一批请求，分发期间的应答等整批结束后统一写出
+struct RpcConnectionState
+{
+    bool dispatching = false;
+};
+
+} // namespace
+
+void RpcResponder::reply(std::string_view response) const
+{
+    send(rpc::kOk, response);
+}
+
+void RpcResponder::fail(std::string_view message, rpc::Status status) const
+{
+    send(status, message);
+}
+
+void RpcResponder::send(rpc::Status status, std::string_view payload) const
+{
+    TcpConnectionPtr conn = conn_.lock();
+    if (!conn || !conn->connected())
+    {
+        return;
+    }
+    if (conn->getLoop()->isInLoopThread())
+    {
+        rpc::encodeResponse(conn->outputBuffer(), requestId_, status, payload);
+        auto* state = std::any_cast<std::shared_ptr<RpcConnectionState>>(conn->getMutableContext());
+        if (state == nullptr || !(*state)->dispatching)
+        {
+            conn->flushOutputBuffer();
+        }
+        return;
+    }
+    Buffer out;
+    rpc::encodeResponse(&out, requestId_, status, payload);
+    conn->send(&out);
+}
+
+RpcServer::RpcServer(EventLoop* loop,
+                     const InetAddress& listenAddr,
+                     TcpServer::Option option)
+    : server_(loop, listenAddr, option),
+      codec_([this](const TcpConnectionPtr& conn, const std::string_view* frames, size_t n, Timestamp t) {
+                 onFrames(conn, frames, n, t);
+             },
+             rpc::kLengthField)
+{
+    server_.setConnectionCallback(
+        std::bind(&RpcServer::onConnection, this, std::placeholders::_1));
+    server_.setMessageCallback(
+        std::bind(&LengthFieldCodec::onMessage, &codec_,
+                  std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+}
+
+void RpcServer::start()
+{
+    server_.start();
+}
+
+void RpcServer::onConnection(const TcpConnectionPtr& conn)
+{
+    if (conn->connected())
+    {
+        conn->setContext(std::make_shared<RpcConnectionState>());
+    }
+}
+
+void RpcServer::onFrames(const TcpConnectionPtr& conn, const std::string_view* frames, size_t n, Timestamp)
+{
+    auto* statePtr = std::any_cast<std::shared_ptr<RpcConnectionState>>(conn->getMutableContext());
+    if (statePtr == nullptr)
+    {
+        return;
+    }
+    std::shared_ptr<RpcConnectionState> state = *statePtr;
+    state->dispatching = true;
+    for (size_t i = 0; i < n; ++i)
+    {
+        rpc::Request request;
+        if (!rpc::decodeRequest(frames[i], &request))
+        {
+            LOG_ERROR("RpcServer::onFrames malformed request from %s", conn->name().c_str());
+            conn->forceClose();
+            break;
+        }
+        RpcResponder responder(conn, request.id, request.timeoutMs);
+        auto it = methods_.find(std::string(request.method));
+        if (it == methods_.end())
+        {
+            responder.fail("method not found", rpc::kMethodNotFound);
+            continue;
+        }
+        it->second(request.payload, responder);
+    }
+    state->dispatching = false;
+    conn->flushOutputBuffer();
+}
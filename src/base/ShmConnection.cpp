@@ -0,0 +1,645 @@
+#include "ShmConnection.h"
+#include "Channel.h"
+#include "Eventloop.h"
+#include "Logger.h"
+#include <algorithm>
+#include <new>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/**
+ * 一个方向的环在共享内存中的头部。head/tail只增不减，取模容量得到下标；
+ * 生产者和消费者各写自己的缓存行，避免两个进程互相使对方的缓存行失效
+ */
+struct ShmConnection::RingHeader
+{
+    alignas(64) std::atomic<uint64_t> head;     // 生产者写入位置
+    alignas(64) std::atomic<uint64_t> tail;     // 消费者读取位置
+    alignas(64) std::atomic<uint32_t> consumerWaiting;  // 消费者环空后在eventfd上等待
+    std::atomic<uint32_t> producerWaiting;      // 生产者环满后在eventfd上等待
+    std::atomic<uint32_t> producerClosed;       // 生产者不再写入
+    std::atomic<uint32_t> consumerClosed;       // 消费者不再读取
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+};
+
+namespace
+{
+
+const uint32_t kRingMagic = 0x52534852;     // "RHSR"
+const uint32_t kRingVersion = 1;
+// 两个环的头部放在第一页，数据区按页对齐
+const size_t kHeaderArea = 4096;
+const size_t kMinCapacity = 4096;
+const int kMaxFds = 8;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared memory ring requires address-free 64-bit atomics");
+
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+size_t roundUpCapacity(size_t capacity)
+{
+    size_t n = kMinCapacity;
+    while (n < capacity)
+    {
+        n <<= 1;
+    }
+    return n;
+}
+
+int createEventfdOrNull()
+{
+    int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG_ERROR("ShmConnection eventfd error:%d", errno);
+    }
+    return fd;
+}
+
+void writeEventfd(int fd)
+{
+    uint64_t one = 1;
+    ssize_t n = ::write(fd, &one, sizeof one);
+    if (n != sizeof one && errno != EAGAIN)
+    {
+        LOG_ERROR("ShmConnection write eventfd error:%d", errno);
+    }
+}
+
+} // namespace
+
+ShmConnectionPtr ShmConnection::create(EventLoop* loop, const std::string& name, size_t capacity)
+{
+    static_assert(sizeof(RingHeader) <= 256, "ring header must fit in 256 bytes");
+    capacity = roundUpCapacity(capacity);
+    size_t mapSize = kHeaderArea + 2 * capacity;
+
+    int memfd = ::memfd_create(("re_muduo_shm:" + name).c_str(), MFD_CLOEXEC);
+    if (memfd < 0)
+    {
+        LOG_ERROR("ShmConnection::create memfd_create error:%d", errno);
+        return nullptr;
+    }
+    if (::ftruncate(memfd, static_cast<off_t>(mapSize)) < 0)
+    {
+        LOG_ERROR("ShmConnection::create ftruncate error:%d", errno);
+        ::close(memfd);
+        return nullptr;
+    }
+    void* base = ::mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (base == MAP_FAILED)
+    {
+        LOG_ERROR("ShmConnection::create mmap error:%d", errno);
+        ::close(memfd);
+        return nullptr;
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+        RingHeader* header = new (static_cast<char*>(base) + i * 256) RingHeader();
+        header->magic = kRingMagic;
+        header->version = kRingVersion;
+        header->capacity = capacity;
+    }
+
+    int creatorEventfd = createEventfdOrNull();
+    int attacherEventfd = createEventfdOrNull();
+    if (creatorEventfd < 0 || attacherEventfd < 0)
+    {
+        if (creatorEventfd >= 0) ::close(creatorEventfd);
+        if (attacherEventfd >= 0) ::close(attacherEventfd);
+        ::munmap(base, mapSize);
+        ::close(memfd);
+        return nullptr;
+    }
+    return std::make_shared<ShmConnection>(loop, name, memfd, base, mapSize,
+                                           creatorEventfd, attacherEventfd, true);
+}
+
+ShmConnectionPtr ShmConnection::attach(EventLoop* loop, const std::string& name,
+                                       const std::vector<int>& fds)
+{
+    auto closeAll = [&fds]() {
+        for (int fd : fds)
+        {
+            ::close(fd);
+        }
+    };
+    if (fds.size() != 3)
+    {
+        LOG_ERROR("ShmConnection::attach expects 3 fds, got %zu", fds.size());
+        closeAll();
+        return nullptr;
+    }
+    struct stat st;
+    if (::fstat(fds[0], &st) < 0 || static_cast<size_t>(st.st_size) < kHeaderArea + 2 * kMinCapacity)
+    {
+        LOG_ERROR("ShmConnection::attach invalid memfd, errno=%d", errno);
+        closeAll();
+        return nullptr;
+    }
+    size_t mapSize = static_cast<size_t>(st.st_size);
+    void* base = ::mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    if (base == MAP_FAILED)
+    {
+        LOG_ERROR("ShmConnection::attach mmap error:%d", errno);
+        closeAll();
+        return nullptr;
+    }
+    const RingHeader* header = static_cast<const RingHeader*>(base);
+    // 容量来自对端写入的共享内存，必须是2的幂，环的下标计算依赖这一点
+    uint64_t capacity = header->capacity;
+    if (header->magic != kRingMagic || header->version != kRingVersion
+        || capacity < kMinCapacity || (capacity & (capacity - 1)) != 0
+        || kHeaderArea + 2 * capacity != mapSize)
+    {
+        LOG_ERROR("ShmConnection::attach ring layout mismatch, name=%s", name.c_str());
+        ::munmap(base, mapSize);
+        closeAll();
+        return nullptr;
+    }
+    // 接收方在自己的eventfd上等待，唤醒创建方
+    return std::make_shared<ShmConnection>(loop, name, fds[0], base, mapSize,
+                                           fds[2], fds[1], false);
+}
+
+bool ShmConnection::sendFds(int sockfd, const std::vector<int>& fds)
+{
+    if (fds.empty() || fds.size() > static_cast<size_t>(kMaxFds))
+    {
+        return false;
+    }
+    char byte = 'S';
+    iovec iov;
+    iov.iov_base = &byte;
+    iov.iov_len = 1;
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * fds.size()));
+
+    msghdr msg;
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+    memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+
+    ssize_t n;
+    do
+    {
+        n = ::sendmsg(sockfd, &msg, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    if (n != 1)
+    {
+        LOG_ERROR("ShmConnection::sendFds sendmsg error:%d", errno);
+        return false;
+    }
+    return true;
+}
+
+int ShmConnection::recvFds(int sockfd, std::vector<int>* fds)
+{
+    char byte;
+    iovec iov;
+    iov.iov_base = &byte;
+    iov.iov_len = 1;
+    char control[CMSG_SPACE(sizeof(int) * kMaxFds)];
+
+    msghdr msg;
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof control;
+
+    ssize_t n;
+    do
+    {
+        n = ::recvmsg(sockfd, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0)
+    {
+        return -1;
+    }
+
+    std::vector<int> received;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+        {
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const int* p = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+            received.insert(received.end(), p, p + count);
+        }
+    }
+    if (msg.msg_flags & MSG_CTRUNC)
+    {
+        LOG_ERROR("ShmConnection::recvFds control message truncated");
+        for (int fd : received)
+        {
+            ::close(fd);
+        }
+        return -1;
+    }
+    fds->insert(fds->end(), received.begin(), received.end());
+    return static_cast<int>(received.size());
+}
+
+ShmConnection::ShmConnection(EventLoop* loop, const std::string& name, int memfd,
+                             void* base, size_t mapSize, int localEventfd, int peerEventfd, bool creator)
+    : loop_(loop),
+      name_(name),
+      state_(kConnecting),
+      creator_(creator),
+      memfd_(memfd),
+      base_(base),
+      mapSize_(mapSize),
+      localEventfd_(localEventfd),
+      peerEventfd_(peerEventfd),
+      channel_(new Channel(loop, localEventfd)),
+      capacity_((mapSize - kHeaderArea) / 2),
+      cachedTxTail_(0),
+      spinCount_(0),
+      bytesSent_(0),
+      bytesReceived_(0),
+      notifies_(0),
+      notifiesSkipped_(0),
+      wakeups_(0)
+{
+    char* p = static_cast<char*>(base);
+    RingHeader* first = reinterpret_cast<RingHeader*>(p);
+    RingHeader* second = reinterpret_cast<RingHeader*>(p + 256);
+    char* firstData = p + kHeaderArea;
+    char* secondData = firstData + capacity_;
+    // 第一个环由创建方生产，第二个环由接收方生产
+    txHeader_ = creator ? first : second;
+    txData_ = creator ? firstData : secondData;
+    rxHeader_ = creator ? second : first;
+    rxData_ = creator ? secondData : firstData;
+    cachedTxTail_ = txHeader_->tail.load(std::memory_order_acquire);
+
+    channel_->setReadCallback(
+        std::bind(&ShmConnection::handleRead, this, std::placeholders::_1));
+    LOG_DEBUG("ShmConnection created, name=%s, capacity=%zu, creator=%d",
+              name_.c_str(), capacity_, creator_);
+}
+
+ShmConnection::~ShmConnection()
+{
+    if (state_ != kDisconnected)
+    {
+        // 未正常关闭就释放时也要让对端知道不会再有读写
+        txHeader_->producerClosed.store(1, std::memory_order_release);
+        rxHeader_->consumerClosed.store(1, std::memory_order_release);
+        writeEventfd(peerEventfd_);
+        if (state_ != kConnecting)
+        {
+            channel_->disableAll();
+            channel_->remove();
+        }
+    }
+    ::munmap(base_, mapSize_);
+    ::close(memfd_);
+    ::close(localEventfd_);
+    ::close(peerEventfd_);
+}
+
+std::vector<int> ShmConnection::exportFds() const
+{
+    int creatorEventfd = creator_ ? localEventfd_ : peerEventfd_;
+    int attacherEventfd = creator_ ? peerEventfd_ : localEventfd_;
+    return {memfd_, creatorEventfd, attacherEventfd};
+}
+
+void ShmConnection::start()
+{
+    ShmConnectionPtr self(shared_from_this());
+    loop_->runInLoop([self]() {
+        self->state_ = kConnected;
+        self->channel_->tie(self);
+        self->channel_->enableReading();
+        LOG_INFO("ShmConnection established: %s", self->name_.c_str());
+        if (self->connectionCallback_)
+        {
+            self->connectionCallback_(self);
+        }
+        // 对端可能在本端置上等待标志之前就写入了数据，这部分不会有通知，先主动处理一次
+        self->handleRead(Timestamp::now());
+    });
+}
+
+void ShmConnection::handleRead(Timestamp receiveTime)
+{
+    uint64_t counter = 0;
+    if (::read(localEventfd_, &counter, sizeof counter) == sizeof counter)
+    {
+        wakeups_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 对端腾出了空间
+    if (!outputBuffer_.empty())
+    {
+        flushOutput();
+    }
+
+    ShmConnectionPtr guardThis(shared_from_this());
+    while (state_ != kDisconnected)
+    {
+        size_t n = drain();
+        if (n > 0 && messageCallback_)
+        {
+            messageCallback_(guardThis, &inputBuffer_, receiveTime);
+            continue;
+        }
+
+        bool more = false;
+        for (int i = 0; i < spinCount_ && !more; ++i)
+        {
+            cpuRelax();
+            more = rxHeader_->head.load(std::memory_order_acquire)
+                   != rxHeader_->tail.load(std::memory_order_relaxed);
+        }
+        if (more)
+        {
+            continue;
+        }
+
+        // 先置等待标志再复查，生产者在此之前发布的数据由复查读到，之后发布的会看到标志并通知
+        rxHeader_->consumerWaiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (rxHeader_->head.load(std::memory_order_acquire)
+            == rxHeader_->tail.load(std::memory_order_relaxed))
+        {
+            break;
+        }
+        rxHeader_->consumerWaiting.store(0, std::memory_order_relaxed);
+    }
+
+    if (state_ != kDisconnected && peerClosed())
+    {
+        handleClose();
+    }
+}
+
+size_t ShmConnection::drain()
+{
+    uint64_t tail = rxHeader_->tail.load(std::memory_order_relaxed);
+    uint64_t head = rxHeader_->head.load(std::memory_order_acquire);
+    size_t n = static_cast<size_t>(head - tail);
+    if (n == 0)
+    {
+        return 0;
+    }
+    if (n > capacity_)
+    {
+        // 对端写坏了位置，按它拷贝会越过映射区
+        protocolError("ShmConnection::drain", head, tail);
+        return 0;
+    }
+    size_t capacity = capacity_;
+    size_t offset = static_cast<size_t>(tail & (capacity - 1));
+    size_t first = std::min(n, capacity - offset);
+    inputBuffer_.append(rxData_ + offset, first);
+    if (n > first)
+    {
+        inputBuffer_.append(rxData_, n - first);
+    }
+    rxHeader_->tail.store(head, std::memory_order_release);
+    bytesReceived_.fetch_add(n, std::memory_order_relaxed);
+    notifyPeer(rxHeader_->producerWaiting);
+    return n;
+}
+
+size_t ShmConnection::writeRing(const void* data, size_t len)
+{
+    size_t capacity = capacity_;
+    uint64_t head = txHeader_->head.load(std::memory_order_relaxed);
+    size_t space = capacity - static_cast<size_t>(head - cachedTxTail_);
+    if (space < len)
+    {
+        cachedTxTail_ = txHeader_->tail.load(std::memory_order_acquire);
+        if (head - cachedTxTail_ > capacity)
+        {
+            // 对端把读取位置移到了写入位置之前或之后太远，剩余空间无从计算
+            protocolError("ShmConnection::writeRing", head, cachedTxTail_);
+            return 0;
+        }
+        space = capacity - static_cast<size_t>(head - cachedTxTail_);
+    }
+    size_t n = std::min(len, space);
+    if (n == 0)
+    {
+        return 0;
+    }
+    const char* src = static_cast<const char*>(data);
+    size_t offset = static_cast<size_t>(head & (capacity - 1));
+    size_t first = std::min(n, capacity - offset);
+    memcpy(txData_ + offset, src, first);
+    if (n > first)
+    {
+        memcpy(txData_, src + first, n - first);
+    }
+    txHeader_->head.store(head + n, std::memory_order_release);
+    bytesSent_.fetch_add(n, std::memory_order_relaxed);
+    notifyPeer(txHeader_->consumerWaiting);
+    return n;
+}
+
+void ShmConnection::notifyPeer(std::atomic<uint32_t>& waiting)
+{
+    // 与对端“置标志后复查”配对：先发布位置再读标志，两边至少有一边能看到对方的写入
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed) != 0
+        && waiting.exchange(0, std::memory_order_acq_rel) != 0)
+    {
+        writeEventfd(peerEventfd_);
+        notifies_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        notifiesSkipped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ShmConnection::protocolError(const char* where, uint64_t head, uint64_t tail)
+{
+    LOG_ERROR("%s ring corrupted by peer, name=%s, head=%lu, tail=%lu, capacity=%zu",
+              where, name_.c_str(), head, tail, capacity_);
+    handleClose();
+}
+
+void ShmConnection::flushOutput()
+{
+    while (!outputBuffer_.empty())
+    {
+        size_t n = writeRing(outputBuffer_.peek(), outputBuffer_.readableBytes());
+        outputBuffer_.retrieve(n);
+        if (n > 0)
+        {
+            continue;
+        }
+        // 环满：置等待标志后再试一次，仍然写不进去就等对端读走数据后唤醒
+        txHeader_->producerWaiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        n = writeRing(outputBuffer_.peek(), outputBuffer_.readableBytes());
+        if (n == 0)
+        {
+            return;
+        }
+        outputBuffer_.retrieve(n);
+        txHeader_->producerWaiting.store(0, std::memory_order_relaxed);
+    }
+
+    if (writeCompleteCallback_)
+    {
+        loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+    }
+    if (state_ == kDisconnecting)
+    {
+        shutdownInLoop();
+    }
+}
+
+bool ShmConnection::peerClosed() const
+{
+    if (txHeader_->consumerClosed.load(std::memory_order_acquire))
+    {
+        return true;
+    }
+    return rxHeader_->producerClosed.load(std::memory_order_acquire)
+           && rxHeader_->head.load(std::memory_order_acquire)
+              == rxHeader_->tail.load(std::memory_order_relaxed);
+}
+
+void ShmConnection::handleClose()
+{
+    if (state_ == kDisconnected)
+    {
+        return;
+    }
+    state_ = kDisconnected;
+    txHeader_->producerClosed.store(1, std::memory_order_release);
+    rxHeader_->consumerClosed.store(1, std::memory_order_release);
+    writeEventfd(peerEventfd_);
+    channel_->disableAll();
+
+    ShmConnectionPtr guardThis(shared_from_this());
+    // 可能正处于本Channel的事件回调中，移除推迟到本轮事件处理之后
+    loop_->queueInLoop([guardThis]() { guardThis->channel_->remove(); });
+    LOG_INFO("ShmConnection closed: %s", name_.c_str());
+    if (connectionCallback_)
+    {
+        connectionCallback_(guardThis);
+    }
+    if (closeCallback_)
+    {
+        closeCallback_(guardThis);
+    }
+}
+
+void ShmConnection::send(const void* data, size_t len)
+{
+    if (state_ != kConnected)
+    {
+        return;
+    }
+    if (loop_->isInLoopThread())
+    {
+        sendInLoop(data, len);
+    }
+    else
+    {
+        std::string message(static_cast<const char*>(data), len);
+        ShmConnectionPtr self(shared_from_this());
+        loop_->runInLoop([self, message]() {
+            self->sendInLoop(message.data(), message.size());
+        });
+    }
+}
+
+void ShmConnection::send(const std::string& message)
+{
+    send(message.data(), message.size());
+}
+
+void ShmConnection::send(Buffer* message)
+{
+    send(message->peek(), message->readableBytes());
+    message->retrieveAll();
+}
+
+void ShmConnection::sendInLoop(const void* data, size_t len)
+{
+    if (state_ == kDisconnected)
+    {
+        LOG_ERROR("ShmConnection::sendInLoop disconnected, give up writing, name=%s", name_.c_str());
+        return;
+    }
+    size_t nwrote = 0;
+    bool wasEmpty = outputBuffer_.empty();
+    if (wasEmpty)
+    {
+        nwrote = writeRing(data, len);
+        if (nwrote == len)
+        {
+            if (writeCompleteCallback_)
+            {
+                loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+            }
+            return;
+        }
+    }
+    outputBuffer_.append(static_cast<const char*>(data) + nwrote, len - nwrote);
+    if (wasEmpty)
+    {
+        flushOutput();
+    }
+}
+
+void ShmConnection::shutdown()
+{
+    if (state_ == kConnected)
+    {
+        state_ = kDisconnecting;
+        ShmConnectionPtr self(shared_from_this());
+        loop_->runInLoop([self]() { self->shutdownInLoop(); });
+    }
+}
+
+void ShmConnection::shutdownInLoop()
+{
+    if (outputBuffer_.empty())
+    {
+        // 关闭是低频事件，不依赖等待标志，直接唤醒对端
+        txHeader_->producerClosed.store(1, std::memory_order_release);
+        writeEventfd(peerEventfd_);
+    }
+}
+
+void ShmConnection::forceClose()
+{
+    if (state_ == kConnected || state_ == kDisconnecting)
+    {
+        state_ = kDisconnecting;
+        ShmConnectionPtr self(shared_from_this());
+        loop_->queueInLoop([self]() { self->handleClose(); });
+    }
+}
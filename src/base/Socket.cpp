@@ -4,19 +4,48 @@
 #include <unistd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <netinet/tcp.h>
+#include <linux/filter.h>
 #include <string.h>
+#include <errno.h>
 
 Socket::~Socket()
 {
     close(sockfd_);
 }
 
+// 文件路径上是上次运行遗留的socket文件时删除，否则bind会失败。
+// 只删除socket文件，并且连接被拒绝（没有进程在监听）时才删除，不会抢走正在使用的地址
+static void removeStaleUnixSocket(const InetAddress &localaddr)
+{
+    std::string path = localaddr.unixPath();
+    struct stat st;
+    if (path.empty() || path[0] == '@' || ::lstat(path.c_str(), &st) != 0 || !S_ISSOCK(st.st_mode))
+    {
+        return;
+    }
+    int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0)
+    {
+        return;
+    }
+    if (::connect(probe, localaddr.getGenericSockAddr(), localaddr.getSockAddrLen()) != 0 && errno == ECONNREFUSED)
+    {
+        ::unlink(path.c_str());
+    }
+    ::close(probe);
+}
+
 void Socket::bindAddress(const InetAddress &localaddr)
 {
-    if (0 != bind(sockfd_, (sockaddr*)localaddr.getSockAddr(), sizeof(sockaddr_in)))
+    if (localaddr.isUnix())
     {
-        LOG_FATAL("bind sockfd:%d fail \n", sockfd_);
+        removeStaleUnixSocket(localaddr);
+    }
+    if (0 != bind(sockfd_, localaddr.getGenericSockAddr(), localaddr.getSockAddrLen()))
+    {
+        LOG_FATAL("bind sockfd:%d to %s fail, errno=%d \n", sockfd_, localaddr.toIpPort().c_str(), errno);
     }
 }
 
@@ -36,13 +65,13 @@ int Socket::accept(InetAddress *peeraddr)
      * 这样accept返回的socket会自动设置为非阻塞和close-on-exec
      * 避免了额外的fcntl系统调用，提高了性能
      */
-    sockaddr_in addr;
+    sockaddr_storage addr;
     socklen_t len = sizeof addr;
     bzero(&addr, sizeof addr);
     int connfd = ::accept4(sockfd_, (sockaddr*)&addr, &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
     if (connfd >= 0)
     {
-        peeraddr->setSockAddr(addr);
+        *peeraddr = InetAddress((sockaddr*)&addr, len);
     }
     return connfd;
 }
@@ -79,13 +108,94 @@ void Socket::setKeepAlive(bool on)
     ::setsockopt(sockfd_, SOL_SOCKET, SO_KEEPALIVE, &optval, sizeof optval);
 }
 
+bool Socket::setReusePortCpuFilter(int groupSize)
+{
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+    if (groupSize <= 0)
+    {
+        return false;
+    }
+    // A = 当前CPU; A = A % groupSize; return A
+    struct sock_filter code[] = {
+        { BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<__u32>(SKF_AD_OFF + SKF_AD_CPU) },
+        { BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<__u32>(groupSize) },
+        { BPF_RET | BPF_A, 0, 0, 0 },
+    };
+    struct sock_fprog prog;
+    prog.len = sizeof(code) / sizeof(code[0]);
+    prog.filter = code;
+    if (::setsockopt(sockfd_, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof prog) < 0)
+    {
+        LOG_ERROR("setReusePortCpuFilter sockfd:%d fail, errno=%d", sockfd_, errno);
+        return false;
+    }
+    return true;
+#else
+    (void)groupSize;
+    return false;
+#endif
+}
+
 InetAddress Socket::getLocalAddr(int sockfd)
 {
-    sockaddr_in localaddr;
+    sockaddr_storage localaddr;
     socklen_t addrlen = sizeof(localaddr);
+    bzero(&localaddr, sizeof localaddr);
     if (::getsockname(sockfd, (sockaddr*)&localaddr, &addrlen) < 0)
     {
         LOG_ERROR("getLocalAddr error");
     }
-    return InetAddress(localaddr);
+    return InetAddress((sockaddr*)&localaddr, addrlen);
+}
+
+InetAddress Socket::getPeerAddr(int sockfd)
+{
+    sockaddr_storage peeraddr;
+    socklen_t addrlen = sizeof(peeraddr);
+    bzero(&peeraddr, sizeof peeraddr);
+    if (::getpeername(sockfd, (sockaddr*)&peeraddr, &addrlen) < 0)
+    {
+        LOG_ERROR("getPeerAddr error");
+    }
+    return InetAddress((sockaddr*)&peeraddr, addrlen);
+}
+
+int Socket::getSocketError(int sockfd)
+{
+    int optval = 0;
+    socklen_t optlen = sizeof optval;
+    if (::getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &optval, &optlen) < 0)
+    {
+        return errno;
+    }
+    return optval;
+}
+
+bool Socket::isSelfConnect(int sockfd)
+{
+    InetAddress localaddr = getLocalAddr(sockfd);
+    InetAddress peeraddr = getPeerAddr(sockfd);
+    // Unix域socket不存在自连接
+    if (localaddr.family() != AF_INET || peeraddr.family() != AF_INET)
+    {
+        return false;
+    }
+    return localaddr.getSockAddr()->sin_port == peeraddr.getSockAddr()->sin_port
+        && localaddr.getSockAddr()->sin_addr.s_addr == peeraddr.getSockAddr()->sin_addr.s_addr;
+}
+
+int Socket::getIncomingCpu(int sockfd)
+{
+#ifdef SO_INCOMING_CPU
+    int cpu = -1;
+    socklen_t len = sizeof cpu;
+    if (::getsockopt(sockfd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) < 0)
+    {
+        return -1;
+    }
+    return cpu;
+#else
+    (void)sockfd;
+    return -1;
+#endif
 }
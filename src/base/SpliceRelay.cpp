@@ -0,0 +1,359 @@
+#include "SpliceRelay.h"
+#include "TcpConnection.h"
+#include "Eventloop.h"
+#include "Logger.h"
+#include <vector>
+#include <utility>
+#include <cassert>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+
+const int kPipeCapacity = 64 * 1024;
+const size_t kMaxIdlePipes = 32;
+// 单次事件中每个方向最多搬运的轮数，避免一对高速连接饿死同一loop上的其他连接
+const int kMaxRounds = 16;
+
+/**
+ * 每个IO线程一个管道池（一个线程只运行一个EventLoop，即每个loop一个），
+ * 只缓存已经排空的管道，避免每次建立转发都创建/销毁管道
+ */
+class PipePool : noncopyable
+{
+public:
+    ~PipePool()
+    {
+        for (auto &p : idle_)
+        {
+            ::close(p.first);
+            ::close(p.second);
+        }
+    }
+
+    bool acquire(int *readFd, int *writeFd)
+    {
+        if (!idle_.empty())
+        {
+            *readFd = idle_.back().first;
+            *writeFd = idle_.back().second;
+            idle_.pop_back();
+            return true;
+        }
+        int fds[2];
+        if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0)
+        {
+            LOG_ERROR("PipePool::acquire pipe2 error:%d", errno);
+            return false;
+        }
+        ::fcntl(fds[1], F_SETPIPE_SZ, kPipeCapacity);
+        *readFd = fds[0];
+        *writeFd = fds[1];
+        return true;
+    }
+
+    // 管道中还有残留数据时不能复用，直接关闭
+    void release(int readFd, int writeFd, bool empty)
+    {
+        if (readFd < 0)
+        {
+            return;
+        }
+        if (empty && idle_.size() < kMaxIdlePipes)
+        {
+            idle_.emplace_back(readFd, writeFd);
+        }
+        else
+        {
+            ::close(readFd);
+            ::close(writeFd);
+        }
+    }
+
+    static PipePool &forThisLoop()
+    {
+        static thread_local PipePool pool;
+        return pool;
+    }
+
+private:
+    std::vector<std::pair<int, int>> idle_;
+};
+
+}
+
+SpliceRelay::RelayPtr SpliceRelay::start(const TcpConnectionPtr &a, const TcpConnectionPtr &b)
+{
+    RelayPtr relay(std::make_shared<SpliceRelay>(a, b));
+    relay->loop_->runInLoop(std::bind(&SpliceRelay::startInLoop, relay));
+    return relay;
+}
+
+SpliceRelay::SpliceRelay(const TcpConnectionPtr &a, const TcpConnectionPtr &b)
+    : loop_(a->getLoop()),
+      finished_(false)
+{
+    assert(a->getLoop() == b->getLoop());
+    dirs_[0].from = a;
+    dirs_[0].to = b;
+    dirs_[1].from = b;
+    dirs_[1].to = a;
+}
+
+SpliceRelay::~SpliceRelay()
+{
+    // 正常结束时管道已经归还给管道池，这里只处理未能启动的情况
+    for (Direction &d : dirs_)
+    {
+        if (d.pipeRead >= 0)
+        {
+            ::close(d.pipeRead);
+            ::close(d.pipeWrite);
+        }
+    }
+}
+
+void SpliceRelay::startInLoop()
+{
+    loop_->assertInLoopThread();
+    PipePool &pool = PipePool::forThisLoop();
+    for (Direction &d : dirs_)
+    {
+        if (!pool.acquire(&d.pipeRead, &d.pipeWrite))
+        {
+            abort();
+            return;
+        }
+        // 先发目的端发送缓冲区中尚未写出的数据，再发源端已经读入的数据
+        Buffer *pending = d.to->outputBuffer();
+        d.head.append(pending->peek(), pending->readableBytes());
+        pending->retrieveAll();
+        Buffer *input = d.from->inputBuffer();
+        d.head.append(input->peek(), input->readableBytes());
+        input->retrieveAll();
+    }
+
+    RelayPtr self(shared_from_this());
+    TcpConnectionPtr a = dirs_[0].from;
+    TcpConnectionPtr b = dirs_[1].from;
+    a->setRawHandlers([self]() { self->pump(self->dirs_[0]); },
+                      [self]() { self->pump(self->dirs_[1]); },
+                      [self]() { self->handleClose(0); });
+    b->setRawHandlers([self]() { self->pump(self->dirs_[1]); },
+                      [self]() { self->pump(self->dirs_[0]); },
+                      [self]() { self->handleClose(1); });
+
+    if (a->disconnected())
+    {
+        handleClose(0);
+    }
+    if (b->disconnected())
+    {
+        handleClose(1);
+    }
+    pump(dirs_[0]);
+    pump(dirs_[1]);
+}
+
+bool SpliceRelay::flushHead(Direction &d)
+{
+    while (d.head.readableBytes() > 0)
+    {
+        ssize_t n = ::write(d.to->fd(), d.head.peek(), d.head.readableBytes());
+        if (n > 0)
+        {
+            d.head.retrieve(n);
+            d.bytes += n;
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        else if (errno == EAGAIN)
+        {
+            return false;
+        }
+        else
+        {
+            LOG_ERROR("SpliceRelay::flushHead write error, name=%s, errno=%d", d.to->name().c_str(), errno);
+            abort();
+            return false;
+        }
+    }
+    return true;
+}
+
+void SpliceRelay::pump(Direction &d)
+{
+    if (finished_ || d.done)
+    {
+        return;
+    }
+    // 目的端只有写出没有读入，由relay替它刷新空闲定时器
+    size_t bytesBefore = d.bytes;
+    if (!flushHead(d))
+    {
+        if (!finished_)
+        {
+            if (d.bytes != bytesBefore && d.to->connected())
+            {
+                d.to->resetIdleTimer();
+            }
+            updateInterest();
+        }
+        return;
+    }
+
+    for (int round = 0; round < kMaxRounds; ++round)
+    {
+        // 先排空管道，目的端写不动时停在这里，等待可写事件
+        while (d.inPipe > 0)
+        {
+            ssize_t n = ::splice(d.pipeRead, nullptr, d.to->fd(), nullptr, d.inPipe,
+                                 SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (n > 0)
+            {
+                d.inPipe -= n;
+                d.bytes += n;
+            }
+            else if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            else if (n < 0 && errno == EAGAIN)
+            {
+                break;
+            }
+            else
+            {
+                LOG_ERROR("SpliceRelay::pump splice to %s error:%d", d.to->name().c_str(), errno);
+                abort();
+                return;
+            }
+        }
+        if (d.inPipe > 0 || d.eof)
+        {
+            break;
+        }
+
+        ssize_t n = ::splice(d.from->fd(), nullptr, d.pipeWrite, nullptr, kPipeCapacity,
+                             SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n > 0)
+        {
+            d.inPipe += n;
+        }
+        else if (n == 0)
+        {
+            d.eof = true;
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        else if (errno == EAGAIN)
+        {
+            break;
+        }
+        else
+        {
+            LOG_ERROR("SpliceRelay::pump splice from %s error:%d", d.from->name().c_str(), errno);
+            abort();
+            return;
+        }
+    }
+
+    if (d.bytes != bytesBefore && !finished_ && d.to->connected())
+    {
+        d.to->resetIdleTimer();
+    }
+    if (d.eof && d.inPipe == 0)
+    {
+        // 源端已关闭写方向且数据已全部送达，把半关闭传递给目的端
+        d.done = true;
+        d.to->enableRawWriting(false);
+        d.to->shutdown();
+    }
+    if (dirs_[0].done && dirs_[1].done)
+    {
+        finish();
+        return;
+    }
+    updateInterest();
+}
+
+void SpliceRelay::updateInterest()
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        const Direction &out = dirs_[i];       // 以该连接为源的方向
+        const Direction &in = dirs_[1 - i];    // 以该连接为目的的方向
+        const TcpConnectionPtr &conn = out.from;
+        bool backlog = out.inPipe > 0 || out.head.readableBytes() > 0;
+        conn->enableRawReading(!out.done && !out.eof && !backlog);
+        conn->enableRawWriting(!in.done && (in.inPipe > 0 || in.head.readableBytes() > 0));
+    }
+}
+
+void SpliceRelay::handleClose(int side)
+{
+    if (finished_)
+    {
+        return;
+    }
+    LOG_DEBUG("SpliceRelay::handleClose %s", dirs_[side].from->name().c_str());
+    // 该连接已经关闭：发往它的方向直接结束，从它读出的方向把管道中剩余的数据送完再结束
+    dirs_[1 - side].done = true;
+    dirs_[side].eof = true;
+    pump(dirs_[side]);
+    if (!finished_ && dirs_[0].done && dirs_[1].done)
+    {
+        finish();
+    }
+}
+
+void SpliceRelay::abort()
+{
+    for (Direction &d : dirs_)
+    {
+        d.done = true;
+    }
+    finish();
+}
+
+void SpliceRelay::finish()
+{
+    if (finished_)
+    {
+        return;
+    }
+    finished_ = true;
+    LOG_DEBUG("SpliceRelay finished, %s->%s %zu bytes, %s->%s %zu bytes",
+              dirs_[0].from->name().c_str(), dirs_[0].to->name().c_str(), dirs_[0].bytes,
+              dirs_[1].from->name().c_str(), dirs_[1].to->name().c_str(), dirs_[1].bytes);
+    for (Direction &d : dirs_)
+    {
+        d.from->forceClose();
+    }
+    // 当前可能正在某个原始IO回调中执行，延后解除连接对relay的引用
+    RelayPtr self(shared_from_this());
+    loop_->queueInLoop([self]() {
+        for (Direction &d : self->dirs_)
+        {
+            d.from->setRawHandlers(nullptr, nullptr, nullptr);
+        }
+        self->releasePipes();
+    });
+}
+
+void SpliceRelay::releasePipes()
+{
+    PipePool &pool = PipePool::forThisLoop();
+    for (Direction &d : dirs_)
+    {
+        pool.release(d.pipeRead, d.pipeWrite, d.inPipe == 0);
+        d.pipeRead = -1;
+        d.pipeWrite = -1;
+    }
+}
@@ -0,0 +1,133 @@
+#include "TcpClient.h"
+#include "TcpConnection.h"
+#include "Eventloop.h"
+#include "Socket.h"
+#include "Logger.h"
+#include <stdio.h>
+#include <cassert>
+
+using namespace std::placeholders;
+
+namespace
+{
+
+void removeConnection(EventLoop *loop, const TcpConnectionPtr &conn)
+{
+    loop->queueInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
+}
+
+void removeConnector(const ConnectorPtr &connector)
+{
+    (void)connector;
+}
+
+}
+
+TcpClient::TcpClient(EventLoop *loop, const InetAddress &serverAddr, const std::string &name)
+    : loop_(loop),
+      connector_(new Connector(loop, serverAddr)),
+      name_(name),
+      connectionCallback_([](const TcpConnectionPtr &) {}),
+      messageCallback_([](const TcpConnectionPtr &, Buffer *buf, Timestamp) { buf->retrieveAll(); }),
+      retry_(false),
+      connect_(true),
+      nextConnId_(1)
+{
+    connector_->setNewConnectionCallback(std::bind(&TcpClient::newConnection, this, _1));
+    LOG_INFO("TcpClient::TcpClient[%s] - connector %p", name_.c_str(), connector_.get());
+}
+
+TcpClient::~TcpClient()
+{
+    LOG_INFO("TcpClient::~TcpClient[%s] - connector %p", name_.c_str(), connector_.get());
+    TcpConnectionPtr conn;
+    bool unique = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        unique = connection_.use_count() == 1;
+        conn = connection_;
+    }
+    if (conn)
+    {
+        assert(loop_ == conn->getLoop());
+        // 连接可能比TcpClient活得久，关闭回调改为直接销毁连接，不再访问this
+        CloseCallback cb = std::bind(&::removeConnection, loop_, _1);
+        loop_->runInLoop([conn, cb]() { conn->setCloseCallback(cb); });
+        if (unique)
+        {
+            conn->forceClose();
+        }
+    }
+    else
+    {
+        connector_->stop();
+        // 等待stopInLoop执行完后再释放connector
+        loop_->runAfter(1, std::bind(&::removeConnector, connector_));
+    }
+}
+
+void TcpClient::connect()
+{
+    LOG_INFO("TcpClient::connect[%s] - connecting to %s", name_.c_str(),
+             connector_->serverAddress().toIpPort().c_str());
+    connect_ = true;
+    connector_->start();
+}
+
+void TcpClient::disconnect()
+{
+    connect_ = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (connection_)
+        {
+            connection_->shutdown();
+        }
+    }
+}
+
+void TcpClient::stop()
+{
+    connect_ = false;
+    connector_->stop();
+}
+
+void TcpClient::newConnection(int sockfd)
+{
+    loop_->assertInLoopThread();
+    InetAddress peerAddr(Socket::getPeerAddr(sockfd));
+    // Unix域地址的路径可能很长，不能写进定长缓冲区，否则截断后连接名会重复
+    std::string connName = name_ + ":" + peerAddr.toIpPort() + "#" + std::to_string(nextConnId_);
+    ++nextConnId_;
+
+    InetAddress localAddr(Socket::getLocalAddr(sockfd));
+    TcpConnectionPtr conn(new TcpConnection(loop_, connName, sockfd, localAddr, peerAddr));
+    conn->setConnectionCallback(connectionCallback_);
+    conn->setMessageCallback(messageCallback_);
+    conn->setWriteCompleteCallback(writeCompleteCallback_);
+    conn->setCloseCallback(std::bind(&TcpClient::removeConnection, this, _1));
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        connection_ = conn;
+    }
+    conn->connectEstablished();
+}
+
+void TcpClient::removeConnection(const TcpConnectionPtr &conn)
+{
+    loop_->assertInLoopThread();
+    assert(loop_ == conn->getLoop());
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        assert(connection_ == conn);
+        connection_.reset();
+    }
+
+    loop_->queueInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
+    if (retry_ && connect_)
+    {
+        LOG_INFO("TcpClient::removeConnection[%s] - reconnecting to %s", name_.c_str(),
+                 connector_->serverAddress().toIpPort().c_str());
+        connector_->restart();
+    }
+}
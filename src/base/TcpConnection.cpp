@@ -8,6 +8,9 @@
 #include <unistd.h>
 #include <errno.h>
 #include <functional>
+#include <algorithm>
+#include <climits>
+#include <sys/uio.h>
 
 TcpConnection::TcpConnection(EventLoop* loop,
                              const std::string& name,
@@ -22,6 +25,7 @@ TcpConnection::TcpConnection(EventLoop* loop,
       peerAddr_(peerAddr),
       state_(kConnecting),
       highWaterMark_(64*1024*1024),
+      aboveHighWaterMark_(false),
       idleTimeout_(0),
       keepAliveInterval_(30),
       keepAliveEnabled_(false),
@@ -66,6 +70,20 @@ void TcpConnection::connectDestroyed()
 
 void TcpConnection::handleRead(Timestamp receiveTime)
 {
+    if (rawReadHandler_)
+    {
+        rawReadHandler_();
+        // 数据由原始处理器直接搬走，这里同样算作一次活动，否则正在转发的连接会被当成空闲关闭
+        if (state_ == kConnected)
+        {
+            if (idleTimeout_ > 0)
+            {
+                resetIdleTimer();
+            }
+            lastActivityTime_ = receiveTime;
+        }
+        return;
+    }
     int savedErrno = 0;
     ssize_t n = inputBuffer_.readFd(channel_->fd(), &savedErrno);
     if (n > 0)
@@ -93,6 +111,11 @@ void TcpConnection::handleRead(Timestamp receiveTime)
 
 void TcpConnection::handleWrite()
 {
+    if (rawWriteHandler_)
+    {
+        rawWriteHandler_();
+        return;
+    }
     if (channel_->isWriting())
     {
         ssize_t n = ::write(channel_->fd(),
@@ -101,6 +124,10 @@ void TcpConnection::handleWrite()
         if (n > 0)
         {
             outputBuffer_.retrieve(n);
+            if (outputBuffer_.readableBytes() < highWaterMark_)
+            {
+                aboveHighWaterMark_ = false;
+            }
             if (outputBuffer_.readableBytes() == 0)
             {
                 channel_->disableWriting();
@@ -117,10 +144,11 @@ void TcpConnection::handleWrite()
         }
         else
         {
-            if (errno != EWOULDBLOCK)
+            int savedErrno = errno;
+            if (savedErrno != EWOULDBLOCK)
             {
-                LOG_ERROR("TcpConnection::handleWrite write error, name=%s, errno=%d", name_.c_str(), errno);
-                if (errno == EPIPE || errno == ECONNRESET)
+                LOG_EVERY_MS(ERROR, 1000, "TcpConnection::handleWrite write error, name=%s, errno=%d", name_.c_str(), savedErrno);
+                if (savedErrno == EPIPE || savedErrno == ECONNRESET)
                 {
                     handleClose();
                 }
@@ -129,7 +157,7 @@ void TcpConnection::handleWrite()
     }
     else
     {
-        LOG_INFO("handleWrite called but channel is not writing, name=%s", name_.c_str());
+        LOG_DEBUG("handleWrite called but channel is not writing, name=%s", name_.c_str());
     }
 }
 
@@ -153,6 +181,10 @@ void TcpConnection::handleClose()
     }
     
     TcpConnectionPtr guardThis(shared_from_this());
+    if (rawCloseHandler_)
+    {
+        rawCloseHandler_();
+    }
     connectionCallback_(guardThis);
     closeCallback_(guardThis);
     
@@ -166,7 +198,7 @@ void TcpConnection::handleError()
     {
         err = errno;
     }
-    LOG_ERROR("TcpConnection::handleError, name=%s, errno=%d", name_.c_str(), err);
+    LOG_EVERY_MS(ERROR, 1000, "TcpConnection::handleError, name=%s, errno=%d", name_.c_str(), err);
 }
 
 void TcpConnection::send(const std::string& message)
@@ -209,6 +241,149 @@ void TcpConnection::send(Buffer* message)
     }
 }
 
+void TcpConnection::sendv(const struct iovec* iov, int iovcnt)
+{
+    if (state_ == kConnected)
+    {
+        if (loop_->isInLoopThread())
+        {
+            sendvInLoop(iov, iovcnt);
+        }
+        else
+        {
+            std::string message;
+            for (int i = 0; i < iovcnt; ++i)
+            {
+                message.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+            }
+            void (TcpConnection::*fp)(const std::string&) = &TcpConnection::sendInLoop;
+            loop_->runInLoop(
+                std::bind(fp,
+                         this,
+                         message));
+        }
+    }
+}
+
+void TcpConnection::sendvInLoop(const struct iovec* iov, int iovcnt)
+{
+    if (state_ == kDisconnected)
+    {
+        LOG_INFO("TcpConnection::sendvInLoop, connection disconnected, name=%s", name_.c_str());
+        return;
+    }
+
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; ++i)
+    {
+        total += iov[i].iov_len;
+    }
+
+    size_t nwrote = 0;
+    if (!channel_->isWriting() && outputBuffer_.readableBytes() == 0)
+    {
+        ssize_t n = ::writev(channel_->fd(), iov, std::min(iovcnt, IOV_MAX));
+        if (n >= 0)
+        {
+            nwrote = static_cast<size_t>(n);
+            if (nwrote == total && writeCompleteCallback_)
+            {
+                loop_->queueInLoop(
+                    std::bind(writeCompleteCallback_, shared_from_this()));
+            }
+        }
+        else if (errno != EWOULDBLOCK)
+        {
+            int savedErrno = errno;
+            LOG_EVERY_MS(ERROR, 1000, "TcpConnection::sendvInLoop writev error, name=%s, errno=%d", name_.c_str(), savedErrno);
+            if (savedErrno == EPIPE || savedErrno == ECONNRESET)
+            {
+                return;
+            }
+        }
+    }
+
+    size_t remaining = total - nwrote;
+    if (remaining > 0)
+    {
+        size_t oldLen = outputBuffer_.readableBytes();
+        if (oldLen + remaining >= highWaterMark_
+            && oldLen < highWaterMark_
+            && highWaterMarkCallback_)
+        {
+            aboveHighWaterMark_ = true;
+            loop_->queueInLoop(
+                std::bind(highWaterMarkCallback_, shared_from_this(), oldLen + remaining));
+        }
+        // 跳过已经写出的部分，其余各段依次追加
+        size_t skip = nwrote;
+        for (int i = 0; i < iovcnt; ++i)
+        {
+            if (skip >= iov[i].iov_len)
+            {
+                skip -= iov[i].iov_len;
+                continue;
+            }
+            outputBuffer_.append(static_cast<const char*>(iov[i].iov_base) + skip, iov[i].iov_len - skip);
+            skip = 0;
+        }
+        if (!channel_->isWriting())
+        {
+            channel_->enableWriting();
+        }
+    }
+}
+
+void TcpConnection::flushOutputBuffer()
+{
+    loop_->assertInLoopThread();
+    if (state_ == kDisconnected || outputBuffer_.readableBytes() == 0)
+    {
+        return;
+    }
+
+    // 已经在等可写事件时不抢先写，保持数据顺序，只检查水位线
+    if (!channel_->isWriting())
+    {
+        ssize_t n = ::write(channel_->fd(), outputBuffer_.peek(), outputBuffer_.readableBytes());
+        if (n >= 0)
+        {
+            outputBuffer_.retrieve(static_cast<size_t>(n));
+            if (outputBuffer_.readableBytes() == 0 && writeCompleteCallback_)
+            {
+                loop_->queueInLoop(
+                    std::bind(writeCompleteCallback_, shared_from_this()));
+            }
+        }
+        else if (errno != EWOULDBLOCK)
+        {
+            int savedErrno = errno;
+            LOG_EVERY_MS(ERROR, 1000, "TcpConnection::flushOutputBuffer write error, name=%s, errno=%d", name_.c_str(), savedErrno);
+            if (savedErrno == EPIPE || savedErrno == ECONNRESET)
+            {
+                return;
+            }
+        }
+    }
+
+    // 应用直接追加数据，拿不到追加前的长度，用aboveHighWaterMark_保证只在越过水位线时回调一次
+    size_t remaining = outputBuffer_.readableBytes();
+    if (remaining < highWaterMark_)
+    {
+        aboveHighWaterMark_ = false;
+    }
+    else if (!aboveHighWaterMark_ && highWaterMarkCallback_)
+    {
+        aboveHighWaterMark_ = true;
+        loop_->queueInLoop(
+            std::bind(highWaterMarkCallback_, shared_from_this(), remaining));
+    }
+    if (remaining > 0 && !channel_->isWriting())
+    {
+        channel_->enableWriting();
+    }
+}
+
 void TcpConnection::sendInLoop(const std::string& message)
 {
     sendInLoop(message.data(), message.size());
@@ -241,10 +416,11 @@ void TcpConnection::sendInLoop(const void* data, size_t len)
         else
         {
             nwrote = 0;
-            if (errno != EWOULDBLOCK)
+            int savedErrno = errno;
+            if (savedErrno != EWOULDBLOCK)
             {
-                LOG_ERROR("TcpConnection::sendInLoop write error, name=%s, errno=%d", name_.c_str(), errno);
-                if (errno == EPIPE || errno == ECONNRESET)
+                LOG_EVERY_MS(ERROR, 1000, "TcpConnection::sendInLoop write error, name=%s, errno=%d", name_.c_str(), savedErrno);
+                if (savedErrno == EPIPE || savedErrno == ECONNRESET)
                 {
                     faultError = true;
                 }
@@ -255,14 +431,15 @@ void TcpConnection::sendInLoop(const void* data, size_t len)
     if (!faultError && remaining > 0)
     {
         size_t oldLen = outputBuffer_.readableBytes();
-        LOG_INFO("TcpConnection::sendInLoop, name=%s, oldLen=%zu, remaining=%zu, highWaterMark_=%zu",
+        LOG_DEBUG("TcpConnection::sendInLoop, name=%s, oldLen=%zu, remaining=%zu, highWaterMark_=%zu",
                   name_.c_str(), oldLen, remaining, highWaterMark_);
         if (oldLen + remaining >= highWaterMark_
             && oldLen < highWaterMark_
             && highWaterMarkCallback_)
         {
-            LOG_INFO("TcpConnection::sendInLoop, high water mark reached, name=%s, size=%zu",
-                     name_.c_str(), oldLen + remaining);
+            LOG_DEBUG("TcpConnection::sendInLoop, high water mark reached, name=%s, size=%zu",
+                      name_.c_str(), oldLen + remaining);
+            aboveHighWaterMark_ = true;
             loop_->queueInLoop(
                 std::bind(highWaterMarkCallback_, shared_from_this(), oldLen + remaining));
         }
@@ -310,6 +487,53 @@ void TcpConnection::forceCloseInLoop()
     }
 }
 
+void TcpConnection::setRawHandlers(RawEventHandler readHandler,
+                                   RawEventHandler writeHandler,
+                                   RawEventHandler closeHandler)
+{
+    loop_->assertInLoopThread();
+    rawReadHandler_ = std::move(readHandler);
+    rawWriteHandler_ = std::move(writeHandler);
+    rawCloseHandler_ = std::move(closeHandler);
+}
+
+void TcpConnection::enableRawReading(bool on)
+{
+    if (state_ == kDisconnected || on == channel_->isReading())
+    {
+        return;
+    }
+    if (on)
+    {
+        channel_->enableReading();
+    }
+    else
+    {
+        channel_->disableReading();
+    }
+}
+
+void TcpConnection::enableRawWriting(bool on)
+{
+    if (state_ == kDisconnected || on == channel_->isWriting())
+    {
+        return;
+    }
+    if (on)
+    {
+        channel_->enableWriting();
+    }
+    else
+    {
+        channel_->disableWriting();
+    }
+}
+
+int TcpConnection::fd() const
+{
+    return socket_->fd();
+}
+
 // 定时器相关方法实现
 void TcpConnection::setConnectionTimeout(double seconds)
 {
@@ -0,0 +1,195 @@
+#include "TcpConnectionPool.h"
+#include "TcpConnection.h"
+#include "Eventloop.h"
+#include "Socket.h"
+#include "Logger.h"
+#include <stdio.h>
+#include <cassert>
+
+TcpConnectionPool::TcpConnectionPool(EventLoop *loop, const std::string &name)
+    : loop_(loop),
+      name_(name),
+      messageCallback_([](const TcpConnectionPtr &, Buffer *buf, Timestamp) { buf->retrieveAll(); }),
+      connectionCallback_([](const TcpConnectionPtr &) {}),
+      maxIdlePerKey_(8),
+      initRetryDelayMs_(Connector::kInitRetryDelayMs),
+      maxRetryDelayMs_(Connector::kMaxRetryDelayMs),
+      connectTimeout_(kDefaultConnectTimeout),
+      nextConnId_(1),
+      nextConnectorId_(1),
+      hits_(0),
+      misses_(0)
+{
+}
+
+TcpConnectionPool::~TcpConnectionPool()
+{
+    loop_->assertInLoopThread();
+    LOG_INFO("TcpConnectionPool[%s] destroyed, hits=%lu misses=%lu reuse=%.2f",
+             name_.c_str(), (unsigned long)hits_, (unsigned long)misses_, reuseRate());
+    for (auto &item : connecting_)
+    {
+        if (item.second.timeoutTimer.isValid())
+        {
+            loop_->cancel(item.second.timeoutTimer);
+        }
+        item.second.connector->stop();
+    }
+    idle_.clear();
+    for (auto &item : connections_)
+    {
+        TcpConnectionPtr conn(item.second);
+        item.second.reset();
+        // 连接可能仍被调用者持有，关闭回调不能再访问连接池
+        conn->setCloseCallback([](const TcpConnectionPtr &c) {
+            c->getLoop()->queueInLoop(std::bind(&TcpConnection::connectDestroyed, c));
+        });
+        loop_->runInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
+    }
+}
+
+void TcpConnectionPool::acquire(const InetAddress &addr, AcquireCallback cb)
+{
+    loop_->assertInLoopThread();
+    std::string key = addr.toIpPort();
+
+    auto it = idle_.find(key);
+    if (it != idle_.end())
+    {
+        IdleList &list = it->second;
+        // 优先取最近归还的连接（LIFO），它最可能仍然是热的
+        while (!list.empty())
+        {
+            TcpConnectionPtr conn = list.back();
+            list.pop_back();
+            if (conn->connected())
+            {
+                ++hits_;
+                cb(conn);
+                return;
+            }
+        }
+    }
+
+    ++misses_;
+    int id = nextConnectorId_++;
+    ConnectorPtr connector(new Connector(loop_, addr));
+    connector->setRetryDelay(initRetryDelayMs_, maxRetryDelayMs_);
+    connector->setNewConnectionCallback(
+        [this, id, key](int sockfd) { newConnection(id, key, sockfd); });
+    Pending &pending = connecting_[id];
+    pending.connector = connector;
+    pending.cb = std::move(cb);
+    if (connectTimeout_ > 0)
+    {
+        pending.timeoutTimer = loop_->runAfter(connectTimeout_, [this, id]() { connectTimeout(id); });
+    }
+    connector->start();
+}
+
+void TcpConnectionPool::release(const TcpConnectionPtr &conn)
+{
+    loop_->assertInLoopThread();
+    assert(conn->getLoop() == loop_);
+    auto keyIt = connKeys_.find(conn->name());
+    if (keyIt == connKeys_.end() || !conn->connected())
+    {
+        return;
+    }
+    IdleList &list = idle_[keyIt->second];
+    if (list.size() < maxIdlePerKey_)
+    {
+        list.push_back(conn);
+    }
+    else
+    {
+        conn->shutdown();
+    }
+}
+
+size_t TcpConnectionPool::idleCount(const InetAddress &addr) const
+{
+    auto it = idle_.find(addr.toIpPort());
+    return it == idle_.end() ? 0 : it->second.size();
+}
+
+void TcpConnectionPool::newConnection(int connectorId, const std::string &key, int sockfd)
+{
+    loop_->assertInLoopThread();
+    auto it = connecting_.find(connectorId);
+    assert(it != connecting_.end());
+    ConnectorPtr connector = it->second.connector;
+    AcquireCallback cb = std::move(it->second.cb);
+    if (it->second.timeoutTimer.isValid())
+    {
+        loop_->cancel(it->second.timeoutTimer);
+    }
+    connecting_.erase(it);
+    // 当前正处于connector的handleWrite中，延后释放connector
+    loop_->queueInLoop([connector]() {});
+
+    InetAddress peerAddr(Socket::getPeerAddr(sockfd));
+    InetAddress localAddr(Socket::getLocalAddr(sockfd));
+    // Unix域地址的路径可能很长，不能写进定长缓冲区，否则截断后连接名会重复
+    std::string connName = name_ + "-" + peerAddr.toIpPort() + "#" + std::to_string(nextConnId_);
+    ++nextConnId_;
+
+    TcpConnectionPtr conn(new TcpConnection(loop_, connName, sockfd, localAddr, peerAddr));
+    conn->setConnectionCallback(connectionCallback_);
+    conn->setMessageCallback(messageCallback_);
+    conn->setCloseCallback(std::bind(&TcpConnectionPool::removeConnection, this, std::placeholders::_1));
+    connections_[connName] = conn;
+    connKeys_[connName] = key;
+    conn->connectEstablished();
+    cb(conn);
+}
+
+void TcpConnectionPool::connectTimeout(int connectorId)
+{
+    loop_->assertInLoopThread();
+    auto it = connecting_.find(connectorId);
+    if (it == connecting_.end())
+    {
+        return;
+    }
+    ConnectorPtr connector = it->second.connector;
+    AcquireCallback cb = std::move(it->second.cb);
+    connecting_.erase(it);
+    LOG_ERROR("TcpConnectionPool[%s] connect to %s timed out after %d retries",
+              name_.c_str(), connector->serverAddress().toIpPort().c_str(), connector->retries());
+    connector->stop();
+    cb(TcpConnectionPtr());
+}
+
+void TcpConnectionPool::removeConnection(const TcpConnectionPtr &conn)
+{
+    loop_->assertInLoopThread();
+    removeIdle(conn);
+    connKeys_.erase(conn->name());
+    connections_.erase(conn->name());
+    loop_->queueInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
+}
+
+bool TcpConnectionPool::removeIdle(const TcpConnectionPtr &conn)
+{
+    auto keyIt = connKeys_.find(conn->name());
+    if (keyIt == connKeys_.end())
+    {
+        return false;
+    }
+    auto it = idle_.find(keyIt->second);
+    if (it == idle_.end())
+    {
+        return false;
+    }
+    IdleList &list = it->second;
+    for (auto i = list.begin(); i != list.end(); ++i)
+    {
+        if (*i == conn)
+        {
+            list.erase(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -5,9 +5,11 @@
 #include "Socket.h"
 #include "Logger.h"
 #include "Timer.h"
+#include "ThreadPool.h"
 #include <stdio.h>
 #include <assert.h>
 #include <functional>
+#include <algorithm>
 using namespace std::placeholders;
 
 using namespace std;
@@ -27,7 +29,14 @@ TcpServer::TcpServer(EventLoop *loop, const InetAddress &listenAddr, Option opti
       connectionTimeout_(0),
       idleTimeout_(0),
       keepAliveEnabled_(false),
-      keepAliveInterval_(30)
+      keepAliveInterval_(30),
+      incomingCpuSteering_(false),
+      computePool_(nullptr),
+      drainTimeout_(0),
+      minThreads_(0),
+      maxThreads_(0),
+      lowUtilization_(0),
+      highUtilization_(0)
 {
     LOG_INFO("TcpServer created, name=%s, listening on %s", name_.c_str(), ipPort_.c_str());
     acceptor_->setNewConnectionCallback(
@@ -37,6 +46,14 @@ TcpServer::TcpServer(EventLoop *loop, const InetAddress &listenAddr, Option opti
 TcpServer::~TcpServer()
 {
     assert(loop_->isInLoopThread());
+    if (scaleTimerId_.isValid())
+    {
+        loop_->cancel(scaleTimerId_);
+    }
+    for (auto &item : drainTimers_)
+    {
+        loop_->cancel(item.second);
+    }
     for (auto &item : connections_)
     {
         TcpConnectionPtr conn(item.second);
@@ -67,11 +84,18 @@ void TcpServer::start()
 void TcpServer::newConnection(int sockfd, const InetAddress &peerAddr)
 {
     assert(loop_->isInLoopThread());
-    EventLoop *ioLoop = threadPool_->getNextLoop();
-    char buf[64];
-    snprintf(buf, sizeof buf, "-%s#%d", ipPort_.c_str(), nextConnId_);
+    EventLoop *ioLoop = nullptr;
+    if (incomingCpuSteering_)
+    {
+        ioLoop = threadPool_->getLoopForCpu(Socket::getIncomingCpu(sockfd));
+    }
+    else
+    {
+        ioLoop = threadPool_->getNextLoop();
+    }
+    // Unix域地址的路径可能很长，不能写进定长缓冲区，否则截断后连接名会重复
+    string connName = name_ + "-" + ipPort_ + "#" + to_string(nextConnId_);
     ++nextConnId_;
-    string connName = name_ + buf;
 
     InetAddress localAddr(Socket::getLocalAddr(sockfd));
     TcpConnectionPtr conn(new TcpConnection(ioLoop,
@@ -80,11 +104,16 @@ void TcpServer::newConnection(int sockfd, const InetAddress &peerAddr)
                                             localAddr,
                                             peerAddr));
     connections_[connName] = conn;
+    ++loopConnections_[ioLoop];
     conn->setConnectionCallback(connectionCallback_);
     conn->setMessageCallback(messageCallback_);
     conn->setWriteCompleteCallback(writeCompleteCallback_);
     conn->setCloseCallback(
         bind(&TcpServer::removeConnection, this, _1));
+    if (computePool_)
+    {
+        conn->setStrand(make_shared<Strand>(computePool_));
+    }
     
     // 应用超时设置
     if (connectionTimeout_ > 0) {
@@ -120,4 +149,155 @@ void TcpServer::removeConnectionInLoop(const TcpConnectionPtr &conn)
     EventLoop *ioLoop = conn->getLoop();
     ioLoop->queueInLoop(
         bind(&TcpConnection::connectDestroyed, conn));
+    if (--loopConnections_[ioLoop] == 0)
+    {
+        loopConnections_.erase(ioLoop);
+        reapRetiringLoops();
+    }
+}
+
+void TcpServer::adjustThreadNum(int numThreads)
+{
+    assert(0 <= numThreads);
+    loop_->runInLoop(bind(&TcpServer::adjustThreadNumInLoop, this, numThreads));
+}
+
+void TcpServer::adjustThreadNumInLoop(int numThreads)
+{
+    assert(loop_->isInLoopThread());
+    if (!threadPool_->started())
+    {
+        threadPool_->setThreadNUm(numThreads);
+        return;
+    }
+
+    while (threadPool_->numLoops() < numThreads)
+    {
+        EventLoop *ioLoop = threadPool_->addLoop();
+        LOG_INFO("TcpServer %s added io loop %p, threads=%d", name_.c_str(), ioLoop, threadPool_->numLoops());
+    }
+    while (threadPool_->numLoops() > numThreads)
+    {
+        EventLoop *ioLoop = threadPool_->retireLoop();
+        retiringLoops_.push_back(ioLoop);
+        LOG_INFO("TcpServer %s retiring io loop %p, connections=%d, threads=%d",
+                 name_.c_str(), ioLoop, loopConnections_.count(ioLoop) ? loopConnections_[ioLoop] : 0,
+                 threadPool_->numLoops());
+        if (drainTimeout_ > 0)
+        {
+            drainTimers_[ioLoop] = loop_->runAfter(drainTimeout_, bind(&TcpServer::closeLoopConnections, this, ioLoop));
+        }
+    }
+    reapRetiringLoops();
+}
+
+void TcpServer::closeLoopConnections(EventLoop *ioLoop)
+{
+    assert(loop_->isInLoopThread());
+    // 回收loop时会取消它的定时器，定时器还在说明ioLoop仍在排空
+    if (drainTimers_.erase(ioLoop) == 0)
+    {
+        return;
+    }
+    for (auto &item : connections_)
+    {
+        if (item.second->getLoop() == ioLoop)
+        {
+            item.second->forceClose();
+        }
+    }
+}
+
+void TcpServer::reapRetiringLoops()
+{
+    assert(loop_->isInLoopThread());
+    for (auto it = retiringLoops_.begin(); it != retiringLoops_.end();)
+    {
+        if (loopConnections_.count(*it) == 0)
+        {
+            LOG_INFO("TcpServer %s io loop %p drained, stopping thread", name_.c_str(), *it);
+            lastBusyMicroSeconds_.erase(*it);
+            auto timer = drainTimers_.find(*it);
+            if (timer != drainTimers_.end())
+            {
+                loop_->cancel(timer->second);
+                drainTimers_.erase(timer);
+            }
+            threadPool_->reapLoop(*it);
+            it = retiringLoops_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void TcpServer::enableAutoScale(int minThreads, int maxThreads,
+                                double lowUtilization, double highUtilization,
+                                double interval)
+{
+    assert(0 <= minThreads && minThreads <= maxThreads);
+    assert(lowUtilization < highUtilization);
+    minThreads_ = minThreads;
+    maxThreads_ = maxThreads;
+    lowUtilization_ = lowUtilization;
+    highUtilization_ = highUtilization;
+    loop_->runInLoop([this, interval]() {
+        if (scaleTimerId_.isValid())
+        {
+            loop_->cancel(scaleTimerId_);
+        }
+        lastScaleSample_ = Timestamp::now();
+        scaleTimerId_ = loop_->runEvery(interval, bind(&TcpServer::onScaleTimer, this));
+    });
+}
+
+void TcpServer::onScaleTimer()
+{
+    assert(loop_->isInLoopThread());
+    reapRetiringLoops();
+    if (!threadPool_->started())
+    {
+        return;
+    }
+
+    Timestamp now = Timestamp::now();
+    double elapsedUs = timeDifference(now, lastScaleSample_) * Timestamp::kMicroSecondsPerSecond;
+    lastScaleSample_ = now;
+    if (elapsedUs <= 0)
+    {
+        return;
+    }
+
+    // 计算参与分配的loop在本采样周期内的平均利用率，新加入的loop从下个周期开始统计
+    double total = 0;
+    int sampled = 0;
+    for (EventLoop *ioLoop : threadPool_->getAllLoops())
+    {
+        int64_t busy = ioLoop->busyMicroSeconds();
+        auto it = lastBusyMicroSeconds_.find(ioLoop);
+        if (it != lastBusyMicroSeconds_.end())
+        {
+            total += static_cast<double>(busy - it->second) / elapsedUs;
+            ++sampled;
+        }
+        lastBusyMicroSeconds_[ioLoop] = busy;
+    }
+    if (sampled == 0)
+    {
+        return;
+    }
+
+    double utilization = total / sampled;
+    int numThreads = threadPool_->numLoops();
+    LOG_DEBUG("TcpServer %s io utilization=%.3f, threads=%d", name_.c_str(), utilization, numThreads);
+    if (utilization > highUtilization_ && numThreads < maxThreads_)
+    {
+        adjustThreadNumInLoop(numThreads + 1);
+    }
+    else if (utilization < lowUtilization_ && numThreads > minThreads_)
+    {
+        adjustThreadNumInLoop(numThreads - 1);
+    }
 }
@@ -0,0 +1,257 @@
+#include "ThreadPool.h"
+#include "Logger.h"
+#include <cassert>
+#include <cstdio>
+#include <thread>
+#include <iterator>
+
+// 当前线程所属的线程池及其队列下标，非工作线程为nullptr
+__thread ThreadPool *t_currentPool = nullptr;
+__thread size_t t_workerIndex = 0;
+
+ThreadPool::ThreadPool(const std::string &name)
+    : name_(name),
+      nextQueue_(0),
+      running_(false),
+      accepting_(false),
+      submitting_(0),
+      pending_(0),
+      idle_(0)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+    if (running_)
+    {
+        stop();
+    }
+}
+
+void ThreadPool::start(int numThreads)
+{
+    assert(!running_);
+    assert(threads_.empty());
+    if (numThreads <= 0)
+    {
+        numThreads = static_cast<int>(std::thread::hardware_concurrency());
+        if (numThreads <= 0)
+        {
+            numThreads = 1;
+        }
+    }
+
+    queues_.reserve(numThreads);
+    for (int i = 0; i < numThreads; ++i)
+    {
+        queues_.emplace_back(new WorkQueue);
+    }
+    running_ = true;
+    accepting_ = true;
+    threads_.reserve(numThreads);
+    for (int i = 0; i < numThreads; ++i)
+    {
+        char buf[name_.size() + 32];
+        snprintf(buf, sizeof buf, "%s%d", name_.c_str(), i);
+        threads_.emplace_back(new Thread(std::bind(&ThreadPool::workerFunc, this, static_cast<size_t>(i)), buf));
+        threads_.back()->start();
+    }
+}
+
+void ThreadPool::stop()
+{
+    // 先不再接受新任务，等已经通过检查的run()放完任务，之后queues_不会再被其他线程访问。
+    // accepting_和submitting_都是顺序一致的读写，run()要么看到accepting_为false，要么被这里等到
+    accepting_ = false;
+    while (submitting_.load() != 0)
+    {
+        std::this_thread::yield();
+    }
+    {
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        running_ = false;
+        sleepCond_.notify_all();
+    }
+    for (auto &thr : threads_)
+    {
+        thr->join();
+    }
+    threads_.clear();
+    queues_.clear();
+}
+
+void ThreadPool::run(Task task)
+{
+    submitting_.fetch_add(1);
+    if (!accepting_.load())
+    {
+        // 线程池未启动或已经停止时直接在调用线程执行
+        submitting_.fetch_sub(1);
+        task();
+        return;
+    }
+
+    size_t index = (t_currentPool == this)
+                       ? t_workerIndex
+                       : nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    {
+        std::unique_lock<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+
+    // pending_与idle_的先写后读配对保证不会丢失唤醒；
+    // pending_在submitting_减一之前增加，stop()等到的任务一定会被工作线程执行
+    pending_.fetch_add(1);
+    submitting_.fetch_sub(1);
+    if (idle_.load() > 0)
+    {
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepCond_.notify_one();
+    }
+}
+
+bool ThreadPool::popTask(size_t index, Task &task)
+{
+    // 先从自己的队列头部取
+    {
+        WorkQueue &q = *queues_[index];
+        std::unique_lock<std::mutex> lock(q.mutex);
+        if (!q.tasks.empty())
+        {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            pending_.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // 再从其他线程的队列尾部窃取
+    for (size_t i = 1; i < queues_.size(); ++i)
+    {
+        WorkQueue &q = *queues_[(index + i) % queues_.size()];
+        std::unique_lock<std::mutex> lock(q.mutex, std::try_to_lock);
+        if (lock.owns_lock() && !q.tasks.empty())
+        {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+            pending_.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerFunc(size_t index)
+{
+    t_currentPool = this;
+    t_workerIndex = index;
+
+    while (true)
+    {
+        Task task;
+        if (popTask(index, task))
+        {
+            try
+            {
+                task();
+            }
+            catch (const std::exception &e)
+            {
+                LOG_ERROR("ThreadPool %s task exception: %s", name_.c_str(), e.what());
+            }
+            catch (...)
+            {
+                LOG_ERROR("ThreadPool %s task unknown exception", name_.c_str());
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        idle_.fetch_add(1);
+        // 窃取时try_lock可能错过任务，只要pending_不为0就继续尝试
+        while (pending_.load() == 0 && running_)
+        {
+            sleepCond_.wait(lock);
+        }
+        idle_.fetch_sub(1);
+        if (!running_ && pending_.load() == 0)
+        {
+            break;
+        }
+    }
+
+    t_currentPool = nullptr;
+}
+
+Strand::Strand(ThreadPool *pool)
+    : pool_(pool),
+      scheduled_(false)
+{
+}
+
+void Strand::post(Task task)
+{
+    bool schedule = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+        if (!scheduled_)
+        {
+            scheduled_ = true;
+            schedule = true;
+        }
+    }
+    if (schedule)
+    {
+        pool_->run(std::bind(&Strand::drain, shared_from_this()));
+    }
+}
+
+void Strand::drain()
+{
+    std::deque<Task> batch;
+    for (int executed = 0; executed < kMaxBatch;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (tasks_.empty())
+            {
+                scheduled_ = false;
+                return;
+            }
+            // 只取本批剩余的额度，其余留在队列中等下次调度
+            size_t quota = static_cast<size_t>(kMaxBatch - executed);
+            if (tasks_.size() <= quota)
+            {
+                batch.swap(tasks_);
+            }
+            else
+            {
+                batch.assign(std::make_move_iterator(tasks_.begin()),
+                             std::make_move_iterator(tasks_.begin() + quota));
+                tasks_.erase(tasks_.begin(), tasks_.begin() + quota);
+            }
+        }
+        while (!batch.empty())
+        {
+            Task task = std::move(batch.front());
+            batch.pop_front();
+            try
+            {
+                task();
+            }
+            catch (const std::exception &e)
+            {
+                LOG_ERROR("Strand task exception: %s", e.what());
+            }
+            catch (...)
+            {
+                LOG_ERROR("Strand task unknown exception");
+            }
+            ++executed;
+        }
+    }
+
+    // 本批执行完仍有任务：重新排队，让其他strand也有机会执行
+    pool_->run(std::bind(&Strand::drain, shared_from_this()));
+}
@@ -1,6 +1,7 @@
 #include "TimerQueue.h"
 #include "Eventloop.h"
 #include "Logger.h"
+#include "BinaryLog.h"
 #include <sys/timerfd.h>
 #include <unistd.h>
 #include <string.h>
@@ -60,11 +61,11 @@ void readTimerfd(int timerfd, Timestamp now)
 {
     uint64_t howmany;
     ssize_t n = ::read(timerfd, &howmany, sizeof(howmany));
-    LOG_DEBUG("TimerQueue::handleRead() %lu at %s", howmany, now.to_string().c_str());
+    BLOG_DEBUG("TimerQueue::handleRead() %lu at %ld", howmany, now.microSecondsSinceEpoch());
     if (n != sizeof(howmany))
     {
         int savedErrno = errno;
-        LOG_ERROR("TimerQueue::handleRead() reads %ld bytes instead of 8, errno=%d", n, savedErrno);
+        LOG_EVERY_MS(ERROR, 1000, "TimerQueue::handleRead() reads %ld bytes instead of 8, errno=%d", n, savedErrno);
         // 如果timerfd无效，记录严重错误
         if (savedErrno == EBADF || savedErrno == EINVAL)
         {
@@ -155,8 +156,9 @@ void TimerQueue::cancelInLoop(TimerId timerId)
         {
             LOG_ERROR("TimerQueue::cancelInLoop() failed to erase timer from timers_, n=%zu", n);
         }
+        Timer* expired = it->first;
         activeTimers_.erase(it);
-        delete it->first;
+        delete expired;
     }
     else if (callingExpiredTimers_)
     {
@@ -166,7 +168,7 @@ void TimerQueue::cancelInLoop(TimerId timerId)
     else
     {
         // 定时器不存在且不在执行中，可能是已经被取消或已过期
-        LOG_DEBUG("TimerQueue::cancelInLoop() timer not found, sequence=%ld", timerId.sequence_);
+        BLOG_DEBUG("TimerQueue::cancelInLoop() timer not found, sequence=%ld", timerId.sequence_);
     }
 }
 
@@ -1,5 +1,9 @@
 #include "Timestamp.h"
 #include<string>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
 #include <sys/time.h>
 
 Timestamp::Timestamp():microSecondsSinceEpoch_(0){}
@@ -20,22 +24,83 @@ Timestamp Timestamp::invalid()
     return Timestamp();
 }
 
-std::string Timestamp::to_string() const
+namespace
+{
+
+// 每个线程最近格式化过的一秒
+struct SecondCache
+{
+    int64_t second = INT64_MIN;
+    char text[18];   // "YYYYMMDD HH:MM:SS"和结尾的'\0'
+    // 本地时间相对UTC的秒数，夏令时只在整点附近切换，每换一个小时用localtime_r重新取一次
+    int64_t hour = INT64_MIN;
+    int64_t utcOffset = 0;
+};
+
+thread_local SecondCache t_secondCache;
+
+int64_t utcOffsetSeconds(SecondCache& cache, int64_t seconds)
+{
+    int64_t hour = seconds / 3600;
+    if (hour != cache.hour)
+    {
+        time_t t = static_cast<time_t>(seconds);
+        struct tm local;
+        cache.utcOffset = localtime_r(&t, &local) != NULL ? static_cast<int64_t>(local.tm_gmtoff) : 0;
+        cache.hour = hour;
+    }
+    return cache.utcOffset;
+}
+
+} // namespace
+
+int Timestamp::format(char* buf) const
 {
-    char buf[128] = {0};
-    time_t seconds = static_cast<time_t>(microSecondsSinceEpoch_ / kMicroSecondsPerSecond);
-    tm *tm_time = localtime(&seconds);
+    int64_t seconds = microSecondsSinceEpoch_ / kMicroSecondsPerSecond;
     int microseconds = static_cast<int>(microSecondsSinceEpoch_ % kMicroSecondsPerSecond);
-    snprintf(buf, 128, "%4d%02d%02d %02d:%02d:%02d.%06d",
-        tm_time->tm_year + 1900,
-        tm_time->tm_mon + 1,
-        tm_time->tm_mday,
-        tm_time->tm_hour,
-        tm_time->tm_min,
-        tm_time->tm_sec,
-        microseconds);
-
-    return buf;
+    if (microseconds < 0)
+    {
+        --seconds;
+        microseconds += kMicroSecondsPerSecond;
+    }
+
+    SecondCache& cache = t_secondCache;
+    if (seconds != cache.second)
+    {
+        // 加上偏移后按UTC拆分，gmtime_r不读时区配置，也没有localtime的共享状态
+        time_t local = static_cast<time_t>(seconds + utcOffsetSeconds(cache, seconds));
+        struct tm tm_time;
+        if (gmtime_r(&local, &tm_time) == NULL)
+        {
+            memset(&tm_time, 0, sizeof tm_time);
+            tm_time.tm_year = -1900;
+            tm_time.tm_mday = 1;
+        }
+        // 取模把每个字段限制在格式宽度内（正常的时间本来就在范围内），保证不会截断
+        snprintf(cache.text, sizeof cache.text, "%04u%02u%02u %02u:%02u:%02u",
+            static_cast<unsigned>(tm_time.tm_year + 1900) % 10000u,
+            static_cast<unsigned>(tm_time.tm_mon + 1) % 100u,
+            static_cast<unsigned>(tm_time.tm_mday) % 100u,
+            static_cast<unsigned>(tm_time.tm_hour) % 100u,
+            static_cast<unsigned>(tm_time.tm_min) % 100u,
+            static_cast<unsigned>(tm_time.tm_sec) % 100u);
+        cache.second = seconds;
+    }
+
+    memcpy(buf, cache.text, 17);
+    buf[17] = '.';
+    for (int i = 23; i > 17; --i)
+    {
+        buf[i] = static_cast<char>('0' + microseconds % 10);
+        microseconds /= 10;
+    }
+    return kFormattedSize;
+}
+
+std::string Timestamp::to_string() const
+{
+    char buf[kFormattedSize];
+    return std::string(buf, format(buf));
 }
 
 /*
@@ -0,0 +1,437 @@
+#include "UdpChannel.h"
+#include "Channel.h"
+#include "Eventloop.h"
+#include "Logger.h"
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+namespace
+{
+
+// GRO合并后的单个报文最大为64KB
+const size_t kGroDatagramSize = 65536;
+// GSO单次最多64段，总长不超过一个IP报文
+const size_t kMaxGsoSegments = 64;
+const size_t kMaxGsoBytes = 65000;
+// 一次可读事件中最多连续调用recvmmsg的次数，避免一个socket占满整个循环
+const int kMaxBatchesPerEvent = 4;
+
+int createUdpSocket()
+{
+    int sockfd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+    if (sockfd < 0)
+    {
+        LOG_FATAL("%s:%s:%d udp socket create err:%d \n", __FILE__, __FUNCTION__, __LINE__, errno);
+    }
+    return sockfd;
+}
+
+/**
+ * 每个IO线程一块报文区：recvmmsg的mmsghdr/iovec/地址/控制消息以及报文数据本身，
+ * 同一loop上的所有UdpChannel共用，容量按用到的最大批量和报文长度增长
+ */
+struct DatagramArena
+{
+    std::vector<char> buffer;
+    std::vector<mmsghdr> msgs;
+    std::vector<iovec> iovecs;
+    std::vector<sockaddr_in> addrs;
+    std::vector<char> control;
+    std::vector<Datagram> datagrams;
+    size_t slotSize = 0;
+
+    // sendmmsg使用的头部，报文数据直接指向各UdpChannel的发送队列
+    std::vector<mmsghdr> sendMsgs;
+    std::vector<iovec> sendIovecs;
+    std::vector<char> sendControl;
+
+    static const size_t kControlSize = CMSG_SPACE(sizeof(int));
+    static const size_t kSendControlSize = CMSG_SPACE(sizeof(uint16_t));
+
+    void prepare(size_t slots, size_t size)
+    {
+        if (slots > msgs.size() || size > slotSize)
+        {
+            slots = std::max(slots, msgs.size());
+            slotSize = std::max(size, slotSize);
+            buffer.resize(slots * slotSize);
+            msgs.resize(slots);
+            iovecs.resize(slots);
+            addrs.resize(slots);
+            control.resize(slots * kControlSize);
+        }
+        for (size_t i = 0; i < slots; ++i)
+        {
+            iovecs[i].iov_base = &buffer[i * slotSize];
+            iovecs[i].iov_len = size;
+            msghdr &hdr = msgs[i].msg_hdr;
+            hdr.msg_name = &addrs[i];
+            hdr.msg_namelen = sizeof(sockaddr_in);
+            hdr.msg_iov = &iovecs[i];
+            hdr.msg_iovlen = 1;
+            hdr.msg_control = &control[i * kControlSize];
+            hdr.msg_controllen = kControlSize;
+            hdr.msg_flags = 0;
+            msgs[i].msg_len = 0;
+        }
+    }
+
+    void prepareSend(size_t slots)
+    {
+        if (slots > sendMsgs.size())
+        {
+            sendMsgs.resize(slots);
+            sendIovecs.resize(slots);
+            sendControl.resize(slots * kSendControlSize);
+        }
+    }
+
+    static DatagramArena &forThisLoop()
+    {
+        static thread_local DatagramArena arena;
+        return arena;
+    }
+};
+
+// 取出GRO合并报文的段长，未合并时返回0
+int groSegmentSize(msghdr *hdr)
+{
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(hdr, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+        {
+            int size = 0;
+            memcpy(&size, CMSG_DATA(cmsg), sizeof size);
+            return size;
+        }
+    }
+    return 0;
+}
+
+}
+
+UdpChannel::UdpChannel(EventLoop *loop, const InetAddress &bindAddr, bool reusePort)
+    : loop_(loop),
+      socket_(createUdpSocket()),
+      channel_(new Channel(loop, socket_.fd())),
+      batchSize_(kDefaultBatchSize),
+      maxDatagramSize_(kDefaultMaxDatagramSize),
+      gso_(false),
+      gro_(false),
+      pendingHead_(0),
+      flushQueued_(false),
+      datagramsReceived_(0),
+      recvCalls_(0),
+      datagramsTruncated_(0),
+      datagramsSent_(0),
+      sendCalls_(0)
+{
+    socket_.setReuseAddr(true);
+    socket_.setReusePort(reusePort);
+    socket_.bindAddress(bindAddr);
+    channel_->setReadCallback(std::bind(&UdpChannel::handleRead, this, std::placeholders::_1));
+    channel_->setWriteCallback(std::bind(&UdpChannel::handleWrite, this));
+}
+
+UdpChannel::~UdpChannel()
+{
+}
+
+bool UdpChannel::enableGso(bool on)
+{
+    if (!on)
+    {
+        gso_ = false;
+        return true;
+    }
+    // 探测内核是否支持UDP_SEGMENT，实际段长在每次发送时通过控制消息指定
+    int segment = 0;
+    gso_ = ::setsockopt(socket_.fd(), SOL_UDP, UDP_SEGMENT, &segment, sizeof segment) == 0;
+    if (!gso_)
+    {
+        LOG_ERROR("UdpChannel::enableGso UDP_SEGMENT not supported, errno=%d", errno);
+    }
+    return gso_;
+}
+
+bool UdpChannel::enableGro(bool on)
+{
+    int optval = on ? 1 : 0;
+    bool ok = ::setsockopt(socket_.fd(), SOL_UDP, UDP_GRO, &optval, sizeof optval) == 0;
+    if (!ok && on)
+    {
+        LOG_ERROR("UdpChannel::enableGro UDP_GRO not supported, errno=%d", errno);
+    }
+    gro_ = on && ok;
+    return ok;
+}
+
+void UdpChannel::start()
+{
+    std::weak_ptr<UdpChannel> weak(shared_from_this());
+    loop_->runInLoop([weak]() {
+        UdpChannelPtr self = weak.lock();
+        if (self)
+        {
+            self->channel_->tie(self);
+            self->channel_->enableReading();
+        }
+    });
+}
+
+void UdpChannel::stopInLoop()
+{
+    loop_->assertInLoopThread();
+    channel_->disableAll();
+    channel_->remove();
+}
+
+void UdpChannel::handleRead(Timestamp receiveTime)
+{
+    DatagramArena &arena = DatagramArena::forThisLoop();
+    size_t slotSize = gro_ ? kGroDatagramSize : maxDatagramSize_;
+
+    for (int round = 0; round < kMaxBatchesPerEvent; ++round)
+    {
+        arena.prepare(batchSize_, slotSize);
+        int n = ::recvmmsg(socket_.fd(), arena.msgs.data(), batchSize_, MSG_DONTWAIT, nullptr);
+        if (n < 0)
+        {
+            if (errno != EAGAIN && errno != EINTR)
+            {
+                LOG_ERROR("UdpChannel::handleRead recvmmsg error, fd=%d, errno=%d", socket_.fd(), errno);
+            }
+            return;
+        }
+        recvCalls_.fetch_add(1, std::memory_order_relaxed);
+
+        arena.datagrams.clear();
+        for (int i = 0; i < n; ++i)
+        {
+            mmsghdr &msg = arena.msgs[i];
+            const char *data = &arena.buffer[i * arena.slotSize];
+            InetAddress peer(arena.addrs[i]);
+            size_t len = msg.msg_len;
+            if (msg.msg_hdr.msg_flags & MSG_TRUNC)
+            {
+                // 报文比接收槽大，剩下的部分已经被内核丢弃，不交给应用半个报文
+                datagramsTruncated_.fetch_add(1, std::memory_order_relaxed);
+                LOG_EVERY_MS(ERROR, 1000, "UdpChannel::handleRead dropped truncated datagram from %s, fd=%d, limit=%zu",
+                             peer.toIpPort().c_str(), socket_.fd(), slotSize);
+                continue;
+            }
+            size_t segment = gro_ ? groSegmentSize(&msg.msg_hdr) : 0;
+            if (segment == 0 || segment >= len)
+            {
+                arena.datagrams.push_back(Datagram{data, len, peer});
+                continue;
+            }
+            // GRO合并的报文按段长拆回原始报文，最后一段可能较短
+            for (size_t off = 0; off < len; off += segment)
+            {
+                arena.datagrams.push_back(Datagram{data + off, std::min(segment, len - off), peer});
+            }
+        }
+        datagramsReceived_.fetch_add(arena.datagrams.size(), std::memory_order_relaxed);
+        if (batchCallback_ && !arena.datagrams.empty())
+        {
+            batchCallback_(this, arena.datagrams.data(), arena.datagrams.size(), receiveTime);
+        }
+        if (n < batchSize_)
+        {
+            return;
+        }
+    }
+}
+
+void UdpChannel::send(const InetAddress &peer, const void *data, size_t len)
+{
+    if (loop_->isInLoopThread())
+    {
+        queueDatagram(*peer.getSockAddr(), static_cast<const char *>(data), len, 0);
+    }
+    else
+    {
+        std::weak_ptr<UdpChannel> weak(shared_from_this());
+        std::string copy(static_cast<const char *>(data), len);
+        sockaddr_in addr = *peer.getSockAddr();
+        loop_->runInLoop([weak, addr, copy]() {
+            UdpChannelPtr self = weak.lock();
+            if (self)
+            {
+                self->queueDatagram(addr, copy.data(), copy.size(), 0);
+            }
+        });
+    }
+}
+
+void UdpChannel::sendSegments(const InetAddress &peer, const void *data, size_t len, size_t segmentSize)
+{
+    if (!loop_->isInLoopThread())
+    {
+        std::weak_ptr<UdpChannel> weak(shared_from_this());
+        std::string copy(static_cast<const char *>(data), len);
+        loop_->runInLoop([weak, peer, copy, segmentSize]() {
+            UdpChannelPtr self = weak.lock();
+            if (self)
+            {
+                self->sendSegments(peer, copy.data(), copy.size(), segmentSize);
+            }
+        });
+        return;
+    }
+
+    const char *p = static_cast<const char *>(data);
+    const sockaddr_in &addr = *peer.getSockAddr();
+    if (gso_ && segmentSize > 0 && segmentSize < len)
+    {
+        size_t chunk = segmentSize * std::min(kMaxGsoSegments, std::max<size_t>(1, kMaxGsoBytes / segmentSize));
+        for (size_t off = 0; off < len; off += chunk)
+        {
+            queueDatagram(addr, p + off, std::min(chunk, len - off), static_cast<uint16_t>(segmentSize));
+        }
+    }
+    else
+    {
+        size_t step = segmentSize > 0 ? segmentSize : len;
+        for (size_t off = 0; off < len; off += step)
+        {
+            queueDatagram(addr, p + off, std::min(step, len - off), 0);
+        }
+    }
+}
+
+void UdpChannel::queueDatagram(const sockaddr_in &peer, const char *data, size_t len, uint16_t segmentSize)
+{
+    pending_.push_back(PendingDatagram{peer, pendingData_.size(), len, segmentSize});
+    pendingData_.append(data, len);
+    scheduleFlush();
+}
+
+void UdpChannel::scheduleFlush()
+{
+    // 等待可写时由handleWrite负责发送
+    if (flushQueued_ || channel_->isWriting())
+    {
+        return;
+    }
+    flushQueued_ = true;
+    std::weak_ptr<UdpChannel> weak(shared_from_this());
+    loop_->queueInLoop([weak]() {
+        UdpChannelPtr self = weak.lock();
+        if (self)
+        {
+            self->flushQueued_ = false;
+            self->flush();
+        }
+    });
+}
+
+void UdpChannel::handleWrite()
+{
+    flush();
+}
+
+void UdpChannel::flush()
+{
+    DatagramArena &arena = DatagramArena::forThisLoop();
+    arena.prepareSend(batchSize_);
+    const size_t kControlSize = DatagramArena::kSendControlSize;
+    std::vector<mmsghdr> &msgs = arena.sendMsgs;
+    std::vector<iovec> &iovecs = arena.sendIovecs;
+    std::vector<char> &control = arena.sendControl;
+
+    while (pendingHead_ < pending_.size())
+    {
+        size_t count = std::min(static_cast<size_t>(batchSize_), pending_.size() - pendingHead_);
+        for (size_t i = 0; i < count; ++i)
+        {
+            PendingDatagram &d = pending_[pendingHead_ + i];
+            iovecs[i].iov_base = &pendingData_[d.offset];
+            iovecs[i].iov_len = d.len;
+            msghdr &hdr = msgs[i].msg_hdr;
+            memset(&hdr, 0, sizeof hdr);
+            hdr.msg_name = &d.peer;
+            hdr.msg_namelen = sizeof(sockaddr_in);
+            hdr.msg_iov = &iovecs[i];
+            hdr.msg_iovlen = 1;
+            if (d.segmentSize > 0)
+            {
+                hdr.msg_control = &control[i * kControlSize];
+                hdr.msg_controllen = kControlSize;
+                cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr);
+                cmsg->cmsg_level = SOL_UDP;
+                cmsg->cmsg_type = UDP_SEGMENT;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                memcpy(CMSG_DATA(cmsg), &d.segmentSize, sizeof d.segmentSize);
+            }
+        }
+
+        int n = ::sendmmsg(socket_.fd(), msgs.data(), count, MSG_DONTWAIT);
+        if (n > 0)
+        {
+            sendCalls_.fetch_add(1, std::memory_order_relaxed);
+            uint64_t sent = 0;
+            for (int i = 0; i < n; ++i)
+            {
+                const PendingDatagram &d = pending_[pendingHead_ + i];
+                sent += d.segmentSize > 0 ? (d.len + d.segmentSize - 1) / d.segmentSize : 1;
+            }
+            datagramsSent_.fetch_add(sent, std::memory_order_relaxed);
+            pendingHead_ += n;
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        else if (errno == EAGAIN)
+        {
+            // 发送缓冲区已满，剩余报文等可写时再发
+            if (!channel_->isWriting())
+            {
+                channel_->enableWriting();
+            }
+            return;
+        }
+        else
+        {
+            // UDP本身不保证送达，出错的报文直接丢弃；
+            // GSO不被网卡支持时关闭GSO，把这个多段报文拆回逐段的普通报文重新排队，段数据仍在pendingData_中
+            int savedErrno = errno;
+            PendingDatagram d = pending_[pendingHead_];
+            LOG_ERROR("UdpChannel::flush sendmmsg error, fd=%d, errno=%d", socket_.fd(), savedErrno);
+            ++pendingHead_;
+            if (d.segmentSize > 0 && (savedErrno == EIO || savedErrno == EINVAL))
+            {
+                gso_ = false;
+                std::vector<PendingDatagram> segments;
+                for (size_t off = 0; off < d.len; off += d.segmentSize)
+                {
+                    size_t len = std::min(static_cast<size_t>(d.segmentSize), d.len - off);
+                    segments.push_back(PendingDatagram{d.peer, d.offset + off, len, 0});
+                }
+                pending_.insert(pending_.begin() + pendingHead_, segments.begin(), segments.end());
+            }
+        }
+    }
+
+    pending_.clear();
+    pendingData_.clear();
+    pendingHead_ = 0;
+    if (channel_->isWriting())
+    {
+        channel_->disableWriting();
+    }
+}
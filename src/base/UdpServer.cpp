@@ -0,0 +1,115 @@
+#include "UdpServer.h"
+#include "Eventloop.h"
+#include "Logger.h"
+#include <future>
+#include <cassert>
+
+UdpServer::UdpServer(EventLoop *loop, const InetAddress &listenAddr, const std::string &name)
+    : loop_(loop),
+      listenAddr_(listenAddr),
+      name_(name),
+      threadPool_(new EventLoopThreadPool(loop, name)),
+      batchSize_(UdpChannel::kDefaultBatchSize),
+      maxDatagramSize_(UdpChannel::kDefaultMaxDatagramSize),
+      gso_(false),
+      gro_(false),
+      started_(false)
+{
+}
+
+UdpServer::~UdpServer()
+{
+    loop_->assertInLoopThread();
+    for (UdpChannelPtr &channel : channels_)
+    {
+        EventLoop *ioLoop = channel->getLoop();
+        if (ioLoop == loop_)
+        {
+            channel->stopInLoop();
+        }
+        else
+        {
+            // 必须等IO线程真正把Channel移除后才能释放，之后线程池析构时才退出该线程
+            std::promise<void> removed;
+            UdpChannelPtr ch = channel;
+            ioLoop->runInLoop([ch, &removed]() {
+                ch->stopInLoop();
+                removed.set_value();
+            });
+            removed.get_future().wait();
+        }
+    }
+}
+
+void UdpServer::start()
+{
+    loop_->assertInLoopThread();
+    if (started_)
+    {
+        return;
+    }
+    started_ = true;
+    threadPool_->start();
+
+    std::vector<EventLoop *> loops = threadPool_->getAllLoops();
+    bool reusePort = loops.size() > 1;
+    for (EventLoop *ioLoop : loops)
+    {
+        UdpChannelPtr channel(std::make_shared<UdpChannel>(ioLoop, listenAddr_, reusePort));
+        channel->setBatchCallback(batchCallback_);
+        channel->setBatchSize(batchSize_);
+        channel->setMaxDatagramSize(maxDatagramSize_);
+        if (gso_)
+        {
+            channel->enableGso(true);
+        }
+        if (gro_)
+        {
+            channel->enableGro(true);
+        }
+        channels_.push_back(channel);
+        channel->start();
+    }
+    LOG_INFO("UdpServer[%s] started on %s with %zu socket(s)",
+             name_.c_str(), listenAddr_.toIpPort().c_str(), channels_.size());
+}
+
+uint64_t UdpServer::datagramsReceived() const
+{
+    uint64_t n = 0;
+    for (const UdpChannelPtr &channel : channels_)
+    {
+        n += channel->datagramsReceived();
+    }
+    return n;
+}
+
+uint64_t UdpServer::recvCalls() const
+{
+    uint64_t n = 0;
+    for (const UdpChannelPtr &channel : channels_)
+    {
+        n += channel->recvCalls();
+    }
+    return n;
+}
+
+uint64_t UdpServer::datagramsSent() const
+{
+    uint64_t n = 0;
+    for (const UdpChannelPtr &channel : channels_)
+    {
+        n += channel->datagramsSent();
+    }
+    return n;
+}
+
+uint64_t UdpServer::sendCalls() const
+{
+    uint64_t n = 0;
+    for (const UdpChannelPtr &channel : channels_)
+    {
+        n += channel->sendCalls();
+    }
+    return n;
+}
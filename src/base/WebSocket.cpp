@@ -0,0 +1,604 @@
+#include "WebSocket.h"
+#include "BufferScan.h"
+#include "Buffer.h"
+#include "HttpParser.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "TcpConnection.h"
+#include "Logger.h"
+#include <cstring>
+#include <vector>
+#include <sys/uio.h>
+
+namespace
+{
+
+const char kWebSocketGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+uint32_t rotl(uint32_t x, int n)
+{
+    return (x << n) | (x >> (32 - n));
+}
+
+// 只用于握手，输入很短，按标准算法逐块处理即可
+void sha1(const std::string& input, unsigned char digest[20])
+{
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    std::string msg = input;
+    msg.push_back(static_cast<char>(0x80));
+    while (msg.size() % 64 != 56)
+    {
+        msg.push_back('\0');
+    }
+    uint64_t bits = static_cast<uint64_t>(input.size()) * 8;
+    for (int i = 7; i >= 0; --i)
+    {
+        msg.push_back(static_cast<char>(bits >> (i * 8)));
+    }
+
+    for (size_t block = 0; block < msg.size(); block += 64)
+    {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(msg.data() + block);
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i)
+        {
+            w[i] = (static_cast<uint32_t>(p[i * 4]) << 24) | (static_cast<uint32_t>(p[i * 4 + 1]) << 16)
+                 | (static_cast<uint32_t>(p[i * 4 + 2]) << 8) | static_cast<uint32_t>(p[i * 4 + 3]);
+        }
+        for (int i = 16; i < 80; ++i)
+        {
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i)
+        {
+            uint32_t f, k;
+            if (i < 20)
+            {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            }
+            else if (i < 40)
+            {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            }
+            else if (i < 60)
+            {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            }
+            else
+            {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    for (int i = 0; i < 5; ++i)
+    {
+        digest[i * 4] = static_cast<unsigned char>(h[i] >> 24);
+        digest[i * 4 + 1] = static_cast<unsigned char>(h[i] >> 16);
+        digest[i * 4 + 2] = static_cast<unsigned char>(h[i] >> 8);
+        digest[i * 4 + 3] = static_cast<unsigned char>(h[i]);
+    }
+}
+
+std::string base64Encode(const unsigned char* data, size_t len)
+{
+    static const char kTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((len + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 3 <= len; i += 3)
+    {
+        uint32_t v = (static_cast<uint32_t>(data[i]) << 16) | (static_cast<uint32_t>(data[i + 1]) << 8) | data[i + 2];
+        out.push_back(kTable[(v >> 18) & 0x3F]);
+        out.push_back(kTable[(v >> 12) & 0x3F]);
+        out.push_back(kTable[(v >> 6) & 0x3F]);
+        out.push_back(kTable[v & 0x3F]);
+    }
+    if (i < len)
+    {
+        uint32_t v = static_cast<uint32_t>(data[i]) << 16;
+        if (i + 1 < len)
+        {
+            v |= static_cast<uint32_t>(data[i + 1]) << 8;
+        }
+        out.push_back(kTable[(v >> 18) & 0x3F]);
+        out.push_back(kTable[(v >> 12) & 0x3F]);
+        out.push_back(i + 1 < len ? kTable[(v >> 6) & 0x3F] : '=');
+        out.push_back('=');
+    }
+    return out;
+}
+
+// 合法的升级请求返回0，否则返回应答的状态码
+int checkUpgradeRequest(const HttpRequest& req)
+{
+    if (req.method() != "GET" || req.minorVersion() < 1
+        || !HttpRequest::hasToken(req.header("Connection"), "upgrade"))
+    {
+        return 400;
+    }
+    // 16字节随机数的base64编码
+    if (req.header("Sec-WebSocket-Key").size() != 24)
+    {
+        return 400;
+    }
+    if (req.header("Sec-WebSocket-Version") != "13")
+    {
+        return 426;
+    }
+    return 0;
+}
+
+void sendHttpResponse(const TcpConnectionPtr& conn, const HttpResponse& response)
+{
+    Buffer out;
+    response.appendToBuffer(&out);
+    conn->send(&out);
+}
+
+} // namespace
+
+namespace websocket
+{
+
+std::string acceptKey(std::string_view clientKey)
+{
+    std::string input(clientKey);
+    input.append(kWebSocketGuid);
+    unsigned char digest[20];
+    sha1(input, digest);
+    return base64Encode(digest, sizeof digest);
+}
+
+size_t encodeFrameHeader(char* out, Opcode opcode, uint64_t payloadLen, bool fin, const unsigned char* maskKey)
+{
+    unsigned char* p = reinterpret_cast<unsigned char*>(out);
+    const unsigned char maskBit = maskKey ? 0x80 : 0;
+    p[0] = static_cast<unsigned char>((fin ? 0x80 : 0) | opcode);
+    size_t n;
+    if (payloadLen < 126)
+    {
+        p[1] = static_cast<unsigned char>(maskBit | payloadLen);
+        n = 2;
+    }
+    else if (payloadLen <= 0xFFFF)
+    {
+        p[1] = maskBit | 126;
+        p[2] = static_cast<unsigned char>(payloadLen >> 8);
+        p[3] = static_cast<unsigned char>(payloadLen);
+        n = 4;
+    }
+    else
+    {
+        p[1] = maskBit | 127;
+        for (int i = 0; i < 8; ++i)
+        {
+            p[2 + i] = static_cast<unsigned char>(payloadLen >> (56 - 8 * i));
+        }
+        n = 10;
+    }
+    if (maskKey)
+    {
+        ::memcpy(p + n, maskKey, 4);
+        n += 4;
+    }
+    return n;
+}
+
+} // namespace websocket
+
+WebSocketConnection::WebSocketConnection(const TcpConnectionPtr& conn)
+    : conn_(conn),
+      name_(conn->name()),
+      state_(kHandshake),
+      handshake_(new HttpParser),
+      messageOpcode_(websocket::kText),
+      inMessage_(false),
+      unmaskedBytes_(0)
+{
+}
+
+WebSocketConnection::~WebSocketConnection() = default;
+
+void WebSocketConnection::sendFrame(websocket::Opcode opcode, std::string_view payload)
+{
+    TcpConnectionPtr conn = conn_.lock();
+    if (!conn)
+    {
+        return;
+    }
+    char header[websocket::kMaxFrameHeaderSize];
+    size_t headerLen = websocket::encodeFrameHeader(header, opcode, payload.size());
+    struct iovec iov[2];
+    iov[0].iov_base = header;
+    iov[0].iov_len = headerLen;
+    iov[1].iov_base = const_cast<char*>(payload.data());
+    iov[1].iov_len = payload.size();
+    conn->sendv(iov, payload.empty() ? 1 : 2);
+}
+
+void WebSocketConnection::send(std::string_view payload, websocket::Opcode opcode)
+{
+    if (state_ == kOpen)
+    {
+        sendFrame(opcode, payload);
+    }
+}
+
+void WebSocketConnection::send(const std::string_view* payloads, size_t n, websocket::Opcode opcode)
+{
+    TcpConnectionPtr conn = conn_.lock();
+    if (!conn || state_ != kOpen || n == 0)
+    {
+        return;
+    }
+    std::vector<char> headers(n * websocket::kMaxFrameHeaderSize);
+    std::vector<struct iovec> iov;
+    iov.reserve(n * 2);
+    for (size_t i = 0; i < n; ++i)
+    {
+        char* header = headers.data() + i * websocket::kMaxFrameHeaderSize;
+        size_t headerLen = websocket::encodeFrameHeader(header, opcode, payloads[i].size());
+        iov.push_back({header, headerLen});
+        if (!payloads[i].empty())
+        {
+            iov.push_back({const_cast<char*>(payloads[i].data()), payloads[i].size()});
+        }
+    }
+    conn->sendv(iov.data(), static_cast<int>(iov.size()));
+}
+
+void WebSocketConnection::ping(std::string_view payload)
+{
+    if (state_ == kOpen)
+    {
+        // 控制帧负载不超过125字节
+        sendFrame(websocket::kPing, payload.substr(0, 125));
+    }
+}
+
+void WebSocketConnection::close(uint16_t code, std::string_view reason)
+{
+    int expected = kOpen;
+    if (!state_.compare_exchange_strong(expected, kClosing))
+    {
+        return;
+    }
+    char payload[125];
+    payload[0] = static_cast<char>(code >> 8);
+    payload[1] = static_cast<char>(code);
+    size_t reasonLen = std::min(reason.size(), sizeof payload - 2);
+    ::memcpy(payload + 2, reason.data(), reasonLen);
+    sendFrame(websocket::kClose, std::string_view(payload, 2 + reasonLen));
+    if (TcpConnectionPtr conn = conn_.lock())
+    {
+        conn->shutdown();
+    }
+}
+
+WebSocketServer::WebSocketServer(EventLoop* loop,
+                                 const InetAddress& listenAddr,
+                                 TcpServer::Option option)
+    : server_(loop, listenAddr, option),
+      maxMessageSize_(kDefaultMaxMessageSize)
+{
+    server_.setConnectionCallback(
+        std::bind(&WebSocketServer::onConnection, this, std::placeholders::_1));
+    server_.setMessageCallback(
+        std::bind(&WebSocketServer::onMessage, this,
+                  std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+}
+
+void WebSocketServer::start()
+{
+    server_.start();
+}
+
+void WebSocketServer::onConnection(const TcpConnectionPtr& conn)
+{
+    if (conn->connected())
+    {
+        conn->setContext(std::make_shared<WebSocketConnection>(conn));
+        return;
+    }
+    auto* wsPtr = std::any_cast<WebSocketConnectionPtr>(conn->getMutableContext());
+    if (wsPtr == nullptr)
+    {
+        return;
+    }
+    WebSocketConnectionPtr ws = *wsPtr;
+    // 只有完成握手的连接才通知应用
+    if (!ws->handshake_)
+    {
+        ws->state_ = WebSocketConnection::kClosing;
+        if (connectionCallback_)
+        {
+            connectionCallback_(ws);
+        }
+    }
+}
+
+void WebSocketServer::onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp receiveTime)
+{
+    auto* wsPtr = std::any_cast<WebSocketConnectionPtr>(conn->getMutableContext());
+    if (wsPtr == nullptr)
+    {
+        buf->retrieveAll();
+        return;
+    }
+    WebSocketConnectionPtr ws = *wsPtr;
+    if (ws->state_ == WebSocketConnection::kHandshake && !handleHandshake(conn, ws, buf))
+    {
+        return;
+    }
+    if (ws->state_ == WebSocketConnection::kOpen)
+    {
+        handleFrames(ws, buf, receiveTime);
+    }
+    else
+    {
+        // 已发出关闭帧，之后的数据不再处理
+        buf->retrieveAll();
+    }
+}
+
+bool WebSocketServer::handleHandshake(const TcpConnectionPtr& conn, const WebSocketConnectionPtr& ws, Buffer* buf)
+{
+    HttpParser* parser = ws->handshake_.get();
+    for (;;)
+    {
+        HttpParser::Result result = parser->parse(buf);
+        if (result == HttpParser::kNeedMore)
+        {
+            return false;
+        }
+        if (result == HttpParser::kError)
+        {
+            HttpResponse response(true);
+            response.setStatusCode(parser->errorStatus());
+            sendHttpResponse(conn, response);
+            buf->retrieveAll();
+            conn->shutdown();
+            return false;
+        }
+
+        const HttpRequest& request = parser->request();
+        if (HttpRequest::hasToken(request.header("Upgrade"), "websocket"))
+        {
+            int status = checkUpgradeRequest(request);
+            if (status == 0 && handshakeCallback_ && !handshakeCallback_(request))
+            {
+                status = HttpResponse::k403Forbidden;
+            }
+            if (status != 0)
+            {
+                HttpResponse response(true);
+                response.setStatusCode(status);
+                if (status == HttpResponse::k426UpgradeRequired)
+                {
+                    response.addHeader("Sec-WebSocket-Version", "13");
+                }
+                sendHttpResponse(conn, response);
+                buf->retrieveAll();
+                conn->shutdown();
+                return false;
+            }
+
+            Buffer out;
+            out.append(std::string("HTTP/1.1 101 Switching Protocols\r\n"
+                                   "Upgrade: websocket\r\n"
+                                   "Connection: Upgrade\r\n"
+                                   "Sec-WebSocket-Accept: "));
+            out.append(websocket::acceptKey(request.header("Sec-WebSocket-Key")));
+            out.append("\r\n\r\n", 4);
+            conn->send(&out);
+
+            // 握手请求之后可能紧跟着客户端的第一批帧，留在缓冲区中继续按帧解析
+            buf->retrieve(parser->consumed());
+            ws->handshake_.reset();
+            ws->state_ = WebSocketConnection::kOpen;
+            if (connectionCallback_)
+            {
+                connectionCallback_(ws);
+            }
+            return ws->state_ == WebSocketConnection::kOpen;
+        }
+
+        // 普通HTTP请求
+        HttpResponse response(!request.keepAlive());
+        if (httpCallback_)
+        {
+            httpCallback_(request, &response);
+        }
+        else
+        {
+            response.setStatusCode(HttpResponse::k426UpgradeRequired);
+            response.addHeader("Upgrade", "websocket");
+        }
+        sendHttpResponse(conn, response);
+        buf->retrieve(parser->consumed());
+        parser->reset();
+        if (response.closeConnection())
+        {
+            buf->retrieveAll();
+            conn->shutdown();
+            return false;
+        }
+    }
+}
+
+void WebSocketServer::handleFrames(const WebSocketConnectionPtr& ws, Buffer* buf, Timestamp receiveTime)
+{
+    char* base = buf->mutablePeek();
+    const size_t readable = buf->readableBytes();
+    size_t consumed = 0;
+
+    while (ws->state_ == WebSocketConnection::kOpen)
+    {
+        const size_t avail = readable - consumed;
+        if (avail < 2)
+        {
+            break;
+        }
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(base + consumed);
+        const bool fin = (p[0] & 0x80) != 0;
+        const int opcode = p[0] & 0x0F;
+        const bool control = (opcode & 0x8) != 0;
+        size_t lengthBytes = (p[1] & 0x7F) == 126 ? 2 : ((p[1] & 0x7F) == 127 ? 8 : 0);
+        // 保留位必须为0，客户端发来的帧必须带掩码
+        if ((p[0] & 0x70) != 0 || (p[1] & 0x80) == 0)
+        {
+            failConnection(ws, websocket::kProtocolError);
+            break;
+        }
+        const size_t headerLen = 2 + lengthBytes + 4;
+        if (avail < headerLen)
+        {
+            break;
+        }
+        uint64_t payloadLen = p[1] & 0x7F;
+        if (lengthBytes > 0)
+        {
+            payloadLen = 0;
+            for (size_t i = 0; i < lengthBytes; ++i)
+            {
+                payloadLen = (payloadLen << 8) | p[2 + i];
+            }
+            if (payloadLen >> 63)
+            {
+                failConnection(ws, websocket::kProtocolError);
+                break;
+            }
+        }
+
+        if (control)
+        {
+            if (!fin || payloadLen > 125
+                || (opcode != websocket::kClose && opcode != websocket::kPing && opcode != websocket::kPong))
+            {
+                failConnection(ws, websocket::kProtocolError);
+                break;
+            }
+        }
+        else
+        {
+            bool continuation = opcode == websocket::kContinuation;
+            if ((opcode != websocket::kText && opcode != websocket::kBinary && !continuation)
+                || continuation != ws->inMessage_)
+            {
+                failConnection(ws, websocket::kProtocolError);
+                break;
+            }
+            // 只看帧头就能判断超限，不必缓存整帧
+            if (ws->message_.size() + payloadLen > maxMessageSize_)
+            {
+                failConnection(ws, websocket::kMessageTooBig);
+                break;
+            }
+        }
+
+        const unsigned char* maskKey = p + headerLen - 4;
+        char* payload = base + consumed + headerLen;
+        const size_t available = avail - headerLen;
+        if (available < payloadLen)
+        {
+            // 大帧边收边解掩码，趁刚读入的数据还在缓存中
+            if (available > ws->unmaskedBytes_)
+            {
+                scan::xorMask(payload + ws->unmaskedBytes_, available - ws->unmaskedBytes_,
+                              maskKey, ws->unmaskedBytes_);
+                ws->unmaskedBytes_ = available;
+            }
+            break;
+        }
+        const size_t len = static_cast<size_t>(payloadLen);
+        scan::xorMask(payload + ws->unmaskedBytes_, len - ws->unmaskedBytes_, maskKey, ws->unmaskedBytes_);
+        ws->unmaskedBytes_ = 0;
+        consumed += headerLen + len;
+
+        switch (opcode)
+        {
+        case websocket::kPing:
+            ws->sendFrame(websocket::kPong, std::string_view(payload, len));
+            break;
+        case websocket::kPong:
+            break;
+        case websocket::kClose:
+        {
+            if (len == 1)
+            {
+                failConnection(ws, websocket::kProtocolError);
+                break;
+            }
+            uint16_t code = websocket::kNormalClosure;
+            if (len >= 2)
+            {
+                code = static_cast<uint16_t>((static_cast<unsigned char>(payload[0]) << 8)
+                                             | static_cast<unsigned char>(payload[1]));
+            }
+            // 回应关闭帧，带回对端的状态码
+            ws->close(code);
+            break;
+        }
+        default:
+            if (fin && !ws->inMessage_)
+            {
+                // 不分片的消息直接交出inputBuffer_中的视图
+                if (messageCallback_)
+                {
+                    messageCallback_(ws, std::string_view(payload, len),
+                                     static_cast<websocket::Opcode>(opcode), receiveTime);
+                }
+                break;
+            }
+            if (!ws->inMessage_)
+            {
+                ws->inMessage_ = true;
+                ws->messageOpcode_ = static_cast<websocket::Opcode>(opcode);
+            }
+            ws->message_.append(payload, len);
+            if (fin)
+            {
+                if (messageCallback_)
+                {
+                    messageCallback_(ws, ws->message_, ws->messageOpcode_, receiveTime);
+                }
+                ws->message_.clear();
+                ws->inMessage_ = false;
+            }
+            break;
+        }
+    }
+
+    if (ws->state_ == WebSocketConnection::kOpen)
+    {
+        buf->retrieve(consumed);
+    }
+    else
+    {
+        buf->retrieveAll();
+    }
+}
+
+void WebSocketServer::failConnection(const WebSocketConnectionPtr& ws, uint16_t code)
+{
+    LOG_INFO("WebSocketServer::failConnection %s, code=%d", ws->name().c_str(), code);
+    ws->close(code);
+}
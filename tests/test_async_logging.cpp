@@ -1,6 +1,7 @@
 #include "AsyncLoggingInit.h"
 #include "Logger.h"
 #include "Thread.h"
+#include "LogFile.h"
 
 // 声明resetAsyncLogging函数
 void resetAsyncLogging();
@@ -379,6 +380,213 @@ void test10_ZeroLengthMessage() {
     }
 }
 
+// 测试11: 每线程缓冲区 - 小缓冲区、浅缓冲池下频繁交接，每个线程的日志完整且保持顺序
+void test11_PerThreadOrdering() {
+    std::cout << "\n[TEST 11] Per-thread Buffer Ordering..." << std::endl;
+    const int kThreads = 8;
+    const int kMessagesPerThread = 20000;
+    system("rm -f log/test_order*.log 2>/dev/null");
+    {
+        AsyncLogging log("log/test_order", 1024 * 1024 * 1024, 1, 4096, 2);
+        log.start();
+        std::vector<std::unique_ptr<Thread>> threads;
+        for (int i = 0; i < kThreads; ++i) {
+            threads.emplace_back(new Thread([i, &log]() {
+                char line[64];
+                for (int j = 0; j < kMessagesPerThread; ++j) {
+                    int len = snprintf(line, sizeof line, "T%d %d\n", i, j);
+                    log.append(line, len);
+                }
+            }, "OrderThread"));
+        }
+        for (auto& thread : threads) {
+            thread->start();
+        }
+        for (auto& thread : threads) {
+            thread->join();
+        }
+        log.stop();
+    }
+
+    std::vector<int> next(kThreads, 0);
+    bool ordered = true;
+    FILE* pipe = popen("cat log/test_order*.log", "r");
+    char buffer[128];
+    while (pipe && fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+        int thread = -1;
+        int seq = -1;
+        if (sscanf(buffer, "T%d %d", &thread, &seq) != 2 || thread < 0 || thread >= kThreads
+            || seq != next[thread]) {
+            ordered = false;
+            break;
+        }
+        ++next[thread];
+    }
+    if (pipe) {
+        pclose(pipe);
+    }
+    for (int i = 0; i < kThreads; ++i) {
+        ordered = ordered && next[i] == kMessagesPerThread;
+    }
+    if (ordered) {
+        test_passed++;
+        std::cout << "[PASS] Test 11: Every thread's lines are complete and in order" << std::endl;
+    } else {
+        test_failed++;
+        std::cout << "[FAIL] Test 11: Lost or reordered lines" << std::endl;
+    }
+}
+
+// 读出文件中的"seq N"行，其余行（丢弃统计）单独返回
+static void readSeqLines(const char* pattern, std::vector<int>* seqs, std::string* notices,
+                         const char* reader = "cat ") {
+    FILE* pipe = popen((std::string(reader) + pattern).c_str(), "r");
+    char buffer[256];
+    while (pipe && fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+        int seq = -1;
+        if (sscanf(buffer, "seq %d", &seq) == 1) {
+            seqs->push_back(seq);
+        } else {
+            notices->append(buffer);
+        }
+    }
+    if (pipe) {
+        pclose(pipe);
+    }
+}
+
+// 测试12: 积压上限 - 后端没有启动时积压很快写满，三种策略分别检查丢弃的是哪些日志和统计是否准确
+void test12_BacklogLimit() {
+    std::cout << "\n[TEST 12] Backlog Limit And Overflow Policies..." << std::endl;
+    const int kLines = 3000;
+    bool ok = true;
+    char line[32];
+
+    for (AsyncLogging::OverflowPolicy policy : {AsyncLogging::kDropNewest, AsyncLogging::kDropOldest}) {
+        system("rm -f log/test_backlog*.log 2>/dev/null");
+        uint64_t dropped = 0;
+        {
+            AsyncLogging log("log/test_backlog", 1024 * 1024 * 1024, 1, 4096, 2);
+            log.setBacklogLimit(8192, policy);
+            for (int i = 0; i < kLines; ++i) {
+                int len = snprintf(line, sizeof line, "seq %d\n", i);
+                log.append(line, len);
+            }
+            ok = ok && log.backlogBytes() <= 8192 && log.droppedLines() > 0;
+            dropped = log.droppedLines();
+            log.start();
+            log.stop();
+            ok = ok && log.backlogBytes() == 0;
+        }
+
+        std::vector<int> seqs;
+        std::string notices;
+        readSeqLines("log/test_backlog*.log", &seqs, &notices);
+        ok = ok && seqs.size() + dropped == kLines;
+        ok = ok && notices.find("ERROR: AsyncLogging dropped " + std::to_string(dropped) + " lines") != std::string::npos;
+        for (size_t i = 1; i < seqs.size(); ++i) {
+            ok = ok && seqs[i] > seqs[i - 1];
+        }
+        if (policy == AsyncLogging::kDropNewest) {
+            // 保留最早的日志
+            ok = ok && !seqs.empty() && seqs.front() == 0 && seqs.back() == static_cast<int>(seqs.size()) - 1;
+        } else {
+            // 保留最近的日志
+            ok = ok && !seqs.empty() && seqs.front() == 0 && seqs.back() == kLines - 1;
+        }
+    }
+
+    // 阻塞策略：后端在运行，写日志的线程等待积压下降，一条都不丢
+    system("rm -f log/test_backlog*.log 2>/dev/null");
+    {
+        AsyncLogging log("log/test_backlog", 1024 * 1024 * 1024, 1, 4096, 2);
+        log.setBacklogLimit(8192, AsyncLogging::kBlock, 10.0);
+        log.start();
+        std::vector<std::unique_ptr<Thread>> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back(new Thread([&log]() {
+                char text[32];
+                for (int i = 0; i < 20000; ++i) {
+                    int len = snprintf(text, sizeof text, "seq %d\n", i);
+                    log.append(text, len);
+                }
+            }, "BlockThread"));
+        }
+        for (auto& thread : threads) {
+            thread->start();
+        }
+        for (auto& thread : threads) {
+            thread->join();
+        }
+        log.stop();
+        ok = ok && log.droppedLines() == 0;
+    }
+    std::vector<int> seqs;
+    std::string notices;
+    readSeqLines("log/test_backlog*.log", &seqs, &notices);
+    ok = ok && seqs.size() == 4 * 20000 && notices.empty();
+
+    if (ok) {
+        test_passed++;
+        std::cout << "[PASS] Test 12: Backlog stays bounded and drops are reported" << std::endl;
+    } else {
+        test_failed++;
+        std::cout << "[FAIL] Test 12: Backlog limit or drop accounting is wrong" << std::endl;
+    }
+}
+
+// 测试13: LogFile直接写文件 - 多级目录自动创建，滚动出去的文件在后台压缩，内容完整有序
+void test13_LogFileArchive() {
+    std::cout << "\n[TEST 13] LogFile Preallocation, Rolling And Compression..." << std::endl;
+    system("rm -rf log/archive 2>/dev/null");
+    const int kLines = 20000;
+    {
+        LogFile file("log/archive/nested/test_gz", 64 * 1024, true, 3, 1);
+        file.setCompressRolledFiles(true);
+        char line[32];
+        for (int i = 0; i < kLines; ++i) {
+            int len = snprintf(line, sizeof line, "seq %d\n", i);
+            file.append(line, len);
+        }
+    }
+
+    FILE* pipe = popen("ls log/archive/nested/ 2>/dev/null", "r");
+    char name[256];
+    int logFiles = 0;
+    int gzFiles = 0;
+    int tmpFiles = 0;
+    while (pipe && fgets(name, sizeof name, pipe) != nullptr) {
+        std::string entry(name);
+        if (entry.find(".gz.tmp") != std::string::npos) {
+            ++tmpFiles;
+        } else if (entry.find(".log.gz") != std::string::npos) {
+            ++gzFiles;
+        } else if (entry.find(".log") != std::string::npos) {
+            ++logFiles;
+        }
+    }
+    if (pipe) {
+        pclose(pipe);
+    }
+
+    std::vector<int> seqs;
+    std::string notices;
+    readSeqLines("log/archive/nested/test_gz*", &seqs, &notices, "zcat -f ");
+    bool ok = logFiles + gzFiles >= 3 && tmpFiles == 0 && seqs.size() == kLines && notices.empty();
+    for (int i = 0; ok && i < kLines; ++i) {
+        ok = seqs[i] == i;
+    }
+    std::cout << "  " << logFiles << " plain and " << gzFiles << " compressed files" << std::endl;
+
+    if (ok) {
+        test_passed++;
+        std::cout << "[PASS] Test 13: Rolled files are archived and no line is lost" << std::endl;
+    } else {
+        test_failed++;
+        std::cout << "[FAIL] Test 13: LogFile lost lines or left temporary files" << std::endl;
+    }
+}
+
 int main() {
     std::cout << "========================================" << std::endl;
     std::cout << "=== Comprehensive AsyncLogging Tests ===" << std::endl;
@@ -403,6 +611,9 @@ int main() {
     test8_RapidStartStop();
     test9_HighConcurrencyStress();
     test10_ZeroLengthMessage();
+    test11_PerThreadOrdering();
+    test12_BacklogLimit();
+    test13_LogFileArchive();
 
     // 输出测试结果
     std::cout << "\n========================================" << std::endl;
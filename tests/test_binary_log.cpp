@@ -0,0 +1,179 @@
+#include "BinaryLog.h"
+#include "AsyncLogging.h"
+#include "Logger.h"
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+enum Color { kRed = 1, kBlue = 2 };
+
+// 参数类型码和转换说明个数都在编译期确定
+static_assert(binlog::detail::argCode<int>() == 'i', "");
+static_assert(binlog::detail::argCode<unsigned short>() == 'H', "");
+static_assert(binlog::detail::argCode<int64_t>() == 'l', "");
+static_assert(binlog::detail::argCode<char[6]>() == 's', "");
+static_assert(binlog::detail::argCode<string>() == 's', "");
+static_assert(binlog::detail::argCode<float>() == 'd', "");
+static_assert(binlog::detail::argCode<Color>() == 'I' || binlog::detail::argCode<Color>() == 'i', "");
+static_assert(binlog::detail::argCode<const void*>() == 'p', "");
+static_assert(binlog::detail::countConversions("a %d %% %-5s %.2f") == 3, "");
+
+static string g_captured;
+
+// 去掉"[时间] 级别: "前缀
+static string messageOf(const string& line) {
+    size_t pos = line.find(": ");
+    return pos == string::npos ? line : line.substr(pos + 2);
+}
+
+static string readFiles(const char* pattern) {
+    string content;
+    FILE* pipe = popen((string("cat ") + pattern).c_str(), "r");
+    char buf[4096];
+    size_t n;
+    while (pipe && (n = fread(buf, 1, sizeof buf, pipe)) > 0) {
+        content.append(buf, n);
+    }
+    if (pipe) {
+        pclose(pipe);
+    }
+    return content;
+}
+
+// 未设置输出时就地格式化，结果和printf一致
+void test_format_inline() {
+    cout << "=== Test Format Inline ===" << endl;
+
+    Logger::setOutput([](const char* msg, int len) { g_captured.append(msg, len); });
+    string name = "conn-7";
+    const char* nullString = nullptr;
+    short negative = -2;
+    BLOG_INFO("name=%s fd=%d", name, 42);
+    BLOG_INFO("%-6s|%5.2f|%u|%#x|%c|%%|%lld", "ab", 3.14159, negative, 255u, 'z', -9000000000LL);
+    BLOG_ERROR("%.3s %s %d", "abcdef", nullString, kBlue);
+    BLOG_DEBUG("filtered %d", 1);
+    Logger::setOutput([](const char* msg, int len) { fwrite(msg, 1, len, stdout); });
+
+    char expected[128];
+    snprintf(expected, sizeof expected, "%-6s|%5.2f|%u|%#x|%c|%%|%lld\n",
+             "ab", 3.14159, static_cast<unsigned short>(negative), 255u, 'z', -9000000000LL);
+    size_t first = g_captured.find('\n');
+    size_t second = g_captured.find('\n', first + 1);
+    assert(g_captured.find("] INFO: ") != string::npos);
+    assert(messageOf(g_captured.substr(0, first + 1)) == "name=conn-7 fd=42\n");
+    assert(messageOf(g_captured.substr(first + 1, second - first)) == expected);
+    assert(messageOf(g_captured.substr(second + 1)) == "abc (null) 2\n");
+    cout << "Format inline test passed" << endl;
+}
+
+// 后端格式化：多个线程写二进制记录，文件里是和LOG_INFO一样的文本
+void test_backend_formatting() {
+    cout << "=== Test Backend Formatting ===" << endl;
+
+    system("rm -f log/test_binlog_text*.log 2>/dev/null");
+    const int kThreads = 4;
+    const int kMessages = 5000;
+    {
+        AsyncLogging log("log/test_binlog_text", 1024 * 1024 * 1024, 1, 8192, 2);
+        log.setEncoding(AsyncLogging::kBinaryFormatted);
+        log.start();
+        binlog::setOutput([&log](const char* record, int len) { log.append(record, len); });
+        vector<unique_ptr<Thread>> threads;
+        for (int i = 0; i < kThreads; ++i) {
+            threads.emplace_back(new Thread([i]() {
+                for (int j = 0; j < kMessages; ++j) {
+                    BLOG_INFO("thread %d seq %d %s", i, j, "payload");
+                }
+            }, "BinlogThread"));
+        }
+        for (auto& thread : threads) {
+            thread->start();
+        }
+        for (auto& thread : threads) {
+            thread->join();
+        }
+        binlog::setOutput(nullptr);
+        log.stop();
+    }
+
+    vector<int> next(kThreads, 0);
+    string content = readFiles("log/test_binlog_text*.log");
+    size_t pos = 0;
+    while (pos < content.size()) {
+        size_t end = content.find('\n', pos);
+        assert(end != string::npos);
+        int thread = -1;
+        int seq = -1;
+        char payload[16];
+        string message = messageOf(content.substr(pos, end - pos));
+        assert(sscanf(message.c_str(), "thread %d seq %d %15s", &thread, &seq, payload) == 3);
+        assert(thread >= 0 && thread < kThreads && seq == next[thread]);
+        assert(string(payload) == "payload");
+        ++next[thread];
+        pos = end + 1;
+    }
+    for (int i = 0; i < kThreads; ++i) {
+        assert(next[i] == kMessages);
+    }
+    cout << "Backend formatting test passed" << endl;
+}
+
+// 原样写入：文件里带格式点定义，不查本进程注册表也能解码；分块喂给Decoder
+void test_raw_and_decode() {
+    cout << "=== Test Raw And Decode ===" << endl;
+
+    system("rm -f log/test_binlog_raw*.log 2>/dev/null");
+    {
+        AsyncLogging log("log/test_binlog_raw", 1024 * 1024 * 1024, 1, 4096, 2);
+        log.setEncoding(AsyncLogging::kBinaryRaw);
+        log.start();
+        binlog::setOutput([&log](const char* record, int len) { log.append(record, len); });
+        for (int i = 0; i < 1000; ++i) {
+            BLOG_INFO("raw %d %.1f %s", i, i / 2.0, string(i % 7, 'x'));
+        }
+        BLOG_ERROR("done %p", static_cast<const void*>(nullptr));
+        binlog::setOutput(nullptr);
+        log.stop();
+    }
+
+    string raw = readFiles("log/test_binlog_raw*.log");
+    binlog::RecordHeader header;
+    memcpy(&header, raw.data(), sizeof header);
+    assert(header.siteId == binlog::kSiteDefinition);
+
+    binlog::Decoder decoder(false);
+    string text;
+    string pending;
+    for (size_t pos = 0; pos < raw.size(); pos += 100) {
+        pending.append(raw, pos, 100);
+        pending.erase(0, decoder.decode(pending.data(), pending.size(), &text));
+    }
+    assert(pending.empty());
+
+    size_t pos = 0;
+    for (int i = 0; i < 1000; ++i) {
+        size_t end = text.find('\n', pos);
+        char expected[64];
+        snprintf(expected, sizeof expected, "raw %d %.1f %s", i, i / 2.0, string(i % 7, 'x').c_str());
+        assert(messageOf(text.substr(pos, end - pos)) == expected);
+        pos = end + 1;
+    }
+    assert(text.find("] ERROR: done ", pos) == pos + 25);
+    cout << "Raw and decode test passed, " << raw.size() << " bytes -> " << text.size() << " bytes" << endl;
+}
+
+int main() {
+    cout << "=== Binary Log Tests ===" << endl;
+
+    test_format_inline();
+    test_backend_formatting();
+    test_raw_and_decode();
+
+    system("rm -f log/test_binlog*.log 2>/dev/null");
+    cout << "=== All Binary Log Tests Passed ===" << endl;
+    return 0;
+}
@@ -3,6 +3,7 @@
 #include <string>
 #include <cassert>
 #include <cstring>
+#include <algorithm>
 
 void testBufferEmpty()
 {
@@ -218,6 +219,140 @@ void testBufferFindCRLF()
     assert(buf3.findCRLF() == nullptr);
 }
 
+void testBufferIntegers()
+{
+    Buffer buf;
+    buf.appendInt8(-1);
+    buf.appendInt16(0x1234);
+    buf.appendInt32(-123456789);
+    buf.appendInt64(0x0102030405060708LL);
+    assert(buf.readableBytes() == 1 + 2 + 4 + 8);
+    // 网络字节序，高位在前
+    assert(buf.peek()[1] == 0x12 && buf.peek()[2] == 0x34);
+
+    assert(buf.peekInt8() == -1);
+    assert(buf.readInt8() == -1);
+    assert(buf.readInt16() == 0x1234);
+    assert(buf.peekInt32() == -123456789);
+    assert(buf.readInt32() == -123456789);
+    assert(buf.readInt64() == 0x0102030405060708LL);
+    assert(buf.readableBytes() == 0);
+
+    buf.append("body");
+    buf.prependInt32(4);
+    assert(buf.readableBytes() == 8);
+    assert(buf.readInt32() == 4);
+    assert(buf.retrieveAllAsString() == "body");
+}
+
+void testBufferVarint()
+{
+    Buffer buf;
+    const uint64_t values[] = {0, 1, 127, 128, 300, 16384, 0xffffffffULL, ~0ULL};
+    for (uint64_t v : values)
+    {
+        buf.appendVarint(v);
+    }
+    // 300编码为0xac 0x02
+    Buffer one;
+    one.appendVarint(300);
+    assert(one.readableBytes() == 2);
+    assert(static_cast<uint8_t>(one.peek()[0]) == 0xac && one.peek()[1] == 0x02);
+
+    for (uint64_t v : values)
+    {
+        uint64_t got = 0;
+        assert(buf.peekVarint(&got) > 0);
+        assert(got == v);
+        assert(buf.readVarint() == v);
+    }
+    assert(buf.readableBytes() == 0);
+
+    // 不完整：只有带延续位的字节
+    uint64_t value = 0;
+    buf.append("\x80\x80", 2);
+    assert(buf.peekVarint(&value) == 0);
+    buf.retrieveAll();
+
+    // 超过10字节仍未结束视为非法
+    std::string bad(11, '\x80');
+    buf.append(bad);
+    assert(buf.peekVarint(&value) == -1);
+    buf.retrieveAll();
+
+    // 第10字节大于0x01时超出64位
+    buf.append(std::string(9, '\xff'));
+    buf.append("\x02", 1);
+    assert(buf.peekVarint(&value) == -1);
+}
+
+// 各实现与std::search/std::find的结果逐个起点比较，覆盖16/32字节块边界和尾部
+void testBufferScanImplementations()
+{
+    std::string data;
+    unsigned seed = 12345;
+    for (int i = 0; i < 1000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        int r = (seed >> 16) % 40;
+        data.push_back(r == 0 ? '\r' : r == 1 ? '\n' : r == 2 ? ':' : static_cast<char>('a' + r % 26));
+    }
+    const char* set = ":\n";
+    const scan::Implementation detected = scan::implementation();
+    const scan::Implementation impls[] = {scan::kScalar, scan::kSse2, scan::kAvx2};
+    for (scan::Implementation impl : impls)
+    {
+        if (!scan::setImplementation(impl))
+        {
+            std::cout << "  skip " << scan::implementationName(impl) << std::endl;
+            continue;
+        }
+        const char* begin = data.data();
+        const char* end = begin + data.size();
+        for (size_t off = 0; off < data.size(); ++off)
+        {
+            const char* start = begin + off;
+            const char* crlf = std::search(start, end, "\r\n", "\r\n" + 2);
+            assert(scan::findCRLF(start, end) == (crlf == end ? nullptr : crlf));
+            const char* lf = std::find(start, end, '\n');
+            assert(scan::findByte(start, end, '\n') == (lf == end ? nullptr : lf));
+            const char* any = std::find_first_of(start, end, set, set + 2);
+            assert(scan::findAnyOf(start, end, set, 2) == (any == end ? nullptr : any));
+        }
+        // 末尾只有'\r'时不能越界读到下一个字节
+        assert(scan::findCRLF(begin, begin + 1) == nullptr);
+        std::cout << "  " << scan::implementationName(impl) << " ok" << std::endl;
+    }
+    scan::setImplementation(detected);
+}
+
+// 增量查找：数据分多次到达时从上次停下的位置继续，"\r\n"被拆在两次之间也能找到
+void testBufferIncrementalScan()
+{
+    Buffer buf;
+    size_t offset = 0;
+    buf.append(std::string(100, 'x'));
+    assert(buf.findCRLF(&offset) == nullptr);
+    assert(offset == 99);
+    buf.append("yy\r");
+    assert(buf.findCRLF(&offset) == nullptr);
+    assert(offset == 102);
+    buf.append("\nrest");
+    const char* crlf = buf.findCRLF(&offset);
+    assert(crlf != nullptr && crlf - buf.peek() == 102);
+
+    buf.retrieveUntil(crlf + 2);
+    offset = 0;
+    assert(buf.findEOL(&offset) == nullptr);
+    assert(offset == 4);
+    buf.append("\n");
+    assert(buf.findEOL(&offset) == buf.peek() + 4);
+
+    size_t anyOffset = 0;
+    assert(buf.findAnyOf("s\n", 2, &anyOffset) == buf.peek() + 2);
+    assert(buf.findEOL() == buf.peek() + 4);
+}
+
 int main()
 {
     std::cout << "Running Buffer tests..." << std::endl;
@@ -252,6 +387,18 @@ int main()
     testBufferFindCRLF();
     std::cout << "testBufferFindCRLF passed" << std::endl;
 
+    testBufferIntegers();
+    std::cout << "testBufferIntegers passed" << std::endl;
+
+    testBufferVarint();
+    std::cout << "testBufferVarint passed" << std::endl;
+
+    testBufferScanImplementations();
+    std::cout << "testBufferScanImplementations passed" << std::endl;
+
+    testBufferIncrementalScan();
+    std::cout << "testBufferIncrementalScan passed" << std::endl;
+
     std::cout << "All Buffer tests passed!" << std::endl;
     return 0;
 }
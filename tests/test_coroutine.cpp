@@ -0,0 +1,191 @@
+#include "Coroutine.h"
+#include "TcpServer.h"
+#include "TcpClient.h"
+#include "TcpConnection.h"
+#include "Eventloop.h"
+#include "InetAddress.h"
+#include "Buffer.h"
+#include <iostream>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+co::Task<int> add(int a, int b) {
+    co_return a + b;
+}
+
+co::Task<int> sum(int n) {
+    int total = 0;
+    for (int i = 0; i < n; ++i) {
+        total += co_await add(i, 1);
+    }
+    co_return total;
+}
+
+co::Task<int> throwing() {
+    throw runtime_error("boom");
+    co_return 0;
+}
+
+// 测试任务嵌套、异常传递和帧复用：同步完成的子任务反复创建，帧应从缓存中复用
+void test_task_and_allocator() {
+    cout << "=== Test Task And Allocator ===" << endl;
+
+    EventLoop loop;
+    int result = 0;
+    bool caught = false;
+    co::spawn(&loop, [&]() -> co::Task<> {
+        result = co_await sum(1000);
+        try {
+            co_await throwing();
+        } catch (const runtime_error& e) {
+            caught = string(e.what()) == "boom";
+        }
+    }());
+
+    assert(result == 1000 * 1001 / 2);
+    assert(caught);
+    co::FrameAllocator& allocator = co::FrameAllocator::current();
+    assert(allocator.reused() >= 999);
+    assert(allocator.allocated() < 10);
+    cout << "Task and allocator test passed, allocated=" << allocator.allocated()
+         << " reused=" << allocator.reused() << endl;
+}
+
+// 测试loop->sleep()：由loop的定时器恢复，多个协程交替执行
+void test_sleep() {
+    cout << "=== Test Sleep ===" << endl;
+
+    EventLoop loop;
+    string trace;
+    auto worker = [&](char tag, double interval) -> co::Task<> {
+        for (int i = 0; i < 3; ++i) {
+            co_await loop.sleep(interval);
+            trace += tag;
+        }
+    };
+    Timestamp start = Timestamp::now();
+    co::spawn(&loop, worker('a', 0.02));
+    co::spawn(&loop, worker('b', 0.05));
+    loop.runAfter(0.3, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(trace == "aabbab" || trace == "aababb");
+    assert(timeDifference(Timestamp::now(), start) >= 0.15);
+    cout << "Sleep test passed, trace=" << trace << endl;
+}
+
+// 端到端：协程按行读取命令，"SEND n"后再读n字节的数据，逐行回显；客户端一次发出所有数据
+co::Task<> session(TcpConnectionPtr conn, int* sessions) {
+    co::Stream stream(conn);
+    while (auto line = co_await stream.readUntil("\r\n")) {
+        if (line->substr(0, 5) == "SEND ") {
+            size_t n = stoul(string(line->substr(5)));
+            auto body = co_await stream.read(n);
+            if (!body) break;
+            co_await stream.send("GOT " + string(*body) + "\r\n");
+        } else if (*line == "QUIT") {
+            conn->shutdown();
+        } else {
+            co_await stream.send("ECHO " + string(*line) + "\r\n");
+        }
+    }
+    ++*sessions;
+}
+
+void test_stream_read() {
+    cout << "=== Test Stream Read ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(19013);
+    TcpServer server(&loop, serverAddr, TcpServer::kReusePort);
+    int sessions = 0;
+    server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (conn->connected()) co::spawn(conn->getLoop(), session(conn, &sessions));
+    });
+    server.start();
+
+    string received;
+    TcpClient client(&loop, serverAddr, "CoClient");
+    client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            conn->send("hello\r\nSEND 9\r\nab\r\ncdefgworld\r\nQUIT\r\n");
+        } else {
+            loop.runAfter(0.1, [&loop]() { loop.quit(); });
+        }
+    });
+    client.setMessageCallback([&](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+        received += buf->retrieveAllAsString();
+    });
+    client.connect();
+
+    loop.runAfter(3.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(received == "ECHO hello\r\nGOT ab\r\ncdefg\r\nECHO world\r\n");
+    assert(sessions == 1);
+    cout << "Stream read test passed" << endl;
+}
+
+// 背压：高水位设为一次写入的大小，每次co_await send()返回时未发出的数据都低于高水位
+co::Task<> produce(TcpConnectionPtr conn, size_t chunkSize, int chunks, size_t* maxPending, bool* finished) {
+    co::Stream stream(conn);
+    stream.setHighWaterMark(chunkSize);
+    string chunk(chunkSize, 'x');
+    for (int i = 0; i < chunks; ++i) {
+        if (!co_await stream.send(chunk)) co_return;
+        *maxPending = max(*maxPending, conn->outputBuffer()->readableBytes());
+    }
+    *finished = true;
+    conn->shutdown();
+}
+
+void test_stream_backpressure() {
+    cout << "=== Test Stream Backpressure ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(19014);
+    TcpServer server(&loop, serverAddr, TcpServer::kReusePort);
+    const size_t kChunk = 64 * 1024;
+    const int kChunks = 256;
+    size_t maxPending = 0;
+    bool finished = false;
+    server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (!conn->connected()) return;
+        co::spawn(conn->getLoop(), produce(conn, kChunk, kChunks, &maxPending, &finished));
+    });
+    server.start();
+
+    size_t received = 0;
+    TcpClient client(&loop, serverAddr, "CoClient");
+    client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (!conn->connected()) loop.quit();
+    });
+    client.setMessageCallback([&](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+        received += buf->readableBytes();
+        buf->retrieveAll();
+    });
+    client.connect();
+
+    loop.runAfter(10.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(finished);
+    assert(received == kChunk * kChunks);
+    assert(maxPending < kChunk);
+    cout << "Stream backpressure test passed, maxPending=" << maxPending << endl;
+}
+
+int main() {
+    cout << "=== Coroutine Tests ===" << endl;
+
+    test_task_and_allocator();
+    test_sleep();
+    test_stream_read();
+    test_stream_backpressure();
+
+    cout << "=== All Coroutine Tests Passed ===" << endl;
+    return 0;
+}
@@ -5,6 +5,10 @@
 #include <chrono>
 #include <atomic>
 #include <thread>
+#include <sched.h>
+#include <vector>
+#include <condition_variable>
+#include <mutex>
 
 // 测试基本的事件循环线程池创建和启动
 void test_basic_creation() {
@@ -215,6 +219,110 @@ void test_concurrent_get_loop() {
     std::cout << "Concurrent get loop test passed" << std::endl;
 }
 
+// 测试CPU绑定与按CPU选择循环
+void test_cpu_affinity() {
+    std::cout << "=== Test CPU Affinity ===" << std::endl;
+
+    EventLoop baseLoop;
+    EventLoopThreadPool pool(&baseLoop, "TestPool");
+
+    pool.setCpuAffinity(true);
+    pool.setThreadNUm(2);
+    pool.start();
+
+    auto loops = pool.getAllLoops();
+    assert(loops.size() == 2);
+
+    // 第i个IO线程绑定在可用CPU列表中的第(i % n)个CPU上，应该运行在该CPU上
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    assert(::sched_getaffinity(0, sizeof cpuset, &cpuset) == 0);
+    std::vector<int> cpus;
+    for (int i = 0; i < CPU_SETSIZE; ++i) {
+        if (CPU_ISSET(i, &cpuset)) {
+            cpus.push_back(i);
+        }
+    }
+
+    std::mutex mu;
+    std::condition_variable cond;
+    std::vector<int> runningCpus(loops.size(), -1);
+    size_t reported = 0;
+    for (size_t i = 0; i < loops.size(); ++i) {
+        loops[i]->runInLoop([&, i]() {
+            std::lock_guard<std::mutex> lock(mu);
+            runningCpus[i] = sched_getcpu();
+            ++reported;
+            cond.notify_one();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mu);
+        cond.wait(lock, [&] { return reported == loops.size(); });
+    }
+    for (size_t i = 0; i < loops.size(); ++i) {
+        assert(runningCpus[i] == cpus[i % cpus.size()]);
+    }
+    int firstCpu = runningCpus[0];
+
+    // 绑定了loop的CPU必须返回其中一个子线程loop
+    EventLoop* byCpu = pool.getLoopForCpu(firstCpu);
+    assert(byCpu == loops[0] || byCpu == loops[1]);
+
+    // 无匹配的CPU回退到轮询
+    EventLoop* fallback1 = pool.getLoopForCpu(-1);
+    EventLoop* fallback2 = pool.getLoopForCpu(100000);
+    assert(fallback1 != fallback2);
+
+    std::cout << "CPU affinity test passed" << std::endl;
+}
+
+// 测试运行时增加和退役循环
+void test_resize_at_runtime() {
+    std::cout << "=== Test Resize At Runtime ===" << std::endl;
+
+    EventLoop baseLoop;
+    EventLoopThreadPool pool(&baseLoop, "TestPool");
+
+    std::atomic<int> initCount(0);
+    pool.setThreadNUm(1);
+    pool.start([&initCount](EventLoop*) { initCount++; });
+    assert(pool.numLoops() == 1);
+
+    // 运行时新增的线程同样会调用初始化回调
+    EventLoop* added = pool.addLoop();
+    assert(pool.numLoops() == 2);
+    assert(initCount == 2);
+    assert(pool.getAllLoops()[1] == added);
+
+    // 退役的循环不再参与轮询
+    EventLoop* retired = pool.retireLoop();
+    assert(retired == added);
+    assert(pool.numLoops() == 1);
+    for (int i = 0; i < 4; ++i) {
+        assert(pool.getNextLoop() != retired);
+    }
+
+    // 退役后线程仍在运行，回收前排队的任务都会被执行
+    std::atomic<int> ran(0);
+    retired->queueInLoop([&ran]() { ran++; });
+    pool.reapLoop(retired);
+    // reapLoop不阻塞baseLoop，回收通知排在退出baseLoop之前
+    retired->queueInLoop([&baseLoop]() {
+        baseLoop.queueInLoop([&baseLoop]() { baseLoop.quit(); });
+    });
+    baseLoop.loop();
+    assert(ran == 1);
+
+    // 全部退役后回退到baseLoop
+    EventLoop* last = pool.retireLoop();
+    pool.reapLoop(last);
+    assert(pool.numLoops() == 0);
+    assert(pool.getNextLoop() == &baseLoop);
+
+    std::cout << "Resize at runtime test passed" << std::endl;
+}
+
 int main() {
     std::cout << "=== EventLoopThreadPool Tests ===" << std::endl;
 
@@ -224,6 +332,8 @@ int main() {
     test_init_callback();
     test_run_in_multiple_loops();
     test_concurrent_get_loop();
+    test_cpu_affinity();
+    test_resize_at_runtime();
 
     std::cout << "=== All EventLoopThreadPool Tests Passed ===" << std::endl;
     return 0;
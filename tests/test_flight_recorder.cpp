@@ -0,0 +1,169 @@
+#include "FlightRecorder.h"
+#include "BinaryLog.h"
+#include "Logger.h"
+#include "Thread.h"
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+static string g_captured;
+
+// 读入转储文件并离线解码成文本
+static string decodeDump(const char* path) {
+    string raw;
+    FILE* fp = fopen(path, "rb");
+    assert(fp != nullptr);
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof buf, fp)) > 0) {
+        raw.append(buf, n);
+    }
+    fclose(fp);
+
+    binlog::Decoder decoder(false);
+    string text;
+    assert(decoder.decode(raw.data(), raw.size(), &text) == raw.size());
+    return text;
+}
+
+// 低于日志级别的记录只进环形缓冲区；写满后覆盖最旧的，转储的是连续的最近记录
+void test_ring_wraps() {
+    cout << "=== Test Ring Wraps ===" << endl;
+
+    Logger::setOutput([](const char* msg, int len) { g_captured.append(msg, len); });
+    for (int i = 0; i < 500; ++i) {
+        BLOG_DEBUG("debug %d %s", i, string(i % 5, 'y'));
+    }
+    BLOG_INFO("info %d", 7);
+    Logger::setOutput([](const char* msg, int len) { fwrite(msg, 1, len, stdout); });
+    assert(g_captured.find("debug") == string::npos);
+    assert(g_captured.find("] INFO: info 7\n") != string::npos);
+
+    assert(FlightRecorder::dump("log/test_flight_demand.dump"));
+    string text = decodeDump("log/test_flight_demand.dump");
+    assert(text.find("flight recorder dump: on demand") != string::npos);
+
+    int first = -1;
+    int last = -1;
+    for (size_t pos = text.find("] DEBUG: debug "); pos != string::npos; pos = text.find("] DEBUG: debug ", pos + 1)) {
+        int seq = -1;
+        assert(sscanf(text.c_str() + pos, "] DEBUG: debug %d", &seq) == 1);
+        assert(last == -1 || seq == last + 1);
+        if (first == -1) {
+            first = seq;
+        }
+        last = seq;
+    }
+    assert(first > 0 && last == 499);
+    assert(text.find("] INFO: info 7\n") > text.find("debug 499"));
+    cout << "Ring wraps test passed, kept " << last - first + 1 << " of 500 records" << endl;
+}
+
+// 每个线程有自己的环形缓冲区，线程退出后记录仍然可以转储
+void test_threads() {
+    cout << "=== Test Threads ===" << endl;
+
+    const int kThreads = 3;
+    atomic<int> started(0);
+    vector<unique_ptr<Thread>> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back(new Thread([t, &started]() {
+            BLOG_DEBUG("thread %d seq %d", t, -1);
+            // 都挂上环形缓冲区后再退出，避免后启动的线程复用先退出线程的缓冲区
+            ++started;
+            while (started.load() < kThreads) {
+                usleep(1000);
+            }
+            for (int i = 0; i < 200; ++i) {
+                BLOG_DEBUG("thread %d seq %d", t, i);
+            }
+        }, "FlightThread"));
+    }
+    for (auto& thread : threads) {
+        thread->start();
+    }
+    for (auto& thread : threads) {
+        thread->join();
+    }
+
+    assert(FlightRecorder::dump("log/test_flight_demand.dump"));
+    string text = decodeDump("log/test_flight_demand.dump");
+    for (int t = 0; t < kThreads; ++t) {
+        char expected[64];
+        snprintf(expected, sizeof expected, "] DEBUG: thread %d seq 199\n", t);
+        assert(text.find(expected) != string::npos);
+    }
+    cout << "Threads test passed" << endl;
+}
+
+// 子进程崩溃或者LOG_FATAL退出时转储到启用时给定的文件
+void test_fatal_dump() {
+    cout << "=== Test Fatal Dump ===" << endl;
+
+    remove("log/test_flight.dump");
+    pid_t pid = fork();
+    if (pid == 0) {
+        BLOG_DEBUG("before crash %d", 42);
+        *static_cast<volatile int*>(nullptr) = 1;
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    assert(WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV);
+    string text = decodeDump("log/test_flight.dump");
+    assert(text.find("flight recorder dump: SIGSEGV") != string::npos);
+    assert(text.find("] DEBUG: before crash 42\n") != string::npos);
+
+    remove("log/test_flight.dump");
+    pid = fork();
+    if (pid == 0) {
+        Logger::setOutput([](const char*, int) {});
+        BLOG_DEBUG("before fatal %d", 43);
+        LOG_FATAL("fatal %d", 1);
+    }
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 255);
+    text = decodeDump("log/test_flight.dump");
+    assert(text.find("flight recorder dump: LOG_FATAL") != string::npos);
+    assert(text.find("] DEBUG: before fatal 43\n") != string::npos);
+
+    // 流式的LOGS_FATAL同样在退出前转储
+    remove("log/test_flight.dump");
+    pid = fork();
+    if (pid == 0) {
+        Logger::setOutput([](const char*, int) {});
+        BLOG_DEBUG("before stream fatal %d", 44);
+        LOGS_FATAL << "stream fatal";
+    }
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 255);
+    text = decodeDump("log/test_flight.dump");
+    assert(text.find("flight recorder dump: LOG_FATAL") != string::npos);
+    assert(text.find("] DEBUG: before stream fatal 44\n") != string::npos);
+    cout << "Fatal dump test passed" << endl;
+}
+
+int main() {
+    cout << "=== Flight Recorder Tests ===" << endl;
+
+    system("mkdir -p log");
+    Logger::instance().setLogLevel(INFO);
+    FlightRecorder::enable("log/test_flight.dump", 4096);
+    assert(FlightRecorder::enabled());
+
+    test_ring_wraps();
+    test_threads();
+    test_fatal_dump();
+
+    system("rm -f log/test_flight*.dump 2>/dev/null");
+    cout << "=== All Flight Recorder Tests Passed ===" << endl;
+    return 0;
+}
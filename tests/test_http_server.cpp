@@ -0,0 +1,263 @@
+#include "HttpServer.h"
+#include "HttpParser.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "TcpClient.h"
+#include "TcpConnection.h"
+#include "Eventloop.h"
+#include "InetAddress.h"
+#include "Buffer.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 测试逐字节喂入：每次只多一个字节，解析结果与一次性喂入相同，视图指向输入缓冲区
+void test_parse_byte_by_byte() {
+    cout << "=== Test Parse Byte By Byte ===" << endl;
+
+    const string wire =
+        "POST /submit?id=7&x=1 HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "content-length: 5\r\n"
+        "X-Trace:   abc  \r\n"
+        "\r\n"
+        "hello";
+    HttpParser parser;
+    Buffer input;
+    for (size_t i = 0; i < wire.size(); ++i) {
+        input.append(wire.data() + i, 1);
+        HttpParser::Result r = parser.parse(&input);
+        assert(r == (i + 1 == wire.size() ? HttpParser::kComplete : HttpParser::kNeedMore));
+    }
+    const HttpRequest& req = parser.request();
+    assert(req.method() == "POST");
+    assert(req.path() == "/submit");
+    assert(req.query() == "id=7&x=1");
+    assert(req.minorVersion() == 1);
+    assert(req.headerCount() == 3);
+    assert(req.header("HOST") == "example.com");
+    assert(req.header("Content-Length") == "5");
+    assert(req.header("x-trace") == "abc");
+    assert(req.header("missing").empty());
+    assert(req.body() == "hello");
+    assert(req.keepAlive());
+    assert(req.method().data() >= input.peek() && req.body().data() < input.peek() + input.readableBytes());
+    assert(parser.consumed() == wire.size());
+    cout << "Parse byte by byte test passed" << endl;
+}
+
+// 测试流水线：一个缓冲区中的多个请求依次解析，最后一个半截请求留在缓冲区
+void test_parse_pipelined() {
+    cout << "=== Test Parse Pipelined ===" << endl;
+
+    Buffer input;
+    input.append(string("GET /a HTTP/1.1\r\n\r\n"
+                        "GET /b HTTP/1.0\r\nConnection: keep-alive\r\n\r\n"
+                        "GET /c HTTP/1.0\r\n\r\n"
+                        "GET /d HT"));
+    HttpParser parser;
+    vector<string> paths;
+    vector<bool> keepAlive;
+    while (parser.parse(&input) == HttpParser::kComplete) {
+        paths.emplace_back(parser.request().path());
+        keepAlive.push_back(parser.request().keepAlive());
+        input.retrieve(parser.consumed());
+        parser.reset();
+    }
+    assert((paths == vector<string>{"/a", "/b", "/c"}));
+    assert((keepAlive == vector<bool>{true, true, false}));
+    assert(input.readableBytes() == 9);
+
+    input.append(string("TP/1.1\r\nConnection: close\r\n\r\n"));
+    assert(parser.parse(&input) == HttpParser::kComplete);
+    assert(parser.request().path() == "/d");
+    assert(!parser.request().keepAlive());
+    cout << "Parse pipelined test passed" << endl;
+}
+
+// 测试分块编码的请求体，包括扩展和尾部字段
+void test_parse_chunked() {
+    cout << "=== Test Parse Chunked ===" << endl;
+
+    const string wire =
+        "POST /upload HTTP/1.1\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "5;ext=1\r\nhello\r\n"
+        "1A\r\nabcdefghijklmnopqrstuvwxyz\r\n"
+        "0\r\n"
+        "Trailer: x\r\n"
+        "\r\n";
+    // 分别按3字节一段喂入和一次性喂入
+    for (size_t step : {size_t(3), wire.size()}) {
+        HttpParser parser;
+        Buffer input;
+        HttpParser::Result r = HttpParser::kNeedMore;
+        for (size_t off = 0; off < wire.size(); off += step) {
+            input.append(wire.data() + off, min(step, wire.size() - off));
+            r = parser.parse(&input);
+            assert(r != HttpParser::kError);
+        }
+        assert(r == HttpParser::kComplete);
+        assert(parser.request().chunked());
+        assert(parser.request().body() == "helloabcdefghijklmnopqrstuvwxyz");
+        assert(parser.consumed() == wire.size());
+    }
+    cout << "Parse chunked test passed" << endl;
+}
+
+// 测试各类错误请求得到对应的状态码
+void test_parse_errors() {
+    cout << "=== Test Parse Errors ===" << endl;
+
+    struct Case {
+        string wire;
+        int status;
+    };
+    const vector<Case> cases = {
+        {"get / HTTP/1.1\r\n\r\n", 400},
+        {"GET / HTTP/2.0\r\n\r\n", 505},
+        {"GET /\r\n\r\n", 400},
+        {"GET / HTTP/1.1\r\nNoColon\r\n\r\n", 400},
+        {"GET / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nContent-Length: 3\r\nTransfer-Encoding: chunked\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n", 501},
+        {"POST / HTTP/1.1\r\nContent-Length: 100\r\n\r\n", 413},
+        {"POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n", 400},
+        {"GET / HTTP/1.1\r\nX: " + string(300, 'a') + "\r\n\r\n", 431},
+    };
+    for (const Case& c : cases) {
+        HttpParser parser;
+        parser.setMaxHeaderSize(256);
+        parser.setMaxBodySize(64);
+        Buffer input;
+        input.append(c.wire);
+        assert(parser.parse(&input) == HttpParser::kError);
+        assert(parser.errorStatus() == c.status);
+    }
+
+    // 没有CRLF的超长请求行在数据到达上限时就报错，不必等到行结束
+    HttpParser parser;
+    parser.setMaxHeaderSize(256);
+    Buffer input;
+    input.append("GET /" + string(1000, 'a'));
+    assert(parser.parse(&input) == HttpParser::kError);
+    assert(parser.errorStatus() == 431);
+    cout << "Parse errors test passed" << endl;
+}
+
+// 测试响应序列化：长度、连接、Date头部以及分块编码
+void test_response_serialize() {
+    cout << "=== Test Response Serialize ===" << endl;
+
+    HttpResponse resp(false);
+    resp.setContentType("text/plain");
+    resp.setBody("hi");
+    Buffer out;
+    resp.appendToBuffer(&out);
+    string s = out.retrieveAllAsString();
+    assert(s.compare(0, 17, "HTTP/1.1 200 OK\r\n") == 0);
+    assert(s.find("Content-Length: 2\r\n") != string::npos);
+    assert(s.find("Connection: Keep-Alive\r\n") != string::npos);
+    assert(s.find("Date: " + httpDate() + "\r\n") != string::npos);
+    assert(s.find("Content-Type: text/plain\r\n") != string::npos);
+    assert(s.size() > 6 && s.compare(s.size() - 6, 6, "\r\n\r\nhi") == 0);
+
+    // 同一秒内返回同一个缓存对象
+    assert(&httpDate() == &httpDate());
+    assert(httpDate().size() == 29);
+
+    HttpResponse chunked(true);
+    chunked.appendChunk("hello");
+    chunked.appendChunk(string(20, 'x'));
+    chunked.appendToBuffer(&out);
+    s = out.retrieveAllAsString();
+    assert(s.find("Transfer-Encoding: chunked\r\n") != string::npos);
+    assert(s.find("Content-Length") == string::npos);
+    assert(s.find("Connection: close\r\n") != string::npos);
+    assert(s.find("\r\n\r\n5\r\nhello\r\n14\r\n" + string(20, 'x') + "\r\n0\r\n\r\n") != string::npos);
+    cout << "Response serialize test passed" << endl;
+}
+
+// 端到端：长连接上的流水线请求按顺序应答，大响应体走writev，Connection: close后服务器关闭连接
+void test_server_pipelining() {
+    cout << "=== Test Server Pipelining ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(19006);
+    HttpServer server(&loop, serverAddr, TcpServer::kReusePort);
+    const string bigBody(100 * 1024, 'b');
+    int handled = 0;
+    server.setHttpCallback([&](const HttpRequest& req, HttpResponse* resp) {
+        ++handled;
+        if (req.path() == "/big") {
+            resp->setBody(bigBody);
+        } else if (req.path() == "/echo") {
+            resp->setBody(string(req.body()));
+        } else if (req.path() == "/chunked") {
+            resp->appendChunk("part1");
+            resp->appendChunk("part2");
+        } else {
+            resp->setStatusCode(HttpResponse::k404NotFound);
+            resp->setBody("nope");
+        }
+    });
+    server.start();
+
+    const string requests =
+        "GET /big HTTP/1.1\r\nHost: t\r\n\r\n"
+        "POST /echo HTTP/1.1\r\nContent-Length: 4\r\n\r\nping"
+        "GET /chunked HTTP/1.1\r\n\r\n"
+        "GET /missing HTTP/1.1\r\nConnection: close\r\n\r\n"
+        "GET /ignored HTTP/1.1\r\n\r\n";
+    string received;
+    bool closedByServer = false;
+    TcpClient client(&loop, serverAddr, "HttpClient");
+    client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            conn->send(requests);
+        } else {
+            closedByServer = true;
+            loop.quit();
+        }
+    });
+    client.setMessageCallback([&](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+        received += buf->retrieveAllAsString();
+    });
+    client.connect();
+
+    loop.runAfter(3.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(closedByServer);
+    // Connection: close之后的请求不再处理
+    assert(handled == 4);
+    size_t p1 = received.find("HTTP/1.1 200 OK\r\nContent-Length: 102400\r\n");
+    size_t p2 = received.find("\r\n\r\nping");
+    size_t p3 = received.find("Transfer-Encoding: chunked");
+    size_t p4 = received.find("HTTP/1.1 404 Not Found\r\nContent-Length: 4\r\nConnection: close\r\n");
+    assert(p1 == 0);
+    assert(p2 != string::npos && p3 != string::npos && p4 != string::npos);
+    assert(p1 < p2 && p2 < p3 && p3 < p4);
+    assert(received.find(bigBody) != string::npos);
+    assert(received.find("Date: ") != string::npos);
+    assert(received.compare(received.size() - 4, 4, "nope") == 0);
+    cout << "Server pipelining test passed" << endl;
+}
+
+int main() {
+    cout << "=== HttpServer Tests ===" << endl;
+
+    test_parse_byte_by_byte();
+    test_parse_pipelined();
+    test_parse_chunked();
+    test_parse_errors();
+    test_response_serialize();
+    test_server_pipelining();
+
+    cout << "=== All HttpServer Tests Passed ===" << endl;
+    return 0;
+}
@@ -2,6 +2,7 @@
 #include "InetAddress.h"
 #include <iostream>
 #include <cassert>
+#include <cstddef>
 
 void test_inetaddress_with_port() {
     uint16_t port = 8080;
@@ -47,11 +48,41 @@ void test_inetaddress_get_sockaddr() {
     std::cout << "InetAddress getSockAddr test passed" << std::endl;
 }
 
+void test_inetaddress_unix() {
+    InetAddress pathAddr = InetAddress::fromUnixPath("/tmp/re_muduo.sock");
+    assert(pathAddr.isUnix());
+    assert(pathAddr.family() == AF_UNIX);
+    assert(pathAddr.unixPath() == "/tmp/re_muduo.sock");
+    assert(pathAddr.toIpPort() == "unix:/tmp/re_muduo.sock");
+    assert(pathAddr.toPort() == 0);
+
+    // 抽象命名空间：sun_path以'\0'开头，长度不含结尾的'\0'
+    InetAddress abstractAddr = InetAddress::fromUnixPath("@re_muduo");
+    assert(abstractAddr.isUnix());
+    assert(abstractAddr.unixPath() == "@re_muduo");
+    assert(abstractAddr.getSockAddrLen() == offsetof(sockaddr_un, sun_path) + 9);
+    const sockaddr_un* un = reinterpret_cast<const sockaddr_un*>(abstractAddr.getGenericSockAddr());
+    assert(un->sun_path[0] == '\0');
+
+    // 放不下的路径不截断，返回无效地址
+    std::string longPath = "/tmp/" + std::string(sizeof(un->sun_path) - 5, 'x');
+    assert(!InetAddress::fromUnixPath(longPath).isValid());
+    assert(InetAddress::fromUnixPath(longPath.substr(0, longPath.size() - 1)).isValid());
+    assert(InetAddress::fromUnixPath("@" + std::string(sizeof(un->sun_path) - 1, 'x')).isValid());
+
+    InetAddress inetAddr(8080);
+    assert(inetAddr.isValid());
+    assert(!inetAddr.isUnix());
+    assert(inetAddr.getSockAddrLen() == sizeof(sockaddr_in));
+    std::cout << "InetAddress unix domain test passed" << std::endl;
+}
+
 int main() {
     std::cout << "=== InetAddress Tests ===" << std::endl;
     test_inetaddress_with_port();
     test_inetaddress_with_ip_and_port();
     test_inetaddress_get_sockaddr();
+    test_inetaddress_unix();
     std::cout << "=== All InetAddress Tests Passed ===" << std::endl;
     return 0;
 }
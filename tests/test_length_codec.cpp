@@ -0,0 +1,260 @@
+#include "LengthFieldCodec.h"
+#include "TcpClient.h"
+#include "TcpServer.h"
+#include "TcpConnection.h"
+#include "Eventloop.h"
+#include "InetAddress.h"
+#include "Buffer.h"
+#include "Timer.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 测试各种长度字段的编解码，以及半帧留到下一次
+void test_decode_partial_frames() {
+    cout << "=== Test Decode Partial Frames ===" << endl;
+
+    const LengthFieldCodec::LengthField fields[] = {
+        LengthFieldCodec::kVarint, LengthFieldCodec::kInt8, LengthFieldCodec::kInt16,
+        LengthFieldCodec::kInt32, LengthFieldCodec::kInt64,
+    };
+    for (LengthFieldCodec::LengthField field : fields) {
+        vector<string> frames;
+        LengthFieldCodec codec([&frames](const TcpConnectionPtr&, string_view frame, Timestamp) {
+            frames.emplace_back(frame);
+        }, field);
+
+        Buffer encoded;
+        const vector<string> payloads = {"a", "", "hello", string(200, 'x'), "end"};
+        for (const string& p : payloads) {
+            codec.encode(&encoded, p);
+        }
+        string wire = encoded.retrieveAllAsString();
+
+        // 按每次7字节喂入，模拟一帧被拆到多次读事件中
+        Buffer input;
+        for (size_t off = 0; off < wire.size(); off += 7) {
+            input.append(wire.data() + off, min<size_t>(7, wire.size() - off));
+            size_t before = frames.size();
+            size_t n = codec.onMessage(nullptr, &input, Timestamp::now());
+            assert(frames.size() == before + n);
+        }
+        assert(frames == payloads);
+        assert(input.readableBytes() == 0);
+    }
+    cout << "Decode partial frames test passed" << endl;
+}
+
+// 测试一次读到的多个完整帧在同一次onMessage中全部分发，视图直接指向输入缓冲区
+void test_zero_copy_batch() {
+    cout << "=== Test Zero Copy Batch ===" << endl;
+
+    Buffer input;
+    vector<const char*> views;
+    LengthFieldCodec codec([&views](const TcpConnectionPtr&, string_view frame, Timestamp) {
+        views.push_back(frame.data());
+    });
+    for (int i = 0; i < 10; ++i) {
+        codec.encode(&input, "frame-" + to_string(i));
+    }
+    codec.encode(&input, "partial");
+    // 截掉最后一帧的最后一个字节
+    string wire = input.retrieveAllAsString();
+    input.append(wire.data(), wire.size() - 1);
+
+    const char* begin = input.peek();
+    const char* end = begin + input.readableBytes();
+    assert(codec.onMessage(nullptr, &input, Timestamp::now()) == 10);
+    assert(views.size() == 10);
+    for (const char* v : views) {
+        assert(v >= begin && v < end);
+    }
+    // 剩下不完整的一帧：4字节长度 + 6字节负载
+    assert(input.readableBytes() == 4 + 6);
+    cout << "Zero copy batch test passed" << endl;
+}
+
+// 测试超过上限的长度和非法长度
+void test_frame_limits() {
+    cout << "=== Test Frame Limits ===" << endl;
+
+    int frames = 0;
+    vector<LengthFieldCodec::Error> errors;
+    LengthFieldCodec codec([&frames](const TcpConnectionPtr&, string_view, Timestamp) { ++frames; },
+                           LengthFieldCodec::kInt32, 1024);
+    codec.setErrorCallback([&errors](const TcpConnectionPtr&, LengthFieldCodec::Error e) {
+        errors.push_back(e);
+    });
+
+    Buffer input;
+    codec.encode(&input, "ok");
+    // 只有长度字段就能判断超限，不必等到数据到齐
+    input.appendInt32(4096);
+    assert(codec.onMessage(nullptr, &input, Timestamp::now()) == 1);
+    assert(frames == 1);
+    assert(errors.size() == 1 && errors[0] == LengthFieldCodec::kFrameTooLarge);
+    assert(input.readableBytes() == 0);
+
+    input.appendInt32(-1);
+    codec.onMessage(nullptr, &input, Timestamp::now());
+    assert(errors.size() == 2 && errors[1] == LengthFieldCodec::kInvalidLength);
+
+    // 长度字段放不下的负载不编码，对端也就不会误解析成截断后的长度
+    LengthFieldCodec small([](const TcpConnectionPtr&, string_view, Timestamp) {}, LengthFieldCodec::kInt8);
+    Buffer out;
+    assert(small.encode(&out, string(255, 'a')));
+    assert(out.readableBytes() == 256);
+    out.retrieveAll();
+    string tooLong(256, 'b');
+    string_view payloads[] = {"ok", tooLong};
+    assert(!small.encode(&out, tooLong));
+    assert(!small.encode(&out, payloads, 2));
+    assert(out.readableBytes() == 0);
+
+    // varint第10字节超过0x01时溢出64位
+    LengthFieldCodec varint([&frames](const TcpConnectionPtr&, string_view, Timestamp) { ++frames; },
+                            LengthFieldCodec::kVarint);
+    varint.setErrorCallback([&errors](const TcpConnectionPtr&, LengthFieldCodec::Error e) {
+        errors.push_back(e);
+    });
+    input.append(string(9, '\xff'));
+    input.append("\x02", 1);
+    varint.onMessage(nullptr, &input, Timestamp::now());
+    assert(errors.size() == 3 && errors[2] == LengthFieldCodec::kInvalidLength);
+    cout << "Frame limits test passed" << endl;
+}
+
+// 测试真实连接上的收发：客户端一次发出多帧，服务器逐帧回显
+void test_codec_over_tcp() {
+    cout << "=== Test Codec Over TCP ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(19004);
+    TcpServer server(&loop, serverAddr, TcpServer::kReusePort);
+    LengthFieldCodec serverCodec([&serverCodec](const TcpConnectionPtr& conn, string_view frame, Timestamp) {
+        serverCodec.send(conn, frame);
+    }, LengthFieldCodec::kVarint);
+    server.setConnectionCallback([](const TcpConnectionPtr&) {});
+    server.setMessageCallback([&serverCodec](const TcpConnectionPtr& conn, Buffer* buf, Timestamp t) {
+        serverCodec.onMessage(conn, buf, t);
+    });
+    server.start();
+
+    const int kFrames = 1000;
+    int received = 0;
+    bool ordered = true;
+    LengthFieldCodec clientCodec([&](const TcpConnectionPtr&, string_view frame, Timestamp) {
+        if (frame != "msg-" + to_string(received)) ordered = false;
+        if (++received == kFrames) loop.quit();
+    }, LengthFieldCodec::kVarint);
+
+    TcpClient client(&loop, serverAddr, "CodecClient");
+    client.setConnectionCallback([&clientCodec](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            Buffer out;
+            for (int i = 0; i < kFrames; ++i) {
+                clientCodec.encode(&out, "msg-" + to_string(i));
+            }
+            conn->send(&out);
+        }
+    });
+    client.setMessageCallback([&clientCodec](const TcpConnectionPtr& conn, Buffer* buf, Timestamp t) {
+        clientCodec.onMessage(conn, buf, t);
+    });
+    client.connect();
+
+    loop.runAfter(3.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(received == kFrames);
+    assert(ordered);
+    cout << "Codec over TCP test passed" << endl;
+}
+
+// 测试批量分发：流水线客户端一次写出多个请求，服务器每次读事件拿到整批帧，所有响应一次send
+void test_batch_dispatch() {
+    cout << "=== Test Batch Dispatch ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(19005);
+    TcpServer server(&loop, serverAddr, TcpServer::kReusePort);
+    int batches = 0;
+    size_t maxBatch = 0;
+    LengthFieldCodec serverCodec([&](const TcpConnectionPtr& conn, const string_view* frames, size_t n, Timestamp) {
+        ++batches;
+        maxBatch = max(maxBatch, n);
+        // 模拟对整批请求做一次批量查询，响应按请求顺序排列
+        vector<string> replies;
+        replies.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            replies.emplace_back("re:" + string(frames[i]));
+        }
+        vector<string_view> views(replies.begin(), replies.end());
+        serverCodec.send(conn, views.data(), views.size());
+    });
+    server.setConnectionCallback([](const TcpConnectionPtr&) {});
+    server.setMessageCallback([&serverCodec](const TcpConnectionPtr& conn, Buffer* buf, Timestamp t) {
+        serverCodec.onMessage(conn, buf, t);
+    });
+    server.start();
+
+    const int kRounds = 20;
+    const int kPipeline = 50;
+    int received = 0;
+    bool ordered = true;
+    TcpClient client(&loop, serverAddr, "BatchClient");
+    LengthFieldCodec clientCodec([&](const TcpConnectionPtr& conn, string_view frame, Timestamp) {
+        if (frame != "re:req-" + to_string(received)) ordered = false;
+        ++received;
+        // 一轮全部收到后再发下一轮
+        if (received % kPipeline == 0) {
+            if (received == kRounds * kPipeline) {
+                loop.quit();
+                return;
+            }
+            vector<string> reqs;
+            for (int i = received; i < received + kPipeline; ++i) reqs.push_back("req-" + to_string(i));
+            vector<string_view> views(reqs.begin(), reqs.end());
+            clientCodec.send(conn, views.data(), views.size());
+        }
+    });
+    client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            Buffer out;
+            for (int i = 0; i < kPipeline; ++i) {
+                clientCodec.encode(&out, "req-" + to_string(i));
+            }
+            conn->send(&out);
+        }
+    });
+    client.setMessageCallback([&clientCodec](const TcpConnectionPtr& conn, Buffer* buf, Timestamp t) {
+        clientCodec.onMessage(conn, buf, t);
+    });
+    client.connect();
+
+    loop.runAfter(3.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(received == kRounds * kPipeline);
+    assert(ordered);
+    // 每轮的请求在一次写中发出，服务器端应按整批收到，而不是逐帧
+    assert(maxBatch > 1);
+    assert(batches < kRounds * kPipeline);
+    cout << "Batch dispatch test passed, batches=" << batches << " maxBatch=" << maxBatch << endl;
+}
+
+int main() {
+    cout << "=== LengthFieldCodec Tests ===" << endl;
+
+    test_decode_partial_frames();
+    test_zero_copy_batch();
+    test_frame_limits();
+    test_codec_over_tcp();
+    test_batch_dispatch();
+
+    cout << "=== All LengthFieldCodec Tests Passed ===" << endl;
+    return 0;
+}
@@ -1,7 +1,18 @@
 
 #include "Logger.h"
+#include "Thread.h"
 #include <iostream>
 #include <cassert>
+#include <string>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <vector>
 
 void test_logger_instance() {
     Logger& logger1 = Logger::instance();
@@ -36,11 +47,191 @@ void test_logger_set_log_level() {
     std::cout << "Logger set log level test passed" << std::endl;
 }
 
+// 捕获输出，测试结束后恢复到stdout
+static std::string g_captured;
+
+static void captureOutput() {
+    g_captured.clear();
+    Logger::setOutput([](const char* msg, int len) { g_captured.append(msg, len); });
+}
+
+static void restoreOutput() {
+    Logger::setOutput([](const char* msg, int len) { fwrite(msg, 1, len, stdout); });
+}
+
+static int g_evaluated = 0;
+
+static int countEvaluation() {
+    return ++g_evaluated;
+}
+
+void test_logger_threshold() {
+    Logger& logger = Logger::instance();
+    captureOutput();
+
+    // 低于阈值的日志不输出，参数也不求值
+    logger.setLogLevel(ERROR);
+    g_evaluated = 0;
+    LOG_INFO("filtered %d", countEvaluation());
+    LOGS_INFO << "filtered " << countEvaluation();
+    assert(g_captured.empty());
+    assert(g_evaluated == 0);
+
+    LOG_ERROR("kept %d", countEvaluation());
+    assert(g_evaluated == 1);
+    assert(g_captured.find("] ERROR: kept 1\n") != std::string::npos);
+
+    // 编译期最低级别为INFO时LOG_DEBUG不生成代码，运行期阈值也无法打开
+    logger.setLogLevel(DEBUG);
+    g_captured.clear();
+    LOG_DEBUG("debug %d", countEvaluation());
+    if (RE_MUDUO_MIN_LOG_LEVEL > DEBUG) {
+        assert(g_captured.empty());
+        assert(g_evaluated == 1);
+    }
+
+    logger.setLogLevel(INFO);
+    restoreOutput();
+    std::cout << "Logger threshold test passed" << std::endl;
+}
+
+void test_logger_stream() {
+    captureOutput();
+
+    LOGS_INFO << "fd=" << 42 << " ratio=" << 0.5 << " name=" << std::string("conn") << ' ' << -7L;
+    assert(g_captured.size() > 0 && g_captured[0] == '[');
+    assert(g_captured.find("] INFO: fd=42 ratio=0.5 name=conn -7\n") != std::string::npos);
+
+    // 超长的printf风格日志被截断，仍以换行结束
+    g_captured.clear();
+    std::string longText(4000, 'x');
+    LOG_INFO("%s", longText.c_str());
+    assert(g_captured.size() <= 1024 && g_captured.back() == '\n');
+
+    restoreOutput();
+    std::cout << "Logger stream test passed" << std::endl;
+}
+
+static size_t countLines(const std::string& text, const char* needle) {
+    size_t n = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        ++n;
+    }
+    return n;
+}
+
+// 限流宏：每个语句独立计数，恢复输出时注明跳过的条数
+void test_logger_sampled() {
+    captureOutput();
+
+    for (int i = 0; i < 25; ++i) {
+        LOG_EVERY_N(ERROR, 10, "every n %d", i);
+    }
+    assert(countLines(g_captured, "\n") == 3);
+    assert(g_captured.find("] ERROR: every n 0\n") != std::string::npos);
+    assert(g_captured.find("] ERROR: every n 10 (9 similar messages suppressed)\n") != std::string::npos);
+    assert(g_captured.find("] ERROR: every n 20 (9 similar messages suppressed)\n") != std::string::npos);
+
+    g_captured.clear();
+    for (int i = 0; i < 10; ++i) {
+        LOG_FIRST_N(INFO, 3, "first n %d", i);
+    }
+    assert(countLines(g_captured, "first n ") == 3);
+    assert(g_captured.find("first n 2\n") != std::string::npos);
+
+    // 低于阈值时不计数
+    g_captured.clear();
+    Logger::instance().setLogLevel(ERROR);
+    for (int i = 0; i < 5; ++i) {
+        LOG_FIRST_N(INFO, 3, "filtered %d", i);
+    }
+    Logger::instance().setLogLevel(INFO);
+    assert(g_captured.empty());
+
+    // 120毫秒内每50毫秒最多一条：第一条，之后约每50毫秒一条
+    g_captured.clear();
+    auto begin = std::chrono::steady_clock::now();
+    int calls = 0;
+    while (std::chrono::steady_clock::now() - begin < std::chrono::milliseconds(120)) {
+        LOG_EVERY_MS(ERROR, 50, "every ms %d", calls++);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    size_t lines = countLines(g_captured, "every ms ");
+    assert(lines >= 2 && lines <= 4);
+    assert(g_captured.find("] ERROR: every ms 0\n") != std::string::npos);
+    assert(g_captured.find("similar messages suppressed)\n") != std::string::npos);
+
+    // 多个线程同时经过同一语句，计数不丢不重
+    g_captured.clear();
+    std::mutex mutex;
+    Logger::setOutput([&mutex](const char* msg, int len) {
+        std::lock_guard<std::mutex> lock(mutex);
+        g_captured.append(msg, len);
+    });
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back(new Thread([]() {
+            for (int i = 0; i < 1000; ++i) {
+                LOG_EVERY_N(ERROR, 100, "threaded %d", i);
+            }
+        }, "SampledLog"));
+    }
+    for (auto& thread : threads) {
+        thread->start();
+    }
+    for (auto& thread : threads) {
+        thread->join();
+    }
+    assert(countLines(g_captured, "threaded ") == 40);
+
+    restoreOutput();
+    std::cout << "Logger sampled test passed" << std::endl;
+}
+
+// LogStream的数字格式化：整数和std::to_string一致，浮点数能原样解析回来，指针固定宽度十六进制
+void test_logstream_numbers() {
+    LogStream stream;
+    stream << INT_MIN << ' ' << INT_MAX << ' ' << 0 << ' ' << -9 << ' ' << 10 << ' ' << 99 << ' ' << 100;
+    std::string expected = std::to_string(INT_MIN) + " " + std::to_string(INT_MAX) + " 0 -9 10 99 100";
+    assert(std::string(stream.data(), stream.length()) == expected);
+
+    for (long long v : {LLONG_MIN, LLONG_MAX, -1000000007LL, 12345678901234LL}) {
+        stream.reset();
+        stream << v;
+        assert(std::string(stream.data(), stream.length()) == std::to_string(v));
+    }
+    stream.reset();
+    stream << ULLONG_MAX << ' ' << static_cast<unsigned short>(65535);
+    assert(std::string(stream.data(), stream.length()) == std::to_string(ULLONG_MAX) + " 65535");
+
+    stream.reset();
+    stream << 100000.0 << ' ' << -3.0 << ' ' << 0.25 << ' ' << 1e300;
+    assert(std::string(stream.data(), stream.length()) == "100000 -3 0.25 1e+300");
+    for (double v : {0.1, 1.0 / 3, -2.5e-8, 123456.789, 6.02214076e23}) {
+        stream.reset();
+        stream << v;
+        assert(strtod(std::string(stream.data(), stream.length()).c_str(), nullptr) == v);
+    }
+
+    stream.reset();
+    int x = 0;
+    stream << static_cast<const void*>(&x);
+    char ptr[32];
+    snprintf(ptr, sizeof ptr, "0x%016lx", reinterpret_cast<unsigned long>(&x));
+    assert(std::string(stream.data(), stream.length()) == ptr);
+
+    std::cout << "LogStream numbers test passed" << std::endl;
+}
+
 int main() {
     std::cout << "=== Logger Tests ===" << std::endl;
     test_logger_instance();
     test_logger_log_levels();
     test_logger_set_log_level();
+    test_logger_threshold();
+    test_logger_stream();
+    test_logger_sampled();
+    test_logstream_numbers();
     std::cout << "=== All Logger Tests Passed ===" << std::endl;
     return 0;
 }
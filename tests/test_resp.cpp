@@ -0,0 +1,296 @@
+#include "RespParser.h"
+#include "RespWriter.h"
+#include "RespServer.h"
+#include "TcpClient.h"
+#include "TcpConnection.h"
+#include "Eventloop.h"
+#include "InetAddress.h"
+#include "Buffer.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// 解析出所有完整的值，返回顶层值的个数
+static int parseAll(RespParser* parser, Buffer* buf) {
+    int n = 0;
+    while (parser->parse(buf) == RespParser::kComplete) ++n;
+    return n;
+}
+
+// 测试逐字节喂入流水线命令：每个命令完整时才返回，视图指向输入缓冲区
+void test_parse_byte_by_byte() {
+    cout << "=== Test Parse Byte By Byte ===" << endl;
+
+    const string wire =
+        "*3\r\n$3\r\nSET\r\n$3\r\nkey\r\n$5\r\nva\r\nl\r\n"
+        "*2\r\n$3\r\nGET\r\n$3\r\nkey\r\n"
+        "*1\r\n$0\r\n\r\n";
+    RespParser parser;
+    Buffer input;
+    int complete = 0;
+    for (size_t i = 0; i < wire.size(); ++i) {
+        input.append(wire.data() + i, 1);
+        complete += parseAll(&parser, &input);
+    }
+    assert(complete == 3);
+    const vector<RespValue>& v = parser.values();
+    assert(v.size() == 9);
+    assert(v[0].type == RespValue::kArray && v[0].integer == 3);
+    assert(v[1].str == "SET" && v[2].str == "key" && v[3].str == "va\r\nl");
+    assert(v[4].integer == 2 && v[5].str == "GET" && v[6].str == "key");
+    assert(v[7].integer == 1 && v[8].type == RespValue::kBulkString && v[8].str.empty());
+    assert(v[3].str.data() >= input.peek() && v[3].str.data() < input.peek() + input.readableBytes());
+    assert(parser.consumed() == wire.size());
+    cout << "Parse byte by byte test passed" << endl;
+}
+
+// 测试clear()之后未完成的值保留进度：半个命令在retrieve前后都能正确拼接
+void test_parse_resume_after_clear() {
+    cout << "=== Test Parse Resume After Clear ===" << endl;
+
+    RespParser parser;
+    Buffer input;
+    input.append(string("*1\r\n$4\r\nPING\r\n*2\r\n$4\r\nECHO\r\n$11\r\nhello"));
+    assert(parseAll(&parser, &input) == 1);
+    assert(parser.values()[1].str == "PING");
+    input.retrieve(parser.consumed());
+    parser.clear();
+    assert(parser.values().empty());
+
+    input.append(string(" world\r\n"));
+    assert(parseAll(&parser, &input) == 1);
+    assert(parser.values().size() == 3);
+    assert(parser.values()[1].str == "ECHO" && parser.values()[2].str == "hello world");
+    assert(parser.consumed() == input.readableBytes());
+    cout << "Parse resume after clear test passed" << endl;
+}
+
+// 测试RESP3的各种类型、RESP2的空值以及inline命令
+void test_parse_resp3_types() {
+    cout << "=== Test Parse RESP3 Types ===" << endl;
+
+    RespParser parser;
+    Buffer input;
+    input.append(string(
+        "%2\r\n+first\r\n:1\r\n$6\r\nsecond\r\n#t\r\n"   // map
+        "~2\r\n,3.14\r\n(3492890328409238509324850943850943825024385\r\n"  // set
+        "|1\r\n+ttl\r\n:3600\r\n=15\r\ntxt:Some string\r\n"   // 带属性的verbatim string
+        ">2\r\n+message\r\n!9\r\nERR oops!\r\n"   // push
+        "_\r\n$-1\r\n*-1\r\n-ERR bad\r\n"
+        "PING  hello\r\n"));
+    assert(parseAll(&parser, &input) == 9);
+    const vector<RespValue>& v = parser.values();
+    size_t i = 0;
+    assert(v[i].type == RespValue::kMap && v[i].integer == 2);
+    assert(v[++i].str == "first" && v[++i].integer == 1);
+    assert(v[++i].str == "second" && v[++i].type == RespValue::kBoolean && v[i].integer == 1);
+    assert(v[++i].type == RespValue::kSet && v[i].integer == 2);
+    assert(v[++i].type == RespValue::kDouble && v[i].str == "3.14");
+    assert(v[++i].type == RespValue::kBigNumber && v[i].str.size() == 43);
+    assert(v[++i].type == RespValue::kAttribute && v[i].integer == 1);
+    assert(v[++i].str == "ttl" && v[++i].integer == 3600);
+    assert(v[++i].type == RespValue::kVerbatimString && v[i].str == "txt:Some string");
+    assert(v[++i].type == RespValue::kPush && v[i].integer == 2);
+    assert(v[++i].str == "message" && v[++i].type == RespValue::kBulkError && v[i].str == "ERR oops!");
+    assert(v[++i].type == RespValue::kNull && v[i].null);
+    assert(v[++i].type == RespValue::kBulkString && v[i].null);
+    assert(v[++i].type == RespValue::kArray && v[i].null);
+    assert(v[++i].type == RespValue::kError && v[i].str == "ERR bad");
+    assert(v[++i].type == RespValue::kArray && v[i].integer == 2);
+    assert(v[++i].str == "PING" && v[++i].str == "hello");
+    assert(i + 1 == v.size());
+    cout << "Parse RESP3 types test passed" << endl;
+}
+
+// 测试错误输入
+void test_parse_errors() {
+    cout << "=== Test Parse Errors ===" << endl;
+
+    const vector<string> cases = {
+        "*1\r\n$3\r\nabcd\r\n",     // bulk长度不符
+        "*x\r\n",
+        "$-2\r\n",
+        "*1\r\n?\r\n",              // 嵌套中的未知类型
+        ":12a\r\n",
+        "#x\r\n",
+        "$2048\r\n",                // 超过上限
+    };
+    for (const string& c : cases) {
+        RespParser parser;
+        parser.setMaxBulkLength(1024);
+        Buffer input;
+        input.append(c);
+        assert(parseAll(&parser, &input) == 0);
+        assert(parser.parse(&input) == RespParser::kError);
+        assert(parser.error() != nullptr);
+    }
+    RespParser parser;
+    Buffer input;
+    input.append(string(RespParser::kMaxLineLength + 1, 'a'));
+    assert(parser.parse(&input) == RespParser::kError);
+    cout << "Parse errors test passed" << endl;
+}
+
+// 测试回复在RESP2和RESP3下的序列化
+void test_writer() {
+    cout << "=== Test Writer ===" << endl;
+
+    Buffer out;
+    RespWriter w2(&out, 2);
+    w2.ok();
+    w2.integer(-42);
+    w2.bulkString("hi");
+    w2.null();
+    w2.nullArray();
+    w2.boolean(true);
+    w2.mapHeader(1);
+    w2.doubleValue(1.5);
+    w2.error("ERR x");
+    assert(out.retrieveAllAsString() == "+OK\r\n:-42\r\n$2\r\nhi\r\n$-1\r\n*-1\r\n:1\r\n*2\r\n$3\r\n1.5\r\n-ERR x\r\n");
+
+    RespWriter w3(&out, 3);
+    w3.null();
+    w3.boolean(false);
+    w3.mapHeader(1);
+    w3.setHeader(2);
+    w3.pushHeader(3);
+    w3.doubleValue(1.5);
+    assert(out.retrieveAllAsString() == "_\r\n#f\r\n%1\r\n~2\r\n>3\r\n,1.5\r\n");
+    cout << "Writer test passed" << endl;
+}
+
+// 端到端：流水线客户端一次写出多条命令，服务器按批分发，回复顺序与命令一致
+void test_server_pipelining() {
+    cout << "=== Test Server Pipelining ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(19009);
+    RespServer server(&loop, serverAddr, TcpServer::kReusePort);
+    unordered_map<string, string> store;
+    int batches = 0;
+    size_t maxBatch = 0;
+    server.setCommandBatchCallback([&](const TcpConnectionPtr&, const RespCommand* cmds, size_t n, RespWriter* out) {
+        ++batches;
+        maxBatch = max(maxBatch, n);
+        for (size_t i = 0; i < n; ++i) {
+            const RespCommand& cmd = cmds[i];
+            if (cmd.is("set") && cmd.argc == 3) {
+                store[string(cmd[1])] = string(cmd[2]);
+                out->ok();
+            } else if (cmd.is("get") && cmd.argc == 2) {
+                auto it = store.find(string(cmd[1]));
+                if (it == store.end()) out->null();
+                else out->bulkString(it->second);
+            } else if (cmd.is("hello") && cmd.argc == 2) {
+                out->setProtocol(cmd[1] == "3" ? 3 : 2);
+                out->mapHeader(1);
+                out->bulkString("proto");
+                out->integer(out->protocol());
+            } else {
+                out->error("ERR unknown command");
+            }
+        }
+    });
+    server.start();
+
+    const int kCommands = 200;
+    string requests;
+    Buffer encoded;
+    RespWriter encoder(&encoded);
+    for (int i = 0; i < kCommands; ++i) {
+        encoder.arrayHeader(3);
+        encoder.bulkString("SET");
+        encoder.bulkString("k" + to_string(i));
+        encoder.bulkString("v" + to_string(i));
+        encoder.arrayHeader(2);
+        encoder.bulkString("get");
+        encoder.bulkString("k" + to_string(i));
+    }
+    requests = encoded.retrieveAllAsString();
+    requests += "*2\r\n$5\r\nHELLO\r\n$1\r\n3\r\n*2\r\n$3\r\nGET\r\n$7\r\nmissing\r\n";
+
+    RespParser replyParser;
+    int replies = 0;
+    bool ordered = true;
+    TcpClient client(&loop, serverAddr, "RespClient");
+    client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (conn->connected()) conn->send(requests);
+    });
+    client.setMessageCallback([&](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+        while (replyParser.parse(buf) == RespParser::kComplete) {
+        }
+        const vector<RespValue>& v = replyParser.values();
+        for (size_t i = 0; i < v.size(); ++i) {
+            int index = replies++;
+            if (index < kCommands * 2) {
+                if (index % 2 == 0 && v[i].str != "OK") ordered = false;
+                if (index % 2 == 1 && v[i].str != "v" + to_string(index / 2)) ordered = false;
+            } else if (index == kCommands * 2) {
+                // HELLO 3的回复是RESP3的map，跳过它的元素
+                if (v[i].type != RespValue::kMap || v[i + 2].integer != 3) ordered = false;
+                i += 2;
+            } else if (!(v[i].type == RespValue::kNull)) {
+                ordered = false;
+            }
+        }
+        buf->retrieve(replyParser.consumed());
+        replyParser.clear();
+        if (replies == kCommands * 2 + 2) loop.quit();
+    });
+    client.connect();
+
+    loop.runAfter(3.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(replies == kCommands * 2 + 2);
+    assert(ordered);
+    assert(maxBatch > 1);
+    assert(batches < kCommands * 2);
+    cout << "Server pipelining test passed, batches=" << batches << " maxBatch=" << maxBatch << endl;
+}
+
+// 协议错误：之前的完整命令照常回复，然后回复错误并关闭连接
+void test_server_protocol_error() {
+    cout << "=== Test Server Protocol Error ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(19010);
+    RespServer server(&loop, serverAddr, TcpServer::kReusePort);
+    server.start();
+
+    string received;
+    TcpClient client(&loop, serverAddr, "BadClient");
+    client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (conn->connected()) conn->send("*1\r\n$4\r\nPING\r\n*1\r\n:5\r\n");
+        else loop.quit();
+    });
+    client.setMessageCallback([&received](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+        received += buf->retrieveAllAsString();
+    });
+    client.connect();
+
+    loop.runAfter(3.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(received == "-ERR unknown command 'PING'\r\n-ERR Protocol error: expected array of bulk strings\r\n");
+    cout << "Server protocol error test passed" << endl;
+}
+
+int main() {
+    cout << "=== RESP Tests ===" << endl;
+
+    test_parse_byte_by_byte();
+    test_parse_resume_after_clear();
+    test_parse_resp3_types();
+    test_parse_errors();
+    test_writer();
+    test_server_pipelining();
+    test_server_protocol_error();
+
+    cout << "=== All RESP Tests Passed ===" << endl;
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include "RpcProtocol.h"
+#include "RpcServer.h"
+#include "RpcClient.h"
+#include "TcpConnection.h"
+#include "Eventloop.h"
+#include "InetAddress.h"
+#include "Buffer.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 测试消息编解码：帧内字段原样往返，截断的帧解码失败
+void test_codec() {
+    cout << "=== Test Codec ===" << endl;
+
+    Buffer buf;
+    rpc::encodeRequest(&buf, 300, 1500, "echo", string("pay\0load", 8));
+    rpc::encodeResponse(&buf, 1ULL << 40, rpc::kMethodNotFound, "no such method");
+
+    uint64_t length = 0;
+    size_t n = Buffer::decodeVarint(buf.peek(), buf.readableBytes(), &length);
+    assert(n > 0);
+    string_view frame(buf.peek() + n, length);
+    rpc::Request request;
+    assert(rpc::decodeRequest(frame, &request));
+    assert(request.id == 300 && request.timeoutMs == 1500);
+    assert(request.method == "echo" && request.payload == string_view("pay\0load", 8));
+    rpc::Response wrongType;
+    assert(!rpc::decodeResponse(frame, &wrongType));
+    for (size_t i = 0; i < frame.size() - request.payload.size(); ++i) {
+        assert(!rpc::decodeRequest(frame.substr(0, i), &request));
+    }
+    buf.retrieve(n + length);
+
+    n = Buffer::decodeVarint(buf.peek(), buf.readableBytes(), &length);
+    frame = string_view(buf.peek() + n, length);
+    rpc::Response response;
+    assert(rpc::decodeResponse(frame, &response));
+    assert(response.id == (1ULL << 40) && response.status == rpc::kMethodNotFound);
+    assert(response.payload == "no such method");
+    assert(!rpc::decodeRequest(frame, &request));
+    cout << "Codec test passed" << endl;
+}
+
+// 同一连接上的乱序应答和批量发送：先发出的慢调用最后完成，同一轮发出的调用在服务器端合并成少数几批
+void test_out_of_order_batching() {
+    cout << "=== Test Out Of Order Batching ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(19011);
+    RpcServer server(&loop, serverAddr, TcpServer::kReusePort);
+    int batches = 0;
+    bool inBatch = false;
+    // 在loop线程中queueInLoop的回调在本轮末尾执行，用它统计有请求到达的轮数
+    auto countBatch = [&]() {
+        if (!inBatch) {
+            inBatch = true;
+            ++batches;
+            loop.queueInLoop([&inBatch]() { inBatch = false; });
+        }
+    };
+    server.registerMethod("echo", [&](string_view request, const RpcResponder& responder) {
+        countBatch();
+        responder.reply(request);
+    });
+    server.registerMethod("slow", [&](string_view request, const RpcResponder& responder) {
+        countBatch();
+        string response(request);
+        loop.runAfter(0.1, [responder, response]() { responder.reply(response); });
+    });
+    server.start();
+
+    const int kCalls = 200;
+    vector<string> order;
+    int wrong = 0;
+    RpcClient client(&loop, serverAddr, "RpcClient");
+    client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (!conn->connected()) return;
+        client.call("slow", "slow", [&](rpc::Status status, string_view response) {
+            if (status != rpc::kOk || response != "slow") ++wrong;
+            order.push_back("slow");
+            loop.quit();
+        });
+        for (int i = 0; i < kCalls; ++i) {
+            string expected = "msg" + to_string(i);
+            client.call("echo", expected, [&, expected](rpc::Status status, string_view response) {
+                if (status != rpc::kOk || response != expected) ++wrong;
+                order.push_back(expected);
+            });
+        }
+    });
+    client.connect();
+
+    loop.runAfter(3.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(order.size() == kCalls + 1);
+    assert(wrong == 0);
+    assert(order.front() == "msg0" && order.back() == "slow");
+    assert(client.pendingCalls() == 0);
+    assert(batches < 10);
+    cout << "Out of order batching test passed, batches=" << batches << endl;
+}
+
+// 错误状态：未知方法、应用错误、超时（之后迟到的应答被丢弃）、未连接和连接断开
+void test_errors() {
+    cout << "=== Test Errors ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(19012);
+    RpcServer server(&loop, serverAddr, TcpServer::kReusePort);
+    vector<RpcResponder> held;
+    server.registerMethod("fail", [](string_view request, const RpcResponder& responder) {
+        responder.fail(string("bad ") + string(request));
+    });
+    server.registerMethod("hold", [&](string_view, const RpcResponder& responder) {
+        held.push_back(responder);
+    });
+    server.start();
+
+    vector<rpc::Status> results(6, rpc::kOk);
+    vector<string> messages(6);
+    auto record = [&](int i) {
+        return [&, i](rpc::Status status, string_view message) {
+            results[i] = status;
+            messages[i] = string(message);
+        };
+    };
+
+    RpcClient client(&loop, serverAddr, "RpcClient");
+    client.setDefaultTimeout(2.0);
+    // 还没有连接时调用立即失败
+    client.call("hold", "", record(0));
+    client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (!conn->connected()) {
+            loop.quit();
+            return;
+        }
+        client.call("missing", "", record(1));
+        client.call("fail", "input", record(2));
+        client.call("hold", "", record(3), 0.05);
+        client.call("hold", "", record(4), 0.1);
+        client.call("hold", "", record(5));
+    });
+    loop.runAfter(0.01, [&client]() { client.connect(); });
+
+    // 超时的两个调用结束后再应答所有请求：前两个应答已经没有对应的调用
+    loop.runAfter(0.3, [&]() {
+        assert(client.pendingCalls() == 1);
+        held[0].reply("late");
+        held[1].reply("late");
+    });
+    loop.runAfter(0.5, [&]() {
+        assert(client.pendingCalls() == 1);
+        client.disconnect();
+    });
+    loop.runAfter(3.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(results[0] == rpc::kConnectionClosed);
+    assert(results[1] == rpc::kMethodNotFound);
+    assert(results[2] == rpc::kApplicationError && messages[2] == "bad input");
+    assert(results[3] == rpc::kDeadlineExceeded);
+    assert(results[4] == rpc::kDeadlineExceeded);
+    assert(results[5] == rpc::kConnectionClosed);
+    assert(held.size() == 3);
+    assert(held[1].timeoutMs() == 100 && held[2].timeoutMs() == 2000);
+    assert(client.pendingCalls() == 0);
+
+    // 析构时还在排队等待flush的调用同样以kConnectionClosed结束，排队的flush不再执行
+    rpc::Status queuedStatus = rpc::kOk;
+    {
+        RpcClient shortLived(&loop, serverAddr, "ShortLived");
+        shortLived.call("hold", "", [&queuedStatus](rpc::Status status, string_view) {
+            queuedStatus = status;
+        });
+    }
+    assert(queuedStatus == rpc::kConnectionClosed);
+    loop.runAfter(0.05, [&loop]() { loop.quit(); });
+    loop.loop();
+    cout << "Errors test passed" << endl;
+}
+
+int main() {
+    cout << "=== RPC Tests ===" << endl;
+
+    test_codec();
+    test_out_of_order_batching();
+    test_errors();
+
+    cout << "=== All RPC Tests Passed ===" << endl;
+    return 0;
+}
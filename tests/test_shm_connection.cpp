@@ -0,0 +1,215 @@
+#include "ShmConnection.h"
+#include "Eventloop.h"
+#include "Buffer.h"
+#include "Timer.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <atomic>
+
+using namespace std;
+
+static char patternByte(size_t i) { return static_cast<char>(i % 251); }
+
+// 子进程：收到fd后映射同一对环，把收到的数据原样发回，对端关闭后退出
+static int runEchoChild(int sockfd) {
+    EventLoop loop;
+    vector<int> fds;
+    if (ShmConnection::recvFds(sockfd, &fds) != 3) {
+        return 1;
+    }
+    ShmConnectionPtr conn = ShmConnection::attach(&loop, "child", fds);
+    if (!conn) {
+        return 2;
+    }
+    conn->setMessageCallback([](const ShmConnectionPtr& c, Buffer* buf, Timestamp) {
+        c->send(buf);
+    });
+    conn->setCloseCallback([&loop](const ShmConnectionPtr&) { loop.quit(); });
+    conn->start();
+    loop.runAfter(10.0, [&loop]() { loop.quit(); });
+    loop.loop();
+    return conn->disconnected() ? 0 : 3;
+}
+
+// 测试跨进程回显：环容量远小于数据量，覆盖回绕和环满后的等待/唤醒
+void test_cross_process_echo() {
+    cout << "=== Test Cross-Process Echo ===" << endl;
+
+    int sv[2];
+    assert(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) == 0);
+    pid_t pid = ::fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        ::close(sv[0]);
+        ::_exit(runEchoChild(sv[1]));
+    }
+    ::close(sv[1]);
+
+    EventLoop loop;
+    ShmConnectionPtr conn = ShmConnection::create(&loop, "parent", 16 * 1024);
+    assert(conn);
+    assert(ShmConnection::sendFds(sv[0], conn->exportFds()));
+
+    const size_t kTotal = 4 * 1024 * 1024;
+    const size_t kChunk = 3000;
+    size_t received = 0;
+    bool intact = true;
+    bool closed = false;
+    conn->setMessageCallback([&](const ShmConnectionPtr& c, Buffer* buf, Timestamp) {
+        const char* p = buf->peek();
+        for (size_t i = 0; i < buf->readableBytes(); ++i) {
+            if (p[i] != patternByte(received + i)) intact = false;
+        }
+        received += buf->readableBytes();
+        buf->retrieveAll();
+        if (received == kTotal) {
+            c->shutdown();
+        }
+    });
+    conn->setCloseCallback([&](const ShmConnectionPtr&) {
+        closed = true;
+        loop.quit();
+    });
+    conn->start();
+
+    // 一次性提交全部数据，环满的部分留在outputBuffer，由对端读走后唤醒继续写
+    loop.runAfter(0.01, [&]() {
+        string chunk;
+        for (size_t sent = 0; sent < kTotal; sent += kChunk) {
+            size_t n = min(kChunk, kTotal - sent);
+            chunk.resize(n);
+            for (size_t i = 0; i < n; ++i) chunk[i] = patternByte(sent + i);
+            conn->send(chunk);
+        }
+    });
+    loop.runAfter(10.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    ::close(sv[0]);
+
+    assert(received == kTotal);
+    assert(intact);
+    assert(closed);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    assert(conn->bytesSent() == kTotal);
+    cout << "Cross-process echo test passed, notifies=" << conn->notifies()
+         << " skipped=" << conn->notifiesSkipped()
+         << " wakeups=" << conn->wakeups() << endl;
+}
+
+// 测试对端已被唤醒时不再写eventfd：同一轮中连续发送多条消息只需通知一次
+void test_notify_skipped_when_awake() {
+    cout << "=== Test Notify Skipped ===" << endl;
+
+    EventLoop loop;
+    ShmConnectionPtr a = ShmConnection::create(&loop, "a");
+    assert(a);
+    int sv[2];
+    assert(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) == 0);
+    assert(ShmConnection::sendFds(sv[0], a->exportFds()));
+    vector<int> fds;
+    assert(ShmConnection::recvFds(sv[1], &fds) == 3);
+    ::close(sv[0]);
+    ::close(sv[1]);
+    ShmConnectionPtr b = ShmConnection::attach(&loop, "b", fds);
+    assert(b);
+
+    const int kMessages = 1000;
+    const string msg = "hello shm";
+    size_t received = 0;
+    int aClosed = 0;
+    int bClosed = 0;
+    b->setMessageCallback([&](const ShmConnectionPtr& c, Buffer* buf, Timestamp) {
+        received += buf->readableBytes();
+        buf->retrieveAll();
+        if (received == kMessages * msg.size()) {
+            c->shutdown();
+        }
+    });
+    a->setCloseCallback([&](const ShmConnectionPtr&) { ++aClosed; });
+    b->setCloseCallback([&](const ShmConnectionPtr&) { ++bClosed; });
+    a->start();
+    b->start();
+
+    loop.runAfter(0.01, [&]() {
+        for (int i = 0; i < kMessages; ++i) {
+            a->send(msg);
+        }
+    });
+    loop.runAfter(0.5, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(received == kMessages * msg.size());
+    // b在等待，第一条消息需要通知；之后b尚未被处理，等待标志已被清除，其余消息都不需要系统调用
+    assert(a->notifies() == 1);
+    assert(a->notifiesSkipped() >= static_cast<uint64_t>(kMessages - 1));
+    assert(b->wakeups() >= 1);
+    assert(aClosed == 1 && bClosed == 1);
+    assert(a->disconnected() && b->disconnected());
+    cout << "Notify skipped test passed, notifies=" << a->notifies()
+         << " skipped=" << a->notifiesSkipped() << endl;
+}
+
+// 测试对端写坏环位置：接收方不按越界的长度拷贝，而是按协议错误关闭连接
+void test_corrupted_peer_closes() {
+    cout << "=== Test Corrupted Peer ===" << endl;
+
+    EventLoop loop;
+    ShmConnectionPtr a = ShmConnection::create(&loop, "a", 16 * 1024);
+    assert(a);
+    vector<int> fds = a->exportFds();
+    vector<int> dup;
+    for (int fd : fds) {
+        dup.push_back(::dup(fd));
+    }
+    ShmConnectionPtr b = ShmConnection::attach(&loop, "b", dup);
+    assert(b);
+
+    // 另外映射一份，扮演写坏共享内存的对端；第一个环由a生产、b消费，head在头部开头
+    struct stat st;
+    assert(::fstat(fds[0], &st) == 0);
+    void* base = ::mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    assert(base != MAP_FAILED);
+    auto* head = static_cast<std::atomic<uint64_t>*>(base);
+
+    size_t received = 0;
+    b->setMessageCallback([&](const ShmConnectionPtr&, Buffer* buf, Timestamp) {
+        received += buf->readableBytes();
+        buf->retrieveAll();
+    });
+    a->start();
+    b->start();
+    loop.runAfter(0.01, [&]() {
+        head->store(head->load() + 3 * 16 * 1024);
+        uint64_t one = 1;
+        ssize_t n = ::write(fds[2], &one, sizeof one);
+        (void)n;
+    });
+    loop.runAfter(0.2, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(received == 0);
+    assert(b->disconnected());
+    ::munmap(base, st.st_size);
+    cout << "Corrupted peer test passed" << endl;
+}
+
+int main() {
+    cout << "=== ShmConnection Tests ===" << endl;
+
+    test_cross_process_echo();
+    test_notify_skipped_when_awake();
+    test_corrupted_peer_closes();
+
+    cout << "=== All ShmConnection Tests Passed ===" << endl;
+    return 0;
+}
@@ -0,0 +1,209 @@
+#include "SpliceRelay.h"
+#include "TcpServer.h"
+#include "TcpClient.h"
+#include "TcpConnection.h"
+#include "Eventloop.h"
+#include "InetAddress.h"
+#include "Timer.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+using namespace std;
+
+// 阻塞方式的客户端：边写边读，收齐回显后半关闭，再确认收到对端的FIN
+static bool runBlockingClient(uint16_t port, const string& payload, string* echoed, bool* gotEof) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, (sockaddr*)&addr, sizeof addr) < 0) {
+        ::close(fd);
+        return false;
+    }
+
+    thread writer([fd, &payload]() {
+        size_t sent = 0;
+        while (sent < payload.size()) {
+            ssize_t n = ::write(fd, payload.data() + sent, payload.size() - sent);
+            if (n <= 0) break;
+            sent += n;
+        }
+    });
+
+    char buf[65536];
+    while (echoed->size() < payload.size()) {
+        ssize_t n = ::read(fd, buf, sizeof buf);
+        if (n <= 0) break;
+        echoed->append(buf, n);
+    }
+    writer.join();
+
+    ::shutdown(fd, SHUT_WR);
+    *gotEof = (::read(fd, buf, sizeof buf) == 0);
+    ::close(fd);
+    return true;
+}
+
+// 测试通过splice转发的双向数据、背压以及半关闭传递
+void test_relay_echo() {
+    cout << "=== Test Splice Relay Echo ===" << endl;
+
+    EventLoop loop;
+
+    // 上游：普通的回显服务器
+    InetAddress upstreamAddr(9999);
+    TcpServer upstream(&loop, upstreamAddr, TcpServer::kReusePort);
+    upstream.setConnectionCallback([](const TcpConnectionPtr&) {});
+    upstream.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+        conn->send(buf->retrieveAllAsString());
+    });
+    upstream.start();
+
+    // 代理：每个下游连接对应一个到上游的TcpClient，连上后开始splice转发
+    InetAddress proxyAddr(9998);
+    TcpServer proxy(&loop, proxyAddr, TcpServer::kReusePort);
+    vector<unique_ptr<TcpClient>> clients;
+    vector<SpliceRelay::RelayPtr> relays;
+    proxy.setConnectionCallback([&](const TcpConnectionPtr& downstream) {
+        if (!downstream->connected()) return;
+        clients.emplace_back(new TcpClient(&loop, upstreamAddr, "Upstream"));
+        TcpClient* client = clients.back().get();
+        client->setConnectionCallback([&relays, downstream](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                relays.push_back(SpliceRelay::start(downstream, conn));
+            }
+        });
+        client->connect();
+    });
+    // 上游连上之前到达的数据留在inputBuffer中，由relay先行转发
+    proxy.setMessageCallback([](const TcpConnectionPtr&, Buffer*, Timestamp) {});
+    proxy.start();
+
+    string payload(4 * 1024 * 1024, '\0');
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<char>('a' + i % 26);
+    }
+    string echoed;
+    bool gotEof = false;
+    bool connected = false;
+    thread clientThread([&]() {
+        connected = runBlockingClient(9998, payload, &echoed, &gotEof);
+        loop.quit();
+    });
+
+    loop.runAfter(10.0, [&loop]() { loop.quit(); });
+    loop.loop();
+    clientThread.join();
+
+    assert(connected);
+    assert(echoed == payload);
+    assert(gotEof);
+    assert(relays.size() == 1);
+    assert(relays[0]->bytesRelayed(0) == payload.size());
+    assert(relays[0]->bytesRelayed(1) == payload.size());
+    assert(relays[0]->finished());
+    cout << "Splice relay echo test passed" << endl;
+}
+
+// 测试两端都设置了比整个转发过程更短的空闲超时：只要数据一直在流动，连接就不能被当成空闲关闭
+void test_relay_idle_timeout() {
+    cout << "=== Test Splice Relay Idle Timeout ===" << endl;
+
+    EventLoop loop;
+    const double kIdleTimeout = 0.3;
+
+    InetAddress upstreamAddr(9979);
+    TcpServer upstream(&loop, upstreamAddr, TcpServer::kReusePort);
+    upstream.setConnectionCallback([](const TcpConnectionPtr&) {});
+    upstream.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+        conn->send(buf->retrieveAllAsString());
+    });
+    upstream.start();
+
+    InetAddress proxyAddr(9978);
+    TcpServer proxy(&loop, proxyAddr, TcpServer::kReusePort);
+    unique_ptr<TcpClient> client;
+    SpliceRelay::RelayPtr relay;
+    proxy.setConnectionCallback([&](const TcpConnectionPtr& downstream) {
+        if (!downstream->connected()) return;
+        downstream->setIdleTimeout(kIdleTimeout);
+        client.reset(new TcpClient(&loop, upstreamAddr, "Upstream"));
+        client->setConnectionCallback([&relay, downstream, kIdleTimeout](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                conn->setIdleTimeout(kIdleTimeout);
+                relay = SpliceRelay::start(downstream, conn);
+            }
+        });
+        client->connect();
+    });
+    proxy.setMessageCallback([](const TcpConnectionPtr&, Buffer*, Timestamp) {});
+    proxy.start();
+
+    // 每隔50ms发一小块并等待回显，整个过程约1.5秒，远长于空闲超时
+    const int kChunks = 30;
+    const string chunk(1024, 'x');
+    int echoedChunks = 0;
+    bool gotEof = false;
+    thread clientThread([&]() {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(9978);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        // 连接被错误关闭时relay仍持有连接、socket不会马上关闭，设置读超时避免一直阻塞
+        timeval tv{2, 0};
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
+        if (::connect(fd, (sockaddr*)&addr, sizeof addr) == 0) {
+            char buf[4096];
+            for (int i = 0; i < kChunks; ++i) {
+                if (::write(fd, chunk.data(), chunk.size()) != static_cast<ssize_t>(chunk.size())) break;
+                size_t got = 0;
+                while (got < chunk.size()) {
+                    ssize_t n = ::read(fd, buf, sizeof buf);
+                    if (n <= 0) break;
+                    got += n;
+                }
+                if (got != chunk.size()) break;
+                ++echoedChunks;
+                this_thread::sleep_for(chrono::milliseconds(50));
+            }
+            ::shutdown(fd, SHUT_WR);
+            gotEof = (::read(fd, buf, sizeof buf) == 0);
+        }
+        ::close(fd);
+        loop.quit();
+    });
+
+    loop.runAfter(10.0, [&loop]() { loop.quit(); });
+    loop.loop();
+    clientThread.join();
+
+    assert(echoedChunks == kChunks);
+    assert(gotEof);
+    assert(relay);
+    assert(relay->bytesRelayed(0) == kChunks * chunk.size());
+    assert(relay->bytesRelayed(1) == kChunks * chunk.size());
+    cout << "Splice relay idle timeout test passed" << endl;
+}
+
+int main() {
+    ::signal(SIGPIPE, SIG_IGN);
+    cout << "=== SpliceRelay Tests ===" << endl;
+
+    test_relay_echo();
+    test_relay_idle_timeout();
+
+    cout << "=== All SpliceRelay Tests Passed ===" << endl;
+    return 0;
+}
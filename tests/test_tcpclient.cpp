@@ -0,0 +1,241 @@
+#include "TcpClient.h"
+#include "TcpConnectionPool.h"
+#include "TcpServer.h"
+#include "TcpConnection.h"
+#include "Eventloop.h"
+#include "InetAddress.h"
+#include "Timer.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static void echoMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    conn->send(buf->retrieveAllAsString());
+}
+
+// 测试客户端连接本地服务器并收发数据
+void test_client_echo() {
+    cout << "=== Test Client Echo ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(9995);
+    TcpServer server(&loop, serverAddr, TcpServer::kReusePort);
+    server.setConnectionCallback([](const TcpConnectionPtr&) {});
+    server.setMessageCallback(echoMessage);
+    server.start();
+
+    TcpClient client(&loop, serverAddr, "EchoClient");
+    string received;
+    bool connected = false;
+    client.setConnectionCallback([&connected](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            connected = true;
+            conn->send("hello client");
+        }
+    });
+    client.setMessageCallback([&received, &loop](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+        received += buf->retrieveAllAsString();
+        if (received.size() >= 12) {
+            loop.quit();
+        }
+    });
+    client.connect();
+
+    loop.runAfter(2.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(connected);
+    assert(received == "hello client");
+    assert(client.connection() && client.connection()->connected());
+    cout << "Client echo test passed" << endl;
+}
+
+// 测试连接被拒绝时按指数退避重试，服务器启动后连接成功
+void test_connect_retry() {
+    cout << "=== Test Connect Retry ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(9996);
+
+    TcpClient client(&loop, serverAddr, "RetryClient");
+    client.connector()->setRetryDelay(20, 100);
+    bool connected = false;
+    client.setConnectionCallback([&connected, &loop](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            connected = true;
+            loop.quit();
+        }
+    });
+    client.connect();
+
+    // 先让客户端失败几次，再启动服务器
+    TcpServer* server = nullptr;
+    int retriesBeforeListen = 0;
+    loop.runAfter(0.3, [&]() {
+        retriesBeforeListen = client.connector()->retries();
+        server = new TcpServer(&loop, serverAddr, TcpServer::kReusePort);
+        server->setConnectionCallback([](const TcpConnectionPtr&) {});
+        server->setMessageCallback(echoMessage);
+        server->start();
+    });
+    loop.runAfter(3.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    // 20+40+80+100... 在300ms内至少重试了3次，但退避后远少于300/20次
+    assert(retriesBeforeListen >= 3);
+    assert(retriesBeforeListen < 10);
+    assert(connected);
+    delete server;
+    cout << "Connect retry test passed" << endl;
+}
+
+// 测试连接池复用同一地址上的空闲连接
+void test_connection_pool() {
+    cout << "=== Test Connection Pool ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(9997);
+    TcpServer server(&loop, serverAddr, TcpServer::kReusePort);
+    server.setConnectionCallback([](const TcpConnectionPtr&) {});
+    server.setMessageCallback(echoMessage);
+    server.start();
+
+    TcpConnectionPool pool(&loop, "Pool");
+    pool.setMaxIdlePerKey(2);
+    const int kRequests = 10;
+    int done = 0;
+    vector<string> connNames;
+    uint64_t serialMisses = 0;
+    size_t serialIdle = 0;
+    int acquired = 0;
+    vector<TcpConnectionPtr> held;
+
+    // 第二阶段：同时持有两条连接时第二次acquire必须新建连接
+    auto acquireTwo = [&]() {
+        serialMisses = pool.misses();
+        serialIdle = pool.idleCount(serverAddr);
+        for (int i = 0; i < 2; ++i) {
+            pool.acquire(serverAddr, [&](const TcpConnectionPtr& conn) {
+                held.push_back(conn);
+                if (++acquired == 2) {
+                    loop.quit();
+                }
+            });
+        }
+    };
+
+    // 第一阶段：串行发起请求，收到回复后归还连接，再发下一个
+    function<void()> request;
+    pool.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+        buf->retrieveAll();
+        pool.release(conn);
+        if (++done == kRequests) {
+            acquireTwo();
+        } else {
+            request();
+        }
+    });
+    request = [&]() {
+        pool.acquire(serverAddr, [&connNames](const TcpConnectionPtr& conn) {
+            connNames.push_back(conn->name());
+            conn->send("ping");
+        });
+    };
+    loop.runInLoop(request);
+
+    loop.runAfter(2.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(done == kRequests);
+    assert(serialMisses == 1);
+    assert(serialIdle == 1);
+    for (const string& name : connNames) {
+        assert(name == connNames[0]);
+    }
+
+    assert(acquired == 2);
+    assert(pool.misses() == 2);
+    assert(pool.hits() == kRequests);
+    assert(held[0] != held[1]);
+    for (auto& conn : held) {
+        pool.release(conn);
+    }
+    assert(pool.idleCount(serverAddr) == 2);
+    assert(pool.reuseRate() > 0.8);
+    cout << "Connection pool test passed, reuse rate " << pool.reuseRate() << endl;
+}
+
+// 测试连接池新建连接超时后以nullptr回调，不再重试
+void test_connection_pool_timeout() {
+    cout << "=== Test Connection Pool Timeout ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(9994);   // 没有服务器监听
+    TcpConnectionPool pool(&loop, "TimeoutPool");
+    pool.setRetryDelay(20, 50);
+    pool.setConnectTimeout(0.3);
+    int calls = 0;
+    bool failed = false;
+    loop.runInLoop([&]() {
+        pool.acquire(serverAddr, [&](const TcpConnectionPtr& conn) {
+            ++calls;
+            failed = !conn;
+        });
+    });
+    loop.runAfter(1.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(calls == 1);
+    assert(failed);
+    assert(pool.misses() == 1);
+    assert(pool.numConnections() == 0);
+    cout << "Connection pool timeout test passed" << endl;
+}
+
+// 测试客户端通过Unix域socket（抽象命名空间）连接
+void test_client_unix() {
+    cout << "=== Test Client Unix ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr = InetAddress::fromUnixPath("@re_muduo_test_tcpclient");
+    TcpServer server(&loop, serverAddr);
+    server.setConnectionCallback([](const TcpConnectionPtr&) {});
+    server.setMessageCallback(echoMessage);
+    server.start();
+
+    TcpClient client(&loop, serverAddr, "UnixClient");
+    string received;
+    client.setConnectionCallback([](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            assert(conn->peerAddress().unixPath() == "@re_muduo_test_tcpclient");
+            conn->send("over uds");
+        }
+    });
+    client.setMessageCallback([&received, &loop](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+        received += buf->retrieveAllAsString();
+        loop.quit();
+    });
+    client.connect();
+
+    loop.runAfter(2.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(received == "over uds");
+    cout << "Client unix test passed" << endl;
+}
+
+int main() {
+    cout << "=== TcpClient Tests ===" << endl;
+
+    test_client_echo();
+    test_connect_retry();
+    test_connection_pool();
+    test_connection_pool_timeout();
+    test_client_unix();
+
+    cout << "=== All TcpClient Tests Passed ===" << endl;
+    return 0;
+}
@@ -1003,6 +1003,57 @@ void test_high_water_mark_improved()
     cout << "High water mark (improved) test passed" << endl;
 }
 
+// 测试直接写outputBuffer()后flushOutputBuffer：高水位回调只在越过水位线时触发一次
+void test_flush_high_water_mark_once()
+{
+    cout << "=== Test Flush High Water Mark Once ===" << endl;
+
+    EventLoop loop;
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) < 0)
+    {
+        perror("socketpair");
+        exit(1);
+    }
+
+    InetAddress localAddr(1234);
+    InetAddress peerAddr(5678);
+
+    int callbacks = 0;
+    TcpConnectionPtr conn(new TcpConnection(&loop, "testConnection", sv[0], localAddr, peerAddr));
+    conn->setConnectionCallback([](const TcpConnectionPtr&) {});
+    conn->setHighWaterMarkCallback([&callbacks](const TcpConnectionPtr&, size_t size) {
+        ++callbacks;
+        cout << "High water mark callback triggered, size: " << size << " bytes" << endl;
+    }, 1024 * 1024);
+    conn->connectEstablished();
+
+    // 对端不读，socket缓冲区写满后数据堆积在outputBuffer_中，逐批追加并flush
+    loop.runInLoop([conn]() {
+        string chunk(256 * 1024, 'F');
+        for (int i = 0; i < 16; ++i)
+        {
+            conn->outputBuffer()->append(chunk);
+            conn->flushOutputBuffer();
+        }
+    });
+
+    loop.runAfter(0.2, [&loop]() {
+        loop.quit();
+    });
+    loop.loop();
+
+    assert(conn->outputBuffer()->readableBytes() >= 1024 * 1024);
+    assert(callbacks == 1);
+
+    conn->connectDestroyed();
+    close(sv[0]);
+    close(sv[1]);
+
+    cout << "Flush high water mark once test passed" << endl;
+}
+
 // 测试跨线程操作
 void test_cross_thread_operations()
 {
@@ -1329,6 +1380,7 @@ int main()
     test_operation_in_callback();
     test_large_message();
     test_high_water_mark_improved();
+    test_flush_high_water_mark_once();
     test_cross_thread_operations();
     test_memory_leak();
 
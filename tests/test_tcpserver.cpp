@@ -3,11 +3,20 @@
 #include "InetAddress.h"
 #include "Timestamp.h"
 #include "TcpConnection.h"
+#include "Socket.h"
 #include <iostream>
 #include <cassert>
 #include <thread>
 #include <chrono>
 #include <string>
+#include <atomic>
+#include <mutex>
+#include <sched.h>
+#include <condition_variable>
+#include <vector>
+#include <map>
+#include <sys/socket.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -184,6 +193,277 @@ void test_server_timeout_settings() {
     cout << "Server timeout settings test passed" << endl;
 }
 
+// 测试按SO_INCOMING_CPU分配连接
+void test_incoming_cpu_steering() {
+    cout << "=== Test Incoming CPU Steering ===" << endl;
+
+    EventLoop loop;
+    InetAddress listenAddr(9986);
+    TcpServer server(&loop, listenAddr);
+
+    // 每个可用CPU上恰好一个IO线程，按CPU选择loop的结果是确定的
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    assert(::sched_getaffinity(0, sizeof cpuset, &cpuset) == 0);
+    server.setThreadNum(CPU_COUNT(&cpuset));
+    server.setThreadCpuAffinity(true);
+    server.setIncomingCpuSteering(true);
+
+    mutex mu;
+    condition_variable cond;
+    int established = 0;
+    bool closed = false;
+    EventLoop* connLoop = nullptr;
+    server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        lock_guard<mutex> lock(mu);
+        if (conn->connected()) {
+            assert(conn->getLoop() != &loop);
+            assert(conn->getLoop()->isInLoopThread());
+            connLoop = conn->getLoop();
+            established++;
+        } else {
+            closed = true;
+        }
+        cond.notify_all();
+    });
+
+    server.start();
+
+    int incomingCpu = -2;
+    thread client([&]() {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        InetAddress serverAddr(9986);
+        int ret = ::connect(fd, (const sockaddr*)serverAddr.getSockAddr(), sizeof(sockaddr_in));
+        assert(ret == 0);
+        (void)ret;
+        unique_lock<mutex> lock(mu);
+        incomingCpu = Socket::getIncomingCpu(fd);
+        cond.wait(lock, [&] { return established == 1; });
+        lock.unlock();
+        ::close(fd);
+        lock.lock();
+        cond.wait(lock, [&] { return closed; });
+        loop.queueInLoop([&loop]() { loop.quit(); });
+    });
+
+    loop.loop();
+    client.join();
+
+    assert(established == 1);
+    assert(incomingCpu >= -1);
+    // 连接必须分配给绑定在SO_INCOMING_CPU上的IO线程
+    if (incomingCpu >= 0) {
+        assert(connLoop == server.threadPool()->getLoopForCpu(incomingCpu));
+    }
+    cout << "Incoming CPU steering test passed" << endl;
+}
+
+// 测试运行时调整IO线程数
+void test_adjust_thread_num() {
+    cout << "=== Test Adjust Thread Num ===" << endl;
+
+    EventLoop loop;
+    InetAddress listenAddr(9987);
+    TcpServer server(&loop, listenAddr);
+    server.setThreadNum(1);
+
+    // 连接回调在不同的IO线程中执行，先后顺序不等于连接顺序，按客户端端口记录每个连接的loop
+    mutex mu;
+    condition_variable cond;
+    map<uint16_t, EventLoop*> connLoops;
+    int closed = 0;
+    server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        lock_guard<mutex> lock(mu);
+        if (conn->connected()) {
+            connLoops[conn->peerAddress().toPort()] = conn->getLoop();
+        } else {
+            ++closed;
+        }
+        cond.notify_all();
+    });
+    server.start();
+
+    auto connectOnce = []() {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        InetAddress serverAddr(9987);
+        int ret = ::connect(fd, (const sockaddr*)serverAddr.getSockAddr(), sizeof(sockaddr_in));
+        assert(ret == 0);
+        (void)ret;
+        return fd;
+    };
+    auto localPort = [](int fd) {
+        return Socket::getLocalAddr(fd).toPort();
+    };
+    auto waitFor = [&](auto done) {
+        unique_lock<mutex> lock(mu);
+        cond.wait(lock, done);
+    };
+    // adjustThreadNum在baseLoop中执行，排在它之后的任务执行时调整已经完成，顺便取出当前的loop
+    vector<EventLoop*> activeLoops;
+    auto adjustAndWait = [&](int numThreads) {
+        server.adjustThreadNum(numThreads);
+        bool adjusted = false;
+        loop.queueInLoop([&]() {
+            lock_guard<mutex> lock(mu);
+            activeLoops = server.threadPool()->getAllLoops();
+            adjusted = true;
+            cond.notify_all();
+        });
+        waitFor([&] { return adjusted; });
+    };
+
+    thread client([&]() {
+        adjustAndWait(2);
+        assert(activeLoops.size() == 2);
+        int fd1 = connectOnce();
+        int fd2 = connectOnce();
+        waitFor([&] { return connLoops.size() == 2; });
+
+        // 退役一个loop，其上的连接保持可用直到关闭
+        adjustAndWait(1);
+        assert(activeLoops.size() == 1);
+        int fd3 = connectOnce();
+        waitFor([&] { return connLoops.size() == 3; });
+
+        {
+            lock_guard<mutex> lock(mu);
+            EventLoop* loop1 = connLoops[localPort(fd1)];
+            EventLoop* loop2 = connLoops[localPort(fd2)];
+            EventLoop* loop3 = connLoops[localPort(fd3)];
+            // 前两个连接分到两个loop，退役后新连接只会分到剩下的loop
+            assert(loop1 != nullptr && loop2 != nullptr && loop1 != loop2);
+            assert(loop3 == activeLoops[0]);
+            (void)loop3;
+        }
+
+        // 关掉所有连接后退役的loop被回收，剩下的loop照常工作
+        ::close(fd2);
+        waitFor([&] { return closed == 1; });
+        ::close(fd1);
+        ::close(fd3);
+        waitFor([&] { return closed == 3; });
+        loop.queueInLoop([&loop]() { loop.quit(); });
+    });
+
+    loop.loop();
+    client.join();
+
+    assert(connLoops.size() == 3);
+    assert(closed == 3);
+    cout << "Adjust thread num test passed" << endl;
+}
+
+// 测试TcpServer/TcpConnection跑在Unix域socket上（文件路径与抽象命名空间）
+void test_unix_domain_socket() {
+    cout << "=== Test Unix Domain Socket ===" << endl;
+
+    const string path = "/tmp/re_muduo_test_tcpserver.sock";
+    vector<InetAddress> addrs = {InetAddress::fromUnixPath(path),
+                                 InetAddress::fromUnixPath("@re_muduo_test_tcpserver")};
+    for (const InetAddress& listenAddr : addrs) {
+        EventLoop loop;
+        TcpServer server(&loop, listenAddr);
+        server.setThreadNum(1);
+        string peerName;
+        server.setConnectionCallback([&peerName](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                assert(conn->localAddress().isUnix());
+                peerName = conn->peerAddress().toIpPort();
+            }
+        });
+        server.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+            conn->send(buf);
+        });
+        server.start();
+
+        string echoed;
+        thread client([&]() {
+            this_thread::sleep_for(chrono::milliseconds(50));
+            int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (::connect(fd, listenAddr.getGenericSockAddr(), listenAddr.getSockAddrLen()) == 0) {
+                ::write(fd, "unix hello", 10);
+                char buf[64];
+                ssize_t n = ::read(fd, buf, sizeof buf);
+                if (n > 0) echoed.assign(buf, n);
+            }
+            ::close(fd);
+            this_thread::sleep_for(chrono::milliseconds(50));
+            loop.quit();
+        });
+
+        loop.loop();
+        client.join();
+
+        assert(echoed == "unix hello");
+        assert(peerName.compare(0, 5, "unix:") == 0);
+        cout << "  " << listenAddr.toIpPort() << " ok" << endl;
+    }
+    // 文件路径形式的socket文件随Acceptor析构删除
+    assert(::access(path.c_str(), F_OK) != 0);
+    cout << "Unix domain socket test passed" << endl;
+}
+
+// 测试路径很长的Unix域地址：连接名不能被截断，否则多个连接同名会互相覆盖
+void test_long_unix_path() {
+    cout << "=== Test Long Unix Path ===" << endl;
+
+    string path = "/tmp/re_muduo_test_tcpserver_" + string(70, 'p') + ".sock";
+    InetAddress listenAddr = InetAddress::fromUnixPath(path);
+    assert(listenAddr.isValid());
+
+    EventLoop loop;
+    TcpServer server(&loop, listenAddr);
+    server.setThreadNum(2);
+    const int kConns = 3;
+    mutex mu;
+    condition_variable cond;
+    vector<string> names;
+    int closed = 0;
+    server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        lock_guard<mutex> lock(mu);
+        if (conn->connected()) {
+            names.push_back(conn->name());
+        } else {
+            ++closed;
+        }
+        cond.notify_all();
+    });
+    server.start();
+
+    thread client([&]() {
+        vector<int> fds;
+        for (int i = 0; i < kConns; ++i) {
+            int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            int ret = ::connect(fd, listenAddr.getGenericSockAddr(), listenAddr.getSockAddrLen());
+            assert(ret == 0);
+            (void)ret;
+            fds.push_back(fd);
+        }
+        unique_lock<mutex> lock(mu);
+        cond.wait(lock, [&] { return names.size() == static_cast<size_t>(kConns); });
+        lock.unlock();
+        for (int fd : fds) {
+            ::close(fd);
+        }
+        lock.lock();
+        cond.wait(lock, [&] { return closed == kConns; });
+        loop.queueInLoop([&loop]() { loop.quit(); });
+    });
+
+    loop.loop();
+    client.join();
+
+    assert(names.size() == static_cast<size_t>(kConns));
+    for (int i = 0; i < kConns; ++i) {
+        const string& name = names[i];
+        assert(name.find(path) != string::npos);
+        for (int j = 0; j < i; ++j) {
+            assert(names[j] != name);
+        }
+    }
+    cout << "Long unix path test passed" << endl;
+}
+
 int main() {
     cout << "=== TcpServer Tests ===" << endl;
 
@@ -192,6 +472,10 @@ int main() {
     test_connection_management();
     test_thread_init_callback();
     test_server_timeout_settings();
+    test_incoming_cpu_steering();
+    test_adjust_thread_num();
+    test_unix_domain_socket();
+    test_long_unix_path();
 
     cout << "=== All TcpServer Tests Passed ===" << endl;
     return 0;
@@ -0,0 +1,272 @@
+#include "ThreadPool.h"
+#include "Eventloop.h"
+#include "CurrentThread.h"
+#include "Timer.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <string>
+
+// 测试基本的任务执行
+void test_basic_run() {
+    std::cout << "=== Test Basic Run ===" << std::endl;
+
+    ThreadPool pool("TestPool");
+    pool.start(4);
+    assert(pool.numThreads() == 4);
+
+    std::atomic<int> counter(0);
+    for (int i = 0; i < 1000; ++i) {
+        pool.run([&counter]() { counter++; });
+    }
+    pool.stop();
+
+    // stop() 等待所有已提交任务执行完
+    assert(counter == 1000);
+    std::cout << "Basic run test passed" << std::endl;
+}
+
+// 测试工作线程内提交的任务（进入本地队列，可被其他线程窃取）
+void test_nested_run() {
+    std::cout << "=== Test Nested Run ===" << std::endl;
+
+    ThreadPool pool("TestPool");
+    pool.start(3);
+
+    std::atomic<int> counter(0);
+    pool.run([&pool, &counter]() {
+        for (int i = 0; i < 100; ++i) {
+            pool.run([&counter]() {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                counter++;
+            });
+        }
+    });
+
+    for (int i = 0; i < 200 && counter < 100; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    assert(counter == 100);
+    pool.stop();
+    std::cout << "Nested run test passed" << std::endl;
+}
+
+// 测试同一strand上的任务按顺序串行执行
+void test_strand_ordering() {
+    std::cout << "=== Test Strand Ordering ===" << std::endl;
+
+    ThreadPool pool("TestPool");
+    pool.start(4);
+
+    const int kStrands = 8;
+    const int kTasks = 500;
+    std::vector<StrandPtr> strands;
+    std::vector<std::vector<int>> results(kStrands);
+    std::vector<std::atomic<int>> running(kStrands);
+    std::atomic<bool> overlapped(false);
+
+    for (int s = 0; s < kStrands; ++s) {
+        strands.push_back(std::make_shared<Strand>(&pool));
+        running[s] = 0;
+    }
+
+    for (int i = 0; i < kTasks; ++i) {
+        for (int s = 0; s < kStrands; ++s) {
+            strands[s]->post([s, i, &results, &running, &overlapped]() {
+                if (running[s].fetch_add(1) != 0) {
+                    overlapped = true;
+                }
+                results[s].push_back(i);
+                running[s].fetch_sub(1);
+            });
+        }
+    }
+    pool.stop();
+
+    assert(!overlapped);
+    for (int s = 0; s < kStrands; ++s) {
+        assert(results[s].size() == static_cast<size_t>(kTasks));
+        for (int i = 0; i < kTasks; ++i) {
+            assert(results[s][i] == i);
+        }
+    }
+    std::cout << "Strand ordering test passed" << std::endl;
+}
+
+// 测试计算结果送回所属的EventLoop
+void test_result_to_loop() {
+    std::cout << "=== Test Result To Loop ===" << std::endl;
+
+    EventLoop loop;
+    ThreadPool pool("TestPool");
+    pool.start(2);
+    StrandPtr strand = std::make_shared<Strand>(&pool);
+
+    int loopTid = CurrentThread::tid();
+    std::atomic<int> workerTid(0);
+    std::string received;
+    int doneTid = 0;
+
+    strand->postThenInLoop(
+        [&workerTid]() {
+            workerTid = CurrentThread::tid();
+            return std::string(1000, 'x');
+        },
+        &loop,
+        [&received, &doneTid, &loop](std::string result) {
+            received = std::move(result);
+            doneTid = CurrentThread::tid();
+            loop.quit();
+        });
+
+    loop.runAfter(2.0, [&loop]() { loop.quit(); });
+    loop.loop();
+    pool.stop();
+
+    assert(received.size() == 1000);
+    assert(workerTid != loopTid);
+    assert(doneTid == loopTid);
+    std::cout << "Result to loop test passed" << std::endl;
+}
+
+// 测试work、done和结果都是只能移动的类型
+void test_move_only_result() {
+    std::cout << "=== Test Move Only Result ===" << std::endl;
+
+    EventLoop loop;
+    ThreadPool pool("TestPool");
+    pool.start(2);
+
+    int received = 0;
+    std::unique_ptr<int> seed(new int(20));
+    std::unique_ptr<int> bonus(new int(1));
+    pool.runThenInLoop(
+        [seed = std::move(seed)]() { return std::unique_ptr<int>(new int(*seed + 1)); },
+        &loop,
+        [bonus = std::move(bonus), &received, &loop](std::unique_ptr<int> result) {
+            received = *result + *bonus;
+            loop.quit();
+        });
+
+    loop.runAfter(2.0, [&loop]() { loop.quit(); });
+    loop.loop();
+    pool.stop();
+
+    assert(received == 22);
+    std::cout << "Move only result test passed" << std::endl;
+}
+
+// 测试work返回void和返回引用：void时调用done()，引用时done收到一份拷贝
+void test_void_and_reference_result() {
+    std::cout << "=== Test Void And Reference Result ===" << std::endl;
+
+    EventLoop loop;
+    ThreadPool pool("TestPool");
+    pool.start(2);
+    StrandPtr strand = std::make_shared<Strand>(&pool);
+
+    std::atomic<bool> workRan(false);
+    bool voidDone = false;
+    strand->postThenInLoop(
+        [&workRan]() { workRan = true; },
+        &loop,
+        [&voidDone]() { voidDone = true; });
+
+    std::string source(100, 'r');
+    std::string received;
+    pool.runThenInLoop(
+        [&source]() -> const std::string& { return source; },
+        &loop,
+        [&received, &loop](std::string result) {
+            received = std::move(result);
+            loop.quit();
+        });
+
+    loop.runAfter(2.0, [&loop]() { loop.quit(); });
+    loop.loop();
+    pool.stop();
+
+    assert(workRan);
+    assert(voidDone);
+    assert(received == source);
+    std::cout << "Void and reference result test passed" << std::endl;
+}
+
+// 测试strand每次调度最多连续执行kMaxBatch(64)个任务，之后让出工作线程
+void test_strand_batch_limit() {
+    std::cout << "=== Test Strand Batch Limit ===" << std::endl;
+
+    ThreadPool pool("TestPool");
+    pool.start(1);
+    StrandPtr strand = std::make_shared<Strand>(&pool);
+
+    // 先堵住唯一的工作线程，让strand的任务和之后提交的任务按顺序排在队列里
+    std::atomic<bool> release(false);
+    pool.run([&release]() {
+        while (!release) {
+            std::this_thread::yield();
+        }
+    });
+    const int kTasks = 200;
+    std::atomic<int> executed(0);
+    for (int i = 0; i < kTasks; ++i) {
+        strand->post([&executed]() { executed++; });
+    }
+    std::atomic<int> executedAtMarker(-1);
+    pool.run([&executedAtMarker, &executed]() { executedAtMarker = executed.load(); });
+    release = true;
+    // stop()之后重新排队的任务会在调用线程中执行，所以先等所有任务完成
+    while (executed != kTasks) {
+        std::this_thread::yield();
+    }
+    pool.stop();
+
+    assert(executedAtMarker == 64);
+    std::cout << "Strand batch limit test passed" << std::endl;
+}
+
+// 测试stop()与其他线程的run()并发：每个任务要么进入队列后被执行，要么在调用线程中执行
+void test_run_during_stop() {
+    std::cout << "=== Test Run During Stop ===" << std::endl;
+
+    for (int round = 0; round < 20; ++round) {
+        ThreadPool pool("TestPool");
+        pool.start(2);
+        std::atomic<int> counter(0);
+        std::atomic<bool> go(false);
+        const int kTasks = 2000;
+        std::thread submitter([&]() {
+            go = true;
+            for (int i = 0; i < kTasks; ++i) {
+                pool.run([&counter]() { counter++; });
+            }
+        });
+        while (!go) {
+            std::this_thread::yield();
+        }
+        pool.stop();
+        submitter.join();
+        assert(counter == kTasks);
+    }
+    std::cout << "Run during stop test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "=== ThreadPool Tests ===" << std::endl;
+
+    test_basic_run();
+    test_nested_run();
+    test_strand_ordering();
+    test_result_to_loop();
+    test_move_only_result();
+    test_void_and_reference_result();
+    test_strand_batch_limit();
+    test_run_during_stop();
+
+    std::cout << "=== All ThreadPool Tests Passed ===" << std::endl;
+    return 0;
+}
@@ -3,6 +3,10 @@
 #include <cassert>
 #include <thread>
 #include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <cstdlib>
 
 void test_timestamp_default_constructor() {
     std::cout << "Test Timestamp default constructor" << std::endl;
@@ -216,6 +220,63 @@ void test_timestamp_format() {
     std::cout << "Timestamp format test passed" << std::endl;
 }
 
+// 和localtime_r逐个比较：跨越秒边界时缓存要重建，同一秒内只改微秒
+void test_timestamp_format_cache() {
+    std::cout << "Test Timestamp format cache" << std::endl;
+
+    int64_t base = Timestamp::now().microSecondsSinceEpoch();
+    const int64_t offsets[] = {0, 1, 999999, 1000000, 1000001, 500000, -1000000, 59000000, 3600000000LL, 7};
+    for (int64_t offset : offsets) {
+        Timestamp ts(base + offset);
+        time_t seconds = static_cast<time_t>(ts.microSecondsSinceEpoch() / Timestamp::kMicroSecondsPerSecond);
+        struct tm tm_time;
+        localtime_r(&seconds, &tm_time);
+        char expected[96];  // 按每个%d最长11个字符留足空间
+        snprintf(expected, sizeof expected, "%04d%02d%02d %02d:%02d:%02d.%06d",
+                 tm_time.tm_year + 1900, tm_time.tm_mon + 1, tm_time.tm_mday,
+                 tm_time.tm_hour, tm_time.tm_min, tm_time.tm_sec,
+                 static_cast<int>(ts.microSecondsSinceEpoch() % Timestamp::kMicroSecondsPerSecond));
+        assert(ts.to_string() == expected);
+
+        char buf[Timestamp::kFormattedSize];
+        assert(ts.format(buf) == Timestamp::kFormattedSize);
+        assert(std::string(buf, sizeof buf) == expected);
+    }
+
+    std::cout << "Timestamp format cache test passed" << std::endl;
+}
+
+// 夏令时切换前后的UTC偏移不同，跨过整点后要重新取偏移
+void test_timestamp_dst_offset() {
+    std::cout << "Test Timestamp DST offset" << std::endl;
+
+    const char* oldTz = getenv("TZ");
+    std::string savedTz = oldTz ? oldTz : "";
+    setenv("TZ", "America/New_York", 1);
+    tzset();
+
+    // 2021-03-14 07:00:00 UTC，当地时间从02:00跳到03:00
+    const int64_t kSpringForward = 1615705200;
+    assert(Timestamp((kSpringForward - 1) * Timestamp::kMicroSecondsPerSecond).to_string() ==
+           "20210314 01:59:59.000000");
+    assert(Timestamp(kSpringForward * Timestamp::kMicroSecondsPerSecond).to_string() ==
+           "20210314 03:00:00.000000");
+    // 2021-11-07 06:00:00 UTC，当地时间从02:00回到01:00
+    const int64_t kFallBack = 1636264800;
+    assert(Timestamp((kFallBack - 1) * Timestamp::kMicroSecondsPerSecond).to_string() ==
+           "20211107 01:59:59.000000");
+    assert(Timestamp(kFallBack * Timestamp::kMicroSecondsPerSecond).to_string() ==
+           "20211107 01:00:00.000000");
+
+    if (oldTz) {
+        setenv("TZ", savedTz.c_str(), 1);
+    } else {
+        unsetenv("TZ");
+    }
+    tzset();
+    std::cout << "Timestamp DST offset test passed" << std::endl;
+}
+
 int main() {
     std::cout << "=== Timestamp Tests ===" << std::endl;
 
@@ -231,6 +292,8 @@ int main() {
     test_timestamp_boundary_values();
     test_timestamp_precision();
     test_timestamp_format();
+    test_timestamp_format_cache();
+    test_timestamp_dst_offset();
 
     std::cout << "=== All Timestamp Tests Passed ===" << std::endl;
     return 0;
@@ -0,0 +1,212 @@
+#include "UdpServer.h"
+#include "UdpChannel.h"
+#include "Eventloop.h"
+#include "InetAddress.h"
+#include "Timer.h"
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+using namespace std;
+
+static int createClientSocket() {
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    timeval tv{2, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
+    return fd;
+}
+
+// 测试批量接收并批量回显
+void test_batch_echo() {
+    cout << "=== Test Batch Echo ===" << endl;
+
+    EventLoop loop;
+    InetAddress addr(19001);
+    UdpServer server(&loop, addr, "UdpEcho");
+    server.setBatchCallback([](UdpChannel* channel, const Datagram* datagrams, size_t n, Timestamp) {
+        for (size_t i = 0; i < n; ++i) {
+            channel->send(datagrams[i].peer, datagrams[i].data, datagrams[i].len);
+        }
+    });
+    server.start();
+
+    // loop启动前先把报文堆进接收缓冲区，保证recvmmsg能一次取到多个
+    const int kCount = 128;
+    int fd = createClientSocket();
+    for (int i = 0; i < kCount; ++i) {
+        string msg = "datagram-" + to_string(i);
+        ::sendto(fd, msg.data(), msg.size(), 0, (const sockaddr*)addr.getSockAddr(), sizeof(sockaddr_in));
+    }
+
+    int echoed = 0;
+    bool ordered = true;
+    thread client([&]() {
+        char buf[2048];
+        for (int i = 0; i < kCount; ++i) {
+            ssize_t n = ::recv(fd, buf, sizeof buf, 0);
+            if (n <= 0) break;
+            if (string(buf, n) != "datagram-" + to_string(i)) ordered = false;
+            ++echoed;
+        }
+        loop.quit();
+    });
+
+    loop.runAfter(5.0, [&loop]() { loop.quit(); });
+    loop.loop();
+    client.join();
+    ::close(fd);
+
+    assert(echoed == kCount);
+    assert(ordered);
+    assert(server.datagramsReceived() == static_cast<uint64_t>(kCount));
+    assert(server.datagramsSent() == static_cast<uint64_t>(kCount));
+    // 默认每批64个报文
+    assert(server.recvCalls() <= 4);
+    assert(server.sendCalls() <= 4);
+    cout << "Batch echo test passed, recvCalls=" << server.recvCalls()
+         << " sendCalls=" << server.sendCalls() << endl;
+}
+
+// 测试按段发送：开启GSO时以大报文提交，开启GRO时接收端拆回原始报文
+void test_segments_gso_gro() {
+    cout << "=== Test GSO/GRO Segments ===" << endl;
+
+    EventLoop loop;
+    InetAddress addr(19002);
+    UdpServer server(&loop, addr, "UdpGro");
+    server.enableGro(true);
+    const size_t kSegment = 1000;
+    const size_t kSegments = 100;
+    size_t received = 0;
+    bool intact = true;
+    server.setBatchCallback([&](UdpChannel*, const Datagram* datagrams, size_t n, Timestamp) {
+        for (size_t i = 0; i < n; ++i) {
+            if (datagrams[i].len != kSegment) intact = false;
+            // 每段内容都是同一个字节，值为段号
+            char expect = static_cast<char>(datagrams[i].data[0]);
+            for (size_t j = 0; j < datagrams[i].len; ++j) {
+                if (datagrams[i].data[j] != expect) intact = false;
+            }
+            ++received;
+        }
+        if (received == kSegments) loop.quit();
+    });
+    server.start();
+
+    UdpChannelPtr sender(make_shared<UdpChannel>(&loop, InetAddress(0)));
+    bool gso = sender->enableGso(true);
+    sender->start();
+    string payload;
+    for (size_t i = 0; i < kSegments; ++i) {
+        payload.append(kSegment, static_cast<char>(i));
+    }
+    // 在loop线程的事件回调中发送，本轮循环结束前统一提交
+    loop.runAfter(0.01, [&]() {
+        sender->sendSegments(addr, payload.data(), payload.size(), kSegment);
+    });
+
+    loop.runAfter(3.0, [&loop]() { loop.quit(); });
+    loop.loop();
+    sender->stopInLoop();
+
+    assert(received == kSegments);
+    assert(intact);
+    assert(sender->datagramsSent() == kSegments);
+    if (gso) {
+        // 100段按每次最多64段提交，只需要一次sendmmsg
+        assert(sender->sendCalls() == 1);
+    }
+    cout << "GSO/GRO segments test passed, gso=" << gso
+         << " gro=" << server.channels()[0]->groEnabled()
+         << " recvCalls=" << server.recvCalls() << endl;
+}
+
+// 测试多个IO线程各自持有SO_REUSEPORT的socket
+void test_reuseport_threads() {
+    cout << "=== Test ReusePort Threads ===" << endl;
+
+    EventLoop loop;
+    InetAddress addr(19003);
+    UdpServer server(&loop, addr, "UdpMulti");
+    server.setThreadNum(3);
+    atomic<int> received(0);
+    server.setBatchCallback([&received](UdpChannel* channel, const Datagram*, size_t n, Timestamp) {
+        channel->getLoop()->assertInLoopThread();
+        received += static_cast<int>(n);
+    });
+    server.start();
+    assert(server.channels().size() == 3);
+
+    const int kClients = 16;
+    const int kPerClient = 20;
+    for (int c = 0; c < kClients; ++c) {
+        int fd = createClientSocket();
+        for (int i = 0; i < kPerClient; ++i) {
+            ::sendto(fd, "x", 1, 0, (const sockaddr*)addr.getSockAddr(), sizeof(sockaddr_in));
+        }
+        ::close(fd);
+    }
+
+    for (int i = 0; i < 200 && received < kClients * kPerClient; ++i) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    assert(received == kClients * kPerClient);
+    assert(server.datagramsReceived() == static_cast<uint64_t>(kClients * kPerClient));
+    cout << "ReusePort threads test passed" << endl;
+}
+
+// 测试超过接收上限的报文被丢弃，不会以截断后的内容交给应用
+void test_truncated_dropped() {
+    cout << "=== Test Truncated Dropped ===" << endl;
+
+    EventLoop loop;
+    InetAddress addr(19004);
+    UdpChannelPtr channel(make_shared<UdpChannel>(&loop, addr));
+    channel->setMaxDatagramSize(100);
+    vector<string> received;
+    channel->setBatchCallback([&](UdpChannel*, const Datagram* datagrams, size_t n, Timestamp) {
+        for (size_t i = 0; i < n; ++i) {
+            received.emplace_back(datagrams[i].data, datagrams[i].len);
+        }
+        if (received.size() == 2) loop.quit();
+    });
+    channel->start();
+
+    int fd = createClientSocket();
+    const string messages[] = {"small", string(200, 'x'), "after"};
+    for (const string& msg : messages) {
+        ::sendto(fd, msg.data(), msg.size(), 0, (const sockaddr*)addr.getSockAddr(), sizeof(sockaddr_in));
+    }
+
+    loop.runAfter(2.0, [&loop]() { loop.quit(); });
+    loop.loop();
+    channel->stopInLoop();
+    ::close(fd);
+
+    assert(received.size() == 2);
+    assert(received[0] == "small" && received[1] == "after");
+    assert(channel->datagramsTruncated() == 1);
+    assert(channel->datagramsReceived() == 2);
+    cout << "Truncated dropped test passed" << endl;
+}
+
+int main() {
+    cout << "=== UdpServer Tests ===" << endl;
+
+    test_batch_echo();
+    test_segments_gso_gro();
+    test_reuseport_threads();
+    test_truncated_dropped();
+
+    cout << "=== All UdpServer Tests Passed ===" << endl;
+    return 0;
+}
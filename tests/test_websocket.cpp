@@ -0,0 +1,298 @@
+#include "WebSocket.h"
+#include "HttpRequest.h"
+#include "BufferScan.h"
+#include "TcpClient.h"
+#include "TcpConnection.h"
+#include "Eventloop.h"
+#include "InetAddress.h"
+#include "Buffer.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 测试RFC 6455中的握手示例
+void test_accept_key() {
+    cout << "=== Test Accept Key ===" << endl;
+    assert(websocket::acceptKey("dGhlIHNhbXBsZSBub25jZQ==") == "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+    cout << "Accept key test passed" << endl;
+}
+
+// 测试各实现的解掩码与逐字节结果一致，覆盖各种长度、起始对齐和密钥相位
+void test_xor_mask() {
+    cout << "=== Test Xor Mask ===" << endl;
+
+    const unsigned char key[4] = {0x12, 0x34, 0xAB, 0xCD};
+    const scan::Implementation detected = scan::implementation();
+    const scan::Implementation impls[] = {scan::kScalar, scan::kSse2, scan::kAvx2};
+    for (scan::Implementation impl : impls) {
+        if (!scan::setImplementation(impl)) {
+            continue;
+        }
+        for (size_t len = 0; len < 300; ++len) {
+            for (size_t align = 0; align < 4; ++align) {
+                for (size_t phase = 0; phase < 4; ++phase) {
+                    string data(len + align, '\0');
+                    for (size_t i = 0; i < data.size(); ++i) data[i] = static_cast<char>(i * 7 + 3);
+                    string expected = data;
+                    for (size_t i = 0; i < len; ++i) {
+                        expected[align + i] = static_cast<char>(expected[align + i] ^ key[(phase + i) & 3]);
+                    }
+                    scan::xorMask(&data[align], len, key, phase);
+                    assert(data == expected);
+                }
+            }
+        }
+        // 分段解掩码与一次解掩码结果相同
+        string whole(1000, 'w');
+        string parts = whole;
+        scan::xorMask(&whole[0], whole.size(), key);
+        scan::xorMask(&parts[0], 333, key, 0);
+        scan::xorMask(&parts[333], 667, key, 333);
+        assert(whole == parts);
+    }
+    scan::setImplementation(detected);
+    cout << "Xor mask test passed" << endl;
+}
+
+// 测试帧头编码的三种长度格式
+void test_frame_header() {
+    cout << "=== Test Frame Header ===" << endl;
+
+    char header[websocket::kMaxFrameHeaderSize];
+    assert(websocket::encodeFrameHeader(header, websocket::kText, 125) == 2);
+    assert(static_cast<unsigned char>(header[0]) == 0x81 && header[1] == 125);
+    assert(websocket::encodeFrameHeader(header, websocket::kBinary, 126, false) == 4);
+    assert(static_cast<unsigned char>(header[0]) == 0x02 && header[1] == 126 && header[3] == 126);
+    assert(websocket::encodeFrameHeader(header, websocket::kBinary, 65536) == 10);
+    assert(static_cast<unsigned char>(header[1]) == 127 && header[7] == 1 && header[8] == 0);
+    const unsigned char key[4] = {1, 2, 3, 4};
+    assert(websocket::encodeFrameHeader(header, websocket::kPing, 0, true, key) == 6);
+    assert(static_cast<unsigned char>(header[1]) == 0x80 && header[5] == 4);
+    cout << "Frame header test passed" << endl;
+}
+
+namespace {
+
+// 客户端发出的帧必须带掩码
+string clientFrame(websocket::Opcode opcode, const string& payload, bool fin = true) {
+    static const unsigned char key[4] = {0x5A, 0xC3, 0x01, 0x7E};
+    char header[websocket::kMaxFrameHeaderSize];
+    size_t n = websocket::encodeFrameHeader(header, opcode, payload.size(), fin, key);
+    string masked = payload;
+    scan::xorMask(&masked[0], masked.size(), key);
+    return string(header, n) + masked;
+}
+
+struct Frame {
+    int opcode;
+    string payload;
+};
+
+// 解析服务器发来的不带掩码的帧
+bool parseServerFrame(Buffer* buf, Frame* frame) {
+    if (buf->readableBytes() < 2) return false;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(buf->peek());
+    size_t len = p[1] & 0x7F;
+    size_t headerLen = 2;
+    if (len == 126) {
+        if (buf->readableBytes() < 4) return false;
+        len = (p[2] << 8) | p[3];
+        headerLen = 4;
+    } else if (len == 127) {
+        if (buf->readableBytes() < 10) return false;
+        len = 0;
+        for (int i = 0; i < 8; ++i) len = (len << 8) | p[2 + i];
+        headerLen = 10;
+    }
+    if (buf->readableBytes() < headerLen + len) return false;
+    frame->opcode = p[0] & 0x0F;
+    frame->payload.assign(buf->peek() + headerLen, len);
+    buf->retrieve(headerLen + len);
+    return true;
+}
+
+} // namespace
+
+// 端到端：握手后紧跟的帧、分片中穿插Ping、1MB大帧、批量推送、关闭握手，以及非升级请求返回426
+void test_server_end_to_end() {
+    cout << "=== Test Server End To End ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(19007);
+    WebSocketServer server(&loop, serverAddr, TcpServer::kReusePort);
+    int opened = 0;
+    int closed = 0;
+    server.setHandshakeCallback([](const HttpRequest& req) {
+        return req.path() == "/ws";
+    });
+    server.setConnectionCallback([&](const WebSocketConnectionPtr& ws) {
+        if (ws->connected()) ++opened;
+        else ++closed;
+    });
+    server.setMessageCallback([](const WebSocketConnectionPtr& ws, string_view msg,
+                                 websocket::Opcode opcode, Timestamp) {
+        if (msg == "batch") {
+            const string_view replies[] = {"one", "two", "three"};
+            ws->send(replies, 3);
+        } else {
+            ws->send(msg, opcode);
+        }
+    });
+    server.start();
+
+    const string bigPayload = [] {
+        string s(1024 * 1024, '\0');
+        for (size_t i = 0; i < s.size(); ++i) s[i] = static_cast<char>(i % 251);
+        return s;
+    }();
+
+    bool handshakeOk = false;
+    vector<Frame> frames;
+    bool clientDisconnected = false;
+    TcpClient client(&loop, serverAddr, "WsClient");
+    client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            // 握手请求和第一帧在同一次写中发出
+            conn->send("GET /ws HTTP/1.1\r\n"
+                       "Host: 127.0.0.1\r\n"
+                       "Upgrade: websocket\r\n"
+                       "Connection: keep-alive, Upgrade\r\n"
+                       "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                       "Sec-WebSocket-Version: 13\r\n"
+                       "\r\n" + clientFrame(websocket::kText, "first"));
+        } else {
+            clientDisconnected = true;
+            // 等服务器端也处理完断开
+            loop.runAfter(0.2, [&loop]() { loop.quit(); });
+        }
+    });
+    client.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+        if (!handshakeOk) {
+            const char* end = buf->findCRLF();
+            while (end && (end + 2 - buf->peek() < 4 || string(end - 2, 4) != "\r\n\r\n")) {
+                end = buf->findCRLF(end + 2);
+            }
+            if (!end) return;
+            string response(buf->peek(), end + 2);
+            buf->retrieveUntil(end + 2);
+            assert(response.compare(0, 34, "HTTP/1.1 101 Switching Protocols\r\n") == 0);
+            assert(response.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n") != string::npos);
+            handshakeOk = true;
+            // 分片消息中间穿插一个Ping，然后是大帧和批量推送请求
+            conn->send(clientFrame(websocket::kText, "hel", false)
+                       + clientFrame(websocket::kPing, "p")
+                       + clientFrame(websocket::kContinuation, "lo", true)
+                       + clientFrame(websocket::kBinary, bigPayload)
+                       + clientFrame(websocket::kText, "batch"));
+        }
+        Frame frame;
+        while (parseServerFrame(buf, &frame)) {
+            frames.push_back(frame);
+            if (frames.size() == 7) {
+                string closePayload("\x03\xe8", 2);
+                conn->send(clientFrame(websocket::kClose, closePayload));
+            }
+        }
+    });
+    client.connect();
+
+    // 不是升级请求的普通HTTP请求
+    string plainResponse;
+    TcpClient plain(&loop, serverAddr, "PlainClient");
+    plain.setConnectionCallback([](const TcpConnectionPtr& conn) {
+        if (conn->connected()) conn->send("GET / HTTP/1.1\r\nConnection: close\r\n\r\n");
+    });
+    plain.setMessageCallback([&plainResponse](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+        plainResponse += buf->retrieveAllAsString();
+    });
+    plain.connect();
+
+    loop.runAfter(5.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(handshakeOk);
+    assert(clientDisconnected);
+    assert(frames.size() == 8);
+    assert(frames[0].opcode == websocket::kText && frames[0].payload == "first");
+    assert(frames[1].opcode == websocket::kPong && frames[1].payload == "p");
+    assert(frames[2].opcode == websocket::kText && frames[2].payload == "hello");
+    assert(frames[3].opcode == websocket::kBinary && frames[3].payload == bigPayload);
+    assert(frames[4].payload == "one" && frames[5].payload == "two" && frames[6].payload == "three");
+    assert(frames[7].opcode == websocket::kClose && frames[7].payload == string("\x03\xe8", 2));
+    assert(opened == 1 && closed == 1);
+    assert(plainResponse.compare(0, 30, "HTTP/1.1 426 Upgrade Required\r") == 0);
+    cout << "Server end to end test passed" << endl;
+}
+
+// 测试协议错误：未掩码的帧以1002关闭，超过上限的消息以1009关闭
+void test_protocol_errors() {
+    cout << "=== Test Protocol Errors ===" << endl;
+
+    EventLoop loop;
+    InetAddress serverAddr(19008);
+    WebSocketServer server(&loop, serverAddr, TcpServer::kReusePort);
+    server.setMaxMessageSize(1024);
+    server.start();
+
+    const string handshake =
+        "GET / HTTP/1.1\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+        "Sec-WebSocket-Version: 13\r\n"
+        "\r\n";
+    char unmaskedHeader[websocket::kMaxFrameHeaderSize];
+    size_t n = websocket::encodeFrameHeader(unmaskedHeader, websocket::kText, 2);
+    const string inputs[] = {
+        handshake + string(unmaskedHeader, n) + "hi",
+        handshake + clientFrame(websocket::kBinary, string(2048, 'x')),
+    };
+    const int expectedCodes[] = {websocket::kProtocolError, websocket::kMessageTooBig};
+
+    int finished = 0;
+    vector<int> codes(2, 0);
+    vector<unique_ptr<TcpClient>> clients;
+    for (int i = 0; i < 2; ++i) {
+        clients.emplace_back(new TcpClient(&loop, serverAddr, "ErrClient" + to_string(i)));
+        clients[i]->setConnectionCallback([&, i](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                conn->send(inputs[i]);
+            } else if (++finished == 2) {
+                loop.quit();
+            }
+        });
+        clients[i]->setMessageCallback([&codes, i](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+            string data = buf->retrieveAllAsString();
+            size_t pos = data.find("\r\n\r\n");
+            if (pos != string::npos && data.size() >= pos + 6) {
+                const unsigned char* f = reinterpret_cast<const unsigned char*>(data.data() + pos + 4);
+                if ((f[0] & 0x0F) == websocket::kClose) codes[i] = (f[2] << 8) | f[3];
+            }
+        });
+        clients[i]->connect();
+    }
+
+    loop.runAfter(3.0, [&loop]() { loop.quit(); });
+    loop.loop();
+
+    assert(finished == 2);
+    assert(codes[0] == expectedCodes[0]);
+    assert(codes[1] == expectedCodes[1]);
+    cout << "Protocol errors test passed" << endl;
+}
+
+int main() {
+    cout << "=== WebSocket Tests ===" << endl;
+
+    test_accept_key();
+    test_xor_mask();
+    test_frame_header();
+    test_server_end_to_end();
+    test_protocol_errors();
+
+    cout << "=== All WebSocket Tests Passed ===" << endl;
+    return 0;
+}
@@ -0,0 +1,51 @@
+// 把AsyncLogging以kBinaryRaw写出的二进制日志解码成文本
+// 用法: binlog_decode [文件...]，不给文件时读标准输入，结果写到标准输出
+#include "BinaryLog.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+namespace {
+
+// 按块读入，末尾不完整的记录留到下一块
+bool decodeFile(FILE* fp, binlog::Decoder* decoder) {
+    std::string pending;
+    std::string text;
+    char buf[64 * 1024];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof buf, fp)) > 0) {
+        pending.append(buf, n);
+        text.clear();
+        size_t consumed = decoder->decode(pending.data(), pending.size(), &text);
+        pending.erase(0, consumed);
+        fwrite(text.data(), 1, text.size(), stdout);
+    }
+    if (!pending.empty()) {
+        fprintf(stderr, "binlog_decode: %zu trailing bytes are not a complete record\n", pending.size());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // 格式点定义只在各文件开头写一次，同一个Decoder按顺序解码所有文件
+    binlog::Decoder decoder(false);
+    if (argc < 2) {
+        return decodeFile(stdin, &decoder) ? 0 : 1;
+    }
+    bool ok = true;
+    for (int i = 1; i < argc; ++i) {
+        FILE* fp = fopen(argv[i], "rb");
+        if (fp == nullptr) {
+            fprintf(stderr, "binlog_decode: cannot open %s: %s\n", argv[i], strerror(errno));
+            ok = false;
+            continue;
+        }
+        ok = decodeFile(fp, &decoder) && ok;
+        fclose(fp);
+    }
+    return ok ? 0 : 1;
+}